@@ -355,23 +355,21 @@ int IRRCALLCONV main(int argc, char* argv[])
 		int fps = driver->getFPS();
 		//if (lastFPS != fps)
 		{
-			io::IAttributes * const attr = smgr->getParameters();
+			const scene::SSceneStatistics& stats = smgr->getFrameStatistics();
 			core::stringw str = L"Q3 [";
 			str += driver->getName();
 			str += "] FPS:";
 			str += fps;
-#ifdef _IRR_SCENEMANAGER_DEBUG			
 			str += " Cull:";
-			str += attr->getAttributeAsInt("calls");
+			str += stats.RegisterCalls;
 			str += "/";
-			str += attr->getAttributeAsInt("culled");
+			str += stats.Culled;
 			str += " Draw: ";
-			str += attr->getAttributeAsInt("drawn_solid");
+			str += stats.DrawnSolid;
 			str += "/";
-			str += attr->getAttributeAsInt("drawn_transparent");
+			str += stats.DrawnTransparent;
 			str += "/";
-			str += attr->getAttributeAsInt("drawn_transparent_effect");
-#endif
+			str += stats.DrawnTransparentEffect;
 			device->setWindowCaption(str.c_str());
 			lastFPS = fps;
 		}
@@ -81,6 +81,12 @@ namespace scene
 		//! Volume Light Scene Node
 		ESNT_VOLUME_LIGHT  = MAKE_IRR_ID('v','o','l','l'),
 
+		//! Static Batch Scene Node
+		ESNT_STATIC_BATCH  = MAKE_IRR_ID('s','b','a','t'),
+
+		//! Instanced Mesh Scene Node
+		ESNT_INSTANCED_MESH = MAKE_IRR_ID('i','m','s','h'),
+
 		//! Maya Camera Scene Node
 		/** Legacy, for loading version <= 1.4.x .irr files */
 		ESNT_CAMERA_MAYA    = MAKE_IRR_ID('c','a','m','M'),
@@ -0,0 +1,119 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __E_VIDEO_COMMANDS_H_INCLUDED__
+#define __E_VIDEO_COMMANDS_H_INCLUDED__
+
+#include "irrTypes.h"
+
+namespace irr
+{
+namespace video
+{
+	//! Commands of a recorded video command stream
+	/** See IVideoDriver::startCommandRecording() and
+	IVideoDriver::replayCommands(). */
+	enum E_VIDEO_COMMAND
+	{
+		//! IVideoDriver::beginScene()
+		EVC_BEGIN_SCENE = 0,
+
+		//! IVideoDriver::endScene()
+		EVC_END_SCENE,
+
+		//! IVideoDriver::setTransform()
+		EVC_SET_TRANSFORM,
+
+		//! IVideoDriver::setMaterial()
+		EVC_SET_MATERIAL,
+
+		//! IVideoDriver::drawVertexPrimitiveList()
+		EVC_DRAW_PRIMITIVES,
+
+		//! IVideoDriver::draw2DVertexPrimitiveList()
+		EVC_DRAW_2D_PRIMITIVES,
+
+		//! IVideoDriver::draw3DLine()
+		EVC_DRAW_3D_LINE,
+
+		//! IVideoDriver::draw2DImage() at a position
+		EVC_DRAW_2D_IMAGE,
+
+		//! IVideoDriver::draw2DImage() into a rectangle
+		EVC_DRAW_2D_IMAGE_RECT,
+
+		//! IVideoDriver::draw2DImageBatch()
+		EVC_DRAW_2D_IMAGE_BATCH,
+
+		//! IVideoDriver::draw2DRectangle() with one color
+		EVC_DRAW_2D_RECTANGLE,
+
+		//! IVideoDriver::draw2DRectangle() with a gradient
+		EVC_DRAW_2D_RECTANGLE_GRADIENT,
+
+		//! IVideoDriver::draw2DLine()
+		EVC_DRAW_2D_LINE,
+
+		//! IVideoDriver::drawPixel()
+		EVC_DRAW_PIXEL,
+
+		//! IVideoDriver::setAmbientLight()
+		EVC_SET_AMBIENT_LIGHT,
+
+		//! IVideoDriver::addDynamicLight()
+		EVC_ADD_DYNAMIC_LIGHT,
+
+		//! IVideoDriver::deleteAllDynamicLights()
+		EVC_DELETE_ALL_DYNAMIC_LIGHTS,
+
+		//! Defines a texture by name, not replayed as a call
+		EVC_TEXTURE,
+
+		//! Defines a vertex or index payload, not replayed as a call
+		EVC_DATA,
+
+		//! Amount of commands in this enumeration
+		EVC_COUNT
+	};
+
+	//! Names of the video commands, for printing replay timings
+	const c8* const VideoCommandNames[] =
+	{
+		"beginScene",
+		"endScene",
+		"setTransform",
+		"setMaterial",
+		"drawVertexPrimitiveList",
+		"draw2DVertexPrimitiveList",
+		"draw3DLine",
+		"draw2DImage",
+		"draw2DImageRect",
+		"draw2DImageBatch",
+		"draw2DRectangle",
+		"draw2DRectangleGradient",
+		"draw2DLine",
+		"drawPixel",
+		"setAmbientLight",
+		"addDynamicLight",
+		"deleteAllDynamicLights",
+		"texture",
+		"data",
+		0
+	};
+
+	//! Time a driver needed for one command of a replayed command stream
+	struct SVideoCommandTiming
+	{
+		//! The replayed command
+		E_VIDEO_COMMAND Command;
+
+		//! Real time the call took, in microseconds
+		u32 Time;
+	};
+
+} // end namespace video
+} // end namespace irr
+
+
+#endif
@@ -0,0 +1,63 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_CLUSTERED_LIGHT_MANAGER_H_INCLUDED__
+#define __I_CLUSTERED_LIGHT_MANAGER_H_INCLUDED__
+
+#include "ISceneManager.h"
+#include "ILightManager.h"
+#include "aabbox3d.h"
+
+namespace irr
+{
+namespace scene
+{
+	class ILightSceneNode;
+
+	//! A light manager which turns on only the lights near each rendered node.
+	/** Once per frame, all point and spot lights are binned into a
+	uniform world space grid of cubic cells, using the bounding sphere
+	given by their radius. Before a node is rendered, the lights whose
+	sphere overlaps the transformed bounding box of the node are looked up
+	in the cells covered by the box, and only the nearest of them are
+	switched on in the video driver. Directional lights affect all nodes.
+	This way scenes can use hundreds of local lights, while each node is
+	still lit by at most the amount of lights the driver can handle.
+	Create it with ISceneManager::createClusteredLightManager() and set
+	it with ISceneManager::setLightManager(). */
+	class IClusteredLightManager : public ILightManager
+	{
+	public:
+
+		//! Sets the edge length of the cubic grid cells.
+		/** Should be in the order of the typical light radius.
+		Takes effect in the next frame. */
+		virtual void setCellSize(f32 size) = 0;
+
+		//! Returns the edge length of the cubic grid cells.
+		virtual f32 getCellSize() const = 0;
+
+		//! Sets the maximal amount of lights switched on for a node.
+		/** \param count Maximal amount of lights. 0, the default, uses
+		IVideoDriver::getMaximalDynamicLightAmount(). */
+		virtual void setMaxLightsPerNode(u32 count) = 0;
+
+		//! Returns the maximal amount of lights switched on for a node.
+		virtual u32 getMaxLightsPerNode() const = 0;
+
+		//! Returns the lights affecting a world space box, nearest first.
+		/** Only valid while the scene is drawn, i.e. from inside the
+		render methods of scene nodes or shader callbacks.
+		\param box World space box to find the lights for.
+		\param outLights Receives the lights. Its previous content is
+		removed. At most getMaxLightsPerNode() lights are returned. */
+		virtual void getLightsInBox(const core::aabbox3d<f32>& box,
+			core::array<ILightSceneNode*>& outLights) = 0;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
@@ -0,0 +1,80 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_INSTANCED_MESH_SCENE_NODE_H_INCLUDED__
+#define __I_INSTANCED_MESH_SCENE_NODE_H_INCLUDED__
+
+#include "ISceneNode.h"
+
+namespace irr
+{
+namespace scene
+{
+	class IMesh;
+
+	//! A scene node drawing one mesh many times with different transformations.
+	/** Each instance has its own transformation relative to the node, so
+	moving the node moves all instances. All instances share the materials
+	of the node, and are drawn with IVideoDriver::drawMeshBufferInstanced(),
+	which issues one call per meshbuffer for all instances together.
+	Useful for vegetation, crowds and other repeated props. The node is
+	culled as a whole, using the bounding box around all instances. */
+	class IInstancedMeshSceneNode : public ISceneNode
+	{
+	public:
+
+		//! constructor
+		IInstancedMeshSceneNode(ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1,1,1))
+			: ISceneNode(parent, mgr, id, position, rotation, scale) {}
+
+		//! Returns type of the scene node
+		virtual ESCENE_NODE_TYPE getType() const { return ESNT_INSTANCED_MESH; }
+
+		//! Sets a new mesh to display for all instances
+		/** \param mesh Mesh to display. */
+		virtual void setMesh(IMesh* mesh) = 0;
+
+		//! Get the currently defined mesh for display.
+		/** \return Pointer to mesh which is displayed by this node. */
+		virtual IMesh* getMesh(void) = 0;
+
+		//! Sets if the scene node should not copy the materials of the mesh but use them in a read only style.
+		/** \param readonly Flag if the materials shall be read-only. */
+		virtual void setReadOnlyMaterials(bool readonly) = 0;
+
+		//! Check if the scene node should not copy the materials of the mesh but use them in a read only style
+		/** \return Whether the materials are read-only. */
+		virtual bool isReadOnlyMaterials() const = 0;
+
+		//! Adds an instance of the mesh.
+		/** \param transform Transformation of the instance relative to this node.
+		\return Index of the new instance. */
+		virtual u32 addInstance(const core::matrix4& transform) = 0;
+
+		//! Removes an instance.
+		/** The last instance takes the index of the removed one.
+		\param index Index of the instance to remove. */
+		virtual void removeInstance(u32 index) = 0;
+
+		//! Removes all instances.
+		virtual void clearInstances() = 0;
+
+		//! Returns amount of instances.
+		virtual u32 getInstanceCount() const = 0;
+
+		//! Sets the transformation of an instance relative to this node.
+		virtual void setInstanceTransform(u32 index, const core::matrix4& transform) = 0;
+
+		//! Returns the transformation of an instance relative to this node.
+		virtual const core::matrix4& getInstanceTransform(u32 index) const = 0;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
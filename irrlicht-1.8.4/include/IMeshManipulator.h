@@ -257,7 +257,12 @@ namespace scene
 		virtual IMesh* createMeshUniquePrimitives(IMesh* mesh) const = 0;
 
 		//! Creates a copy of a mesh with vertices welded
-		/** \param mesh Input mesh
+		/** Each vertex is merged into the first vertex before it in its
+		buffer whose position, normal, tangents and texture coordinates
+		are equal within the tolerance and whose color is the same.
+		Buffers with 32 bit indices keep them and become dynamic mesh
+		buffers, so their size is not limited.
+		\param mesh Input mesh
 		\param tolerance The threshold for vertex comparisons.
 		\return Mesh without redundant vertices. If you no longer need
 		the cloned mesh, you should call IMesh::drop(). See
@@ -16,6 +16,11 @@ namespace scene
 /** This is nothing more than a collection of one or more triangle selectors
 providing together the interface of one triangle selector. In this way,
 collision tests can be done with different triangle soups in one pass.
+The selectors are kept in a tree of their bounding boxes, see
+ITriangleSelector::getTransformedBoundingBox(), so queries only look
+into the selectors they can touch. Queries take the box of a selector
+again when the absolute transformation of its scene node changed since,
+or for meta selectors in the collection, when their box changed.
 */
 class IMetaTriangleSelector : public ITriangleSelector
 {
@@ -33,6 +38,22 @@ public:
 
 	//! Removes all triangle selectors from the collection.
 	virtual void removeAllTriangleSelectors() = 0;
+
+	//! Updates the bounding box of a selector in the collection.
+	/** Moving the scene node of a selector is noticed by the queries,
+	call this when the triangles of the selector moved otherwise.
+	\param toUpdate: Pointer to a triangle selector which is in the list.
+	\return True if successful, false if not. */
+	virtual bool updateTriangleSelector(ITriangleSelector* toUpdate) = 0;
+
+	//! Updates the bounding boxes of all selectors in the collection.
+	virtual void updateAllTriangleSelectors() = 0;
+
+	//! Get the amount of selectors the last query looked into.
+	/** Queries skip the selectors whose bounding box they miss, this
+	tells how many were left. Batches of getCollisionPoints() are not
+	counted, so several threads can run them at the same time. */
+	virtual u32 getVisitedSelectorCount() const = 0;
 };
 
 } // end namespace scene
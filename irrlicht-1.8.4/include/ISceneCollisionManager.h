@@ -10,6 +10,8 @@
 #include "triangle3d.h"
 #include "position2d.h"
 #include "line3d.h"
+#include "aabbox3d.h"
+#include "irrArray.h"
 
 namespace irr
 {
@@ -19,6 +21,45 @@ namespace scene
 	class ISceneNode;
 	class ICameraSceneNode;
 	class ITriangleSelector;
+	struct SCollisionHit;
+
+	//! Triangles around an ellipsoid moved with ISceneCollisionManager::getCollisionResultPosition()
+	/** Keep one cache for each moving object and pass it to every call
+	for this object. The triangles the selector returns around the
+	ellipsoid, with some room to move, are kept in the cache, and the
+	selector is only asked again when the ellipsoid leaves that room or
+	another selector is used. Triangles which move, like those of
+	animated meshes or of nodes moved by other code, are seen at the
+	position they had when they were cached, call clear() after they
+	moved. */
+	struct SCollisionCache
+	{
+		SCollisionCache() : Selector(0) {}
+
+		//! Forgets the triangles, so the next call asks the selector again
+		void clear()
+		{
+			Selector = 0;
+			Triangles.set_used(0);
+			SelectorEnds.set_used(0);
+			SelectorNodes.set_used(0);
+		}
+
+		//! Selector the triangles were taken from, only compared with
+		const ITriangleSelector* Selector;
+
+		//! Box in world space, all triangles of the selector touching it are in Triangles
+		core::aabbox3d<f32> Box;
+
+		//! Triangles touching Box in world space
+		core::array<core::triangle3df> Triangles;
+
+		//! End of the triangles of each selector inside a meta selector
+		core::array<u32> SelectorEnds;
+
+		//! Scene node of each selector inside a meta selector
+		core::array<ISceneNode*> SelectorNodes;
+	};
 
 	//! The Scene Collision Manager provides methods for performing collision tests and picking on scene nodes.
 	class ISceneCollisionManager : public virtual IReferenceCounted
@@ -42,6 +83,41 @@ namespace scene
 				ITriangleSelector* selector, core::vector3df& outCollisionPoint,
 				core::triangle3df& outTriangle, ISceneNode*& outNode) =0;
 
+		//! Finds the nearest collision points of many lines and lots of triangles.
+		/** The lines are split across the threads set with
+		setCollisionThreadCount(), each of them tracing its lines with
+		ITriangleSelector::getCollisionPoints(). The selector is brought
+		up to date once on the calling thread with
+		ITriangleSelector::updateForQueries() and only read afterwards,
+		so it must not be changed until this returns. Selectors created
+		with ISceneManager::createBVHTriangleSelector() trace four lines
+		at once where neighbouring lines start close to each other and
+		point the same way.
+		\param rays: Array of rayCount lines with which collisions are
+		tested.
+		\param rayCount: Amount of lines.
+		\param selector: TriangleSelector containing the triangles.
+		\param outHits: Array of rayCount hits. The hit of each line
+		which collides receives its collision point, triangle and scene
+		node.
+		\param outFound: Array of rayCount flags, true for the lines
+		which collide.
+		\param anyHit: If true, any collision of a line is returned
+		instead of the nearest one, which is faster for visibility
+		tests.
+		\return Amount of lines which collide. */
+		virtual u32 getCollisionPoints(const core::line3d<f32>* rays, u32 rayCount,
+				ITriangleSelector* selector, SCollisionHit* outHits,
+				bool* outFound, bool anyHit=false) =0;
+
+		//! Sets the amount of threads used by getCollisionPoints().
+		/** The threads are shared with the other users of the scene
+		manager, which starts one thread for each processor core.
+		\param threadCount: Most threads used, including the calling
+		one. 0 uses all threads of the scene manager, which is the
+		default. */
+		virtual void setCollisionThreadCount(u32 threadCount) =0;
+
 		//! Collides a moving ellipsoid with a 3d world with gravity and returns the resulting new position of the ellipsoid.
 		/** This can be used for moving a character in a 3d world: The
 		character will slide at walls and is able to walk up stairs.
@@ -64,6 +140,9 @@ namespace scene
 		\param outNode: the node with which the ellipoid collided (if any)
 		\param slidingSpeed: DOCUMENTATION NEEDED.
 		\param gravityDirectionAndSpeed: Direction and force of gravity.
+		\param cache: Triangles kept from earlier calls for the same
+		moving ellipsoid, see SCollisionCache. If 0, the selector is
+		asked for the triangles around the ellipsoid on each call.
 		\return New position of the ellipsoid. */
 		virtual core::vector3df getCollisionResultPosition(
 			ITriangleSelector* selector,
@@ -76,7 +155,8 @@ namespace scene
 			ISceneNode*& outNode,
 			f32 slidingSpeed = 0.0005f,
 			const core::vector3df& gravityDirectionAndSpeed
-			= core::vector3df(0.0f, 0.0f, 0.0f)) = 0;
+			= core::vector3df(0.0f, 0.0f, 0.0f),
+			SCollisionCache* cache = 0) = 0;
 
 		//! Returns a 3d ray which would go through the 2d screen coodinates.
 		/** \param pos: Screen coordinates in pixels.
@@ -19,6 +19,7 @@
 #include "SceneParameters.h"
 #include "IGeometryCreator.h"
 #include "ISkinnedMesh.h"
+#include "SFrameStatistics.h"
 
 namespace irr
 {
@@ -118,6 +119,9 @@ namespace scene
 	class ISceneNodeAnimatorCollisionResponse;
 	class ISceneNodeAnimatorFactory;
 	class ISceneNodeFactory;
+	class IStaticBatchSceneNode;
+	class IInstancedMeshSceneNode;
+	class IClusteredLightManager;
 	class ISceneUserDataSerializer;
 	class ITerrainSceneNode;
 	class ITextSceneNode;
@@ -593,6 +597,44 @@ namespace scene
 			return addOctreeSceneNode(mesh, parent, id, minimalPolysPerNode, alsoAddIfMeshPointerZero);
 		}
 
+		//! Adds a scene node which merges the geometry of static mesh scene nodes.
+		/** All meshbuffers of the given nodes which share the same
+		material are pre-transformed into world space and merged into
+		large meshbuffers with 32bit indices, which are split into cubic
+		chunks of size chunkSize, so that each chunk can be frustum
+		culled on its own. This reduces the amount of draw calls for
+		static level geometry made of many small nodes dramatically.
+		The source nodes stay in the scene graph, but are made invisible
+		while batched. Use IStaticBatchSceneNode::unbatch() to edit them.
+		\param nodes: The static mesh scene nodes to merge.
+		\param parent: Parent node of the batch node.
+		\param id: id of the node. This id can be used to identify the node.
+		\param chunkSize: Edge length of the cubic chunks in world units.
+		\return Pointer to the created scene node.
+		This pointer should not be dropped. See IReferenceCounted::drop() for more information. */
+		virtual IStaticBatchSceneNode* addStaticBatchSceneNode(
+			const core::array<IMeshSceneNode*>& nodes, ISceneNode* parent=0,
+			s32 id=-1, f32 chunkSize=1000.f) = 0;
+
+		//! Adds a scene node drawing a mesh many times with different transformations.
+		/** The instances are added with
+		IInstancedMeshSceneNode::addInstance() and drawn with
+		IVideoDriver::drawMeshBufferInstanced(), so the cost per
+		instance is much lower than with one mesh scene node each.
+		\param mesh: Pointer to the loaded static mesh to be displayed.
+		\param parent: Parent of the scene node. Can be NULL if no parent.
+		\param id: Id of the node. This id can be used to identify the scene node.
+		\param position: Position of the space relative to its parent
+		where the scene node will be placed.
+		\param rotation: Initital rotation of the scene node.
+		\param scale: Initial scale of the scene node.
+		\return Pointer to the created scene node.
+		This pointer should not be dropped. See IReferenceCounted::drop() for more information. */
+		virtual IInstancedMeshSceneNode* addInstancedMeshSceneNode(IMesh* mesh, ISceneNode* parent=0, s32 id=-1,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f)) = 0;
+
 		//! Adds a camera scene node to the scene graph and sets it as active camera.
 		/** This camera does not react on user input like for example the one created with
 		addCameraSceneNodeFPS(). If you want to move or animate it, use animators or the
@@ -1287,10 +1329,15 @@ namespace scene
 		\endcode
 		\param mesh: Mesh of which the triangles are taken.
 		\param node: Scene node of which visibility and transformation is used.
+		\param staticNode: True if the node is not moved anymore. The triangles
+		are then stored with the current absolute transformation of the node
+		already applied, which saves transforming them on each query. Later
+		changes of the transformation are not seen by the selector.
 		\return The selector, or null if not successful.
 		If you no longer need the selector, you should call ITriangleSelector::drop().
 		See IReferenceCounted::drop() for more information. */
-		virtual ITriangleSelector* createTriangleSelector(IMesh* mesh, ISceneNode* node) = 0;
+		virtual ITriangleSelector* createTriangleSelector(IMesh* mesh, ISceneNode* node,
+			bool staticNode=false) = 0;
 
 		//! Creates a simple ITriangleSelector, based on an animated mesh scene node.
 		/** Details of the mesh associated with the node will be extracted internally.
@@ -1332,11 +1379,14 @@ namespace scene
 		\param minimalPolysPerNode: Specifies the minimal polygons contained a octree node.
 		If a node gets less polys the this value, it will not be splitted into
 		smaller nodes.
+		\param staticNode: True if the node is not moved anymore. The triangles
+		are then stored with the current absolute transformation of the node
+		already applied, see createTriangleSelector().
 		\return The selector, or null if not successful.
 		If you no longer need the selector, you should call ITriangleSelector::drop().
 		See IReferenceCounted::drop() for more information. */
 		virtual ITriangleSelector* createOctreeTriangleSelector(IMesh* mesh,
-			ISceneNode* node, s32 minimalPolysPerNode=32) = 0;
+			ISceneNode* node, s32 minimalPolysPerNode=32, bool staticNode=false) = 0;
 
 		//! //! Creates a Triangle Selector, optimized by an octree.
 		/** \deprecated Use createOctreeTriangleSelector instead. This method may be removed by Irrlicht 1.9. */
@@ -1346,6 +1396,44 @@ namespace scene
 			return createOctreeTriangleSelector(mesh, node, minimalPolysPerNode);
 		}
 
+		//! Creates a Triangle Selector, optimized by a bounding volume hierarchy.
+		/** Triangle selectors can be used for doing collision detection.
+		This selector keeps the triangles of the mesh indexed and sorts them
+		into a binary tree of bounding boxes, built with the surface area
+		heuristic. ITriangleSelector::getCollisionPoint() walks only the
+		part of the tree the line passes through and tests the triangles
+		without copying them, which makes picking on meshes with millions
+		of triangles fast. It does not follow changes of the mesh. Of
+		triangles hit at the same distance, like coplanar duplicates, the
+		one with the lowest index in the mesh is returned, also by
+		ITriangleSelector::getCollisionPoints().
+		Please note that the created triangle selector is not automaticly attached
+		to the scene node. You will have to call ISceneNode::setTriangleSelector()
+		for this.
+		\param mesh: Mesh of which the triangles are taken.
+		\param node: Scene node of which visibility and transformation is used.
+		\param maxTrianglesPerLeaf: Nodes with more triangles are split.
+		\return The selector, or null if not successful.
+		If you no longer need the selector, you should call ITriangleSelector::drop().
+		See IReferenceCounted::drop() for more information. */
+		virtual ITriangleSelector* createBVHTriangleSelector(IMesh* mesh,
+			ISceneNode* node, u32 maxTrianglesPerLeaf=4) = 0;
+
+		//! Creates a Triangle Selector, optimized by a bounding volume hierarchy, following an animated mesh scene node.
+		/** The hierarchy is built once from the frame the node shows.
+		For later frames the triangles keep their place in the tree and
+		only the boxes are fitted to the new positions. This is done when
+		a query touches the bounding box of the node, queries missing it
+		cost no more than the box test. The mesh must keep its vertices
+		and indices over all frames, as skinned and morphed meshes do.
+		\param node: The animated mesh scene node from which to build the selector.
+		\param maxTrianglesPerLeaf: Nodes with more triangles are split.
+		\return The selector, or null if not successful.
+		If you no longer need the selector, you should call ITriangleSelector::drop().
+		See IReferenceCounted::drop() for more information. */
+		virtual ITriangleSelector* createBVHTriangleSelector(IAnimatedMeshSceneNode* node,
+			u32 maxTrianglesPerLeaf=4) = 0;
+
 		//! Creates a meta triangle selector.
 		/** A meta triangle selector is nothing more than a
 		collection of one or more triangle selectors providing together
@@ -1638,6 +1726,18 @@ namespace scene
 			current callbacks manager and restore the default behavior. */
 		virtual void setLightManager(ILightManager* lightManager) = 0;
 
+		//! Creates a light manager which switches on only the lights near each node.
+		/** See IClusteredLightManager for details. Use it like this:
+		\code
+		scene::IClusteredLightManager* lm = smgr->createClusteredLightManager(50.f);
+		smgr->setLightManager(lm);
+		lm->drop();
+		\endcode
+		\param cellSize Edge length of the cubic cells of the light grid.
+		\return The light manager. If you no longer need it, you should
+		call IReferenceCounted::drop(). */
+		virtual IClusteredLightManager* createClusteredLightManager(f32 cellSize=100.f) = 0;
+
 		//! Get an instance of a geometry creator.
 		/** The geometry creator provides some helper methods to create various types of
 		basic geometry. This can be useful for custom scene nodes. */
@@ -1653,6 +1753,58 @@ namespace scene
 		\return True if node is not visible in the current scene, else
 		false. */
 		virtual bool isCulled(const ISceneNode* node) const =0;
+
+		//! Adds an occluder for software occlusion culling.
+		/** Once per frame, after the active camera is updated, all
+		visible occluders are rasterized on the cpu into a small depth
+		buffer. Nodes with EAC_OCC_SOFTWARE set in their automatic
+		culling state are culled if their bounding box is completely
+		hidden behind the occluders. This works with every video driver
+		and has no frame of latency, unlike EAC_OCC_QUERY. Occluders
+		should be simple, closed and slightly smaller than the visible
+		geometry they stand for, such as the walls of a building.
+		\param node Scene node whose absolute transformation places the
+		occluder mesh. The node is grabbed until the occluder is removed,
+		or until drawAll() finds the node removed from the scene.
+		\param mesh Low polygon mesh in node space. If 0, the mesh of the
+		node is used if it is a mesh or animated mesh scene node. */
+		virtual void addOccluder(ISceneNode* node, const IMesh* mesh=0) =0;
+
+		//! Removes an occluder added with addOccluder().
+		virtual void removeOccluder(ISceneNode* node) =0;
+
+		//! Removes all occluders.
+		virtual void removeAllOccluders() =0;
+
+		//! Sets the resolution of the software occlusion depth buffer.
+		/** Default is 256x128. */
+		virtual void setOcclusionBufferSize(const core::dimension2d<u32>& size) =0;
+
+		//! Returns the counters and timings of the last drawAll() call.
+		/** Together with IVideoDriver::getFrameStatistics() this
+		replaces the "calls", "culled" and "drawn_*" parameters which
+		were written in debug builds up to 1.8.
+		\return Statistics of the last frame. */
+		virtual const SSceneStatistics& getFrameStatistics() const =0;
+
+		//! Sets a file to which the statistics of each frame are appended.
+		/** A header line is written when the file is set, and then one
+		line with the scene manager and video driver statistics at the
+		end of each drawAll(), separated by semicolons.
+		\param file File to write to, grabbed by the scene manager.
+		Pass 0 to stop logging. */
+		virtual void setFrameLog(io::IWriteFile* file) =0;
+
+		//! Sets length and color of the normals drawn for EDS_NORMALS.
+		/** \param length Length of the normals. Default is 1.
+		\param color Color of the normals. Default is (255,34,221,221). */
+		virtual void setDebugNormals(f32 length, video::SColor color) =0;
+
+		//! Returns the length of the normals drawn for EDS_NORMALS.
+		virtual f32 getDebugNormalLength() const =0;
+
+		//! Returns the color of the normals drawn for EDS_NORMALS.
+		virtual video::SColor getDebugNormalColor() const =0;
 	};
 
 
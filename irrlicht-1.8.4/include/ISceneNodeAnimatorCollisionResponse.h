@@ -126,6 +126,23 @@ namespace scene
 		//! Get the current triangle selector containing all triangles for collision detection.
 		virtual ITriangleSelector* getWorld() const = 0;
 
+		//! Sets whether the triangles around the scene node are kept between frames.
+		/** If enabled, the animator keeps the triangles of the world
+		around the ellipsoid, with some room to move, and only asks the
+		triangle selector again when the ellipsoid leaves that room, see
+		SCollisionCache. Only enable this if the triangles of the world
+		don't move, or call setWorld() again after they moved. Worlds
+		whose selector has no fixed box, see
+		ITriangleSelector::getTransformedBoundingBox(), like those with
+		animated meshes, are asked on every frame anyway.
+		Disabled by default.
+		\param enable: True to keep the triangles between frames, false
+		to ask the triangle selector on every frame. */
+		virtual void setWorldCache(bool enable) = 0;
+
+		//! Returns whether the triangles around the scene node are kept between frames.
+		virtual bool getWorldCache() const = 0;
+
 		//! Set the single node that this animator will act on.
 		/** \param node The new target node. Setting this will force the animator to update
 					its last target position for the node, allowing setPosition() to teleport
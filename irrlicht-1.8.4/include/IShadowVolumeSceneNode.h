@@ -28,6 +28,9 @@ namespace scene
 		virtual void setShadowMesh(const IMesh* mesh) = 0;
 
 		//! Updates the shadow volumes for current light positions.
+		/** Only the volumes of lights which moved relative to the node are
+		rebuilt, unless the positions or indices of the shadow mesh changed.
+		Several volumes of a large mesh are built on multiple threads. */
 		virtual void updateShadowVolumes() = 0;
 	};
 
@@ -0,0 +1,83 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_STATIC_BATCH_SCENE_NODE_H_INCLUDED__
+#define __I_STATIC_BATCH_SCENE_NODE_H_INCLUDED__
+
+#include "ISceneNode.h"
+
+namespace irr
+{
+namespace scene
+{
+	class IMeshSceneNode;
+
+	//! A scene node merging the geometry of many static mesh scene nodes.
+	/** All mesh buffers of the source nodes which share the same material
+	are transformed into world space and merged into large meshbuffers with
+	32bit indices. The merged geometry is split into cubic chunks, so each
+	chunk can still be culled against the view frustum on its own.
+	While batched, the source nodes are made invisible and the batch node
+	draws their geometry instead. Call unbatch() before editing the source
+	nodes, and batch() again afterwards.
+	The transformation of the batch node itself is ignored, as the
+	merged geometry is already in world space. */
+	class IStaticBatchSceneNode : public ISceneNode
+	{
+	public:
+
+		//! constructor
+		IStaticBatchSceneNode(ISceneNode* parent, ISceneManager* mgr, s32 id)
+			: ISceneNode(parent, mgr, id) {}
+
+		//! Returns type of the scene node
+		virtual ESCENE_NODE_TYPE getType() const { return ESNT_STATIC_BATCH; }
+
+		//! Adds a mesh scene node to the list of nodes merged by batch().
+		/** Has no effect on the merged geometry until batch() is called. */
+		virtual void addSourceNode(IMeshSceneNode* node) =0;
+
+		//! Removes a mesh scene node from the list of merged nodes.
+		/** Restores the visibility of the node if it is currently batched.
+		Has no effect on the merged geometry until batch() is called.
+		\return True if the node was found. */
+		virtual bool removeSourceNode(IMeshSceneNode* node) =0;
+
+		//! Returns amount of source nodes
+		virtual u32 getSourceNodeCount() const =0;
+
+		//! Returns a source node by index
+		virtual IMeshSceneNode* getSourceNode(u32 index) const =0;
+
+		//! Merges the geometry of all visible source nodes and hides them.
+		/** Source nodes which are invisible are left out. If the node
+		is already batched, the merged geometry is rebuilt. */
+		virtual void batch() =0;
+
+		//! Frees the merged geometry and restores the source nodes visibility.
+		virtual void unbatch() =0;
+
+		//! Returns true if the merged geometry is currently in use.
+		virtual bool isBatched() const =0;
+
+		//! Sets the edge length of the cubic chunks.
+		/** Takes effect on the next call to batch(). */
+		virtual void setChunkSize(f32 size) =0;
+
+		//! Returns the edge length of the cubic chunks.
+		virtual f32 getChunkSize() const =0;
+
+		//! Returns amount of non-empty chunks of the merged geometry.
+		virtual u32 getChunkCount() const =0;
+
+		//! Returns amount of merged meshbuffers over all chunks.
+		/** This is the amount of draw calls issued if all chunks are visible. */
+		virtual u32 getMeshBufferCount() const =0;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
@@ -18,6 +18,27 @@ namespace scene
 
 class ISceneNode;
 
+//! Triangle hit by a line, see ITriangleSelector::getCollisionPoint()
+struct SCollisionHit
+{
+	SCollisionHit() : Node(0), TriangleIndex(0) {}
+
+	//! Point where the line hit the triangle, in world space
+	core::vector3df Intersection;
+
+	//! The triangle which was hit, in world space
+	core::triangle3df Triangle;
+
+	//! Scene node the triangle belongs to
+	ISceneNode* Node;
+
+	//! Index of the triangle within the selector
+	/** The triangles of a mesh are counted through all its mesh
+	buffers in order. Meta triangle selectors add the triangle
+	counts of the selectors before the one which was hit. */
+	u32 TriangleIndex;
+};
+
 //! Interface to return triangles with specific properties.
 /** Every ISceneNode may have a triangle selector, available with
 ISceneNode::getTriangleScelector() or ISceneManager::createTriangleSelector.
@@ -123,6 +144,70 @@ public:
 	/** Only useful for MetaTriangleSelector, others return 'this' or 0
 	*/
 	virtual const ITriangleSelector* getSelector(u32 index) const = 0;
+
+	//! Get the box around all triangles in world space
+	/** Meta triangle selectors use it to look only into the selectors
+	a query can touch. Selectors whose triangles change with each
+	frame, like those of animated mesh scene nodes, do not have one.
+	\param box Receives the box around all triangles.
+	\return False if the selector has no fixed box, queries then have
+	to look into it. */
+	virtual bool getTransformedBoundingBox(core::aabbox3d<f32>& box) const
+	{
+		return false;
+	}
+
+	//! Brings the selector up to date with the current frame of its scene node
+	/** Selectors following animated mesh scene nodes or the bounding
+	box of a node update their triangles lazily in the queries. After
+	this call, queries in the same frame only read the selector, so
+	several threads can run them at the same time.
+	ISceneCollisionManager::getCollisionPoints() calls it on the calling
+	thread before splitting the lines. */
+	virtual void updateForQueries() const {}
+
+	//! Finds the triangle hit by a line segment
+	/** Unlike getTriangles() no triangles are copied out of the
+	selector, the selector tests them itself. Selectors organized in
+	a tree, like the one created by
+	ISceneManager::createBVHTriangleSelector(), only visit the parts
+	of the tree the line passes through.
+	\param line Line segment in world space. Use a long segment to
+	cast a ray.
+	\param hit Receives the hit triangle, if there is one.
+	\param anyHit If false, the triangle nearest to the start of the
+	line is returned. If true, the first triangle found is returned,
+	which is faster for visibility tests.
+	\return True if a triangle was hit. */
+	virtual bool getCollisionPoint(const core::line3d<f32>& line,
+		SCollisionHit& hit, bool anyHit=false) const = 0;
+
+	//! Finds the triangles hit by several line segments
+	/** Same as calling getCollisionPoint() for each line. Selectors can
+	trace neighbouring lines together, so lines starting close to each
+	other and pointing the same way should be passed next to each
+	other. After updateForQueries() was called in the current frame,
+	the selector is only read, so several threads can call this at the
+	same time.
+	\param lines Array of count line segments in world space.
+	\param count Amount of lines.
+	\param hits Array of count hits, receiving the hit of each line.
+	\param found Array of count flags, set to true for the lines which
+	hit a triangle and to false for the others.
+	\param anyHit See getCollisionPoint().
+	\return Amount of lines which hit a triangle. */
+	virtual u32 getCollisionPoints(const core::line3d<f32>* lines, u32 count,
+		SCollisionHit* hits, bool* found, bool anyHit=false) const
+	{
+		u32 hitCount = 0;
+		for (u32 i=0; i<count; ++i)
+		{
+			found[i] = getCollisionPoint(lines[i], hits[i], anyHit);
+			if (found[i])
+				++hitCount;
+		}
+		return hitCount;
+	}
 };
 
 } // end namespace scene
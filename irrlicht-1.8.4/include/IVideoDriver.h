@@ -19,6 +19,8 @@
 #include "EDriverTypes.h"
 #include "EDriverFeatures.h"
 #include "SExposedVideoData.h"
+#include "SFrameStatistics.h"
+#include "EVideoCommands.h"
 
 namespace irr
 {
@@ -1018,6 +1020,20 @@ namespace video
 		/** \param mb Buffer to draw */
 		virtual void drawMeshBuffer(const scene::IMeshBuffer* mb) =0;
 
+		//! Draws a mesh buffer several times with different world transformations
+		/** The buffer is drawn once per matrix with the current material,
+		each time as if the matrix had been set as ETS_WORLD transformation.
+		The ETS_WORLD transformation set before this call is restored
+		afterwards. Drivers without native instancing support draw the
+		buffer in a loop, but still avoid all redundant state changes
+		between the instances.
+		\param mb Buffer to draw
+		\param transforms Pointer to an array of world transformations,
+		one for each instance.
+		\param instanceCount Amount of matrices in transforms. */
+		virtual void drawMeshBufferInstanced(const scene::IMeshBuffer* mb,
+			const core::matrix4* transforms, u32 instanceCount) =0;
+
 		//! Draws normals of a mesh buffer
 		/** \param mb Buffer to draw the normals of
 		\param length length scale factor of the normals
@@ -1082,6 +1098,12 @@ namespace video
 		\return Amount of primitives drawn in the last frame. */
 		virtual u32 getPrimitiveCountDrawn( u32 mode =0 ) const =0;
 
+		//! Returns the counters of the current frame.
+		/** The counters are reset in beginScene(), so after endScene()
+		they hold the values of the frame just finished.
+		\return Statistics of the current frame. */
+		virtual const SDriverStatistics& getFrameStatistics() const =0;
+
 		//! Deletes all dynamic lights which were previously added with addDynamicLight().
 		virtual void deleteAllDynamicLights() =0;
 
@@ -1373,6 +1395,65 @@ namespace video
 		/** \return An image created from the last rendered frame. */
 		virtual IImage* createScreenShot(video::ECOLOR_FORMAT format=video::ECF_UNKNOWN, video::E_RENDER_TARGET target=video::ERT_FRAME_BUFFER) =0;
 
+		//! Renders the frame buffer into caller owned memory
+		/** Frames are rendered into the given colour buffers in turn,
+		each endScene() switches to the next one. The caller may read the
+		frame finished last, see getExternalFrameBufferIndex(), while the
+		next one is rendered into the other buffer, without any copy.
+		Frames are not shown in the window while the buffers are set, and
+		a viewport set by the caller is kept when the buffers switch.
+		The memory must stay valid until the buffers are replaced or
+		released. Only the software renderer Burning's Video supports this,
+		with its own color format getColorFormat() and rows without padding.
+		\param color Pointer to bufferCount pointers to the colour buffers.
+		Each one holds size.Height rows of pitch bytes.
+		\param bufferCount Amount of colour buffers, 1 or 2. Passing 0
+		renders into the own frame buffer again.
+		\param depth Caller owned depth buffer of size.Width*size.Height
+		32 bit floats, or 0 to use the driver's own depth buffer.
+		\param size Dimension of the buffers in pixels.
+		\param format Color format of the colour buffers.
+		\param pitch Bytes per row of the colour buffers.
+		\return True if the driver renders into the buffers now. */
+		virtual bool setExternalFrameBuffers(void* const* color, u32 bufferCount,
+			void* depth, const core::dimension2d<u32>& size,
+			ECOLOR_FORMAT format, u32 pitch) =0;
+
+		//! Returns the caller owned colour buffer holding the frame finished last
+		/** \return Index into the buffers given to setExternalFrameBuffers(),
+		or -1 if no frame has been finished in them yet. */
+		virtual s32 getExternalFrameBufferIndex() const =0;
+
+		//! Starts recording the draw calls into a binary command stream
+		/** Every setTransform(), setMaterial(), drawVertexPrimitiveList(),
+		draw2DVertexPrimitiveList(), draw3DLine(), 2d image, rectangle,
+		line and pixel call is written to the file, together with
+		beginScene(), endScene(), setAmbientLight(), addDynamicLight()
+		and deleteAllDynamicLights(). Calls other than these are not
+		recorded, nor are calls which draw from hardware buffers without
+		vertex data. Vertex and index data is written once and referenced
+		by its hash afterwards, textures are referenced by their name.
+		Replay the stream with replayCommands().
+		\param file File to write the stream to. It is grabbed until
+		stopCommandRecording() is called.
+		\return True if recording started. */
+		virtual bool startCommandRecording(io::IWriteFile* file) =0;
+
+		//! Stops recording the draw calls and releases the file
+		virtual void stopCommandRecording() =0;
+
+		//! Replays a command stream recorded by startCommandRecording()
+		/** The calls are made on this driver, which can be of another
+		type than the recording one. Textures are looked up by name
+		and loaded if necessary. The stream contains its own
+		beginScene() and endScene() calls.
+		\param file File containing the stream.
+		\param timings If not 0, receives the time each call took.
+		\return Amount of replayed calls, or -1 if the file is not a
+		valid command stream. */
+		virtual s32 replayCommands(io::IReadFile* file,
+			core::array<SVideoCommandTiming>* timings=0) =0;
+
 		//! Check if the image is already loaded.
 		/** Works similar to getTexture(), but does not load the texture
 		if it is not currently loaded.
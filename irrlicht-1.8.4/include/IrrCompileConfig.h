@@ -332,6 +332,22 @@ tool <http://developer.nvidia.com/object/nvperfhud_home.html>. */
 //#define BURNINGVIDEO_RENDERER_ULTRA_FAST
 //#define BURNINGVIDEO_RENDERER_CE
 
+//! Define _IRR_COMPILE_WITH_THREADS_ to let the engine split work across several threads
+/** Used by Burning's Video and ISceneCollisionManager::getCollisionPoints.
+Uses pthreads on posix systems, so applications might have to link with -lpthread. */
+#define _IRR_COMPILE_WITH_THREADS_
+#ifdef NO_IRR_COMPILE_WITH_THREADS_
+#undef _IRR_COMPILE_WITH_THREADS_
+#endif
+
+//! Define _IRR_COMPILE_WITH_BURNINGSVIDEO_THREADS_ to let Burning's Video rasterize with several threads
+/** The amount of threads is set with SIrrlichtCreationParameters::RasterizerThreads.
+Needs _IRR_COMPILE_WITH_THREADS_. */
+#define _IRR_COMPILE_WITH_BURNINGSVIDEO_THREADS_
+#if defined(NO_IRR_COMPILE_WITH_BURNINGSVIDEO_THREADS_) || !defined(_IRR_COMPILE_WITH_THREADS_)
+#undef _IRR_COMPILE_WITH_BURNINGSVIDEO_THREADS_
+#endif
+
 //! Uncomment the following line if you want to ignore the deprecated warnings
 //#define IGNORE_DEPRECATED_WARNING
 
@@ -814,19 +830,5 @@ precision will be lower but speed higher. currently X86 only
 
 #endif
 
-#ifdef _DEBUG
-	//! A few attributes are written in CSceneManager when _IRR_SCENEMANAGER_DEBUG is enabled
-	// NOTE: Those attributes were used always until 1.8.0 and became a global define for 1.8.1
-	// which is only enabled in debug because it had a large (sometimes >5%) impact on speed.
-	// A better solution in the long run is to break the interface and remove _all_ attribute
-	// access in functions like CSceneManager::drawAll and instead put that information in some
-	// own struct/class or in CSceneManager.
-	// See http://irrlicht.sourceforge.net/forum/viewtopic.php?f=2&t=48211 for the discussion.
-	#define _IRR_SCENEMANAGER_DEBUG
-	#ifdef NO_IRR_SCENEMANAGER_DEBUG
-		#undef _IRR_SCENEMANAGER_DEBUG
-	#endif
-#endif
-
 #endif // __IRR_COMPILE_CONFIG_H_INCLUDED__
 
@@ -0,0 +1,135 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __S_FRAME_STATISTICS_H_INCLUDED__
+#define __S_FRAME_STATISTICS_H_INCLUDED__
+
+#include "irrTypes.h"
+
+namespace irr
+{
+namespace video
+{
+	//! Amount of buckets in SDriverStatistics::PrimitiveHistogram
+	const u32 DRIVER_STATISTICS_HISTOGRAM_SIZE = 16;
+
+	//! Counters of a video driver for the current frame.
+	/** All values are reset in IVideoDriver::beginScene() and stay
+	valid after IVideoDriver::endScene() until the next frame begins.
+	Get them with IVideoDriver::getFrameStatistics(). */
+	struct SDriverStatistics
+	{
+		SDriverStatistics()
+		{
+			reset();
+		}
+
+		//! Sets all counters to zero
+		void reset()
+		{
+			DrawCalls = 0;
+			PrimitivesDrawn = 0;
+			VertexCacheHits = 0;
+			VertexCacheMisses = 0;
+			for (u32 i=0; i<DRIVER_STATISTICS_HISTOGRAM_SIZE; ++i)
+				PrimitiveHistogram[i] = 0;
+		}
+
+		//! Counts one draw call with the given amount of primitives
+		void registerDrawCall(u32 primitiveCount)
+		{
+			++DrawCalls;
+			PrimitivesDrawn += primitiveCount;
+
+			u32 bucket = 0;
+			while ((primitiveCount >>= 1) && bucket < DRIVER_STATISTICS_HISTOGRAM_SIZE-1)
+				++bucket;
+			++PrimitiveHistogram[bucket];
+		}
+
+		//! Amount of calls drawing primitives, 2d and 3d
+		u32 DrawCalls;
+
+		//! Amount of primitives drawn
+		u32 PrimitivesDrawn;
+
+		//! Draw calls by amount of primitives
+		/** Bucket i counts the calls with 2^i up to 2^(i+1)-1
+		primitives, bucket 0 also those with no primitive. The last
+		bucket counts all larger calls. */
+		u32 PrimitiveHistogram[DRIVER_STATISTICS_HISTOGRAM_SIZE];
+
+		//! Amount of vertex fetches served by the post transform vertex cache
+		/** Only counted by drivers transforming vertices themselves,
+		so far EDT_BURNINGSVIDEO. */
+		u32 VertexCacheHits;
+
+		//! Amount of vertices transformed because they were not in the vertex cache
+		/** VertexCacheMisses divided by PrimitivesDrawn is the amount
+		of vertices transformed per primitive. Only counted by drivers
+		transforming vertices themselves, so far EDT_BURNINGSVIDEO. */
+		u32 VertexCacheMisses;
+	};
+
+} // end namespace video
+
+namespace scene
+{
+	//! Counters and timings of the scene manager for the last ISceneManager::drawAll() call.
+	/** Get them with ISceneManager::getFrameStatistics(). Times are
+	measured with the real time clock, in milliseconds. */
+	struct SSceneStatistics
+	{
+		SSceneStatistics()
+		{
+			reset();
+		}
+
+		//! Sets all counters to zero
+		void reset()
+		{
+			RegisterCalls = 0;
+			Culled = 0;
+			DrawnSolid = 0;
+			DrawnTransparent = 0;
+			DrawnTransparentEffect = 0;
+			DrawnShadows = 0;
+			TimeAnimate = 0;
+			TimeRegister = 0;
+			TimeRender = 0;
+		}
+
+		//! Amount of nodes which tried to register for rendering
+		u32 RegisterCalls;
+
+		//! Amount of nodes which were culled on registration
+		u32 Culled;
+
+		//! Amount of nodes drawn in the solid pass
+		u32 DrawnSolid;
+
+		//! Amount of nodes drawn in the transparent pass
+		u32 DrawnTransparent;
+
+		//! Amount of nodes drawn in the transparent effect pass
+		u32 DrawnTransparentEffect;
+
+		//! Amount of shadow volume nodes drawn
+		u32 DrawnShadows;
+
+		//! Time spent animating the nodes
+		u32 TimeAnimate;
+
+		//! Time spent registering and culling the nodes
+		u32 TimeRegister;
+
+		//! Time spent in the render passes
+		u32 TimeRender;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
@@ -44,6 +44,8 @@ namespace irr
 #endif
 			DisplayAdapter(0),
 			DriverMultithreaded(false),
+			RasterizerThreads(1),
+			VertexCacheSize(0),
 			UsePerformanceTimer(true),
 			SDK_version_do_not_use(IRRLICHT_SDK_VERSION)
 		{
@@ -74,6 +76,8 @@ namespace irr
 			WindowId = other.WindowId;
 			LoggingLevel = other.LoggingLevel;
 			DriverMultithreaded = other.DriverMultithreaded;
+			RasterizerThreads = other.RasterizerThreads;
+			VertexCacheSize = other.VertexCacheSize;
 			DisplayAdapter = other.DisplayAdapter;
 			UsePerformanceTimer = other.UsePerformanceTimer;
 			return *this;
@@ -276,6 +280,23 @@ namespace irr
 			So far only supported on D3D. */
 		bool DriverMultithreaded;
 
+		//! Amount of threads the software rasterizer uses.
+		/** Default is 1, which rasterizes on the calling thread only. 0
+			uses one thread for each processor core. The screen is split
+			into interleaved bands of rows, which the threads rasterize
+			in parallel. The image is the same as with a single thread.
+			So far only supported by EDT_BURNINGSVIDEO. */
+		u32 RasterizerThreads;
+
+		//! Amount of transformed vertices kept by drivers with a software vertex pipeline.
+		/** Vertices are looked up by their index, so vertices shared by
+			many triangles are only transformed once while they stay in
+			the cache. The size is rounded up to a power of two. 0 uses
+			the default of 1024 vertices. Hits and misses are counted in
+			IVideoDriver::getFrameStatistics(). So far only supported by
+			EDT_BURNINGSVIDEO. */
+		u32 VertexCacheSize;
+
 		//! Enables use of high performance timers on Windows platform.
 		/** When performance timers are not used, standard GetTickCount()
 		is used instead which usually has worse resolution, but also less
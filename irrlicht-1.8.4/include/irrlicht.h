@@ -51,6 +51,7 @@
 #include "ESceneNodeAnimatorTypes.h"
 #include "ESceneNodeTypes.h"
 #include "ETerrainElements.h"
+#include "EVideoCommands.h"
 #include "fast_atof.h"
 #include "heapsort.h"
 #include "IAnimatedMesh.h"
@@ -100,6 +101,7 @@
 #include "IImage.h"
 #include "IImageLoader.h"
 #include "IImageWriter.h"
+#include "IInstancedMeshSceneNode.h"
 #include "IIndexBuffer.h"
 #include "ILightSceneNode.h"
 #include "ILogger.h"
@@ -144,6 +146,7 @@
 #include "IShaderConstantSetCallBack.h"
 #include "IShadowVolumeSceneNode.h"
 #include "ISkinnedMesh.h"
+#include "IStaticBatchSceneNode.h"
 #include "ITerrainSceneNode.h"
 #include "ITextSceneNode.h"
 #include "ITexture.h"
@@ -157,6 +160,7 @@
 #include "IXMLReader.h"
 #include "IXMLWriter.h"
 #include "ILightManager.h"
+#include "IClusteredLightManager.h"
 #include "Keycodes.h"
 #include "line2d.h"
 #include "line3d.h"
@@ -170,6 +174,7 @@
 #include "SceneParameters.h"
 #include "SColor.h"
 #include "SExposedVideoData.h"
+#include "SFrameStatistics.h"
 #include "SIrrCreationParameters.h"
 #include "SKeyMap.h"
 #include "SLight.h"
@@ -357,8 +357,8 @@ void CAnimatedMeshSceneNode::render()
 		// show normals
 		if (DebugDataVisible & scene::EDS_NORMALS)
 		{
-			const f32 debugNormalLength = SceneManager->getParameters()->getAttributeAsFloat(DEBUG_NORMAL_LENGTH);
-			const video::SColor debugNormalColor = SceneManager->getParameters()->getAttributeAsColor(DEBUG_NORMAL_COLOR);
+			const f32 debugNormalLength = SceneManager->getDebugNormalLength();
+			const video::SColor debugNormalColor = SceneManager->getDebugNormalColor();
 			const u32 count = m->getMeshBufferCount();
 
 			// draw normals
@@ -0,0 +1,1057 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CBVHTriangleSelector.h"
+#include "ISceneNode.h"
+#include "IMeshBuffer.h"
+#include "IAnimatedMeshSceneNode.h"
+#include "os.h"
+
+// traces four lines at once with sse, one by one otherwise
+#if !defined(NO_BVH_TRIANGLE_SELECTOR_SSE) && ( defined(__SSE__) || defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 1 ) )
+	#define BVH_TRIANGLE_SELECTOR_SSE
+	#include <xmmintrin.h>
+#endif
+
+namespace irr
+{
+namespace scene
+{
+
+namespace
+{
+	//! bins of the surface area heuristic
+	const u32 BVH_BINS = 16;
+
+	//! depth from which nodes are split at the median
+	/** Keeps the depth of the tree below the traversal stack size. */
+	const u32 BVH_MAX_SAH_DEPTH = 32;
+
+	//! entries of the traversal stack
+	const u32 BVH_STACK_SIZE = 64;
+
+	inline f32 getAxis(const core::vector3df& v, u32 axis)
+	{
+		return axis == 0 ? v.X : axis == 1 ? v.Y : v.Z;
+	}
+
+	//! returns the reciprocal of the direction, without infinities
+	core::vector3df getInverseDirection(const core::vector3df& dir)
+	{
+		return core::vector3df(
+			fabsf(dir.X) > 1e-30f ? 1.f / dir.X : (dir.X < 0.f ? -1e30f : 1e30f),
+			fabsf(dir.Y) > 1e-30f ? 1.f / dir.Y : (dir.Y < 0.f ? -1e30f : 1e30f),
+			fabsf(dir.Z) > 1e-30f ? 1.f / dir.Z : (dir.Z < 0.f ? -1e30f : 1e30f));
+	}
+
+	//! slab test of the line from start with inverse direction, between 0 and far
+	inline bool intersectsWithLine(const core::aabbox3d<f32>& box,
+		const core::vector3df& start, const core::vector3df& invDir,
+		f32 far, f32& outNear)
+	{
+		f32 t0 = (box.MinEdge.X - start.X) * invDir.X;
+		f32 t1 = (box.MaxEdge.X - start.X) * invDir.X;
+		f32 tnear = core::min_(t0, t1);
+		f32 tfar = core::max_(t0, t1);
+
+		t0 = (box.MinEdge.Y - start.Y) * invDir.Y;
+		t1 = (box.MaxEdge.Y - start.Y) * invDir.Y;
+		tnear = core::max_(tnear, core::min_(t0, t1));
+		tfar = core::min_(tfar, core::max_(t0, t1));
+
+		t0 = (box.MinEdge.Z - start.Z) * invDir.Z;
+		t1 = (box.MaxEdge.Z - start.Z) * invDir.Z;
+		tnear = core::max_(tnear, core::min_(t0, t1), 0.f);
+		tfar = core::min_(tfar, core::max_(t0, t1), far);
+
+		outNear = tnear;
+		return tnear <= tfar;
+	}
+
+	//! returns the line parameter where it hits the triangle, or a negative value
+	inline f32 intersectTriangle(const core::vector3df& start, const core::vector3df& dir,
+		const core::vector3df& a, const core::vector3df& b, const core::vector3df& c)
+	{
+		const core::vector3df e1(b - a);
+		const core::vector3df e2(c - a);
+		const core::vector3df p(dir.crossProduct(e2));
+		const f32 det = e1.dotProduct(p);
+		if (det == 0.f)
+			return -1.f;
+
+		const f32 invDet = 1.f / det;
+		const core::vector3df s(start - a);
+		const f32 u = s.dotProduct(p) * invDet;
+		if (u < 0.f || u > 1.f)
+			return -1.f;
+
+		const core::vector3df q(s.crossProduct(e1));
+		const f32 v = dir.dotProduct(q) * invDet;
+		if (v < 0.f || u + v > 1.f)
+			return -1.f;
+
+		return e2.dotProduct(q) * invDet;
+	}
+}
+
+
+//! constructor
+CBVHTriangleSelector::CBVHTriangleSelector(const IMesh* mesh, ISceneNode* node,
+		u32 maxTrianglesPerLeaf)
+	: SceneNode(node), MaxTrianglesPerLeaf(core::max_(maxTrianglesPerLeaf, 1u)),
+	AnimatedNode(0), LastMeshFrame(0)
+{
+	#ifdef _DEBUG
+	setDebugName("CBVHTriangleSelector");
+	#endif
+
+	if (mesh)
+		createFromMesh(mesh);
+}
+
+
+//! constructor
+CBVHTriangleSelector::CBVHTriangleSelector(IAnimatedMeshSceneNode* node,
+		u32 maxTrianglesPerLeaf)
+	: SceneNode(node), MaxTrianglesPerLeaf(core::max_(maxTrianglesPerLeaf, 1u)),
+	AnimatedNode(node), LastMeshFrame(0)
+{
+	#ifdef _DEBUG
+	setDebugName("CBVHTriangleSelector");
+	#endif
+
+	if (!AnimatedNode)
+		return;
+
+	IAnimatedMesh* animatedMesh = AnimatedNode->getMesh();
+	if (!animatedMesh)
+		return;
+
+	LastMeshFrame = (u32)AnimatedNode->getFrameNr();
+	IMesh* mesh = animatedMesh->getMesh(LastMeshFrame);
+
+	if (mesh)
+		createFromMesh(mesh);
+}
+
+
+//! Builds the hierarchy for the triangles of a mesh
+void CBVHTriangleSelector::createFromMesh(const IMesh* mesh)
+{
+	const u32 start = os::Timer::getRealTime();
+
+	u32 i;
+	u32 indexCount = 0;
+	u32 vertexCount = 0;
+	for (i=0; i<mesh->getMeshBufferCount(); ++i)
+	{
+		indexCount += mesh->getMeshBuffer(i)->getIndexCount() / 3 * 3;
+		vertexCount += mesh->getMeshBuffer(i)->getVertexCount();
+	}
+
+	core::array<u32> indices(indexCount);
+	core::array<SBuildTriangle> build(indexCount / 3);
+	Positions.reallocate(vertexCount);
+
+	for (i=0; i<mesh->getMeshBufferCount(); ++i)
+	{
+		const IMeshBuffer* buf = mesh->getMeshBuffer(i);
+		const u32 base = Positions.size();
+
+		for (u32 j=0; j<buf->getVertexCount(); ++j)
+			Positions.push_back(buf->getPosition(j));
+
+		const u32 idxCnt = buf->getIndexCount() / 3 * 3;
+		const bool index32 = buf->getIndexType() == video::EIT_32BIT;
+		const u16* const indices16 = buf->getIndices();
+		const u32* const indices32 = (const u32*) buf->getIndices();
+
+		for (u32 j=0; j<idxCnt; j+=3)
+		{
+			SBuildTriangle triangle;
+			for (u32 k=0; k<3; ++k)
+			{
+				const u32 index = base + (index32 ? indices32[j+k] : indices16[j+k]);
+				indices.push_back(index);
+				if (k)
+					triangle.Box.addInternalPoint(Positions[index]);
+				else
+					triangle.Box.reset(Positions[index]);
+			}
+			triangle.Center = triangle.Box.getCenter();
+			triangle.Index = build.size();
+			build.push_back(triangle);
+		}
+	}
+
+	if (build.empty())
+		return;
+
+	Nodes.reallocate(build.size() / MaxTrianglesPerLeaf * 2 + 1);
+	buildNode(build, 0, build.size(), 0);
+
+	// store the triangles in the order of the leaves
+	Indices.set_used(indices.size());
+	TriangleIndices.set_used(build.size());
+	for (i=0; i<build.size(); ++i)
+	{
+		const u32 index = build[i].Index;
+		Indices[i*3] = indices[index*3];
+		Indices[i*3+1] = indices[index*3+1];
+		Indices[i*3+2] = indices[index*3+2];
+		TriangleIndices[i] = index;
+	}
+
+	c8 tmp[256];
+	sprintf(tmp, "Needed %ums to create BVHTriangleSelector.(%u nodes, %u polys)",
+		os::Timer::getRealTime() - start, Nodes.size(), TriangleIndices.size());
+	os::Printer::log(tmp, ELL_INFORMATION);
+}
+
+
+//! Moves the triangles to the positions of a frame with the same topology and refits the boxes
+void CBVHTriangleSelector::updateFromMesh(const IMesh* mesh) const
+{
+	u32 i;
+	u32 vertexCount = 0;
+	for (i=0; i<mesh->getMeshBufferCount(); ++i)
+		vertexCount += mesh->getMeshBuffer(i)->getVertexCount();
+	if (vertexCount != Positions.size() || Nodes.empty())
+		return;
+
+	// all vertex types start with the position
+	core::vector3df* positions = Positions.pointer();
+	for (i=0; i<mesh->getMeshBufferCount(); ++i)
+	{
+		const IMeshBuffer* buf = mesh->getMeshBuffer(i);
+		const u32 pitch = video::getVertexPitchFromType(buf->getVertexType());
+		const u8* vertex = (const u8*) buf->getVertices();
+		for (u32 j=buf->getVertexCount(); j; --j, vertex+=pitch)
+			*positions++ = *(const core::vector3df*) vertex;
+	}
+
+	// children follow their parent, so going backwards sees them first
+	for (i=Nodes.size(); i>0; --i)
+	{
+		SBVHNode& node = Nodes[i-1];
+		// min and max instead of addInternalPoint(), which branches
+		// on each point and mispredicts on most of them here
+		core::vector3df minEdge, maxEdge;
+		if (node.Count)
+		{
+			const u32 end = (node.Index + node.Count) * 3;
+			minEdge = maxEdge = Positions[Indices[node.Index*3]];
+			for (u32 j=node.Index*3+1; j<end; ++j)
+			{
+				const core::vector3df& p = Positions[Indices[j]];
+				minEdge.set(core::min_(minEdge.X, p.X), core::min_(minEdge.Y, p.Y), core::min_(minEdge.Z, p.Z));
+				maxEdge.set(core::max_(maxEdge.X, p.X), core::max_(maxEdge.Y, p.Y), core::max_(maxEdge.Z, p.Z));
+			}
+		}
+		else
+		{
+			const core::aabbox3d<f32>& first = Nodes[i].Box;
+			const core::aabbox3d<f32>& second = Nodes[node.Index].Box;
+			minEdge.set(core::min_(first.MinEdge.X, second.MinEdge.X),
+				core::min_(first.MinEdge.Y, second.MinEdge.Y),
+				core::min_(first.MinEdge.Z, second.MinEdge.Z));
+			maxEdge.set(core::max_(first.MaxEdge.X, second.MaxEdge.X),
+				core::max_(first.MaxEdge.Y, second.MaxEdge.Y),
+				core::max_(first.MaxEdge.Z, second.MaxEdge.Z));
+		}
+		node.Box.MinEdge = minEdge;
+		node.Box.MaxEdge = maxEdge;
+	}
+}
+
+
+//! Updates to the current frame of the animated node, unless the query misses it
+bool CBVHTriangleSelector::update(const core::aabbox3d<f32>* box) const
+{
+	if (!AnimatedNode)
+		return true;
+
+	const u32 currentFrame = (u32)AnimatedNode->getFrameNr();
+	if (currentFrame == LastMeshFrame)
+		return true;
+
+	// the box of the node follows its frames, refit only when the query reaches it
+	if (box && !box->intersectsWithBox(AnimatedNode->getBoundingBox()))
+		return false;
+
+	LastMeshFrame = currentFrame;
+	IAnimatedMesh* animatedMesh = AnimatedNode->getMesh();
+
+	if (animatedMesh)
+	{
+		IMesh* mesh = animatedMesh->getMesh(LastMeshFrame);
+
+		if (mesh)
+			updateFromMesh(mesh);
+	}
+	return true;
+}
+
+
+//! Builds the node for the triangles from start to end, returns its index
+u32 CBVHTriangleSelector::buildNode(core::array<SBuildTriangle>& build,
+		u32 start, u32 end, u32 depth)
+{
+	const u32 index = Nodes.size();
+	Nodes.push_back(SBVHNode());
+
+	core::aabbox3d<f32> box(build[start].Box);
+	for (u32 i=start+1; i<end; ++i)
+		box.addInternalBox(build[i].Box);
+	Nodes[index].Box = box;
+
+	if (end - start <= MaxTrianglesPerLeaf)
+	{
+		Nodes[index].Index = start;
+		Nodes[index].Count = end - start;
+		return index;
+	}
+
+	const u32 middle = split(build, start, end, depth);
+	buildNode(build, start, middle, depth + 1);
+	const u32 second = buildNode(build, middle, end, depth + 1);
+
+	Nodes[index].Index = second;
+	Nodes[index].Count = 0;
+	return index;
+}
+
+
+//! Splits the triangles from start to end, returns the first of the second half
+u32 CBVHTriangleSelector::split(core::array<SBuildTriangle>& build,
+		u32 start, u32 end, u32 depth) const
+{
+	u32 i;
+	core::aabbox3d<f32> centers(build[start].Center);
+	for (i=start+1; i<end; ++i)
+		centers.addInternalPoint(build[i].Center);
+	const core::vector3df extent(centers.getExtent());
+
+	u32 axis = 0;
+	if (extent.Y > getAxis(extent, axis))
+		axis = 1;
+	if (extent.Z > getAxis(extent, axis))
+		axis = 2;
+
+	// all triangles at one place, any split does
+	if (getAxis(extent, axis) <= 0.f)
+		return start + (end - start) / 2;
+
+	if (depth < BVH_MAX_SAH_DEPTH)
+	{
+		// binned surface area heuristic along the longest axis
+		const f32 minimum = getAxis(centers.MinEdge, axis);
+		const f32 scale = BVH_BINS * 0.9999f / getAxis(extent, axis);
+
+		u32 count[BVH_BINS];
+		core::aabbox3d<f32> bins[BVH_BINS];
+		for (i=0; i<BVH_BINS; ++i)
+			count[i] = 0;
+
+		for (i=start; i<end; ++i)
+		{
+			const u32 bin = core::min_((u32) ((getAxis(build[i].Center, axis) - minimum) * scale), BVH_BINS - 1);
+			if (count[bin]++)
+				bins[bin].addInternalBox(build[i].Box);
+			else
+				bins[bin] = build[i].Box;
+		}
+
+		// area and count left of each split
+		f32 leftArea[BVH_BINS];
+		u32 leftCount[BVH_BINS];
+		core::aabbox3d<f32> sweep;
+		u32 n = 0;
+		for (i=0; i<BVH_BINS-1; ++i)
+		{
+			if (count[i])
+			{
+				if (n)
+					sweep.addInternalBox(bins[i]);
+				else
+					sweep = bins[i];
+				n += count[i];
+			}
+			leftArea[i] = n ? sweep.getArea() : 0.f;
+			leftCount[i] = n;
+		}
+
+		f32 bestCost = FLT_MAX;
+		u32 bestBin = 0;
+		n = 0;
+		for (i=BVH_BINS-1; i>0; --i)
+		{
+			if (count[i])
+			{
+				if (n)
+					sweep.addInternalBox(bins[i]);
+				else
+					sweep = bins[i];
+				n += count[i];
+			}
+			if (!n || !leftCount[i-1])
+				continue;
+
+			const f32 cost = leftArea[i-1] * leftCount[i-1] + sweep.getArea() * n;
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestBin = i;
+			}
+		}
+
+		if (bestCost < FLT_MAX)
+		{
+			u32 middle = start;
+			for (i=start; i<end; ++i)
+			{
+				const u32 bin = core::min_((u32) ((getAxis(build[i].Center, axis) - minimum) * scale), BVH_BINS - 1);
+				if (bin < bestBin)
+					core::swap(build[i], build[middle++]);
+			}
+			if (middle != start && middle != end)
+				return middle;
+		}
+	}
+
+	// median of the centers on the longest axis
+	const s32 middle = (s32) (start + (end - start) / 2);
+	s32 lo = (s32) start;
+	s32 hi = (s32) end - 1;
+	while (lo < hi)
+	{
+		const f32 pivot = getAxis(build[(lo + hi) / 2].Center, axis);
+		s32 l = lo;
+		s32 h = hi;
+		while (l <= h)
+		{
+			while (getAxis(build[l].Center, axis) < pivot)
+				++l;
+			while (getAxis(build[h].Center, axis) > pivot)
+				--h;
+			if (l <= h)
+				core::swap(build[l++], build[h--]);
+		}
+		if (middle <= h)
+			hi = h;
+		else if (middle >= l)
+			lo = l;
+		else
+			break;
+	}
+	return (u32) middle;
+}
+
+
+//! Gets all triangles.
+void CBVHTriangleSelector::getTriangles(core::triangle3df* triangles,
+		s32 arraySize, s32& outTriangleCount,
+		const core::matrix4* transform) const
+{
+	// Update my triangles if necessary
+	update(0);
+
+	core::matrix4 mat;
+	if (transform)
+		mat = *transform;
+	if (SceneNode)
+		mat *= SceneNode->getAbsoluteTransformation();
+
+	const u32 cnt = core::min_((u32) core::max_(arraySize, 0), TriangleIndices.size());
+	core::triangle3df triangle;
+	for (u32 i=0; i<cnt; ++i)
+	{
+		getTriangle(i, triangle);
+		mat.transformVect(triangles[i].pointA, triangle.pointA);
+		mat.transformVect(triangles[i].pointB, triangle.pointB);
+		mat.transformVect(triangles[i].pointC, triangle.pointC);
+	}
+
+	outTriangleCount = cnt;
+}
+
+
+//! Gets all triangles which lie within a specific bounding box.
+void CBVHTriangleSelector::getTriangles(core::triangle3df* triangles,
+		s32 arraySize, s32& outTriangleCount,
+		const core::aabbox3d<f32>& box,
+		const core::matrix4* transform) const
+{
+	outTriangleCount = 0;
+	if (Nodes.empty() || arraySize <= 0)
+		return;
+
+	core::matrix4 mat;
+	core::aabbox3d<f32> tBox(box);
+	if (SceneNode)
+	{
+		SceneNode->getAbsoluteTransformation().getInverse(mat);
+		mat.transformBoxEx(tBox);
+	}
+	if (!update(&tBox))
+		return;
+	if (transform)
+		mat = *transform;
+	else
+		mat.makeIdentity();
+	if (SceneNode)
+		mat *= SceneNode->getAbsoluteTransformation();
+
+	u32 stack[BVH_STACK_SIZE];
+	u32 top = 0;
+	stack[top++] = 0;
+
+	s32 written = 0;
+	core::triangle3df triangle;
+	while (top)
+	{
+		const SBVHNode& node = Nodes[stack[--top]];
+		if (!node.Box.intersectsWithBox(tBox))
+			continue;
+
+		if (node.Count)
+		{
+			for (u32 i=node.Index; i<node.Index+node.Count; ++i)
+			{
+				getTriangle(i, triangle);
+				// This isn't an accurate test, but it's fast, and the
+				// API contract doesn't guarantee complete accuracy.
+				if (triangle.isTotalOutsideBox(tBox))
+					continue;
+
+				mat.transformVect(triangles[written].pointA, triangle.pointA);
+				mat.transformVect(triangles[written].pointB, triangle.pointB);
+				mat.transformVect(triangles[written].pointC, triangle.pointC);
+				if (++written == arraySize)
+				{
+					outTriangleCount = written;
+					return;
+				}
+			}
+		}
+		else
+		{
+			stack[top++] = node.Index;
+			stack[top++] = (u32) (&node - Nodes.const_pointer()) + 1;
+		}
+	}
+
+	outTriangleCount = written;
+}
+
+
+//! Gets all triangles which have or may have contact with a 3d line.
+void CBVHTriangleSelector::getTriangles(core::triangle3df* triangles,
+		s32 arraySize, s32& outTriangleCount,
+		const core::line3d<f32>& line,
+		const core::matrix4* transform) const
+{
+	outTriangleCount = 0;
+	if (Nodes.empty() || arraySize <= 0)
+		return;
+
+	core::matrix4 mat;
+	core::vector3df start(line.start);
+	core::vector3df end(line.end);
+	if (SceneNode)
+	{
+		SceneNode->getAbsoluteTransformation().getInverse(mat);
+		mat.transformVect(start);
+		mat.transformVect(end);
+	}
+	core::aabbox3d<f32> box(start);
+	box.addInternalPoint(end);
+	if (!update(&box))
+		return;
+	if (transform)
+		mat = *transform;
+	else
+		mat.makeIdentity();
+	if (SceneNode)
+		mat *= SceneNode->getAbsoluteTransformation();
+
+	const core::vector3df invDir(getInverseDirection(end - start));
+
+	u32 stack[BVH_STACK_SIZE];
+	u32 top = 0;
+	stack[top++] = 0;
+
+	s32 written = 0;
+	f32 tnear;
+	core::triangle3df triangle;
+	while (top)
+	{
+		const SBVHNode& node = Nodes[stack[--top]];
+		if (!intersectsWithLine(node.Box, start, invDir, 1.f, tnear))
+			continue;
+
+		if (node.Count)
+		{
+			for (u32 i=node.Index; i<node.Index+node.Count; ++i)
+			{
+				getTriangle(i, triangle);
+				mat.transformVect(triangles[written].pointA, triangle.pointA);
+				mat.transformVect(triangles[written].pointB, triangle.pointB);
+				mat.transformVect(triangles[written].pointC, triangle.pointC);
+				if (++written == arraySize)
+				{
+					outTriangleCount = written;
+					return;
+				}
+			}
+		}
+		else
+		{
+			stack[top++] = node.Index;
+			stack[top++] = (u32) (&node - Nodes.const_pointer()) + 1;
+		}
+	}
+
+	outTriangleCount = written;
+}
+
+
+//! Finds the triangle hit by a line segment
+bool CBVHTriangleSelector::getCollisionPoint(const core::line3d<f32>& line,
+		SCollisionHit& hit, bool anyHit) const
+{
+	if (Nodes.empty())
+		return false;
+
+	// walk the tree in mesh space
+	core::vector3df start(line.start);
+	core::vector3df end(line.end);
+	if (SceneNode)
+	{
+		core::matrix4 inverse(core::matrix4::EM4CONST_NOTHING);
+		SceneNode->getAbsoluteTransformation().getInverse(inverse);
+		inverse.transformVect(start);
+		inverse.transformVect(end);
+	}
+	core::aabbox3d<f32> box(start);
+	box.addInternalPoint(end);
+	if (!update(&box))
+		return false;
+	const core::vector3df dir(end - start);
+
+	f32 nearest = 1.f;
+	const s32 found = traceLine(start, dir, nearest, anyHit);
+	if (found < 0)
+		return false;
+
+	getHit(start, dir, nearest, (u32) found, hit);
+	return true;
+}
+
+
+//! Finds the triangles hit by several line segments
+u32 CBVHTriangleSelector::getCollisionPoints(const core::line3d<f32>* lines, u32 count,
+		SCollisionHit* hits, bool* found, bool anyHit) const
+{
+	u32 i;
+	if (Nodes.empty())
+	{
+		for (i=0; i<count; ++i)
+			found[i] = false;
+		return 0;
+	}
+
+	core::matrix4 inverse(core::matrix4::EM4CONST_NOTHING);
+	if (SceneNode)
+		SceneNode->getAbsoluteTransformation().getInverse(inverse);
+
+	if (AnimatedNode && (u32)AnimatedNode->getFrameNr() != LastMeshFrame)
+	{
+		core::aabbox3d<f32> box;
+		for (i=0; i<count; ++i)
+		{
+			core::vector3df start(lines[i].start);
+			core::vector3df end(lines[i].end);
+			if (SceneNode)
+			{
+				inverse.transformVect(start);
+				inverse.transformVect(end);
+			}
+			if (i == 0)
+				box.reset(start);
+			else
+				box.addInternalPoint(start);
+			box.addInternalPoint(end);
+		}
+		if (!update(&box))
+		{
+			for (i=0; i<count; ++i)
+				found[i] = false;
+			return 0;
+		}
+	}
+
+	u32 hitCount = 0;
+	core::vector3df start[4];
+	core::vector3df dir[4];
+	f32 nearest[4];
+	s32 triangle[4];
+	for (i=0; i<count; )
+	{
+		// lines next to each other pointing the same way are traced
+		// together, the others one by one
+		u32 n = 1;
+		if (i + 4 <= count)
+		{
+			for (; n<4; ++n)
+			{
+				const core::vector3df d0(lines[i].end - lines[i].start);
+				const core::vector3df d(lines[i+n].end - lines[i+n].start);
+				if ((d0.X < 0.f) != (d.X < 0.f) || (d0.Y < 0.f) != (d.Y < 0.f) ||
+					(d0.Z < 0.f) != (d.Z < 0.f))
+					break;
+			}
+			if (n < 4)
+				n = 1;
+		}
+
+		u32 j;
+		for (j=0; j<n; ++j)
+		{
+			start[j] = lines[i+j].start;
+			core::vector3df end(lines[i+j].end);
+			if (SceneNode)
+			{
+				inverse.transformVect(start[j]);
+				inverse.transformVect(end);
+			}
+			dir[j] = end - start[j];
+			nearest[j] = 1.f;
+		}
+
+#ifdef BVH_TRIANGLE_SELECTOR_SSE
+		if (n == 4)
+			traceLines4(start, dir, nearest, triangle, anyHit);
+		else
+#endif
+		for (j=0; j<n; ++j)
+			triangle[j] = traceLine(start[j], dir[j], nearest[j], anyHit);
+
+		for (j=0; j<n; ++j, ++i)
+		{
+			found[i] = triangle[j] >= 0;
+			if (found[i])
+			{
+				getHit(start[j], dir[j], nearest[j], (u32) triangle[j], hits[i]);
+				++hitCount;
+			}
+		}
+	}
+
+	return hitCount;
+}
+
+
+//! Traces a line from start along dir in mesh space
+s32 CBVHTriangleSelector::traceLine(const core::vector3df& start,
+		const core::vector3df& dir, f32& nearest, bool anyHit) const
+{
+	const core::vector3df invDir(getInverseDirection(dir));
+
+	// the end of the line is not part of it
+	s32 found = -1;
+
+	u32 stack[BVH_STACK_SIZE];
+	f32 stackNear[BVH_STACK_SIZE];
+	u32 top = 0;
+
+	f32 tnear;
+	if (!intersectsWithLine(Nodes[0].Box, start, invDir, nearest, tnear))
+		return -1;
+
+	u32 current = 0;
+	while (true)
+	{
+		const SBVHNode& node = Nodes[current];
+		if (node.Count)
+		{
+			for (u32 i=node.Index; i<node.Index+node.Count; ++i)
+			{
+				const f32 t = intersectTriangle(start, dir,
+					Positions[Indices[i*3]], Positions[Indices[i*3+1]], Positions[Indices[i*3+2]]);
+				if (t >= 0.f && (t < nearest || (t == nearest && isBetterTie(i, found))))
+				{
+					nearest = t;
+					found = (s32) i;
+					if (anyHit)
+						return found;
+				}
+			}
+		}
+		else
+		{
+			u32 first = current + 1;
+			u32 second = node.Index;
+			f32 firstNear, secondNear;
+			const bool hitFirst = intersectsWithLine(Nodes[first].Box, start, invDir, nearest, firstNear);
+			const bool hitSecond = intersectsWithLine(Nodes[second].Box, start, invDir, nearest, secondNear);
+
+			if (hitFirst && hitSecond)
+			{
+				// the nearer child first, the other one later
+				if (secondNear < firstNear)
+				{
+					core::swap(first, second);
+					core::swap(firstNear, secondNear);
+				}
+				stack[top] = second;
+				stackNear[top++] = secondNear;
+				current = first;
+				continue;
+			}
+			if (hitFirst || hitSecond)
+			{
+				current = hitFirst ? first : second;
+				continue;
+			}
+		}
+
+		// next node still in front of the nearest hit
+		while (top && stackNear[top-1] > nearest)
+			--top;
+		if (!top)
+			break;
+		current = stack[--top];
+	}
+
+	return found;
+}
+
+
+#ifdef BVH_TRIANGLE_SELECTOR_SSE
+
+//! Traces four lines with the same direction signs at once, like traceLine()
+/** Nodes are visited while any of the lines still passes through them,
+in the order the first line would visit them. Hits at the same distance
+are decided by isBetterTie() as in traceLine(), so the order does not
+change the result. */
+void CBVHTriangleSelector::traceLines4(const core::vector3df* start,
+		const core::vector3df* dir, f32* nearest, s32* found, bool anyHit) const
+{
+	u32 i;
+	core::vector3df invDir[4];
+	for (i=0; i<4; ++i)
+	{
+		invDir[i] = getInverseDirection(dir[i]);
+		found[i] = -1;
+	}
+
+	const __m128 ox = _mm_setr_ps(start[0].X, start[1].X, start[2].X, start[3].X);
+	const __m128 oy = _mm_setr_ps(start[0].Y, start[1].Y, start[2].Y, start[3].Y);
+	const __m128 oz = _mm_setr_ps(start[0].Z, start[1].Z, start[2].Z, start[3].Z);
+	const __m128 dx = _mm_setr_ps(dir[0].X, dir[1].X, dir[2].X, dir[3].X);
+	const __m128 dy = _mm_setr_ps(dir[0].Y, dir[1].Y, dir[2].Y, dir[3].Y);
+	const __m128 dz = _mm_setr_ps(dir[0].Z, dir[1].Z, dir[2].Z, dir[3].Z);
+	const __m128 ix = _mm_setr_ps(invDir[0].X, invDir[1].X, invDir[2].X, invDir[3].X);
+	const __m128 iy = _mm_setr_ps(invDir[0].Y, invDir[1].Y, invDir[2].Y, invDir[3].Y);
+	const __m128 iz = _mm_setr_ps(invDir[0].Z, invDir[1].Z, invDir[2].Z, invDir[3].Z);
+
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.f);
+	__m128 tmax = _mm_loadu_ps(nearest);
+	__m128 active = _mm_cmpeq_ps(zero, zero);
+
+	u32 stack[BVH_STACK_SIZE];
+	u32 top = 0;
+	stack[top++] = 0;
+
+	while (top)
+	{
+		const u32 current = stack[--top];
+		const SBVHNode& node = Nodes[current];
+
+		// slab test of all lines
+		const core::aabbox3d<f32>& box = node.Box;
+		__m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box.MinEdge.X), ox), ix);
+		__m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box.MaxEdge.X), ox), ix);
+		__m128 tnear = _mm_min_ps(t0, t1);
+		__m128 tfar = _mm_max_ps(t0, t1);
+		t0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box.MinEdge.Y), oy), iy);
+		t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box.MaxEdge.Y), oy), iy);
+		tnear = _mm_max_ps(tnear, _mm_min_ps(t0, t1));
+		tfar = _mm_min_ps(tfar, _mm_max_ps(t0, t1));
+		t0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box.MinEdge.Z), oz), iz);
+		t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box.MaxEdge.Z), oz), iz);
+		tnear = _mm_max_ps(_mm_max_ps(tnear, _mm_min_ps(t0, t1)), zero);
+		tfar = _mm_min_ps(_mm_min_ps(tfar, _mm_max_ps(t0, t1)), tmax);
+		if (!_mm_movemask_ps(_mm_and_ps(_mm_cmple_ps(tnear, tfar), active)))
+			continue;
+
+		if (!node.Count)
+		{
+			// the child nearer along the first line is visited first
+			const u32 first = current + 1;
+			const u32 second = node.Index;
+			if ((Nodes[second].Box.getCenter() - Nodes[first].Box.getCenter()).dotProduct(dir[0]) < 0.f)
+			{
+				stack[top++] = first;
+				stack[top++] = second;
+			}
+			else
+			{
+				stack[top++] = second;
+				stack[top++] = first;
+			}
+			continue;
+		}
+
+		for (i=node.Index; i<node.Index+node.Count; ++i)
+		{
+			const core::vector3df& a = Positions[Indices[i*3]];
+			const core::vector3df& b = Positions[Indices[i*3+1]];
+			const core::vector3df& c = Positions[Indices[i*3+2]];
+			const __m128 e1x = _mm_set1_ps(b.X - a.X);
+			const __m128 e1y = _mm_set1_ps(b.Y - a.Y);
+			const __m128 e1z = _mm_set1_ps(b.Z - a.Z);
+			const __m128 e2x = _mm_set1_ps(c.X - a.X);
+			const __m128 e2y = _mm_set1_ps(c.Y - a.Y);
+			const __m128 e2z = _mm_set1_ps(c.Z - a.Z);
+
+			// same operations as intersectTriangle()
+			const __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+			const __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+			const __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+			const __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+			const __m128 invDet = _mm_div_ps(one, det);
+
+			const __m128 sx = _mm_sub_ps(ox, _mm_set1_ps(a.X));
+			const __m128 sy = _mm_sub_ps(oy, _mm_set1_ps(a.Y));
+			const __m128 sz = _mm_sub_ps(oz, _mm_set1_ps(a.Z));
+			const __m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), invDet);
+
+			const __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+			const __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+			const __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+			const __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), invDet);
+			const __m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), invDet);
+
+			__m128 mask = _mm_and_ps(active, _mm_cmpneq_ps(det, zero));
+			mask = _mm_and_ps(mask, _mm_and_ps(_mm_cmpge_ps(u, zero), _mm_cmple_ps(u, one)));
+			mask = _mm_and_ps(mask, _mm_and_ps(_mm_cmpge_ps(v, zero), _mm_cmple_ps(_mm_add_ps(u, v), one)));
+			mask = _mm_and_ps(mask, _mm_and_ps(_mm_cmpge_ps(t, zero), _mm_cmple_ps(t, tmax)));
+
+			s32 hitLanes = _mm_movemask_ps(mask);
+			if (!hitLanes)
+				continue;
+
+			// hits at the distance of the current one only replace it
+			// as in traceLine(), tmax stays the same for them
+			const s32 tieLanes = hitLanes & _mm_movemask_ps(_mm_cmpeq_ps(t, tmax));
+			for (u32 lane=0; lane<4; ++lane)
+			{
+				if ((tieLanes & (1 << lane)) && !isBetterTie(i, found[lane]))
+					hitLanes &= ~(1 << lane);
+			}
+
+			tmax = _mm_or_ps(_mm_and_ps(mask, t), _mm_andnot_ps(mask, tmax));
+			for (u32 lane=0; lane<4; ++lane)
+			{
+				if (hitLanes & (1 << lane))
+					found[lane] = (s32) i;
+			}
+
+			if (anyHit)
+			{
+				active = _mm_andnot_ps(mask, active);
+				if (!_mm_movemask_ps(active))
+				{
+					_mm_storeu_ps(nearest, tmax);
+					return;
+				}
+			}
+		}
+	}
+
+	_mm_storeu_ps(nearest, tmax);
+}
+
+#endif
+
+
+//! Fills the hit of a line in mesh space with the triangle at a position in the leaves
+void CBVHTriangleSelector::getHit(const core::vector3df& start,
+		const core::vector3df& dir, f32 t, u32 triangle, SCollisionHit& hit) const
+{
+	getTriangle(triangle, hit.Triangle);
+	hit.Intersection = start + dir * t;
+	if (SceneNode)
+	{
+		const core::matrix4& mat = SceneNode->getAbsoluteTransformation();
+		mat.transformVect(hit.Intersection);
+		mat.transformVect(hit.Triangle.pointA);
+		mat.transformVect(hit.Triangle.pointB);
+		mat.transformVect(hit.Triangle.pointC);
+	}
+	hit.Node = SceneNode;
+	hit.TriangleIndex = TriangleIndices[triangle];
+}
+
+
+//! Get the box around all triangles in world space
+bool CBVHTriangleSelector::getTransformedBoundingBox(core::aabbox3d<f32>& box) const
+{
+	// the boxes of animated nodes are refitted with the frame
+	if (AnimatedNode || Nodes.empty())
+		return false;
+
+	box = Nodes[0].Box;
+	if (SceneNode)
+		SceneNode->getAbsoluteTransformation().transformBoxEx(box);
+	return true;
+}
+
+
+//! Returns amount of all available triangles in this selector
+s32 CBVHTriangleSelector::getTriangleCount() const
+{
+	return TriangleIndices.size();
+}
+
+
+/* Get the number of TriangleSelectors that are part of this one.
+Only useful for MetaTriangleSelector others return 1
+*/
+u32 CBVHTriangleSelector::getSelectorCount() const
+{
+	return 1;
+}
+
+
+/* Get the TriangleSelector based on index based on getSelectorCount.
+Only useful for MetaTriangleSelector others return 'this' or 0
+*/
+ITriangleSelector* CBVHTriangleSelector::getSelector(u32 index)
+{
+	if (index)
+		return 0;
+	else
+		return this;
+}
+
+
+/* Get the TriangleSelector based on index based on getSelectorCount.
+Only useful for MetaTriangleSelector others return 'this' or 0
+*/
+const ITriangleSelector* CBVHTriangleSelector::getSelector(u32 index) const
+{
+	if (index)
+		return 0;
+	else
+		return this;
+}
+
+
+} // end namespace scene
+} // end namespace irr
+
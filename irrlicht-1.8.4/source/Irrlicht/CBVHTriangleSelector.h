@@ -0,0 +1,173 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_BVH_TRIANGLE_SELECTOR_H_INCLUDED__
+#define __C_BVH_TRIANGLE_SELECTOR_H_INCLUDED__
+
+#include "ITriangleSelector.h"
+#include "IMesh.h"
+#include "irrArray.h"
+
+namespace irr
+{
+namespace scene
+{
+
+class ISceneNode;
+class IAnimatedMeshSceneNode;
+
+//! Triangle selector keeping indexed triangles in a bounding volume hierarchy
+/** The hierarchy is built with the surface area heuristic and stored
+depth first in one array, the first child of an inner node follows it
+directly. Line queries walk the tree front to back in mesh space and
+test the triangles themselves, without copying them out.
+Built from an animated mesh scene node, the tree keeps the triangles of
+the first frame and only its boxes are fitted to the positions of later
+frames, when a query touches the bounding box of the node. */
+class CBVHTriangleSelector : public ITriangleSelector
+{
+public:
+
+	//! Constructs a selector based on a mesh
+	CBVHTriangleSelector(const IMesh* mesh, ISceneNode* node, u32 maxTrianglesPerLeaf);
+
+	//! Constructs a selector following the frames of an animated mesh scene node
+	CBVHTriangleSelector(IAnimatedMeshSceneNode* node, u32 maxTrianglesPerLeaf);
+
+	//! Gets all triangles.
+	virtual void getTriangles(core::triangle3df* triangles, s32 arraySize,
+		s32& outTriangleCount, const core::matrix4* transform=0) const;
+
+	//! Gets all triangles which lie within a specific bounding box.
+	virtual void getTriangles(core::triangle3df* triangles, s32 arraySize,
+		s32& outTriangleCount, const core::aabbox3d<f32>& box,
+		const core::matrix4* transform=0) const;
+
+	//! Gets all triangles which have or may have contact with a 3d line.
+	virtual void getTriangles(core::triangle3df* triangles, s32 arraySize,
+		s32& outTriangleCount, const core::line3d<f32>& line,
+		const core::matrix4* transform=0) const;
+
+	//! Returns amount of all available triangles in this selector
+	virtual s32 getTriangleCount() const;
+
+	//! Return the scene node associated with a given triangle.
+	virtual ISceneNode* getSceneNodeForTriangle(u32 triangleIndex) const { return SceneNode; }
+
+	// Get the number of TriangleSelectors that are part of this one
+	virtual u32 getSelectorCount() const;
+
+	// Get the TriangleSelector based on index based on getSelectorCount
+	virtual ITriangleSelector* getSelector(u32 index);
+
+	// Get the TriangleSelector based on index based on getSelectorCount
+	virtual const ITriangleSelector* getSelector(u32 index) const;
+
+	//! Refits the hierarchy to the current frame of an animated node
+	virtual void updateForQueries() const { update(0); }
+
+	//! Finds the triangle hit by a line segment
+	virtual bool getCollisionPoint(const core::line3d<f32>& line,
+		SCollisionHit& hit, bool anyHit=false) const;
+
+	//! Finds the triangles hit by several line segments
+	virtual u32 getCollisionPoints(const core::line3d<f32>* lines, u32 count,
+		SCollisionHit* hits, bool* found, bool anyHit=false) const;
+
+	//! Get the box around all triangles in world space
+	virtual bool getTransformedBoundingBox(core::aabbox3d<f32>& box) const;
+
+private:
+
+	//! Node of the hierarchy
+	struct SBVHNode
+	{
+		core::aabbox3d<f32> Box;
+
+		//! first triangle of a leaf, or the second child of an inner node
+		u32 Index;
+
+		//! triangles of a leaf, 0 for inner nodes
+		u32 Count;
+	};
+
+	//! Triangle while building the hierarchy
+	struct SBuildTriangle
+	{
+		core::aabbox3d<f32> Box;
+		core::vector3df Center;
+		u32 Index;
+	};
+
+	//! Builds the hierarchy for the triangles of a mesh
+	void createFromMesh(const IMesh* mesh);
+
+	//! Moves the triangles to the positions of a frame with the same topology and refits the boxes
+	void updateFromMesh(const IMesh* mesh) const;
+
+	//! Updates to the current frame of the animated node, unless the query misses it
+	/** \param box Box around the query in mesh space, or 0 if it may touch any triangle.
+	\return False if the query cannot hit any triangle of the current frame. */
+	bool update(const core::aabbox3d<f32>* box) const;
+
+	//! Builds the node for the triangles from start to end, returns its index
+	u32 buildNode(core::array<SBuildTriangle>& build, u32 start, u32 end, u32 depth);
+
+	//! Splits the triangles from start to end, returns the first of the second half
+	u32 split(core::array<SBuildTriangle>& build, u32 start, u32 end, u32 depth) const;
+
+	//! Traces a line from start along dir in mesh space
+	/** Of triangles hit at the same distance the one with the lowest
+	index in the mesh is returned, unless anyHit is set.
+	\param nearest Line parameter up to which triangles are hit,
+	receives the one of the hit.
+	\return Position of the hit triangle in the leaves, or -1. */
+	s32 traceLine(const core::vector3df& start, const core::vector3df& dir,
+		f32& nearest, bool anyHit) const;
+
+	//! Traces four lines with the same direction signs at once, like traceLine()
+	void traceLines4(const core::vector3df* start, const core::vector3df* dir,
+		f32* nearest, s32* found, bool anyHit) const;
+
+	//! Returns true if a triangle hit at the distance of the current hit replaces it
+	bool isBetterTie(u32 i, s32 found) const
+	{
+		return found >= 0 && TriangleIndices[i] < TriangleIndices[(u32) found];
+	}
+
+	//! Fills the hit of a line in mesh space with the triangle at a position in the leaves
+	void getHit(const core::vector3df& start, const core::vector3df& dir,
+		f32 t, u32 triangle, SCollisionHit& hit) const;
+
+	//! Returns a triangle in mesh space
+	void getTriangle(u32 i, core::triangle3df& triangle) const
+	{
+		triangle.pointA = Positions[Indices[i*3]];
+		triangle.pointB = Positions[Indices[i*3+1]];
+		triangle.pointC = Positions[Indices[i*3+2]];
+	}
+
+	ISceneNode* SceneNode;
+
+	mutable core::array<SBVHNode> Nodes; // (mutable for refitting to animated frames)
+	mutable core::array<core::vector3df> Positions;
+
+	//! three positions per triangle, in the order of the leaves
+	core::array<u32> Indices;
+
+	//! triangle index in the mesh, in the order of the leaves
+	core::array<u32> TriangleIndices;
+
+	u32 MaxTrianglesPerLeaf;
+
+	IAnimatedMeshSceneNode* AnimatedNode;
+	mutable u32 LastMeshFrame;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+
+#endif
+
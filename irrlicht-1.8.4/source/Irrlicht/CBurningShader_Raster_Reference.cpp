@@ -854,6 +854,9 @@ void CBurningShader_Raster_Reference::drawTriangle ( const s4DVertex *a,const s4
 	sScanConvertData scan;
 	u32 i;
 
+	// depth writes depend on the material, the coarse depth is read again
+	markDepthTiles ( a, b, c );
+
 	// sort on height, y
 	if ( F32_A_GREATER_B ( a->Pos.y , b->Pos.y ) ) swapVertexPointer(&a, &b);
 	if ( F32_A_GREATER_B ( b->Pos.y , c->Pos.y ) ) swapVertexPointer(&b, &c);
@@ -978,7 +981,8 @@ void CBurningShader_Raster_Reference::drawTriangle ( const s4DVertex *a,const s4
 			}
 
 			// render a scanline
-			scanline ();
+			if ( isRowOwned ( line.y ) )
+				scanline ();
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
@@ -1093,7 +1097,8 @@ void CBurningShader_Raster_Reference::drawTriangle ( const s4DVertex *a,const s4
 			}
 
 			// render a scanline
-			scanline ();
+			if ( isRowOwned ( line.y ) )
+				scanline ();
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
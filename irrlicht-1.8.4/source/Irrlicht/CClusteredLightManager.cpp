@@ -0,0 +1,324 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CClusteredLightManager.h"
+#include "ILightSceneNode.h"
+#include "IVideoDriver.h"
+
+namespace irr
+{
+namespace scene
+{
+
+//! lights covering more cells are tested against every node instead
+static const s32 MAX_CELLS_PER_LIGHT = 64;
+
+
+//! constructor
+CClusteredLightManager::CClusteredLightManager(ISceneManager* mgr, f32 cellSize)
+: SceneManager(mgr), LightList(0), CellSize(100.f), MaxLightsPerNode(0),
+	Stamp(0), CurrentPass(ESNRP_NONE)
+{
+	#ifdef _DEBUG
+	setDebugName("CClusteredLightManager");
+	#endif
+
+	// the scene manager holds the light manager, so it is not grabbed here
+	setCellSize(cellSize);
+}
+
+
+//! bins all point and spot lights into the grid
+void CClusteredLightManager::OnPreRender(core::array<ISceneNode*>& lightList)
+{
+	LightList = &lightList;
+
+	Lights.set_used(lightList.size());
+	Cells.set_used(0);
+	GlobalLights.set_used(0);
+	LargeLights.set_used(0);
+	Enabled.set_used(0);
+	Stamp = 0;
+
+	const f32 invCellSize = core::reciprocal(CellSize);
+
+	// the lights are added to the driver in list order, so the
+	// index in the list is also the driver light index
+	for (u32 i=0; i<lightList.size(); ++i)
+	{
+		SLightEntry& entry = Lights[i];
+		entry.Node = 0;
+		entry.Stamp = 0;
+
+		if (lightList[i]->getType() != ESNT_LIGHT)
+			continue;
+
+		entry.Node = static_cast<ILightSceneNode*>(lightList[i]);
+		const video::SLight& data = entry.Node->getLightData();
+
+		if (data.Type == video::ELT_DIRECTIONAL)
+		{
+			GlobalLights.push_back(i);
+			continue;
+		}
+
+		entry.Position = entry.Node->getAbsolutePosition();
+		entry.RadiusSQ = data.Radius * data.Radius;
+
+		const s32 x0 = core::floor32((entry.Position.X - data.Radius) * invCellSize);
+		const s32 y0 = core::floor32((entry.Position.Y - data.Radius) * invCellSize);
+		const s32 z0 = core::floor32((entry.Position.Z - data.Radius) * invCellSize);
+		const s32 x1 = core::floor32((entry.Position.X + data.Radius) * invCellSize);
+		const s32 y1 = core::floor32((entry.Position.Y + data.Radius) * invCellSize);
+		const s32 z1 = core::floor32((entry.Position.Z + data.Radius) * invCellSize);
+
+		if ((x1-x0+1) * (y1-y0+1) * (z1-z0+1) > MAX_CELLS_PER_LIGHT)
+		{
+			LargeLights.push_back(i);
+			continue;
+		}
+
+		SCellEntry cell;
+		cell.Light = i;
+		for (cell.Z=z0; cell.Z<=z1; ++cell.Z)
+			for (cell.Y=y0; cell.Y<=y1; ++cell.Y)
+				for (cell.X=x0; cell.X<=x1; ++cell.X)
+					Cells.push_back(cell);
+	}
+
+	Cells.sort();
+}
+
+
+void CClusteredLightManager::OnPostRender(void)
+{
+	LightList = 0;
+	Lights.set_used(0);
+	Cells.set_used(0);
+	GlobalLights.set_used(0);
+	LargeLights.set_used(0);
+	Enabled.set_used(0);
+}
+
+
+void CClusteredLightManager::OnRenderPassPreRender(E_SCENE_NODE_RENDER_PASS renderPass)
+{
+	CurrentPass = renderPass;
+}
+
+
+void CClusteredLightManager::OnRenderPassPostRender(E_SCENE_NODE_RENDER_PASS renderPass)
+{
+	// all lights are on after they were added, each node switches on its own
+	if (renderPass == ESNRP_LIGHT && LightList)
+	{
+		video::IVideoDriver* driver = SceneManager->getVideoDriver();
+		for (u32 i=0; i<Lights.size(); ++i)
+			driver->turnLightOn((s32)i, false);
+	}
+
+	CurrentPass = ESNRP_NONE;
+}
+
+
+//! switches on the lights affecting the node
+void CClusteredLightManager::OnNodePreRender(ISceneNode* node)
+{
+	if (!LightList || !node)
+		return;
+
+	video::IVideoDriver* driver = SceneManager->getVideoDriver();
+
+	collectLights(node->getTransformedBoundingBox());
+
+	u32 i;
+	for (i=0; i<Enabled.size(); ++i)
+		driver->turnLightOn((s32)Enabled[i], false);
+
+	Enabled.set_used(Candidates.size());
+	for (i=0; i<Candidates.size(); ++i)
+	{
+		Enabled[i] = Candidates[i].Light;
+		driver->turnLightOn((s32)Enabled[i], true);
+	}
+}
+
+
+void CClusteredLightManager::OnNodePostRender(ISceneNode* node)
+{
+}
+
+
+void CClusteredLightManager::setCellSize(f32 size)
+{
+	CellSize = size > 0.f ? size : 100.f;
+}
+
+
+f32 CClusteredLightManager::getCellSize() const
+{
+	return CellSize;
+}
+
+
+void CClusteredLightManager::setMaxLightsPerNode(u32 count)
+{
+	MaxLightsPerNode = count;
+}
+
+
+u32 CClusteredLightManager::getMaxLightsPerNode() const
+{
+	return MaxLightsPerNode;
+}
+
+
+//! Returns the lights affecting a world space box, nearest first.
+void CClusteredLightManager::getLightsInBox(const core::aabbox3d<f32>& box,
+		core::array<ILightSceneNode*>& outLights)
+{
+	outLights.set_used(0);
+
+	if (!LightList)
+		return;
+
+	collectLights(box);
+
+	outLights.set_used(Candidates.size());
+	for (u32 i=0; i<Candidates.size(); ++i)
+		outLights[i] = Lights[Candidates[i].Light].Node;
+}
+
+
+u32 CClusteredLightManager::getLightLimit() const
+{
+	if (MaxLightsPerNode)
+		return MaxLightsPerNode;
+
+	const u32 limit = SceneManager->getVideoDriver()->getMaximalDynamicLightAmount();
+	return limit ? limit : Lights.size();
+}
+
+
+void CClusteredLightManager::collectLights(const core::aabbox3d<f32>& box)
+{
+	Candidates.set_used(0);
+
+	// marks the lights already tested for this box
+	++Stamp;
+
+	u32 i;
+	for (i=0; i<GlobalLights.size(); ++i)
+	{
+		SCandidate c;
+		c.Light = GlobalLights[i];
+		c.DistanceSQ = 0.f;
+		Candidates.push_back(c);
+	}
+
+	for (i=0; i<LargeLights.size(); ++i)
+		testLight(LargeLights[i], box);
+
+	const f32 invCellSize = core::reciprocal(CellSize);
+	const s32 x0 = core::floor32(box.MinEdge.X * invCellSize);
+	const s32 y0 = core::floor32(box.MinEdge.Y * invCellSize);
+	const s32 z0 = core::floor32(box.MinEdge.Z * invCellSize);
+	const s32 x1 = core::floor32(box.MaxEdge.X * invCellSize);
+	const s32 y1 = core::floor32(box.MaxEdge.Y * invCellSize);
+	const s32 z1 = core::floor32(box.MaxEdge.Z * invCellSize);
+
+	// large boxes would visit more cells than there are lights
+	const f64 cellCount = (f64)(x1-x0+1) * (f64)(y1-y0+1) * (f64)(z1-z0+1);
+	if (cellCount > (f64)Lights.size())
+	{
+		for (i=0; i<Lights.size(); ++i)
+		{
+			if (Lights[i].Node && Lights[i].Node->getLightData().Type != video::ELT_DIRECTIONAL)
+				testLight(i, box);
+		}
+	}
+	else
+	{
+		for (s32 z=z0; z<=z1; ++z)
+		{
+			for (s32 y=y0; y<=y1; ++y)
+			{
+				u32 c = findCell(x0, y, z);
+				while (c < Cells.size() && Cells[c].Z == z && Cells[c].Y == y && Cells[c].X <= x1)
+				{
+					testLight(Cells[c].Light, box);
+					++c;
+				}
+			}
+		}
+	}
+
+	Candidates.sort();
+
+	const u32 limit = getLightLimit();
+	if (Candidates.size() > limit)
+		Candidates.set_used(limit);
+}
+
+
+void CClusteredLightManager::testLight(u32 light, const core::aabbox3d<f32>& box)
+{
+	SLightEntry& entry = Lights[light];
+	if (entry.Stamp == Stamp)
+		return;
+
+	entry.Stamp = Stamp;
+
+	// squared distance of the light position to the box
+	const core::vector3df& p = entry.Position;
+	f32 d;
+	f32 distanceSQ = 0.f;
+
+	d = core::max_(box.MinEdge.X - p.X, 0.f, p.X - box.MaxEdge.X);
+	distanceSQ += d * d;
+	d = core::max_(box.MinEdge.Y - p.Y, 0.f, p.Y - box.MaxEdge.Y);
+	distanceSQ += d * d;
+	d = core::max_(box.MinEdge.Z - p.Z, 0.f, p.Z - box.MaxEdge.Z);
+	distanceSQ += d * d;
+
+	if (distanceSQ > entry.RadiusSQ)
+		return;
+
+	SCandidate c;
+	c.Light = light;
+	c.DistanceSQ = distanceSQ;
+	Candidates.push_back(c);
+}
+
+
+u32 CClusteredLightManager::findCell(s32 x, s32 y, s32 z) const
+{
+	SCellEntry key;
+	key.X = x;
+	key.Y = y;
+	key.Z = z;
+	key.Light = 0;
+
+	u32 first = 0;
+	u32 count = Cells.size();
+	while (count > 0)
+	{
+		const u32 step = count >> 1;
+		const u32 mid = first + step;
+		if (Cells[mid] < key)
+		{
+			first = mid + 1;
+			count -= step + 1;
+		}
+		else
+			count = step;
+	}
+
+	return first;
+}
+
+
+} // end namespace scene
+} // end namespace irr
+
@@ -0,0 +1,114 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_CLUSTERED_LIGHT_MANAGER_H_INCLUDED__
+#define __C_CLUSTERED_LIGHT_MANAGER_H_INCLUDED__
+
+#include "IClusteredLightManager.h"
+#include "ISceneManager.h"
+
+namespace irr
+{
+namespace scene
+{
+	//! Light manager switching on the lights near each node, found with a world grid.
+	class CClusteredLightManager : public IClusteredLightManager
+	{
+	public:
+
+		//! constructor
+		CClusteredLightManager(ISceneManager* mgr, f32 cellSize);
+
+		virtual void OnPreRender(core::array<ISceneNode*>& lightList);
+		virtual void OnPostRender(void);
+		virtual void OnRenderPassPreRender(E_SCENE_NODE_RENDER_PASS renderPass);
+		virtual void OnRenderPassPostRender(E_SCENE_NODE_RENDER_PASS renderPass);
+		virtual void OnNodePreRender(ISceneNode* node);
+		virtual void OnNodePostRender(ISceneNode* node);
+
+		virtual void setCellSize(f32 size);
+		virtual f32 getCellSize() const;
+		virtual void setMaxLightsPerNode(u32 count);
+		virtual u32 getMaxLightsPerNode() const;
+		virtual void getLightsInBox(const core::aabbox3d<f32>& box,
+			core::array<ILightSceneNode*>& outLights);
+
+	private:
+
+		struct SLightEntry
+		{
+			ILightSceneNode* Node;
+			core::vector3df Position;
+			f32 RadiusSQ;
+			u32 Stamp;
+		};
+
+		//! a light overlapping one grid cell, sorted by cell
+		struct SCellEntry
+		{
+			s32 X, Y, Z;
+			u32 Light;
+
+			bool operator<(const SCellEntry& other) const
+			{
+				if (Z != other.Z)
+					return Z < other.Z;
+				if (Y != other.Y)
+					return Y < other.Y;
+				if (X != other.X)
+					return X < other.X;
+				return Light < other.Light;
+			}
+		};
+
+		struct SCandidate
+		{
+			u32 Light;
+			f32 DistanceSQ;
+
+			bool operator<(const SCandidate& other) const
+			{
+				return DistanceSQ < other.DistanceSQ;
+			}
+		};
+
+		//! fills Candidates with the lights affecting the box, nearest first
+		void collectLights(const core::aabbox3d<f32>& box);
+
+		//! adds the light to Candidates if it overlaps the box
+		void testLight(u32 light, const core::aabbox3d<f32>& box);
+
+		//! returns index of the first cell entry not less than the cell
+		u32 findCell(s32 x, s32 y, s32 z) const;
+
+		u32 getLightLimit() const;
+
+		ISceneManager* SceneManager;
+		core::array<ISceneNode*>* LightList;
+
+		core::array<SLightEntry> Lights;
+		core::array<SCellEntry> Cells;
+
+		//! directional lights, affecting every node
+		core::array<u32> GlobalLights;
+
+		//! lights covering too many cells to be binned
+		core::array<u32> LargeLights;
+
+		core::array<SCandidate> Candidates;
+
+		//! driver indices of the lights switched on for the current node
+		core::array<u32> Enabled;
+
+		f32 CellSize;
+		u32 MaxLightsPerNode;
+		u32 Stamp;
+		E_SCENE_NODE_RENDER_PASS CurrentPass;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
@@ -16,7 +16,10 @@ namespace video
 
 //! constructor
 CDepthBuffer::CDepthBuffer(const core::dimension2d<u32>& size)
-: Buffer(0), Size(0,0)
+: Buffer(0), OwnBuffer(0), Size(0,0)
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+	, TileFar(0), TileDirty(0), TileCount(0,0)
+#endif
 {
 	#ifdef _DEBUG
 	setDebugName("CDepthBuffer");
@@ -30,8 +33,13 @@ CDepthBuffer::CDepthBuffer(const core::dimension2d<u32>& size)
 //! destructor
 CDepthBuffer::~CDepthBuffer()
 {
-	if (Buffer)
-		delete [] Buffer;
+	if (OwnBuffer)
+		delete [] OwnBuffer;
+
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+	delete [] TileFar;
+	delete [] TileDirty;
+#endif
 }
 
 
@@ -50,8 +58,55 @@ void CDepthBuffer::clear()
 	zMaxValue = IR(zMax);
 
 	memset32 ( Buffer, zMaxValue, TotalSize );
+
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+	const u32 tiles = TileCount.Width * TileCount.Height;
+	memset32 ( TileFar, zMaxValue, tiles * sizeof ( fp24 ) );
+	memset ( TileDirty, 0, tiles );
+#endif
+}
+
+
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+//! reads the farthest depth of a tile from the depth buffer
+void CDepthBuffer::updateTile(u32 tileX, u32 tileY)
+{
+	const u32 x0 = tileX << SOFTWARE_DRIVER_2_TILE_SIZE_LOG2;
+	const u32 y0 = tileY << SOFTWARE_DRIVER_2_TILE_SIZE_LOG2;
+	const u32 x1 = core::min_ ( x0 + ( 1 << SOFTWARE_DRIVER_2_TILE_SIZE_LOG2 ), Size.Width );
+	const u32 y1 = core::min_ ( y0 + ( 1 << SOFTWARE_DRIVER_2_TILE_SIZE_LOG2 ), Size.Height );
+
+	// w buffer, the farthest value is the smallest
+	fp24 zFar = ((fp24*) Buffer) [ y0 * Size.Width + x0 ];
+	for ( u32 y = y0; y != y1; ++y )
+	{
+		const fp24* z = (fp24*) Buffer + y * Size.Width;
+		for ( u32 x = x0; x != x1; ++x )
+			zFar = core::min_ ( zFar, z[x] );
+	}
+
+	const u32 tile = tileY * TileCount.Width + tileX;
+	TileFar[tile] = zFar;
+	TileDirty[tile] = 0;
 }
+#endif
+
+
+
+//! keeps the depth values in caller owned memory of the current size
+void CDepthBuffer::setForeignMemory(void* data)
+{
+	u8* buffer = data ? (u8*) data : OwnBuffer;
+	if (buffer == Buffer)
+		return;
+
+	Buffer = buffer;
 
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+	// the coarse layer is read again from the new memory
+	memset ( TileDirty, 1, TileCount.Width * TileCount.Height );
+#endif
+}
 
 
 //! sets the new size of the zbuffer
@@ -62,12 +117,25 @@ void CDepthBuffer::setSize(const core::dimension2d<u32>& size)
 
 	Size = size;
 
-	if (Buffer)
-		delete [] Buffer;
+	if (OwnBuffer)
+		delete [] OwnBuffer;
 
 	Pitch = size.Width * sizeof ( fp24 );
 	TotalSize = Pitch * size.Height;
-	Buffer = new u8[TotalSize];
+	OwnBuffer = new u8[TotalSize];
+	Buffer = OwnBuffer;
+
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+	delete [] TileFar;
+	delete [] TileDirty;
+
+	const u32 tileSize = 1 << SOFTWARE_DRIVER_2_TILE_SIZE_LOG2;
+	TileCount.Width = ( size.Width + tileSize - 1 ) >> SOFTWARE_DRIVER_2_TILE_SIZE_LOG2;
+	TileCount.Height = ( size.Height + tileSize - 1 ) >> SOFTWARE_DRIVER_2_TILE_SIZE_LOG2;
+	TileFar = new fp24[TileCount.Width * TileCount.Height];
+	TileDirty = new u8[TileCount.Width * TileCount.Height];
+#endif
+
 	clear ();
 }
 
@@ -40,13 +40,51 @@ namespace video
 		//! returns pitch of depthbuffer (in bytes)
 		virtual u32 getPitch() const { return Pitch; }
 
+		//! keeps the depth values in caller owned memory of the current size
+		/** The own memory is used again if data is 0 or the size changes. */
+		void setForeignMemory(void* data);
+
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+		//! returns the amount of tiles in x and y
+		const core::dimension2d<u32>& getTileCount() const { return TileCount; }
+
+		//! returns the farthest depth of a tile, updated first if the tile was written
+		inline fp24 getTileFar(u32 tileX, u32 tileY)
+		{
+			const u32 tile = tileY * TileCount.Width + tileX;
+			if (TileDirty[tile])
+				updateTile(tileX, tileY);
+			return TileFar[tile];
+		}
+
+		//! marks the tiles of a rectangle of tiles as written
+		inline void markTiles(u32 tileX0, u32 tileX1, u32 tileY)
+		{
+			u8* dirty = TileDirty + tileY * TileCount.Width;
+			for (u32 x = tileX0; x <= tileX1; ++x)
+				dirty[x] = 1;
+		}
+#endif
 
 	private:
 
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+		//! reads the farthest depth of a tile from the depth buffer
+		void updateTile(u32 tileX, u32 tileY);
+#endif
+
 		u8* Buffer;
+		u8* OwnBuffer;
 		core::dimension2d<u32> Size;
 		u32 TotalSize;
 		u32 Pitch;
+
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+		// coarse layer, tiles of 1 << SOFTWARE_DRIVER_2_TILE_SIZE_LOG2 pixels
+		fp24* TileFar;
+		u8* TileDirty;
+		core::dimension2d<u32> TileCount;
+#endif
 	};
 
 
@@ -0,0 +1,320 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CInstancedMeshSceneNode.h"
+#include "IVideoDriver.h"
+#include "ISceneManager.h"
+#include "IMaterialRenderer.h"
+
+namespace irr
+{
+namespace scene
+{
+
+
+//! constructor
+CInstancedMeshSceneNode::CInstancedMeshSceneNode(IMesh* mesh, ISceneNode* parent,
+			ISceneManager* mgr, s32 id,
+			const core::vector3df& position, const core::vector3df& rotation,
+			const core::vector3df& scale)
+: IInstancedMeshSceneNode(parent, mgr, id, position, rotation, scale), Mesh(0),
+	PassCount(0), ReadOnlyMaterials(false), BoxDirty(true)
+{
+	#ifdef _DEBUG
+	setDebugName("CInstancedMeshSceneNode");
+	#endif
+
+	setMesh(mesh);
+}
+
+
+//! destructor
+CInstancedMeshSceneNode::~CInstancedMeshSceneNode()
+{
+	if (Mesh)
+		Mesh->drop();
+}
+
+
+//! frame
+void CInstancedMeshSceneNode::OnRegisterSceneNode()
+{
+	if (IsVisible)
+	{
+		// the box has to be valid before the scene manager culls the node
+		updateBoundingBox();
+
+		if (Mesh && Instances.size())
+		{
+			video::IVideoDriver* driver = SceneManager->getVideoDriver();
+
+			PassCount = 0;
+			int transparentCount = 0;
+			int solidCount = 0;
+
+			const u32 count = ReadOnlyMaterials ? Mesh->getMeshBufferCount() : Materials.size();
+			for (u32 i=0; i<count; ++i)
+			{
+				const scene::IMeshBuffer* mb = ReadOnlyMaterials ? Mesh->getMeshBuffer(i) : 0;
+				if (ReadOnlyMaterials && !mb)
+					continue;
+
+				const video::SMaterial& material = mb ? mb->getMaterial() : Materials[i];
+				video::IMaterialRenderer* rnd = driver->getMaterialRenderer(material.MaterialType);
+
+				if (rnd && rnd->isTransparent())
+					++transparentCount;
+				else
+					++solidCount;
+
+				if (solidCount && transparentCount)
+					break;
+			}
+
+			if (solidCount)
+				SceneManager->registerNodeForRendering(this, scene::ESNRP_SOLID);
+
+			if (transparentCount)
+				SceneManager->registerNodeForRendering(this, scene::ESNRP_TRANSPARENT);
+		}
+
+		ISceneNode::OnRegisterSceneNode();
+	}
+}
+
+
+//! renders the node.
+void CInstancedMeshSceneNode::render()
+{
+	video::IVideoDriver* driver = SceneManager->getVideoDriver();
+
+	if (!Mesh || !driver || Instances.empty())
+		return;
+
+	bool isTransparentPass =
+		SceneManager->getSceneNodeRenderPass() == scene::ESNRP_TRANSPARENT;
+
+	++PassCount;
+
+	// the absolute transformations are shared by all meshbuffers and passes
+	if (PassCount == 1)
+	{
+		WorldTransforms.set_used(Instances.size());
+		for (u32 i=0; i<Instances.size(); ++i)
+			WorldTransforms[i].setbyproduct_nocheck(AbsoluteTransformation, Instances[i]);
+	}
+
+	driver->setTransform(video::ETS_WORLD, AbsoluteTransformation);
+
+	for (u32 i=0; i<Mesh->getMeshBufferCount(); ++i)
+	{
+		scene::IMeshBuffer* mb = Mesh->getMeshBuffer(i);
+		if (!mb)
+			continue;
+
+		const video::SMaterial& material = ReadOnlyMaterials ? mb->getMaterial() : Materials[i];
+
+		video::IMaterialRenderer* rnd = driver->getMaterialRenderer(material.MaterialType);
+		bool transparent = (rnd && rnd->isTransparent());
+
+		// only render transparent buffer if this is the transparent render pass
+		// and solid only in solid pass
+		if (transparent == isTransparentPass)
+		{
+			driver->setMaterial(material);
+			driver->drawMeshBufferInstanced(mb, WorldTransforms.const_pointer(), WorldTransforms.size());
+		}
+	}
+
+	// for debug purposes only:
+	if (DebugDataVisible && PassCount==1)
+	{
+		video::SMaterial m;
+		m.Lighting = false;
+		m.AntiAliasing=0;
+		driver->setMaterial(m);
+
+		if (DebugDataVisible & scene::EDS_BBOX)
+		{
+			driver->draw3DBox(Box, video::SColor(255,255,255,255));
+		}
+		if (DebugDataVisible & scene::EDS_BBOX_BUFFERS)
+		{
+			const core::aabbox3d<f32>& meshBox = Mesh->getBoundingBox();
+			for (u32 i=0; i<WorldTransforms.size(); ++i)
+			{
+				driver->setTransform(video::ETS_WORLD, WorldTransforms[i]);
+				driver->draw3DBox(meshBox, video::SColor(255,190,128,128));
+			}
+			driver->setTransform(video::ETS_WORLD, AbsoluteTransformation);
+		}
+	}
+}
+
+
+//! returns the axis aligned bounding box of all instances
+const core::aabbox3d<f32>& CInstancedMeshSceneNode::getBoundingBox() const
+{
+	return Box;
+}
+
+
+void CInstancedMeshSceneNode::updateBoundingBox()
+{
+	if (!BoxDirty)
+		return;
+
+	BoxDirty = false;
+
+	if (!Mesh || Instances.empty())
+	{
+		Box.reset(0,0,0);
+		return;
+	}
+
+	const core::aabbox3d<f32>& meshBox = Mesh->getBoundingBox();
+	core::aabbox3d<f32> b(meshBox);
+	Instances[0].transformBoxEx(b);
+	Box = b;
+
+	for (u32 i=1; i<Instances.size(); ++i)
+	{
+		b = meshBox;
+		Instances[i].transformBoxEx(b);
+		Box.addInternalBox(b);
+	}
+}
+
+
+//! returns the material based on the zero based index i.
+video::SMaterial& CInstancedMeshSceneNode::getMaterial(u32 i)
+{
+	if (Mesh && ReadOnlyMaterials && i<Mesh->getMeshBufferCount())
+	{
+		ReadOnlyMaterial = Mesh->getMeshBuffer(i)->getMaterial();
+		return ReadOnlyMaterial;
+	}
+
+	if (i >= Materials.size())
+		return ISceneNode::getMaterial(i);
+
+	return Materials[i];
+}
+
+
+//! returns amount of materials used by this scene node.
+u32 CInstancedMeshSceneNode::getMaterialCount() const
+{
+	if (Mesh && ReadOnlyMaterials)
+		return Mesh->getMeshBufferCount();
+
+	return Materials.size();
+}
+
+
+//! Sets a new mesh
+void CInstancedMeshSceneNode::setMesh(IMesh* mesh)
+{
+	if (mesh)
+	{
+		mesh->grab();
+		if (Mesh)
+			Mesh->drop();
+
+		Mesh = mesh;
+		copyMaterials();
+		BoxDirty = true;
+	}
+}
+
+
+//! Sets if the scene node should not copy the materials of the mesh but use them in a read only style.
+void CInstancedMeshSceneNode::setReadOnlyMaterials(bool readonly)
+{
+	ReadOnlyMaterials = readonly;
+}
+
+
+//! Returns if the scene node should not copy the materials of the mesh but use them in a read only style
+bool CInstancedMeshSceneNode::isReadOnlyMaterials() const
+{
+	return ReadOnlyMaterials;
+}
+
+
+u32 CInstancedMeshSceneNode::addInstance(const core::matrix4& transform)
+{
+	Instances.push_back(transform);
+	BoxDirty = true;
+	return Instances.size()-1;
+}
+
+
+void CInstancedMeshSceneNode::removeInstance(u32 index)
+{
+	if (index >= Instances.size())
+		return;
+
+	Instances[index] = Instances.getLast();
+	Instances.erase(Instances.size()-1);
+	BoxDirty = true;
+}
+
+
+void CInstancedMeshSceneNode::clearInstances()
+{
+	Instances.clear();
+	WorldTransforms.clear();
+	BoxDirty = true;
+}
+
+
+u32 CInstancedMeshSceneNode::getInstanceCount() const
+{
+	return Instances.size();
+}
+
+
+void CInstancedMeshSceneNode::setInstanceTransform(u32 index, const core::matrix4& transform)
+{
+	if (index >= Instances.size())
+		return;
+
+	Instances[index] = transform;
+	BoxDirty = true;
+}
+
+
+const core::matrix4& CInstancedMeshSceneNode::getInstanceTransform(u32 index) const
+{
+	if (index >= Instances.size())
+		return core::IdentityMatrix;
+
+	return Instances[index];
+}
+
+
+void CInstancedMeshSceneNode::copyMaterials()
+{
+	Materials.clear();
+
+	if (Mesh)
+	{
+		video::SMaterial mat;
+
+		for (u32 i=0; i<Mesh->getMeshBufferCount(); ++i)
+		{
+			IMeshBuffer* mb = Mesh->getMeshBuffer(i);
+			if (mb)
+				mat = mb->getMaterial();
+
+			Materials.push_back(mat);
+		}
+	}
+}
+
+
+} // end namespace scene
+} // end namespace irr
+
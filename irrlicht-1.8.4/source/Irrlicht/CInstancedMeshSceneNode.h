@@ -0,0 +1,92 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_INSTANCED_MESH_SCENE_NODE_H_INCLUDED__
+#define __C_INSTANCED_MESH_SCENE_NODE_H_INCLUDED__
+
+#include "IInstancedMeshSceneNode.h"
+#include "IMesh.h"
+
+namespace irr
+{
+namespace scene
+{
+
+	class CInstancedMeshSceneNode : public IInstancedMeshSceneNode
+	{
+	public:
+
+		//! constructor
+		CInstancedMeshSceneNode(IMesh* mesh, ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f));
+
+		//! destructor
+		virtual ~CInstancedMeshSceneNode();
+
+		//! frame
+		virtual void OnRegisterSceneNode();
+
+		//! renders the node.
+		virtual void render();
+
+		//! returns the axis aligned bounding box of all instances
+		virtual const core::aabbox3d<f32>& getBoundingBox() const;
+
+		//! returns the material based on the zero based index i.
+		virtual video::SMaterial& getMaterial(u32 i);
+
+		//! returns amount of materials used by this scene node.
+		virtual u32 getMaterialCount() const;
+
+		//! Sets a new mesh
+		virtual void setMesh(IMesh* mesh);
+
+		//! Returns the current mesh
+		virtual IMesh* getMesh(void) { return Mesh; }
+
+		//! Sets if the scene node should not copy the materials of the mesh but use them in a read only style.
+		virtual void setReadOnlyMaterials(bool readonly);
+
+		//! Returns if the scene node should not copy the materials of the mesh but use them in a read only style
+		virtual bool isReadOnlyMaterials() const;
+
+		virtual u32 addInstance(const core::matrix4& transform);
+		virtual void removeInstance(u32 index);
+		virtual void clearInstances();
+		virtual u32 getInstanceCount() const;
+		virtual void setInstanceTransform(u32 index, const core::matrix4& transform);
+		virtual const core::matrix4& getInstanceTransform(u32 index) const;
+
+	protected:
+
+		void copyMaterials();
+
+		//! recalculates the box around all instances, if needed
+		void updateBoundingBox();
+
+		core::array<video::SMaterial> Materials;
+		video::SMaterial ReadOnlyMaterial;
+
+		//! instance transformations relative to the node
+		core::array<core::matrix4> Instances;
+
+		//! absolute instance transformations, rebuilt each frame
+		core::array<core::matrix4> WorldTransforms;
+
+		core::aabbox3d<f32> Box;
+
+		IMesh* Mesh;
+
+		s32 PassCount;
+		bool ReadOnlyMaterials;
+		bool BoxDirty;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
@@ -5,9 +5,11 @@
 #include "CMeshManipulator.h"
 #include "SMesh.h"
 #include "CMeshBuffer.h"
+#include "CDynamicMeshBuffer.h"
 #include "SAnimatedMesh.h"
 #include "os.h"
 #include "irrMap.h"
+#include "CVertexWelder.h"
 
 namespace irr
 {
@@ -760,24 +762,149 @@ IMesh* CMeshManipulator::createMeshUniquePrimitives(IMesh* mesh) const
 }
 
 
+namespace
+{
+//! Returns true if createMeshWelded() merges the two vertices
+inline bool isWeldable(const video::S3DVertex& a, const video::S3DVertex& b, f32 tolerance)
+{
+	return a.Pos.equals(b.Pos, tolerance) &&
+		a.Normal.equals(b.Normal, tolerance) &&
+		a.TCoords.equals(b.TCoords) &&
+		(a.Color == b.Color);
+}
+
+inline bool isWeldable(const video::S3DVertex2TCoords& a, const video::S3DVertex2TCoords& b, f32 tolerance)
+{
+	return isWeldable((const video::S3DVertex&)a, (const video::S3DVertex&)b, tolerance) &&
+		a.TCoords2.equals(b.TCoords2);
+}
+
+inline bool isWeldable(const video::S3DVertexTangents& a, const video::S3DVertexTangents& b, f32 tolerance)
+{
+	return isWeldable((const video::S3DVertex&)a, (const video::S3DVertex&)b, tolerance) &&
+		a.Tangent.equals(b.Tangent, tolerance) &&
+		a.Binormal.equals(b.Binormal, tolerance);
+}
+
+//! Vertices of a buffer as seen by weldVertices()
+template <class T>
+struct SWeldBufferVertices
+{
+	SWeldBufferVertices(const T* vertices, f32 tolerance)
+		: Vertices(vertices), Tolerance(tolerance) {}
+
+	const core::vector3df& getPosition(u32 i) const
+	{
+		return Vertices[i].Pos;
+	}
+
+	bool isWeldable(u32 i, u32 j) const
+	{
+		return scene::isWeldable(Vertices[i], Vertices[j], Tolerance);
+	}
+
+	const T* Vertices;
+	f32 Tolerance;
+};
+
+//! Welds the vertices of a buffer into another one with the same index type
+template <class T>
+void weldBuffer(const IMeshBuffer* mb, f32 tolerance, core::array<u32>& redirects,
+		core::array<T>& welded, core::array<u16>* outIdx, IIndexBuffer* outIdx32)
+{
+	const T* const v = (const T*)mb->getVertices();
+	const u32 vertexCount = mb->getVertexCount();
+	weldVertices(SWeldBufferVertices<T>(v, tolerance), vertexCount, tolerance, redirects);
+
+	// keep the first vertex of each group, the others point to it
+	welded.reallocate(vertexCount);
+	for (u32 i=0; i<vertexCount; ++i)
+	{
+		if (redirects[i] == i)
+		{
+			redirects[i] = welded.size();
+			welded.push_back(v[i]);
+		}
+		else
+			redirects[i] = redirects[redirects[i]];
+	}
+
+	const u32 indexCount = mb->getIndexCount();
+	if (outIdx32)
+	{
+		const u32* const indices = (const u32*)mb->getIndices();
+		outIdx32->reallocate(indexCount);
+		for (u32 i=0; i<indexCount; ++i)
+			outIdx32->push_back(redirects[indices[i]]);
+	}
+	else
+	{
+		const u16* const indices = mb->getIndices();
+		outIdx->set_used(indexCount);
+		for (u32 i=0; i<indexCount; ++i)
+			(*outIdx)[i] = (u16)redirects[indices[i]];
+	}
+}
+} // end anonymous namespace
+
+
 //! Creates a copy of a mesh, which will have identical vertices welded together
-// not yet 32bit
 IMesh* CMeshManipulator::createMeshWelded(IMesh *mesh, f32 tolerance) const
 {
 	SMesh* clone = new SMesh();
 	clone->BoundingBox = mesh->getBoundingBox();
 
-	core::array<u16> redirects;
+	core::array<u32> redirects;
 
 	for (u32 b=0; b<mesh->getMeshBufferCount(); ++b)
 	{
 		const IMeshBuffer* const mb = mesh->getMeshBuffer(b);
-		// reset redirect list
-		redirects.set_used(mb->getVertexCount());
 
-		const u16* indices = 0;
-		u32 indexCount = 0;
-		core::array<u16>* outIdx = 0;
+		// buffers with 32 bit indices may have more vertices than
+		// the fixed buffers take, so they stay dynamic ones
+		if (mb->getIndexType() == video::EIT_32BIT)
+		{
+			CDynamicMeshBuffer* buffer = new CDynamicMeshBuffer(mb->getVertexType(), video::EIT_32BIT);
+			buffer->BoundingBox = mb->getBoundingBox();
+			buffer->Material = mb->getMaterial();
+
+			IVertexBuffer& vertices = buffer->getVertexBuffer();
+			IIndexBuffer* indices = &buffer->getIndexBuffer();
+			switch(mb->getVertexType())
+			{
+			case video::EVT_STANDARD:
+			{
+				core::array<video::S3DVertex> welded;
+				weldBuffer(mb, tolerance, redirects, welded, 0, indices);
+				vertices.reallocate(welded.size());
+				for (u32 i=0; i<welded.size(); ++i)
+					vertices.push_back(welded[i]);
+				break;
+			}
+			case video::EVT_2TCOORDS:
+			{
+				core::array<video::S3DVertex2TCoords> welded;
+				weldBuffer(mb, tolerance, redirects, welded, 0, indices);
+				vertices.reallocate(welded.size());
+				for (u32 i=0; i<welded.size(); ++i)
+					vertices.push_back(welded[i]);
+				break;
+			}
+			case video::EVT_TANGENTS:
+			{
+				core::array<video::S3DVertexTangents> welded;
+				weldBuffer(mb, tolerance, redirects, welded, 0, indices);
+				vertices.reallocate(welded.size());
+				for (u32 i=0; i<welded.size(); ++i)
+					vertices.push_back(welded[i]);
+				break;
+			}
+			}
+
+			clone->addMeshBuffer(buffer);
+			buffer->drop();
+			continue;
+		}
 
 		switch(mb->getVertexType())
 		{
@@ -789,39 +916,7 @@ IMesh* CMeshManipulator::createMeshWelded(IMesh *mesh, f32 tolerance) const
 			clone->addMeshBuffer(buffer);
 			buffer->drop();
 
-			video::S3DVertex* v =
-					(video::S3DVertex*)mb->getVertices();
-
-			u32 vertexCount = mb->getVertexCount();
-
-			indices = mb->getIndices();
-			indexCount = mb->getIndexCount();
-			outIdx = &buffer->Indices;
-
-			buffer->Vertices.reallocate(vertexCount);
-
-			for (u32 i=0; i < vertexCount; ++i)
-			{
-				bool found = false;
-				for (u32 j=0; j < i; ++j)
-				{
-					if ( v[i].Pos.equals( v[j].Pos, tolerance) &&
-						 v[i].Normal.equals( v[j].Normal, tolerance) &&
-						 v[i].TCoords.equals( v[j].TCoords ) &&
-						(v[i].Color == v[j].Color) )
-					{
-						redirects[i] = redirects[j];
-						found = true;
-						break;
-					}
-				}
-				if (!found)
-				{
-					redirects[i] = buffer->Vertices.size();
-					buffer->Vertices.push_back(v[i]);
-				}
-			}
-			
+			weldBuffer(mb, tolerance, redirects, buffer->Vertices, &buffer->Indices, 0);
 			break;
 		}
 		case video::EVT_2TCOORDS:
@@ -832,39 +927,7 @@ IMesh* CMeshManipulator::createMeshWelded(IMesh *mesh, f32 tolerance) const
 			clone->addMeshBuffer(buffer);
 			buffer->drop();
 
-			video::S3DVertex2TCoords* v =
-					(video::S3DVertex2TCoords*)mb->getVertices();
-
-			u32 vertexCount = mb->getVertexCount();
-
-			indices = mb->getIndices();
-			indexCount = mb->getIndexCount();
-			outIdx = &buffer->Indices;
-
-			buffer->Vertices.reallocate(vertexCount);
-
-			for (u32 i=0; i < vertexCount; ++i)
-			{
-				bool found = false;
-				for (u32 j=0; j < i; ++j)
-				{
-					if ( v[i].Pos.equals( v[j].Pos, tolerance) &&
-						 v[i].Normal.equals( v[j].Normal, tolerance) &&
-						 v[i].TCoords.equals( v[j].TCoords ) &&
-						 v[i].TCoords2.equals( v[j].TCoords2 ) &&
-						(v[i].Color == v[j].Color) )
-					{
-						redirects[i] = redirects[j];
-						found = true;
-						break;
-					}
-				}
-				if (!found)
-				{
-					redirects[i] = buffer->Vertices.size();
-					buffer->Vertices.push_back(v[i]);
-				}
-			}
+			weldBuffer(mb, tolerance, redirects, buffer->Vertices, &buffer->Indices, 0);
 			break;
 		}
 		case video::EVT_TANGENTS:
@@ -875,55 +938,13 @@ IMesh* CMeshManipulator::createMeshWelded(IMesh *mesh, f32 tolerance) const
 			clone->addMeshBuffer(buffer);
 			buffer->drop();
 
-			video::S3DVertexTangents* v =
-					(video::S3DVertexTangents*)mb->getVertices();
-
-			u32 vertexCount = mb->getVertexCount();
-
-			indices = mb->getIndices();
-			indexCount = mb->getIndexCount();
-			outIdx = &buffer->Indices;
-
-			buffer->Vertices.reallocate(vertexCount);
-
-			for (u32 i=0; i < vertexCount; ++i)
-			{
-				bool found = false;
-				for (u32 j=0; j < i; ++j)
-				{
-					if ( v[i].Pos.equals( v[j].Pos, tolerance) &&
-						 v[i].Normal.equals( v[j].Normal, tolerance) &&
-						 v[i].TCoords.equals( v[j].TCoords ) &&
-						 v[i].Tangent.equals( v[j].Tangent, tolerance ) &&
-						 v[i].Binormal.equals( v[j].Binormal, tolerance ) &&
-						(v[i].Color == v[j].Color) )
-					{
-						redirects[i] = redirects[j];
-						found = true;
-						break;
-					}
-				}
-				if (!found)
-				{
-					redirects[i] = buffer->Vertices.size();
-					buffer->Vertices.push_back(v[i]);
-				}
-			}
+			weldBuffer(mb, tolerance, redirects, buffer->Vertices, &buffer->Indices, 0);
 			break;
 		}
 		default:
 			os::Printer::log("Cannot create welded mesh, vertex type unsupported", ELL_ERROR);
 			break;
 		}
-
-		// write the buffer's index list
-		core::array<u16> &Indices = *outIdx;
-
-		Indices.set_used(indexCount);
-		for (u32 i=0; i<indexCount; ++i)
-		{
-			Indices[i] = redirects[ indices[i] ];
-		}
 	}
 	return clone;
 }
@@ -3,14 +3,27 @@
 // For conditions of distribution and use, see copyright notice in irrlicht.h
 
 #include "CMetaTriangleSelector.h"
+#include "ISceneNode.h"
 
 namespace irr
 {
 namespace scene
 {
 
+namespace
+{
+	//! grows a box a little, so lines along its sides are not lost to rounding
+	void padBox(core::aabbox3d<f32>& box)
+	{
+		const f32 pad = core::max_(box.MinEdge.getLength(), box.MaxEdge.getLength()) * 1e-5f + 1e-5f;
+		box.MinEdge -= core::vector3df(pad);
+		box.MaxEdge += core::vector3df(pad);
+	}
+}
+
 //! constructor
 CMetaTriangleSelector::CMetaTriangleSelector()
+	: Root(-1), FreeNodes(-1), VisitedSelectors(0)
 {
 	#ifdef _DEBUG
 	setDebugName("CMetaTriangleSelector");
@@ -41,16 +54,21 @@ void CMetaTriangleSelector::getTriangles(core::triangle3df* triangles, s32 array
 		s32& outTriangleCount, const core::matrix4* transform) const
 {
 	s32 outWritten = 0;
-	for (u32 i=0; i<TriangleSelectors.size(); ++i)
+	u32 i;
+	for (i=0; i<TriangleSelectors.size(); ++i)
 	{
 		s32 t = 0;
 		TriangleSelectors[i]->getTriangles(triangles + outWritten,
 				arraySize - outWritten, t, transform);
 		outWritten += t;
 		if (outWritten==arraySize)
+		{
+			++i;
 			break;
+		}
 	}
 
+	VisitedSelectors = i;
 	outTriangleCount = outWritten;
 }
 
@@ -60,17 +78,27 @@ void CMetaTriangleSelector::getTriangles(core::triangle3df* triangles, s32 array
 		s32& outTriangleCount, const core::aabbox3d<f32>& box,
 		const core::matrix4* transform) const
 {
+	updateMovedSelectors();
+
+	core::array<u32> selectors;
+	getSelectors(box, selectors);
+
 	s32 outWritten = 0;
-	for (u32 i=0; i<TriangleSelectors.size(); ++i)
+	u32 i;
+	for (i=0; i<selectors.size(); ++i)
 	{
 		s32 t = 0;
-		TriangleSelectors[i]->getTriangles(triangles + outWritten,
+		TriangleSelectors[selectors[i]]->getTriangles(triangles + outWritten,
 				arraySize - outWritten, t, box, transform);
 		outWritten += t;
 		if (outWritten==arraySize)
+		{
+			++i;
 			break;
+		}
 	}
 
+	VisitedSelectors = i;
 	outTriangleCount = outWritten;
 }
 
@@ -80,21 +108,195 @@ void CMetaTriangleSelector::getTriangles(core::triangle3df* triangles, s32 array
 		s32& outTriangleCount, const core::line3d<f32>& line,
 		const core::matrix4* transform) const
 {
+	updateMovedSelectors();
+
+	core::array<u32> selectors;
+	getSelectors(line, selectors);
+
 	s32 outWritten = 0;
-	for (u32 i=0; i<TriangleSelectors.size(); ++i)
+	u32 i;
+	for (i=0; i<selectors.size(); ++i)
 	{
 		s32 t = 0;
-		TriangleSelectors[i]->getTriangles(triangles + outWritten,
+		TriangleSelectors[selectors[i]]->getTriangles(triangles + outWritten,
 				arraySize - outWritten, t, line, transform);
 		outWritten += t;
 		if (outWritten==arraySize)
+		{
+			++i;
 			break;
+		}
 	}
 
+	VisitedSelectors = i;
 	outTriangleCount = outWritten;
 }
 
 
+//! Brings all selectors in the collection up to date
+void CMetaTriangleSelector::updateForQueries() const
+{
+	for (u32 i=0; i<TriangleSelectors.size(); ++i)
+		TriangleSelectors[i]->updateForQueries();
+
+	updateMovedSelectors();
+}
+
+
+//! Finds the triangle hit by a line segment
+bool CMetaTriangleSelector::getCollisionPoint(const core::line3d<f32>& line,
+		SCollisionHit& hit, bool anyHit) const
+{
+	updateMovedSelectors();
+
+	u32 visited = 0;
+	const bool found = traceLine(line, hit, anyHit, false, visited);
+	VisitedSelectors = visited;
+	return found;
+}
+
+
+//! Finds the triangles hit by several line segments, without counting the visited selectors
+u32 CMetaTriangleSelector::getCollisionPoints(const core::line3d<f32>* lines, u32 count,
+		SCollisionHit* hits, bool* found, bool anyHit) const
+{
+	// batches may run on several threads, which must not write the counter.
+	// Moved selectors were already taken again by updateForQueries() then.
+	updateMovedSelectors();
+
+	u32 hitCount = 0;
+	for (u32 i=0; i<count; ++i)
+	{
+		u32 visited = 0;
+		found[i] = traceLine(lines[i], hits[i], anyHit, true, visited);
+		if (found[i])
+			++hitCount;
+	}
+	return hitCount;
+}
+
+
+//! Finds the triangle hit by a line segment, counting the selectors looked into
+bool CMetaTriangleSelector::traceLine(const core::line3d<f32>& line,
+		SCollisionHit& hit, bool anyHit, bool batch, u32& visited) const
+{
+	core::array<u32> selectors;
+	getSelectors(line, selectors);
+
+	// each hit shortens the line for the following selectors
+	core::line3d<f32> rest(line);
+	SCollisionHit candidate;
+	s32 found = -1;
+
+	for (u32 i=0; i<selectors.size(); ++i)
+	{
+		const u32 index = selectors[i];
+		if (found >= 0 && Leaves[index] >= 0 && !Nodes[Leaves[index]].Box.intersectsWithLine(rest))
+			continue;
+
+		++visited;
+		bool candidateFound = false;
+		if (batch)
+			TriangleSelectors[index]->getCollisionPoints(&rest, 1, &candidate, &candidateFound, anyHit);
+		else
+			candidateFound = TriangleSelectors[index]->getCollisionPoint(rest, candidate, anyHit);
+		if (candidateFound)
+		{
+			hit = candidate;
+			rest.end = candidate.Intersection;
+			found = (s32)index;
+			if (anyHit)
+				break;
+		}
+	}
+
+	if (found < 0)
+		return false;
+
+	for (s32 i=0; i<found; ++i)
+		hit.TriangleIndex += TriangleSelectors[i]->getTriangleCount();
+	return true;
+}
+
+
+//! Get the box around all triangles in world space
+bool CMetaTriangleSelector::getTransformedBoundingBox(core::aabbox3d<f32>& box) const
+{
+	updateMovedSelectors();
+
+	if (Root < 0 || !Unbounded.empty())
+		return false;
+
+	box = Nodes[Root].Box;
+	return true;
+}
+
+
+//! Gets the sorted indices of the selectors whose boxes touch the box
+void CMetaTriangleSelector::getSelectors(const core::aabbox3d<f32>& box,
+		core::array<u32>& out) const
+{
+	out = Unbounded;
+	if (Root >= 0)
+	{
+		core::array<s32> stack;
+		stack.push_back(Root);
+		while (!stack.empty())
+		{
+			const SSelectorNode& node = Nodes[stack.getLast()];
+			stack.erase(stack.size()-1);
+			if (!node.Box.intersectsWithBox(box))
+				continue;
+
+			if (node.Child[0] < 0)
+				out.push_back(node.Selector);
+			else
+			{
+				stack.push_back(node.Child[0]);
+				stack.push_back(node.Child[1]);
+			}
+		}
+	}
+
+	// same order as the selectors were added
+	out.sort();
+}
+
+
+//! Gets the sorted indices of the selectors whose boxes the line passes
+void CMetaTriangleSelector::getSelectors(const core::line3d<f32>& line,
+		core::array<u32>& out) const
+{
+	out = Unbounded;
+	if (Root >= 0)
+	{
+		core::aabbox3d<f32> box(line.start);
+		box.addInternalPoint(line.end);
+
+		core::array<s32> stack;
+		stack.push_back(Root);
+		while (!stack.empty())
+		{
+			const SSelectorNode& node = Nodes[stack.getLast()];
+			stack.erase(stack.size()-1);
+			if (!node.Box.intersectsWithBox(box) || !node.Box.intersectsWithLine(line))
+				continue;
+
+			if (node.Child[0] < 0)
+				out.push_back(node.Selector);
+			else
+			{
+				stack.push_back(node.Child[0]);
+				stack.push_back(node.Child[1]);
+			}
+		}
+	}
+
+	// same order as the selectors were added
+	out.sort();
+}
+
+
 //! Adds a triangle selector to the collection of triangle selectors
 //! in this metaTriangleSelector.
 void CMetaTriangleSelector::addTriangleSelector(ITriangleSelector* toAdd)
@@ -104,6 +306,7 @@ void CMetaTriangleSelector::addTriangleSelector(ITriangleSelector* toAdd)
 
 	TriangleSelectors.push_back(toAdd);
 	toAdd->grab();
+	insertSelector(TriangleSelectors.size()-1);
 }
 
 
@@ -114,8 +317,41 @@ bool CMetaTriangleSelector::removeTriangleSelector(ITriangleSelector* toRemove)
 	{
 		if (toRemove == TriangleSelectors[i])
 		{
+			removeSelector(i);
 			TriangleSelectors[i]->drop();
 			TriangleSelectors.erase(i);
+			Leaves.erase(i);
+			Sources.erase(i);
+
+			// the selectors behind move down by one
+			u32 j;
+			for (j=0; j<Leaves.size(); ++j)
+			{
+				if (j >= i && Leaves[j] >= 0)
+					--Nodes[Leaves[j]].Selector;
+			}
+			for (j=0; j<Unbounded.size(); ++j)
+			{
+				if (Unbounded[j] > i)
+					--Unbounded[j];
+			}
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+//! Updates the bounding box of a selector in the collection.
+bool CMetaTriangleSelector::updateTriangleSelector(ITriangleSelector* toUpdate)
+{
+	for (u32 i=0; i<TriangleSelectors.size(); ++i)
+	{
+		if (toUpdate == TriangleSelectors[i])
+		{
+			removeSelector(i);
+			insertSelector(i);
 			return true;
 		}
 	}
@@ -124,6 +360,236 @@ bool CMetaTriangleSelector::removeTriangleSelector(ITriangleSelector* toRemove)
 }
 
 
+//! Updates the bounding boxes of all selectors in the collection.
+void CMetaTriangleSelector::updateAllTriangleSelectors()
+{
+	Nodes.clear();
+	Root = -1;
+	FreeNodes = -1;
+	Unbounded.clear();
+
+	for (u32 i=0; i<TriangleSelectors.size(); ++i)
+		insertSelector(i);
+}
+
+
+//! Puts a selector into the tree, or into the unbounded ones
+void CMetaTriangleSelector::insertSelector(u32 index)
+{
+	if (Leaves.size() <= index)
+		Leaves.set_used(index + 1);
+	while (Sources.size() <= index)
+		Sources.push_back(SLeafSource());
+
+	const ITriangleSelector* selector = TriangleSelectors[index];
+	core::aabbox3d<f32> box;
+	if (selector->getTransformedBoundingBox(box))
+	{
+		// selectors of their own follow their node, meta selectors
+		// are compared by their box
+		SLeafSource& source = Sources[index];
+		source.Node = selector->getSelector(0) == selector ?
+			selector->getSceneNodeForTriangle(0) : 0;
+		if (source.Node)
+			source.Transform = source.Node->getAbsoluteTransformation();
+		source.Box = box;
+
+		padBox(box);
+		Leaves[index] = insertLeaf(box, index);
+	}
+	else
+	{
+		Leaves[index] = -1;
+		Unbounded.push_back(index);
+		Unbounded.sort();
+	}
+}
+
+
+//! Takes the boxes of the selectors again which moved since they were inserted
+void CMetaTriangleSelector::updateMovedSelectors() const
+{
+	// nodes are often moved, or get their first absolute
+	// transformation, after their selector was added
+	CMetaTriangleSelector* self = 0;
+	for (u32 i=0; i<Leaves.size(); ++i)
+	{
+		if (Leaves[i] < 0)
+			continue;
+
+		const SLeafSource& source = Sources[i];
+		bool moved;
+		if (source.Node)
+			moved = source.Node->getAbsoluteTransformation() != source.Transform;
+		else
+		{
+			core::aabbox3d<f32> box;
+			moved = !TriangleSelectors[i]->getTransformedBoundingBox(box) ||
+				box.MinEdge != source.Box.MinEdge || box.MaxEdge != source.Box.MaxEdge;
+		}
+
+		if (moved)
+		{
+			if (!self)
+				self = const_cast<CMetaTriangleSelector*>(this);
+			self->removeSelector(i);
+			self->insertSelector(i);
+		}
+	}
+}
+
+
+//! Takes a selector out of the tree or the unbounded ones
+void CMetaTriangleSelector::removeSelector(u32 index)
+{
+	if (Leaves[index] >= 0)
+	{
+		removeLeaf(Leaves[index]);
+		Leaves[index] = -1;
+	}
+	else
+	{
+		const s32 i = Unbounded.binary_search(index);
+		if (i >= 0)
+			Unbounded.erase(i);
+	}
+}
+
+
+//! Adds a leaf to the tree, next to the node where it grows the tree least
+s32 CMetaTriangleSelector::insertLeaf(const core::aabbox3d<f32>& box, u32 selector)
+{
+	const s32 leaf = allocateNode();
+	Nodes[leaf].Box = box;
+	Nodes[leaf].Child[0] = Nodes[leaf].Child[1] = -1;
+	Nodes[leaf].Selector = selector;
+
+	if (Root < 0)
+	{
+		Nodes[leaf].Parent = -1;
+		Root = leaf;
+		return leaf;
+	}
+
+	// walk down while a child is a cheaper sibling than the node itself,
+	// the cost being the surface area the tree grows by
+	s32 sibling = Root;
+	while (Nodes[sibling].Child[0] >= 0)
+	{
+		const SSelectorNode& node = Nodes[sibling];
+		core::aabbox3d<f32> combined(node.Box);
+		combined.addInternalBox(box);
+		const f32 area = combined.getArea();
+
+		// a new parent here, or the growth of this node for going down
+		const f32 cost = 2.f * area;
+		const f32 inherited = 2.f * (area - node.Box.getArea());
+
+		f32 childCost[2];
+		for (u32 i=0; i<2; ++i)
+		{
+			const SSelectorNode& child = Nodes[node.Child[i]];
+			core::aabbox3d<f32> grown(child.Box);
+			grown.addInternalBox(box);
+			childCost[i] = grown.getArea() + inherited;
+			if (child.Child[0] >= 0)
+				childCost[i] -= child.Box.getArea();
+		}
+
+		if (cost < childCost[0] && cost < childCost[1])
+			break;
+
+		sibling = node.Child[childCost[1] < childCost[0] ? 1 : 0];
+	}
+
+	const s32 oldParent = Nodes[sibling].Parent;
+	const s32 parent = allocateNode();
+	Nodes[parent].Box = Nodes[sibling].Box;
+	Nodes[parent].Box.addInternalBox(box);
+	Nodes[parent].Parent = oldParent;
+	Nodes[parent].Child[0] = sibling;
+	Nodes[parent].Child[1] = leaf;
+	Nodes[parent].Selector = 0;
+	Nodes[sibling].Parent = parent;
+	Nodes[leaf].Parent = parent;
+
+	if (oldParent < 0)
+		Root = parent;
+	else
+	{
+		SSelectorNode& node = Nodes[oldParent];
+		node.Child[node.Child[0] == sibling ? 0 : 1] = parent;
+		refitNodes(oldParent);
+	}
+
+	return leaf;
+}
+
+
+//! Removes a leaf from the tree
+void CMetaTriangleSelector::removeLeaf(s32 leaf)
+{
+	if (leaf == Root)
+	{
+		Root = -1;
+		freeNode(leaf);
+		return;
+	}
+
+	// the sibling takes the place of the parent
+	const s32 parent = Nodes[leaf].Parent;
+	const s32 grandParent = Nodes[parent].Parent;
+	const s32 sibling = Nodes[parent].Child[Nodes[parent].Child[0] == leaf ? 1 : 0];
+
+	Nodes[sibling].Parent = grandParent;
+	if (grandParent < 0)
+		Root = sibling;
+	else
+	{
+		SSelectorNode& node = Nodes[grandParent];
+		node.Child[node.Child[0] == parent ? 0 : 1] = sibling;
+		refitNodes(grandParent);
+	}
+
+	freeNode(parent);
+	freeNode(leaf);
+}
+
+
+//! Recomputes the boxes from a node up to the root
+void CMetaTriangleSelector::refitNodes(s32 node)
+{
+	while (node >= 0)
+	{
+		SSelectorNode& n = Nodes[node];
+		n.Box = Nodes[n.Child[0]].Box;
+		n.Box.addInternalBox(Nodes[n.Child[1]].Box);
+		node = n.Parent;
+	}
+}
+
+
+s32 CMetaTriangleSelector::allocateNode()
+{
+	if (FreeNodes < 0)
+	{
+		Nodes.push_back(SSelectorNode());
+		return (s32)Nodes.size() - 1;
+	}
+
+	const s32 node = FreeNodes;
+	FreeNodes = Nodes[node].Parent;
+	return node;
+}
+
+
+void CMetaTriangleSelector::freeNode(s32 node)
+{
+	Nodes[node].Parent = FreeNodes;
+	FreeNodes = node;
+}
+
+
 //! Removes all triangle selectors from the collection.
 void CMetaTriangleSelector::removeAllTriangleSelectors()
 {
@@ -131,6 +597,12 @@ void CMetaTriangleSelector::removeAllTriangleSelectors()
 		TriangleSelectors[i]->drop();
 
 	TriangleSelectors.clear();
+	Leaves.clear();
+	Sources.clear();
+	Unbounded.clear();
+	Nodes.clear();
+	Root = -1;
+	FreeNodes = -1;
 }
 
 
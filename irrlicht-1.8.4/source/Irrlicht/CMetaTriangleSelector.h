@@ -63,9 +63,110 @@ public:
 	// Get the TriangleSelector based on index based on getSelectorCount
 	virtual const ITriangleSelector* getSelector(u32 index) const;
 
+	//! Brings all selectors in the collection up to date
+	virtual void updateForQueries() const;
+
+	//! Finds the triangle hit by a line segment
+	virtual bool getCollisionPoint(const core::line3d<f32>& line,
+		SCollisionHit& hit, bool anyHit=false) const;
+
+	//! Finds the triangles hit by several line segments, without counting the visited selectors
+	virtual u32 getCollisionPoints(const core::line3d<f32>* lines, u32 count,
+		SCollisionHit* hits, bool* found, bool anyHit=false) const;
+
+	//! Get the box around all triangles in world space
+	virtual bool getTransformedBoundingBox(core::aabbox3d<f32>& box) const;
+
+	//! Updates the bounding box of a selector in the collection.
+	virtual bool updateTriangleSelector(ITriangleSelector* toUpdate);
+
+	//! Updates the bounding boxes of all selectors in the collection.
+	virtual void updateAllTriangleSelectors();
+
+	//! Get the amount of selectors the last query looked into.
+	virtual u32 getVisitedSelectorCount() const { return VisitedSelectors; }
+
 private:
 
+	//! Node of the tree over the boxes of the selectors
+	struct SSelectorNode
+	{
+		core::aabbox3d<f32> Box;
+
+		//! parent node, or the next free node of unused ones
+		s32 Parent;
+
+		//! children of inner nodes, -1 for leaves
+		s32 Child[2];
+
+		//! index of the selector of a leaf
+		u32 Selector;
+	};
+
+	//! What the box of a selector in the tree was taken from
+	struct SLeafSource
+	{
+		SLeafSource() : Node(0) {}
+
+		//! node of the selector, 0 for meta selectors and selectors without one
+		const ISceneNode* Node;
+
+		//! absolute transformation of the node when the box was taken
+		core::matrix4 Transform;
+
+		//! the box, compared for selectors without a node
+		core::aabbox3d<f32> Box;
+	};
+
+	//! Puts a selector into the tree, or into the unbounded ones
+	void insertSelector(u32 index);
+
+	//! Takes the boxes of the selectors again which moved since they were inserted
+	void updateMovedSelectors() const;
+
+	//! Takes a selector out of the tree or the unbounded ones
+	void removeSelector(u32 index);
+
+	//! Adds a leaf to the tree, next to the node where it grows the tree least
+	s32 insertLeaf(const core::aabbox3d<f32>& box, u32 selector);
+
+	//! Removes a leaf from the tree
+	void removeLeaf(s32 leaf);
+
+	//! Recomputes the boxes from a node up to the root
+	void refitNodes(s32 node);
+
+	s32 allocateNode();
+	void freeNode(s32 node);
+
+	//! Gets the sorted indices of the selectors whose boxes touch the box
+	void getSelectors(const core::aabbox3d<f32>& box, core::array<u32>& out) const;
+
+	//! Gets the sorted indices of the selectors whose boxes the line passes
+	void getSelectors(const core::line3d<f32>& line, core::array<u32>& out) const;
+
+	//! Finds the triangle hit by a line segment, counting the selectors looked into
+	/** \param batch True to query the selectors with getCollisionPoints(),
+	which doesn't write counters of nested meta selectors. */
+	bool traceLine(const core::line3d<f32>& line, SCollisionHit& hit,
+		bool anyHit, bool batch, u32& visited) const;
+
 	core::array<ITriangleSelector*> TriangleSelectors;
+
+	//! leaf of each selector, -1 for those without a box
+	core::array<s32> Leaves;
+
+	//! source of the box of each selector in the tree
+	core::array<SLeafSource> Sources;
+
+	//! selectors without a box, looked into by every query
+	core::array<u32> Unbounded;
+
+	core::array<SSelectorNode> Nodes;
+	s32 Root;
+	s32 FreeNodes;
+
+	mutable u32 VisitedSelectors;
 };
 
 } // end namespace scene
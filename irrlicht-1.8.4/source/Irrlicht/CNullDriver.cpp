@@ -83,8 +83,9 @@ IImageWriter* createImageWriterPPM();
 //! constructor
 CNullDriver::CNullDriver(io::IFileSystem* io, const core::dimension2d<u32>& screenSize)
 : FileSystem(io), MeshManipulator(0), ViewPort(0,0,0,0), ScreenSize(screenSize),
-	PrimitivesDrawn(0), MinVertexCountForVBO(500), TextureCreationFlags(0),
-	OverrideMaterial2DEnabled(false), AllowZWriteOnTransparent(false)
+	MinVertexCountForVBO(500), TextureCreationFlags(0),
+	OverrideMaterial2DEnabled(false), AllowZWriteOnTransparent(false),
+	CommandRecorder(0)
 {
 	#ifdef _DEBUG
 	setDebugName("CNullDriver");
@@ -203,6 +204,8 @@ CNullDriver::CNullDriver(io::IFileSystem* io, const core::dimension2d<u32>& scre
 //! destructor
 CNullDriver::~CNullDriver()
 {
+	delete CommandRecorder;
+
 	if (DriverAttributes)
 		DriverAttributes->drop();
 
@@ -302,7 +305,10 @@ bool CNullDriver::beginScene(bool backBuffer, bool zBuffer, SColor color,
 		const SExposedVideoData& videoData, core::rect<s32>* sourceRect)
 {
 	core::clearFPUException();
-	PrimitivesDrawn = 0;
+	Statistics.reset();
+
+	if (CommandRecorder)
+		CommandRecorder->beginScene(backBuffer, zBuffer, color);
 	return true;
 }
 
@@ -310,7 +316,10 @@ bool CNullDriver::beginScene(bool backBuffer, bool zBuffer, SColor color,
 //! applications must call this method after performing any rendering. returns false if failed.
 bool CNullDriver::endScene()
 {
-	FPSCounter.registerFrame(os::Timer::getRealTime(), PrimitivesDrawn);
+	if (CommandRecorder)
+		CommandRecorder->endScene();
+
+	FPSCounter.registerFrame(os::Timer::getRealTime(), Statistics.PrimitivesDrawn);
 	updateAllHardwareBuffers();
 	updateAllOcclusionQueries();
 	return true;
@@ -341,6 +350,9 @@ const io::IAttributes& CNullDriver::getDriverAttributes() const
 //! sets transformation
 void CNullDriver::setTransform(E_TRANSFORMATION_STATE state, const core::matrix4& mat)
 {
+	CVideoCommandScope command(CommandRecorder);
+	if (command.isRecording())
+		command->setTransform(state, mat);
 }
 
 
@@ -354,6 +366,9 @@ const core::matrix4& CNullDriver::getTransform(E_TRANSFORMATION_STATE state) con
 //! sets a material
 void CNullDriver::setMaterial(const SMaterial& material)
 {
+	CVideoCommandScope command(CommandRecorder);
+	if (command.isRecording())
+		command->setMaterial(material);
 }
 
 
@@ -646,7 +661,11 @@ void CNullDriver::drawVertexPrimitiveList(const void* vertices, u32 vertexCount,
 {
 	if ((iType==EIT_16BIT) && (vertexCount>65536))
 		os::Printer::log("Too many vertices for 16bit index type, render artifacts may occur.");
-	PrimitivesDrawn += primitiveCount;
+	Statistics.registerDrawCall(primitiveCount);
+
+	CVideoCommandScope command(CommandRecorder);
+	if (command.isRecording())
+		command->drawVertexPrimitiveList(false, vertices, vertexCount, indexList, primitiveCount, vType, pType, iType);
 }
 
 
@@ -655,7 +674,11 @@ void CNullDriver::draw2DVertexPrimitiveList(const void* vertices, u32 vertexCoun
 {
 	if ((iType==EIT_16BIT) && (vertexCount>65536))
 		os::Printer::log("Too many vertices for 16bit index type, render artifacts may occur.");
-	PrimitivesDrawn += primitiveCount;
+	Statistics.registerDrawCall(primitiveCount);
+
+	CVideoCommandScope command(CommandRecorder);
+	if (command.isRecording())
+		command->drawVertexPrimitiveList(true, vertices, vertexCount, indexList, primitiveCount, vType, pType, iType);
 }
 
 
@@ -663,6 +686,9 @@ void CNullDriver::draw2DVertexPrimitiveList(const void* vertices, u32 vertexCoun
 void CNullDriver::draw3DLine(const core::vector3df& start,
 				const core::vector3df& end, SColor color)
 {
+	CVideoCommandScope command(CommandRecorder);
+	if (command.isRecording())
+		command->draw3DLine(start, end, color);
 }
 
 
@@ -736,6 +762,10 @@ void CNullDriver::draw2DImageBatch(const video::ITexture* texture,
 				const core::rect<s32>* clipRect, SColor color,
 				bool useAlphaChannelOfTexture)
 {
+	CVideoCommandScope command(CommandRecorder);
+	if (command.isRecording())
+		command->draw2DImageBatch(texture, pos, sourceRects, indices, kerningWidth, clipRect, color, useAlphaChannelOfTexture);
+
 	core::position2d<s32> target(pos);
 
 	for (u32 i=0; i<indices.size(); ++i)
@@ -756,6 +786,10 @@ void CNullDriver::draw2DImageBatch(const video::ITexture* texture,
 				SColor color,
 				bool useAlphaChannelOfTexture)
 {
+	CVideoCommandScope command(CommandRecorder);
+	if (command.isRecording())
+		command->draw2DImageBatch(texture, positions, sourceRects, clipRect, color, useAlphaChannelOfTexture);
+
 	const irr::u32 drawCount = core::min_<u32>(positions.size(), sourceRects.size());
 
 	for (u32 i=0; i<drawCount; ++i)
@@ -771,6 +805,10 @@ void CNullDriver::draw2DImage(const video::ITexture* texture, const core::rect<s
 	const core::rect<s32>& sourceRect, const core::rect<s32>* clipRect,
 	const video::SColor* const colors, bool useAlphaChannelOfTexture)
 {
+	CVideoCommandScope command(CommandRecorder);
+	if (command.isRecording())
+		command->draw2DImage(texture, destRect, sourceRect, clipRect, colors, useAlphaChannelOfTexture);
+
 	if (destRect.isValid())
 		draw2DImage(texture, core::position2d<s32>(destRect.UpperLeftCorner),
 				sourceRect, clipRect, colors?colors[0]:video::SColor(0xffffffff),
@@ -784,6 +822,9 @@ void CNullDriver::draw2DImage(const video::ITexture* texture, const core::positi
 				const core::rect<s32>* clipRect, SColor color,
 				bool useAlphaChannelOfTexture)
 {
+	CVideoCommandScope command(CommandRecorder);
+	if (command.isRecording())
+		command->draw2DImage(texture, destPos, sourceRect, clipRect, color, useAlphaChannelOfTexture);
 }
 
 
@@ -800,6 +841,10 @@ void CNullDriver::draw2DRectangleOutline(const core::recti& pos, SColor color)
 //! Draw a 2d rectangle
 void CNullDriver::draw2DRectangle(SColor color, const core::rect<s32>& pos, const core::rect<s32>* clip)
 {
+	CVideoCommandScope command(CommandRecorder);
+	if (command.isRecording())
+		command->draw2DRectangle(color, pos, clip);
+
 	draw2DRectangle(pos, color, color, color, color, clip);
 }
 
@@ -810,6 +855,9 @@ void CNullDriver::draw2DRectangle(const core::rect<s32>& pos,
 	SColor colorLeftUp, SColor colorRightUp, SColor colorLeftDown, SColor colorRightDown,
 	const core::rect<s32>* clip)
 {
+	CVideoCommandScope command(CommandRecorder);
+	if (command.isRecording())
+		command->draw2DRectangle(pos, colorLeftUp, colorRightUp, colorLeftDown, colorRightDown, clip);
 }
 
 
@@ -818,11 +866,17 @@ void CNullDriver::draw2DRectangle(const core::rect<s32>& pos,
 void CNullDriver::draw2DLine(const core::position2d<s32>& start,
 				const core::position2d<s32>& end, SColor color)
 {
+	CVideoCommandScope command(CommandRecorder);
+	if (command.isRecording())
+		command->draw2DLine(start, end, color);
 }
 
 //! Draws a pixel
 void CNullDriver::drawPixel(u32 x, u32 y, const SColor & color)
 {
+	CVideoCommandScope command(CommandRecorder);
+	if (command.isRecording())
+		command->drawPixel(x, y, color);
 }
 
 
@@ -891,12 +945,22 @@ u32 CNullDriver::getPrimitiveCountDrawn( u32 param ) const
 }
 
 
+//! Returns the counters of the current frame.
+const SDriverStatistics& CNullDriver::getFrameStatistics() const
+{
+	return Statistics;
+}
+
+
 
 //! Sets the dynamic ambient light color. The default color is
 //! (0,0,0,0) which means it is dark.
 //! \param color: New color of the ambient light.
 void CNullDriver::setAmbientLight(const SColorf& color)
 {
+	CVideoCommandScope command(CommandRecorder);
+	if (command.isRecording())
+		command->setAmbientLight(color);
 }
 
 
@@ -932,6 +996,10 @@ void CNullDriver::drawStencilShadow(bool clearStencilBuffer,
 //! deletes all dynamic lights there are
 void CNullDriver::deleteAllDynamicLights()
 {
+	CVideoCommandScope command(CommandRecorder);
+	if (command.isRecording())
+		command->deleteAllDynamicLights();
+
 	Lights.set_used(0);
 }
 
@@ -939,6 +1007,10 @@ void CNullDriver::deleteAllDynamicLights()
 //! adds a dynamic light
 s32 CNullDriver::addDynamicLight(const SLight& light)
 {
+	CVideoCommandScope command(CommandRecorder);
+	if (command.isRecording())
+		command->addDynamicLight(light);
+
 	Lights.push_back(light);
 	return Lights.size() - 1;
 }
@@ -1520,6 +1592,32 @@ void CNullDriver::drawMeshBuffer(const scene::IMeshBuffer* mb)
 }
 
 
+//! Draws a mesh buffer once for each of the given world transformations
+void CNullDriver::drawMeshBufferInstanced(const scene::IMeshBuffer* mb,
+		const core::matrix4* transforms, u32 instanceCount)
+{
+	if (!mb || !transforms || !instanceCount)
+		return;
+
+	const core::matrix4 world = getTransform(ETS_WORLD);
+
+	// look up the hardware buffer only once for all instances
+	SHWBufferLink *HWBuffer=getBufferLink(mb);
+
+	for (u32 i=0; i<instanceCount; ++i)
+	{
+		setTransform(ETS_WORLD, transforms[i]);
+
+		if (HWBuffer)
+			drawHardwareBuffer(HWBuffer);
+		else
+			drawVertexPrimitiveList(mb->getVertices(), mb->getVertexCount(), mb->getIndices(), mb->getIndexCount()/3, mb->getVertexType(), scene::EPT_TRIANGLES, mb->getIndexType());
+	}
+
+	setTransform(ETS_WORLD, world);
+}
+
+
 //! Draws the normals of a mesh buffer
 void CNullDriver::drawMeshBufferNormals(const scene::IMeshBuffer* mb, f32 length, SColor color)
 {
@@ -2339,6 +2437,51 @@ IImage* CNullDriver::createScreenShot(video::ECOLOR_FORMAT format, video::E_REND
 }
 
 
+//! Renders the frame buffer into caller owned memory
+bool CNullDriver::setExternalFrameBuffers(void* const* color, u32 bufferCount,
+		void* depth, const core::dimension2d<u32>& size,
+		ECOLOR_FORMAT format, u32 pitch)
+{
+	return 0 == bufferCount;
+}
+
+
+//! Returns the caller owned colour buffer holding the frame finished last
+s32 CNullDriver::getExternalFrameBufferIndex() const
+{
+	return -1;
+}
+
+
+//! Starts recording the draw calls into a binary command stream
+bool CNullDriver::startCommandRecording(io::IWriteFile* file)
+{
+	stopCommandRecording();
+
+	if (!file)
+		return false;
+
+	CommandRecorder = new CVideoCommandRecorder(file);
+	return true;
+}
+
+
+//! Stops recording the draw calls and releases the file
+void CNullDriver::stopCommandRecording()
+{
+	delete CommandRecorder;
+	CommandRecorder = 0;
+}
+
+
+//! Replays a command stream recorded by startCommandRecording()
+s32 CNullDriver::replayCommands(io::IReadFile* file,
+		core::array<SVideoCommandTiming>* timings)
+{
+	return replayVideoCommands(this, file, timings);
+}
+
+
 // prints renderer version
 void CNullDriver::printVersion()
 {
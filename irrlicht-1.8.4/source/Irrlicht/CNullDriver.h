@@ -21,6 +21,7 @@
 #include "SVertexIndex.h"
 #include "SLight.h"
 #include "SExposedVideoData.h"
+#include "CVideoCommandStream.h"
 
 #ifdef _MSC_VER
 #pragma warning( disable: 4996)
@@ -250,6 +251,9 @@ namespace video
 		//! very useful method for statistics.
 		virtual u32 getPrimitiveCountDrawn( u32 param = 0 ) const;
 
+		//! Returns the counters of the current frame.
+		virtual const SDriverStatistics& getFrameStatistics() const;
+
 		//! deletes all dynamic lights there are
 		virtual void deleteAllDynamicLights();
 
@@ -372,6 +376,10 @@ namespace video
 		//! Draws a mesh buffer
 		virtual void drawMeshBuffer(const scene::IMeshBuffer* mb);
 
+		//! Draws a mesh buffer once for each of the given world transformations
+		virtual void drawMeshBufferInstanced(const scene::IMeshBuffer* mb,
+			const core::matrix4* transforms, u32 instanceCount);
+
 		//! Draws the normals of a mesh buffer
 		virtual void drawMeshBufferNormals(const scene::IMeshBuffer* mb, f32 length=10.f, SColor color=0xffffffff);
 
@@ -585,6 +593,24 @@ namespace video
 		//! Returns an image created from the last rendered frame.
 		virtual IImage* createScreenShot(video::ECOLOR_FORMAT format=video::ECF_UNKNOWN, video::E_RENDER_TARGET target=video::ERT_FRAME_BUFFER);
 
+		//! Renders the frame buffer into caller owned memory, not supported
+		virtual bool setExternalFrameBuffers(void* const* color, u32 bufferCount,
+			void* depth, const core::dimension2d<u32>& size,
+			ECOLOR_FORMAT format, u32 pitch);
+
+		//! Returns the caller owned colour buffer holding the frame finished last
+		virtual s32 getExternalFrameBufferIndex() const;
+
+		//! Starts recording the draw calls into a binary command stream
+		virtual bool startCommandRecording(io::IWriteFile* file);
+
+		//! Stops recording the draw calls and releases the file
+		virtual void stopCommandRecording();
+
+		//! Replays a command stream recorded by startCommandRecording()
+		virtual s32 replayCommands(io::IReadFile* file,
+			core::array<SVideoCommandTiming>* timings=0);
+
 		//! Writes the provided image to disk file
 		virtual bool writeImageToFile(IImage* image, const io::path& filename, u32 param = 0);
 
@@ -828,7 +854,7 @@ namespace video
 
 		CFPSCounter FPSCounter;
 
-		u32 PrimitivesDrawn;
+		SDriverStatistics Statistics;
 		u32 MinVertexCountForVBO;
 
 		u32 TextureCreationFlags;
@@ -852,6 +878,9 @@ namespace video
 		bool AllowZWriteOnTransparent;
 
 		bool FeatureEnabled[video::EVDF_COUNT];
+
+		//! writes the draw calls while recording, see startCommandRecording()
+		CVideoCommandRecorder* CommandRecorder;
 	};
 
 } // end namespace video
@@ -12,28 +12,53 @@ namespace irr
 namespace scene
 {
 
+namespace
+{
+	//! depth of the nodes whose subtrees are constructed by the threads
+	const u32 OCTREE_TASK_DEPTH = 2;
+
+	//! meshes with less triangles are constructed on the calling thread
+	const u32 OCTREE_MIN_THREADED = 65536;
+}
+
+
 //! constructor
 COctreeTriangleSelector::COctreeTriangleSelector(const IMesh* mesh,
-		ISceneNode* node, s32 minimalPolysPerNode)
-	: CTriangleSelector(mesh, node), Root(0), NodeCount(0),
+		ISceneNode* node, s32 minimalPolysPerNode, bool staticNode, CThreadPool* threads)
+	: CTriangleSelector(mesh, node, staticNode), Root(0), NodeCount(0),
 	 MinimalPolysPerNode(minimalPolysPerNode)
 {
 	#ifdef _DEBUG
 	setDebugName("COctreeTriangleSelector");
 	#endif
 
-	if (!Triangles.empty())
+	const u32 cnt = getStoredTriangleCount();
+	if (cnt)
 	{
 		const u32 start = os::Timer::getRealTime();
 
-		// create the triangle octree
+		SOctreeBuild build;
+		build.Indices.set_used(cnt);
+		for (u32 i=0; i<cnt; ++i)
+			build.Indices[i] = i;
+		build.Scratch.set_used(cnt);
+		build.Children.set_used(cnt);
+
+		// create the triangle octree, the top levels on this thread and
+		// the subtrees below on all of them
 		Root = new SOctreeNode();
-		Root->Triangles = Triangles;
-		constructOctree(Root);
+		NodeCount = constructOctree(Root, 0, cnt, build, 0, OCTREE_TASK_DEPTH);
+		constructTasks(build, threads);
+
+		// sort the triangles by node, so the nodes read them in one piece
+		build.Scratch.clear();
+		build.Children.clear();
+		reorderTriangles(build.Indices);
+		TriangleIndices.swap(build.Indices);
 
 		c8 tmp[256];
 		sprintf(tmp, "Needed %ums to create OctreeTriangleSelector.(%d nodes, %u polys)",
-			os::Timer::getRealTime() - start, NodeCount, Triangles.size());
+			os::Timer::getRealTime() - start, NodeCount, cnt);
 		os::Printer::log(tmp, ELL_INFORMATION);
 	}
 }
@@ -46,64 +71,172 @@ COctreeTriangleSelector::~COctreeTriangleSelector()
 }
 
 
-void COctreeTriangleSelector::constructOctree(SOctreeNode* node)
+//! Partitions the triangles from first to first+count into the node and its children
+s32 COctreeTriangleSelector::constructOctree(SOctreeNode* node, u32 first, u32 count,
+		SOctreeBuild& build, u32 depth, u32 taskDepth) const
 {
-	++NodeCount;
+	if (depth == taskDepth)
+	{
+		node->First = first;
+		node->Count = count;
+		build.Tasks.push_back(node);
+		return 0;
+	}
 
-	node->Box.reset(node->Triangles[0].pointA);
+	u32* const indices = build.Indices.pointer() + first;
+	u8* const children = build.Children.pointer() + first;
+
+	core::triangle3df triangle;
+	getTriangle(indices[0], triangle);
+	node->Box.reset(triangle.pointA);
 
 	// get bounding box
-	const u32 cnt = node->Triangles.size();
-	for (u32 i=0; i<cnt; ++i)
+	u32 i;
+	for (i=0; i<count; ++i)
 	{
-		node->Box.addInternalPoint(node->Triangles[i].pointA);
-		node->Box.addInternalPoint(node->Triangles[i].pointB);
-		node->Box.addInternalPoint(node->Triangles[i].pointC);
+		getTriangle(indices[i], triangle);
+		node->Box.addInternalPoint(triangle.pointA);
+		node->Box.addInternalPoint(triangle.pointB);
+		node->Box.addInternalPoint(triangle.pointC);
 	}
 
+	node->First = first;
+	node->Count = count;
+
+	if (node->Box.isEmpty() || (s32)count <= MinimalPolysPerNode)
+		return 1;
+
+	// Child ch spans from the middle to edges[ch]. Bit 4 of ch selects
+	// the upper half in x, bit 1 in y and bit 2 in z, a triangle goes
+	// to the first child which contains it.
 	const core::vector3df& middle = node->Box.getCenter();
 	core::vector3df edges[8];
 	node->Box.getEdges(edges);
 
-	core::aabbox3d<f32> box;
-	core::array<core::triangle3df> keepTriangles;
+	core::aabbox3d<f32> lower(middle);
+	lower.addInternalPoint(edges[0]);
+	core::aabbox3d<f32> upper(middle);
+	upper.addInternalPoint(edges[7]);
 
-	// calculate children
+	// single pass: the child of each triangle, counted per child
+	u32 childCount[9];
+	for (i=0; i<9; ++i)
+		childCount[i] = 0;
 
-	if (!node->Box.isEmpty() && (s32)node->Triangles.size() > MinimalPolysPerNode)
-	for (s32 ch=0; ch<8; ++ch)
+	for (i=0; i<count; ++i)
 	{
-		box.reset(middle);
-		box.addInternalPoint(edges[ch]);
-		node->Child[ch] = new SOctreeNode();
-
-		for (s32 i=0; i<(s32)node->Triangles.size(); ++i)
+		core::triangle3df t;
+		getTriangle(indices[i], t);
+		u32 ch = 0;
+		u32 axis;
+		for (axis=0; axis<3; ++axis)
 		{
-			if (node->Triangles[i].isTotalInsideBox(box))
-			{
-				node->Child[ch]->Triangles.push_back(node->Triangles[i]);
-				//node->Triangles.erase(i);
-				//--i;
-			}
+			const f32 lowerMin = axis == 0 ? lower.MinEdge.X : axis == 1 ? lower.MinEdge.Y : lower.MinEdge.Z;
+			const f32 lowerMax = axis == 0 ? lower.MaxEdge.X : axis == 1 ? lower.MaxEdge.Y : lower.MaxEdge.Z;
+			const f32 upperMin = axis == 0 ? upper.MinEdge.X : axis == 1 ? upper.MinEdge.Y : upper.MinEdge.Z;
+			const f32 upperMax = axis == 0 ? upper.MaxEdge.X : axis == 1 ? upper.MaxEdge.Y : upper.MaxEdge.Z;
+			const f32 a = axis == 0 ? t.pointA.X : axis == 1 ? t.pointA.Y : t.pointA.Z;
+			const f32 b = axis == 0 ? t.pointB.X : axis == 1 ? t.pointB.Y : t.pointB.Z;
+			const f32 c = axis == 0 ? t.pointC.X : axis == 1 ? t.pointC.Y : t.pointC.Z;
+			const f32 lo = core::min_(a, b, c);
+			const f32 hi = core::max_(a, b, c);
+
+			if (lo >= lowerMin && hi <= lowerMax)
+				continue;
+			if (lo >= upperMin && hi <= upperMax)
+				ch |= axis == 0 ? 4 : axis == 1 ? 1 : 2;
 			else
-			{
-				keepTriangles.push_back(node->Triangles[i]);
-			}
+				break;
 		}
-		memcpy(node->Triangles.pointer(), keepTriangles.pointer(),
-			sizeof(core::triangle3df)*keepTriangles.size());
+		if (axis != 3)
+			ch = 8;
 
-		node->Triangles.set_used(keepTriangles.size());
-		keepTriangles.set_used(0);
+		children[i] = (u8) ch;
+		++childCount[ch];
+	}
 
-		if (node->Child[ch]->Triangles.empty())
-		{
-			delete node->Child[ch];
-			node->Child[ch] = 0;
-		}
-		else
-			constructOctree(node->Child[ch]);
+	// the triangles staying in the node first, then the ones of the
+	// children in their order, keeping the order inside each of them
+	u32 offset[9];
+	offset[8] = 0;
+	u32 sum = childCount[8];
+	for (i=0; i<8; ++i)
+	{
+		offset[i] = sum;
+		sum += childCount[i];
+	}
+
+	u32* const scratch = build.Scratch.pointer() + first;
+	for (i=0; i<count; ++i)
+		scratch[offset[children[i]]++] = indices[i];
+	memcpy(indices, scratch, count * sizeof(u32));
+
+	node->Count = childCount[8];
+
+	s32 nodeCount = 1;
+	u32 childFirst = first + childCount[8];
+	for (u32 ch=0; ch<8; ++ch)
+	{
+		if (!childCount[ch])
+			continue;
+
+		node->Child[ch] = new SOctreeNode();
+		nodeCount += constructOctree(node->Child[ch], childFirst, childCount[ch],
+			build, depth + 1, taskDepth);
+		childFirst += childCount[ch];
+	}
+
+	return nodeCount;
+}
+
+
+//! Constructs the subtrees of the tasks on several threads
+void COctreeTriangleSelector::constructTasks(SOctreeBuild& build, CThreadPool* threads)
+{
+	if (build.Tasks.empty())
+		return;
+
+	// larger subtrees first, so the threads get similar amounts of work
+	core::array<SOctreeNode*>& tasks = build.Tasks;
+	for (u32 i=1; i<tasks.size(); ++i)
+	{
+		SOctreeNode* task = tasks[i];
+		u32 j = i;
+		for (; j>0 && tasks[j-1]->Count < task->Count; --j)
+			tasks[j] = tasks[j-1];
+		tasks[j] = task;
+	}
+
+	SConstructJob job;
+	job.Selector = this;
+	job.Build = &build;
+	if (threads && getStoredTriangleCount() >= OCTREE_MIN_THREADED)
+	{
+		job.NodeCounts.set_used(threads->getThreadCount());
+		threads->run(&job);
+	}
+	else
+	{
+		job.NodeCounts.set_used(1);
+		job.run(0);
 	}
+
+	for (u32 i=0; i<job.NodeCounts.size(); ++i)
+		NodeCount += job.NodeCounts[i];
+}
+
+
+//! Constructs the subtrees of every n-th task on each thread
+void COctreeTriangleSelector::SConstructJob::run(u32 thread)
+{
+	s32 nodeCount = 0;
+	for (u32 i=thread; i<Build->Tasks.size(); i+=NodeCounts.size())
+	{
+		SOctreeNode* task = Build->Tasks[i];
+		nodeCount += Selector->constructOctree(task, task->First, task->Count,
+			*Build, 0, 0xffffffff);
+	}
+	NodeCounts[thread] = nodeCount;
 }
 
 
@@ -116,9 +249,9 @@ void COctreeTriangleSelector::getTriangles(core::triangle3df* triangles,
 	core::matrix4 mat(core::matrix4::EM4CONST_NOTHING);
 	core::aabbox3d<f32> invbox = box;
 
-	if (SceneNode)
+	if (TransformNode)
 	{
-		SceneNode->getAbsoluteTransformation().getInverse(mat);
+		TransformNode->getAbsoluteTransformation().getInverse(mat);
 		mat.transformBoxEx(invbox);
 	}
 
@@ -127,8 +260,8 @@ void COctreeTriangleSelector::getTriangles(core::triangle3df* triangles,
 	else
 		mat.makeIdentity();
 
-	if (SceneNode)
-		mat *= SceneNode->getAbsoluteTransformation();
+	if (TransformNode)
+		mat *= TransformNode->getAbsoluteTransformation();
 
 	s32 trianglesWritten = 0;
 
@@ -148,11 +281,12 @@ void COctreeTriangleSelector::getTrianglesFromOctree(
 	if (!box.intersectsWithBox(node->Box))
 		return;
 
-	const u32 cnt = node->Triangles.size();
+	const u32 end = node->First + node->Count;
+	core::triangle3df srcTri;
 
-	for (u32 i=0; i<cnt; ++i)
+	for (u32 i=node->First; i<end; ++i)
 	{
-		const core::triangle3df& srcTri = node->Triangles[i];
+		getTriangle(i, srcTri);
 		// This isn't an accurate test, but it's fast, and the 
 		// API contract doesn't guarantee complete accuracy.
 		if (srcTri.isTotalOutsideBox(box))
@@ -194,9 +328,9 @@ void COctreeTriangleSelector::getTriangles(core::triangle3df* triangles, s32 arr
 	core::matrix4 mat ( core::matrix4::EM4CONST_NOTHING );
 
 	core::vector3df vectStartInv ( line.start ), vectEndInv ( line.end );
-	if (SceneNode)
+	if (TransformNode)
 	{
-		mat = SceneNode->getAbsoluteTransformation();
+		mat = TransformNode->getAbsoluteTransformation();
 		mat.makeInverse();
 		mat.transformVect(vectStartInv, line.start);
 		mat.transformVect(vectEndInv, line.end);
@@ -208,8 +342,8 @@ void COctreeTriangleSelector::getTriangles(core::triangle3df* triangles, s32 arr
 	if (transform)
 		mat = (*transform);
 
-	if (SceneNode)
-		mat *= SceneNode->getAbsoluteTransformation();
+	if (TransformNode)
+		mat *= TransformNode->getAbsoluteTransformation();
 
 	s32 trianglesWritten = 0;
 
@@ -227,7 +361,7 @@ void COctreeTriangleSelector::getTrianglesFromOctree(SOctreeNode* node,
 	if (!node->Box.intersectsWithLine(line))
 		return;
 
-	s32 cnt = node->Triangles.size();
+	s32 cnt = node->Count;
 	if (cnt + trianglesWritten > maximumSize)
 		cnt -= cnt + trianglesWritten - maximumSize;
 
@@ -237,7 +371,7 @@ void COctreeTriangleSelector::getTrianglesFromOctree(SOctreeNode* node,
 	{
 		for (i=0; i<cnt; ++i)
 		{
-			triangles[trianglesWritten] = node->Triangles[i];
+			getTriangle(node->First + i, triangles[trianglesWritten]);
 			++trianglesWritten;
 		}
 	}
@@ -245,7 +379,7 @@ void COctreeTriangleSelector::getTrianglesFromOctree(SOctreeNode* node,
 	{
 		for (i=0; i<cnt; ++i)
 		{
-			triangles[trianglesWritten] = node->Triangles[i];
+			getTriangle(node->First + i, triangles[trianglesWritten]);
 			transform->transformVect(triangles[trianglesWritten].pointA);
 			transform->transformVect(triangles[trianglesWritten].pointB);
 			transform->transformVect(triangles[trianglesWritten].pointC);
@@ -260,6 +394,86 @@ void COctreeTriangleSelector::getTrianglesFromOctree(SOctreeNode* node,
 }
 
 
+//! Finds the triangle hit by a line segment
+bool COctreeTriangleSelector::getCollisionPoint(const core::line3d<f32>& line,
+		SCollisionHit& hit, bool anyHit) const
+{
+	if (!Root)
+		return false;
+
+	core::matrix4 mat;
+	core::line3d<f32> invline(line);
+	if (TransformNode)
+	{
+		mat = TransformNode->getAbsoluteTransformation();
+		mat.makeInverse();
+		mat.transformVect(invline.start, line.start);
+		mat.transformVect(invline.end, line.end);
+		mat = TransformNode->getAbsoluteTransformation();
+	}
+
+	core::aabbox3d<f32> box(invline.start);
+	box.addInternalPoint(invline.end);
+
+	SCollisionLine collision(line);
+	return getCollisionPointFromOctree(Root, invline, box, mat, collision, hit, anyHit);
+}
+
+
+bool COctreeTriangleSelector::getCollisionPointFromOctree(const SOctreeNode* node,
+		const core::line3d<f32>& line, const core::aabbox3d<f32>& box,
+		const core::matrix4& transform, SCollisionLine& collision,
+		SCollisionHit& hit, bool anyHit) const
+{
+	if (!node->Box.intersectsWithLine(line))
+		return false;
+
+	bool found = false;
+	core::triangle3df triangle;
+	core::vector3df intersection;
+
+	const u32 end = node->First + node->Count;
+	for (u32 i=node->First; i<end; ++i)
+	{
+		// triangles beside the line are not transformed at all
+		getTriangle(i, triangle);
+		if (triangle.isTotalOutsideBox(box))
+			continue;
+
+		if (TransformNode)
+		{
+			transform.transformVect(triangle.pointA);
+			transform.transformVect(triangle.pointB);
+			transform.transformVect(triangle.pointC);
+		}
+
+		if (collision.collide(triangle, intersection))
+		{
+			hit.Intersection = intersection;
+			hit.Triangle = triangle;
+			hit.Node = SceneNode;
+			hit.TriangleIndex = TriangleIndices[i];
+			found = true;
+			if (anyHit)
+				return true;
+		}
+	}
+
+	for (u32 i=0; i<8; ++i)
+	{
+		if (node->Child[i] && getCollisionPointFromOctree(node->Child[i],
+				line, box, transform, collision, hit, anyHit))
+		{
+			found = true;
+			if (anyHit)
+				return true;
+		}
+	}
+
+	return found;
+}
+
+
 } // end namespace scene
 } // end namespace irr
 
@@ -6,6 +6,7 @@
 #define __C_OCTREE_TRIANGLE_SELECTOR_H_INCLUDED__
 
 #include "CTriangleSelector.h"
+#include "CThreadPool.h"
 
 namespace irr
 {
@@ -20,7 +21,10 @@ class COctreeTriangleSelector : public CTriangleSelector
 public:
 
 	//! Constructs a selector based on a mesh
-	COctreeTriangleSelector(const IMesh* mesh, ISceneNode* node, s32 minimalPolysPerNode);
+	/** \param threads Threads on which large meshes are constructed,
+	if 0 everything runs on the calling thread. */
+	COctreeTriangleSelector(const IMesh* mesh, ISceneNode* node, s32 minimalPolysPerNode,
+		bool staticNode=false, CThreadPool* threads=0);
 
 	virtual ~COctreeTriangleSelector();
 
@@ -33,11 +37,15 @@ public:
 		s32& outTriangleCount, const core::line3d<f32>& line,
 		const core::matrix4* transform=0) const;
 
+	//! Finds the triangle hit by a line segment
+	virtual bool getCollisionPoint(const core::line3d<f32>& line,
+		SCollisionHit& hit, bool anyHit=false) const;
+
 private:
 
 	struct SOctreeNode
 	{
-		SOctreeNode()
+		SOctreeNode() : First(0), Count(0)
 		{
 			for (u32 i=0; i!=8; ++i)
 				Child[i] = 0;
@@ -49,14 +57,48 @@ private:
 				delete Child[i];
 		}
 
-		core::array<core::triangle3df> Triangles;
+		//! stored triangles of this node, the ones of the children follow them
+		u32 First;
+		u32 Count;
 		SOctreeNode* Child[8];
 		core::aabbox3d<f32> Box;
 	};
 
+	//! Temporary data while the octree is constructed
+	struct SOctreeBuild
+	{
+		//! triangle in the mesh for each position in the octree
+		core::array<u32> Indices;
+
+		//! partitioned indices, before they are copied back
+		core::array<u32> Scratch;
+
+		//! child of each triangle while a node is partitioned, 8 keeps it in the node
+		core::array<u8> Children;
+
+		//! nodes whose subtrees are left for the threads, with their whole range
+		core::array<SOctreeNode*> Tasks;
+	};
+
+	//! Partitions the triangles from first to first+count into the node and its children
+	/** Nodes at taskDepth are only added to the tasks of the build.
+	\return Amount of constructed nodes. */
+	s32 constructOctree(SOctreeNode* node, u32 first, u32 count,
+			SOctreeBuild& build, u32 depth, u32 taskDepth) const;
+
+	//! Constructs the subtrees of every n-th task on each thread
+	struct SConstructJob : public CThreadPool::IJob
+	{
+		virtual void run(u32 thread);
+
+		const COctreeTriangleSelector* Selector;
+		SOctreeBuild* Build;
+		core::array<s32> NodeCounts;
+	};
+
+	//! Constructs the subtrees of the tasks on several threads
+	void constructTasks(SOctreeBuild& build, CThreadPool* threads);
 
-	void constructOctree(SOctreeNode* node);
-	void deleteEmptyNodes(SOctreeNode* node);
 	void getTrianglesFromOctree(SOctreeNode* node, s32& trianglesWritten,
 			s32 maximumSize, const core::aabbox3d<f32>& box,
 			const core::matrix4* transform,
@@ -67,9 +109,21 @@ private:
 			const core::matrix4* transform,
 			core::triangle3df* triangles) const;
 
+	//! Finds the triangle hit by a line segment in the node and its children
+	/** \param line The line in the space of the stored triangles.
+	\param box The box around that line.
+	\param transform Transformation of the stored triangles to world space. */
+	bool getCollisionPointFromOctree(const SOctreeNode* node,
+			const core::line3d<f32>& line, const core::aabbox3d<f32>& box,
+			const core::matrix4& transform, SCollisionLine& collision,
+			SCollisionHit& hit, bool anyHit) const;
+
 	SOctreeNode* Root;
 	s32 NodeCount;
 	s32 MinimalPolysPerNode;
+
+	//! triangle in the mesh for each stored one, which are sorted by node
+	core::array<u32> TriangleIndices;
 };
 
 } // end namespace scene
@@ -941,6 +941,10 @@ const core::matrix4& COpenGLDriver::getTransform(E_TRANSFORMATION_STATE state) c
 //! sets transformation
 void COpenGLDriver::setTransform(E_TRANSFORMATION_STATE state, const core::matrix4& mat)
 {
+	CVideoCommandScope command(CommandRecorder);
+	if (command.isRecording())
+		command->setTransform(state, mat);
+
 	Matrices[state] = mat;
 	Transformation3DChanged = true;
 
@@ -1916,6 +1920,10 @@ void COpenGLDriver::draw2DImageBatch(const video::ITexture* texture,
 				SColor color,
 				bool useAlphaChannelOfTexture)
 {
+	CVideoCommandScope command(CommandRecorder);
+	if (command.isRecording())
+		command->draw2DImageBatch(texture, positions, sourceRects, clipRect, color, useAlphaChannelOfTexture);
+
 	if (!texture)
 		return;
 
@@ -2052,6 +2060,10 @@ void COpenGLDriver::draw2DImage(const video::ITexture* texture,
 				const core::rect<s32>* clipRect, SColor color,
 				bool useAlphaChannelOfTexture)
 {
+	CVideoCommandScope command(CommandRecorder);
+	if (command.isRecording())
+		command->draw2DImage(texture, pos, sourceRect, clipRect, color, useAlphaChannelOfTexture);
+
 	if (!texture)
 		return;
 
@@ -2180,6 +2192,10 @@ void COpenGLDriver::draw2DImage(const video::ITexture* texture, const core::rect
 		const core::rect<s32>& sourceRect, const core::rect<s32>* clipRect,
 		const video::SColor* const colors, bool useAlphaChannelOfTexture)
 {
+	CVideoCommandScope command(CommandRecorder);
+	if (command.isRecording())
+		command->draw2DImage(texture, destRect, sourceRect, clipRect, colors, useAlphaChannelOfTexture);
+
 	if (!texture)
 		return;
 
@@ -2256,6 +2272,10 @@ void COpenGLDriver::draw2DImage(const video::ITexture* texture,
 				const core::rect<s32>* clipRect, SColor color,
 				bool useAlphaChannelOfTexture)
 {
+	CVideoCommandScope command(CommandRecorder);
+	if (command.isRecording())
+		command->draw2DImageBatch(texture, pos, sourceRects, indices, 0, clipRect, color, useAlphaChannelOfTexture);
+
 	if (!texture)
 		return;
 
@@ -2321,6 +2341,10 @@ void COpenGLDriver::draw2DImage(const video::ITexture* texture,
 void COpenGLDriver::draw2DRectangle(SColor color, const core::rect<s32>& position,
 		const core::rect<s32>* clip)
 {
+	CVideoCommandScope command(CommandRecorder);
+	if (command.isRecording())
+		command->draw2DRectangle(color, position, clip);
+
 	disableTextures();
 	setRenderStates2DMode(color.getAlpha() < 255, false, false);
 
@@ -2343,6 +2367,10 @@ void COpenGLDriver::draw2DRectangle(const core::rect<s32>& position,
 			SColor colorLeftUp, SColor colorRightUp, SColor colorLeftDown, SColor colorRightDown,
 			const core::rect<s32>* clip)
 {
+	CVideoCommandScope command(CommandRecorder);
+	if (command.isRecording())
+		command->draw2DRectangle(position, colorLeftUp, colorRightUp, colorLeftDown, colorRightDown, clip);
+
 	core::rect<s32> pos = position;
 
 	if (clip)
@@ -2383,6 +2411,10 @@ void COpenGLDriver::draw2DRectangle(const core::rect<s32>& position,
 void COpenGLDriver::draw2DLine(const core::position2d<s32>& start,
 				const core::position2d<s32>& end, SColor color)
 {
+	CVideoCommandScope command(CommandRecorder);
+	if (command.isRecording())
+		command->draw2DLine(start, end, color);
+
 	if (start==end)
 		drawPixel(start.X, start.Y, color);
 	else
@@ -2413,6 +2445,10 @@ void COpenGLDriver::draw2DLine(const core::position2d<s32>& start,
 //! Draws a pixel
 void COpenGLDriver::drawPixel(u32 x, u32 y, const SColor &color)
 {
+	CVideoCommandScope command(CommandRecorder);
+	if (command.isRecording())
+		command->drawPixel(x, y, color);
+
 	const core::dimension2d<u32>& renderTargetSize = getCurrentRenderTargetSize();
 	if (x > (u32)renderTargetSize.Width || y > (u32)renderTargetSize.Height)
 		return;
@@ -2515,6 +2551,10 @@ video::ITexture* COpenGLDriver::createDeviceDependentTexture(IImage* surface, co
 //! Sets a material. All 3d drawing functions draw geometry now using this material.
 void COpenGLDriver::setMaterial(const SMaterial& material)
 {
+	CVideoCommandScope command(CommandRecorder);
+	if (command.isRecording())
+		command->setMaterial(material);
+
 	Material = material;
 	OverrideMaterial.apply(Material);
 
@@ -3540,6 +3580,10 @@ u32 COpenGLDriver::getMaximalDynamicLightAmount() const
 //! \param color: New color of the ambient light.
 void COpenGLDriver::setAmbientLight(const SColorf& color)
 {
+	CVideoCommandScope command(CommandRecorder);
+	if (command.isRecording())
+		command->setAmbientLight(color);
+
 	GLfloat data[4] = {color.r, color.g, color.b, color.a};
 	glLightModelfv(GL_LIGHT_MODEL_AMBIENT, data);
 }
@@ -3811,6 +3855,10 @@ void COpenGLDriver::setFog(SColor c, E_FOG_TYPE fogType, f32 start,
 void COpenGLDriver::draw3DLine(const core::vector3df& start,
 				const core::vector3df& end, SColor color)
 {
+	CVideoCommandScope command(CommandRecorder);
+	if (command.isRecording())
+		command->draw3DLine(start, end, color);
+
 	setRenderStates3DMode();
 
 	glBegin(GL_LINES);
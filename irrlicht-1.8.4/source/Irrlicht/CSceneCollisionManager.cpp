@@ -7,6 +7,7 @@
 #include "ICameraSceneNode.h"
 #include "ITriangleSelector.h"
 #include "SViewFrustum.h"
+#include "CThreadPool.h"
 
 #include "os.h"
 #include "irrMath.h"
@@ -16,9 +17,67 @@ namespace irr
 namespace scene
 {
 
+namespace
+{
+	//! lines traced by a thread in one go, threads take every n-th chunk
+	const u32 COLLISION_BATCH_CHUNK = 64;
+
+	//! batches with less lines are traced on the calling thread
+	const u32 COLLISION_BATCH_MIN_THREADED = 256;
+
+	//! traces interleaved chunks of a line batch on the first threadCount threads of the pool
+	class CCollisionBatchJob : public CThreadPool::IJob
+	{
+	public:
+		CCollisionBatchJob(const ITriangleSelector* selector,
+				const core::line3d<f32>* lines, u32 count,
+				SCollisionHit* hits, bool* found, bool anyHit,
+				u32 threadCount)
+			: Selector(selector), Lines(lines), Count(count), Hits(hits),
+			Found(found), AnyHit(anyHit), ThreadCount(threadCount)
+		{
+			HitCounts.set_used(threadCount);
+		}
+
+		virtual void run(u32 thread)
+		{
+			if (thread >= ThreadCount)
+				return;
+
+			u32 hitCount = 0;
+			for (u32 i=thread*COLLISION_BATCH_CHUNK; i<Count; i+=ThreadCount*COLLISION_BATCH_CHUNK)
+			{
+				const u32 n = core::min_(COLLISION_BATCH_CHUNK, Count - i);
+				hitCount += Selector->getCollisionPoints(Lines + i, n,
+					Hits + i, Found + i, AnyHit);
+			}
+			HitCounts[thread] = hitCount;
+		}
+
+		u32 getHitCount() const
+		{
+			u32 hitCount = 0;
+			for (u32 i=0; i<HitCounts.size(); ++i)
+				hitCount += HitCounts[i];
+			return hitCount;
+		}
+
+	private:
+		const ITriangleSelector* Selector;
+		const core::line3d<f32>* Lines;
+		u32 Count;
+		SCollisionHit* Hits;
+		bool* Found;
+		bool AnyHit;
+		u32 ThreadCount;
+		core::array<u32> HitCounts;
+	};
+}
+
 //! constructor
-CSceneCollisionManager::CSceneCollisionManager(ISceneManager* smanager, video::IVideoDriver* driver)
-: SceneManager(smanager), Driver(driver)
+CSceneCollisionManager::CSceneCollisionManager(ISceneManager* smanager, video::IVideoDriver* driver,
+		CThreadPool* threads)
+: SceneManager(smanager), Driver(driver), Threads(threads), ThreadCount(0)
 {
 	#ifdef _DEBUG
 	setDebugName("CSceneCollisionManager");
@@ -357,63 +416,55 @@ bool CSceneCollisionManager::getCollisionPoint(const core::line3d<f32>& ray,
 		return false;
 	}
 
-	s32 totalcnt = selector->getTriangleCount();
-	if ( totalcnt <= 0 )
-		return false;
+	SCollisionHit hit;
+	const bool found = selector->getCollisionPoint(ray, hit);
+	if (found)
+	{
+		outIntersection = hit.Intersection;
+		outTriangle = hit.Triangle;
+		outNode = hit.Node;
+	}
 
-	Triangles.set_used(totalcnt);
+	_IRR_IMPLEMENT_MANAGED_MARSHALLING_BUGFIX;
+	return found;
+}
 
-	s32 cnt = 0;
-	selector->getTriangles(Triangles.pointer(), totalcnt, cnt, ray);
 
-	const core::vector3df linevect = ray.getVector().normalize();
-	core::vector3df intersection;
-	f32 nearest = FLT_MAX;
-	bool found = false;
-	const f32 raylength = ray.getLengthSQ();
+//! Finds the collision points of many lines and lots of triangles.
+u32 CSceneCollisionManager::getCollisionPoints(const core::line3d<f32>* rays,
+		u32 rayCount, ITriangleSelector* selector, SCollisionHit* outHits,
+		bool* outFound, bool anyHit)
+{
+	if (!selector || !rayCount)
+		return 0;
 
-	const f32 minX = core::min_(ray.start.X, ray.end.X);
-	const f32 maxX = core::max_(ray.start.X, ray.end.X);
-	const f32 minY = core::min_(ray.start.Y, ray.end.Y);
-	const f32 maxY = core::max_(ray.start.Y, ray.end.Y);
-	const f32 minZ = core::min_(ray.start.Z, ray.end.Z);
-	const f32 maxZ = core::max_(ray.start.Z, ray.end.Z);
+	// animated selectors take the current frame here, the threads only
+	// read them afterwards
+	selector->updateForQueries();
 
-	for (s32 i=0; i<cnt; ++i)
+	if (rayCount >= COLLISION_BATCH_MIN_THREADED && Threads)
 	{
-		const core::triangle3df & triangle = Triangles[i];
+		u32 threadCount = Threads->getThreadCount();
+		if (ThreadCount)
+			threadCount = core::min_(threadCount, ThreadCount);
 
-		if(minX > triangle.pointA.X && minX > triangle.pointB.X && minX > triangle.pointC.X)
-			continue;
-		if(maxX < triangle.pointA.X && maxX < triangle.pointB.X && maxX < triangle.pointC.X)
-			continue;
-		if(minY > triangle.pointA.Y && minY > triangle.pointB.Y && minY > triangle.pointC.Y)
-			continue;
-		if(maxY < triangle.pointA.Y && maxY < triangle.pointB.Y && maxY < triangle.pointC.Y)
-			continue;
-		if(minZ > triangle.pointA.Z && minZ > triangle.pointB.Z && minZ > triangle.pointC.Z)
-			continue;
-		if(maxZ < triangle.pointA.Z && maxZ < triangle.pointB.Z && maxZ < triangle.pointC.Z)
-			continue;
-
-		if (triangle.getIntersectionWithLine(ray.start, linevect, intersection))
+		if (threadCount > 1)
 		{
-			const f32 tmp = intersection.getDistanceFromSQ(ray.start);
-			const f32 tmp2 = intersection.getDistanceFromSQ(ray.end);
-
-			if (tmp < raylength && tmp2 < raylength && tmp < nearest)
-			{
-				nearest = tmp;
-				outTriangle = triangle;
-				outIntersection = intersection;
-				outNode = selector->getSceneNodeForTriangle(i);
-				found = true;
-			}
+			CCollisionBatchJob job(selector, rays, rayCount, outHits, outFound,
+				anyHit, threadCount);
+			Threads->run(&job);
+			return job.getHitCount();
 		}
 	}
 
-	_IRR_IMPLEMENT_MANAGED_MARSHALLING_BUGFIX;
-	return found;
+	return selector->getCollisionPoints(rays, rayCount, outHits, outFound, anyHit);
+}
+
+
+//! Sets the amount of threads used by getCollisionPoints().
+void CSceneCollisionManager::setCollisionThreadCount(u32 threadCount)
+{
+	ThreadCount = threadCount;
 }
 
 
@@ -428,10 +479,57 @@ core::vector3df CSceneCollisionManager::getCollisionResultPosition(
 		bool& outFalling,
 		ISceneNode*& outNode,
 		f32 slidingSpeed,
-		const core::vector3df& gravity)
+		const core::vector3df& gravity,
+		SCollisionCache* cache)
 {
 	return collideEllipsoidWithWorld(selector, position,
-		radius, direction, slidingSpeed, gravity, triout, hitPosition, outFalling, outNode);
+		radius, direction, slidingSpeed, gravity, triout, hitPosition, outFalling, outNode,
+		cache);
+}
+
+
+//! Makes sure the cache holds all triangles of the selector touching the box
+void CSceneCollisionManager::updateCollisionCache(SCollisionCache& cache,
+		const ITriangleSelector* selector, const core::aabbox3d<f32>& box)
+{
+	if (cache.Selector == selector && box.isFullInside(cache.Box))
+		return;
+
+	cache.clear();
+	cache.Selector = selector;
+	cache.Box = box;
+	addCollisionCacheTriangles(cache, selector, box);
+}
+
+
+//! Adds the triangles of each selector in a meta selector touching the box to the cache
+void CSceneCollisionManager::addCollisionCacheTriangles(SCollisionCache& cache,
+		const ITriangleSelector* selector, const core::aabbox3d<f32>& box)
+{
+	const u32 selectorCount = selector->getSelectorCount();
+	if (selectorCount != 1 || selector->getSelector(0) != selector)
+	{
+		for (u32 i=0; i<selectorCount; ++i)
+		{
+			if (selector->getSelector(i))
+				addCollisionCacheTriangles(cache, selector->getSelector(i), box);
+		}
+		return;
+	}
+
+	const s32 totalTriangleCnt = selector->getTriangleCount();
+	Triangles.set_used(totalTriangleCnt);
+
+	s32 triangleCnt = 0;
+	selector->getTriangles(Triangles.pointer(), totalTriangleCnt, triangleCnt, box);
+
+	const u32 first = cache.Triangles.size();
+	cache.Triangles.set_used(first + triangleCnt);
+	for (s32 i=0; i<triangleCnt; ++i)
+		cache.Triangles[first + i] = Triangles[i];
+
+	cache.SelectorEnds.push_back(cache.Triangles.size());
+	cache.SelectorNodes.push_back(selector->getSceneNodeForTriangle(0));
 }
 
 
@@ -694,7 +792,8 @@ core::vector3df CSceneCollisionManager::collideEllipsoidWithWorld(
 		core::triangle3df& triout,
 		core::vector3df& hitPosition,
 		bool& outFalling,
-		ISceneNode*& outNode)
+		ISceneNode*& outNode,
+		SCollisionCache* cache)
 {
 	if (!selector || radius.X == 0.0f || radius.Y == 0.0f || radius.Z == 0.0f)
 		return position;
@@ -706,8 +805,8 @@ core::vector3df CSceneCollisionManager::collideEllipsoidWithWorld(
 	colData.R3Position = position;
 	colData.R3Velocity = velocity;
 	colData.eRadius = radius;
+	colData.eInvRadius.set(1.0f / radius.X, 1.0f / radius.Y, 1.0f / radius.Z);
 	colData.nearestDistance = FLT_MAX;
-	colData.selector = selector;
 	colData.slidingSpeed = slidingSpeed;
 	colData.triangleHits = 0;
 	colData.triangleIndex = -1;
@@ -715,6 +814,32 @@ core::vector3df CSceneCollisionManager::collideEllipsoidWithWorld(
 	core::vector3df eSpacePosition = colData.R3Position / colData.eRadius;
 	core::vector3df eSpaceVelocity = colData.R3Velocity / colData.eRadius;
 
+	// Sliding never moves the ellipsoid further than its velocity, apart
+	// from keeping slidingSpeed away from walls on each of the up to 7
+	// steps of a pass, so the triangles within that distance in ellipsoid
+	// space are all it can touch during both passes.
+	const f32 reach = 1.0f + eSpaceVelocity.getLength() +
+		(gravity / colData.eRadius).getLength() + 14.0f * core::abs_(slidingSpeed);
+	core::aabbox3d<f32> box(position - radius * reach, position + radius * reach);
+
+	// a cache kept between calls gets room for the next moves
+	if (cache)
+	{
+		if (cache->Selector != selector || !box.isFullInside(cache->Box))
+		{
+			box.MinEdge -= radius * reach;
+			box.MaxEdge += radius * reach;
+		}
+	}
+	else
+	{
+		cache = &Cache;
+		Cache.clear();
+	}
+
+	updateCollisionCache(*cache, selector, box);
+	colData.cache = cache;
+
 	// iterate until we have our final position
 
 	core::vector3df finalPos = collideWithWorld(
@@ -744,7 +869,11 @@ core::vector3df CSceneCollisionManager::collideEllipsoidWithWorld(
 		triout.pointA *= colData.eRadius;
 		triout.pointB *= colData.eRadius;
 		triout.pointC *= colData.eRadius;
-		outNode = selector->getSceneNodeForTriangle(colData.triangleIndex);
+
+		u32 i = 0;
+		while (cache->SelectorEnds[i] <= (u32)colData.triangleIndex)
+			++i;
+		outNode = cache->SelectorNodes[i];
 	}
 
 	finalPos *= colData.eRadius;
@@ -770,27 +899,26 @@ core::vector3df CSceneCollisionManager::collideWithWorld(s32 recursionDepth,
 
 	//------------------ collide with world
 
-	// get all triangles with which we might collide
-	core::aabbox3d<f32> box(colData.R3Position);
-	box.addInternalPoint(colData.R3Position + colData.R3Velocity);
+	// test the cached triangles this step might touch, in ellipsoid space
+	core::aabbox3d<f32> box(pos * colData.eRadius);
+	box.addInternalPoint((pos + vel) * colData.eRadius);
 	box.MinEdge -= colData.eRadius;
 	box.MaxEdge += colData.eRadius;
 
-	s32 totalTriangleCnt = colData.selector->getTriangleCount();
-	Triangles.set_used(totalTriangleCnt);
-
-	core::matrix4 scaleMatrix;
-	scaleMatrix.setScale(
-			core::vector3df(1.0f / colData.eRadius.X,
-					1.0f / colData.eRadius.Y,
-					1.0f / colData.eRadius.Z));
-
-	s32 triangleCnt = 0;
-	colData.selector->getTriangles(Triangles.pointer(), totalTriangleCnt, triangleCnt, box, &scaleMatrix);
+	const core::array<core::triangle3df>& triangles = colData.cache->Triangles;
+	const u32 triangleCnt = triangles.size();
+	core::triangle3df triangle;
+	for (u32 i=0; i<triangleCnt; ++i)
+	{
+		if (triangles[i].isTotalOutsideBox(box))
+			continue;
 
-	for (s32 i=0; i<triangleCnt; ++i)
-		if(testTriangleIntersection(&colData, Triangles[i]))
-			colData.triangleIndex = i;
+		triangle.pointA = triangles[i].pointA * colData.eInvRadius;
+		triangle.pointB = triangles[i].pointB * colData.eInvRadius;
+		triangle.pointC = triangles[i].pointC * colData.eInvRadius;
+		if (testTriangleIntersection(&colData, triangle))
+			colData.triangleIndex = (s32)i;
+	}
 
 	//---------------- end collide with world
 
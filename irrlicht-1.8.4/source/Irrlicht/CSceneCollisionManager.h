@@ -11,6 +11,9 @@
 
 namespace irr
 {
+
+class CThreadPool;
+
 namespace scene
 {
 
@@ -20,7 +23,8 @@ namespace scene
 	public:
 
 		//! constructor
-		CSceneCollisionManager(ISceneManager* smanager, video::IVideoDriver* driver);
+		CSceneCollisionManager(ISceneManager* smanager, video::IVideoDriver* driver,
+			CThreadPool* threads);
 
 		//! destructor
 		virtual ~CSceneCollisionManager();
@@ -47,6 +51,14 @@ namespace scene
 			core::triangle3df& outTriangle,
 			ISceneNode* & outNode);
 
+		//! Finds the collision points of many lines and lots of triangles.
+		virtual u32 getCollisionPoints(const core::line3d<f32>* rays, u32 rayCount,
+			ITriangleSelector* selector, SCollisionHit* outHits,
+			bool* outFound, bool anyHit=false);
+
+		//! Sets the amount of threads used by getCollisionPoints().
+		virtual void setCollisionThreadCount(u32 threadCount);
+
 		//! Collides a moving ellipsoid with a 3d world with gravity and returns
 		//! the resulting new position of the ellipsoid.
 		virtual core::vector3df getCollisionResultPosition(
@@ -59,7 +71,8 @@ namespace scene
 			bool& outFalling,
 			ISceneNode*& outNode,
 			f32 slidingSpeed,
-			const core::vector3df& gravityDirectionAndSpeed);
+			const core::vector3df& gravityDirectionAndSpeed,
+			SCollisionCache* cache=0);
 
 		//! Returns a 3d ray which would go through the 2d screen coodinates.
 		virtual core::line3d<f32> getRayFromScreenCoordinates(
@@ -119,7 +132,11 @@ namespace scene
 
 			f32 slidingSpeed;
 
-			ITriangleSelector* selector;
+			//! triangles around the ellipsoid, in world space
+			const SCollisionCache* cache;
+
+			//! 1 / eRadius, scales world space to ellipsoid space
+			core::vector3df eInvRadius;
 		};
 
 		//! Tests the current collision data against an individual triangle.
@@ -138,7 +155,16 @@ namespace scene
 			const core::vector3df& gravity, core::triangle3df& triout,
 			core::vector3df& hitPosition,
 			bool& outFalling,
-			ISceneNode*& outNode);
+			ISceneNode*& outNode,
+			SCollisionCache* cache);
+
+		//! Makes sure the cache holds all triangles of the selector touching the box
+		void updateCollisionCache(SCollisionCache& cache,
+			const ITriangleSelector* selector, const core::aabbox3d<f32>& box);
+
+		//! Adds the triangles of each selector in a meta selector touching the box to the cache
+		void addCollisionCacheTriangles(SCollisionCache& cache,
+			const ITriangleSelector* selector, const core::aabbox3d<f32>& box);
 
 		core::vector3df collideWithWorld(s32 recursionDepth, SCollisionData &colData,
 			core::vector3df pos, core::vector3df vel);
@@ -148,6 +174,15 @@ namespace scene
 		ISceneManager* SceneManager;
 		video::IVideoDriver* Driver;
 		core::array<core::triangle3df> Triangles; // triangle buffer
+
+		//! triangles of getCollisionResultPosition() calls without a cache
+		SCollisionCache Cache;
+
+		//! threads of the scene manager, used by getCollisionPoints()
+		CThreadPool* Threads;
+
+		//! most threads used by getCollisionPoints(), 0 for all of Threads
+		u32 ThreadCount;
 	};
 
 
@@ -150,12 +150,16 @@
 #include "CTextSceneNode.h"
 #include "CQuake3ShaderSceneNode.h"
 #include "CVolumeLightSceneNode.h"
+#include "CStaticBatchSceneNode.h"
+#include "CInstancedMeshSceneNode.h"
 
 #include "CDefaultSceneNodeFactory.h"
 
+#include "CClusteredLightManager.h"
 #include "CSceneCollisionManager.h"
 #include "CTriangleSelector.h"
 #include "COctreeTriangleSelector.h"
+#include "CBVHTriangleSelector.h"
 #include "CTriangleBBSelector.h"
 #include "CMetaTriangleSelector.h"
 #include "CTerrainTriangleSelector.h"
@@ -172,6 +176,7 @@
 #include "CDefaultSceneNodeAnimatorFactory.h"
 
 #include "CGeometryCreator.h"
+#include "CThreadPool.h"
 
 namespace irr
 {
@@ -183,9 +188,10 @@ CSceneManager::CSceneManager(video::IVideoDriver* driver, io::IFileSystem* fs,
 		gui::ICursorControl* cursorControl, IMeshCache* cache,
 		gui::IGUIEnvironment* gui)
 : ISceneNode(0, 0), Driver(driver), FileSystem(fs), GUIEnvironment(gui),
-	CursorControl(cursorControl), CollisionManager(0),
+	CursorControl(cursorControl), CollisionManager(0), Threads(0),
 	ActiveCamera(0), ShadowColor(150,0,0,0), AmbientLight(0,0,0,0),
 	MeshCache(cache), CurrentRendertime(ESNRP_NONE), LightManager(0),
+	FrameLog(0), DebugNormalLength(1.f), DebugNormalColor(255, 34, 221, 221),
 	IRR_XML_FORMAT_SCENE(L"irr_scene"), IRR_XML_FORMAT_NODE(L"node"), IRR_XML_FORMAT_NODE_ATTR_TYPE(L"type")
 {
 	#ifdef _DEBUG
@@ -196,10 +202,6 @@ CSceneManager::CSceneManager(video::IVideoDriver* driver, io::IFileSystem* fs,
 	// root node's scene manager
 	SceneManager = this;
 
-	// set scene parameters
-	Parameters.setAttribute( DEBUG_NORMAL_LENGTH, 1.f );
-	Parameters.setAttribute( DEBUG_NORMAL_COLOR, video::SColor(255, 34, 221, 221));
-
 	if (Driver)
 		Driver->grab();
 
@@ -218,8 +220,12 @@ CSceneManager::CSceneManager(video::IVideoDriver* driver, io::IFileSystem* fs,
 	else
 		MeshCache->grab();
 
+	// create the threads of the scene, shared by all of its users
+	Threads = new CThreadPool(0);
+	Parameters.addUserPointer(IRR_SCENE_MANAGER_THREAD_POOL, Threads);
+
 	// create collision manager
-	CollisionManager = new CSceneCollisionManager(this, Driver);
+	CollisionManager = new CSceneCollisionManager(this, Driver, Threads);
 
 	// create geometry creator
 	GeometryCreator = new CGeometryCreator();
@@ -360,12 +366,17 @@ CSceneManager::~CSceneManager()
 	if (LightManager)
 		LightManager->drop();
 
+	if (FrameLog)
+		FrameLog->drop();
+
 	// remove all nodes and animators before dropping the driver
 	// as render targets may be destroyed twice
 
 	removeAll();
 	removeAnimators();
 
+	delete Threads;
+
 	if (Driver)
 		Driver->drop();
 }
@@ -685,6 +696,41 @@ IMeshSceneNode* CSceneManager::addOctreeSceneNode(IMesh* mesh, ISceneNode* paren
 }
 
 
+//! Adds a scene node merging the geometry of static mesh scene nodes.
+IStaticBatchSceneNode* CSceneManager::addStaticBatchSceneNode(
+	const core::array<IMeshSceneNode*>& nodes, ISceneNode* parent,
+	s32 id, f32 chunkSize)
+{
+	if (!parent)
+		parent = this;
+
+	CStaticBatchSceneNode* node = new CStaticBatchSceneNode(parent, this, id, chunkSize);
+
+	for (u32 i=0; i<nodes.size(); ++i)
+		node->addSourceNode(nodes[i]);
+
+	node->batch();
+	node->drop();
+
+	return node;
+}
+
+
+//! Adds a scene node drawing a mesh many times with different transformations.
+IInstancedMeshSceneNode* CSceneManager::addInstancedMeshSceneNode(IMesh* mesh,
+	ISceneNode* parent, s32 id, const core::vector3df& position,
+	const core::vector3df& rotation, const core::vector3df& scale)
+{
+	if (!parent)
+		parent = this;
+
+	IInstancedMeshSceneNode* node = new CInstancedMeshSceneNode(mesh, parent, this, id, position, rotation, scale);
+	node->drop();
+
+	return node;
+}
+
+
 //! Adds a camera scene node to the tree and sets it as active camera.
 //! \param position: Position of the space relative to its parent where the camera will be placed.
 //! \param lookat: Position where the camera will look at. Also known as target.
@@ -1217,11 +1263,58 @@ bool CSceneManager::isCulled(const ISceneNode* node) const
 		}
 	}
 
+	// hidden behind the software occluders ?
+	if (!result && (node->getAutomaticCulling() & scene::EAC_OCC_SOFTWARE))
+	{
+		core::aabbox3d<f32> tbox = node->getBoundingBox();
+		node->getAbsoluteTransformation().transformBoxEx(tbox);
+		result = OcclusionCuller.isOccluded(tbox);
+	}
+
 	_IRR_IMPLEMENT_MANAGED_MARSHALLING_BUGFIX;
 	return result;
 }
 
 
+//! Adds an occluder for software occlusion culling.
+void CSceneManager::addOccluder(ISceneNode* node, const IMesh* mesh)
+{
+	if (!node)
+		return;
+
+	if (!mesh)
+	{
+		if (node->getType() == ESNT_MESH)
+			mesh = static_cast<IMeshSceneNode*>(node)->getMesh();
+		else if (node->getType() == ESNT_ANIMATED_MESH && static_cast<IAnimatedMeshSceneNode*>(node)->getMesh())
+			mesh = static_cast<IAnimatedMeshSceneNode*>(node)->getMesh()->getMesh(0);
+	}
+
+	OcclusionCuller.addOccluder(node, mesh);
+}
+
+
+//! Removes an occluder added with addOccluder().
+void CSceneManager::removeOccluder(ISceneNode* node)
+{
+	OcclusionCuller.removeOccluder(node);
+}
+
+
+//! Removes all occluders.
+void CSceneManager::removeAllOccluders()
+{
+	OcclusionCuller.removeAllOccluders();
+}
+
+
+//! Sets the resolution of the software occlusion depth buffer.
+void CSceneManager::setOcclusionBufferSize(const core::dimension2d<u32>& size)
+{
+	OcclusionCuller.setBufferSize(size);
+}
+
+
 //! registers a node for rendering it at a specific time.
 u32 CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDER_PASS pass)
 {
@@ -1323,16 +1416,9 @@ u32 CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDE
 		break;
 	}
 
-#ifdef _IRR_SCENEMANAGER_DEBUG
-	s32 index = Parameters.findAttribute ( "calls" );
-	Parameters.setAttribute ( index, Parameters.getAttributeAsInt ( index ) + 1 );
-
+	++Statistics.RegisterCalls;
 	if (!taken)
-	{
-		index = Parameters.findAttribute ( "culled" );
-		Parameters.setAttribute ( index, Parameters.getAttributeAsInt ( index ) + 1 );
-	}
-#endif
+		++Statistics.Culled;
 
 	return taken;
 }
@@ -1345,14 +1431,8 @@ void CSceneManager::drawAll()
 	if (!Driver)
 		return;
 
-#ifdef _IRR_SCENEMANAGER_DEBUG
-	// reset attributes
-	Parameters.setAttribute ( "culled", 0 );
-	Parameters.setAttribute ( "calls", 0 );
-	Parameters.setAttribute ( "drawn_solid", 0 );
-	Parameters.setAttribute ( "drawn_transparent", 0 );
-	Parameters.setAttribute ( "drawn_transparent_effect", 0 );
-#endif
+	Statistics.reset();
+	u32 time = os::Timer::getRealTime();
 
 	u32 i; // new ISO for scoping problem in some compilers
 
@@ -1370,6 +1450,10 @@ void CSceneManager::drawAll()
 	// do animations and other stuff.
 	OnAnimate(os::Timer::getTime());
 
+	u32 now = os::Timer::getRealTime();
+	Statistics.TimeAnimate = now - time;
+	time = now;
+
 	/*!
 		First Scene Node for prerendering should be the active camera
 		consistent Camera is needed for culling
@@ -1381,9 +1465,16 @@ void CSceneManager::drawAll()
 		camWorldPos = ActiveCamera->getAbsolutePosition();
 	}
 
+	// fill the occlusion buffer before the nodes are culled
+	OcclusionCuller.update(ActiveCamera, this);
+
 	// let all nodes register themselves
 	OnRegisterSceneNode();
 
+	now = os::Timer::getRealTime();
+	Statistics.TimeRegister = now - time;
+	time = now;
+
 	if (LightManager)
 		LightManager->OnPreRender(LightList);
 
@@ -1501,9 +1592,7 @@ void CSceneManager::drawAll()
 				SolidNodeList[i].Node->render();
 		}
 
-#ifdef _IRR_SCENEMANAGER_DEBUG
-		Parameters.setAttribute("drawn_solid", (s32) SolidNodeList.size() );
-#endif
+		Statistics.DrawnSolid = SolidNodeList.size();
 		SolidNodeList.set_used(0);
 
 		if (LightManager)
@@ -1536,6 +1625,7 @@ void CSceneManager::drawAll()
 			Driver->drawStencilShadow(true,ShadowColor, ShadowColor,
 				ShadowColor, ShadowColor);
 
+		Statistics.DrawnShadows = ShadowNodeList.size();
 		ShadowNodeList.set_used(0);
 
 		if (LightManager)
@@ -1566,9 +1656,7 @@ void CSceneManager::drawAll()
 				TransparentNodeList[i].Node->render();
 		}
 
-#ifdef _IRR_SCENEMANAGER_DEBUG
-		Parameters.setAttribute ( "drawn_transparent", (s32) TransparentNodeList.size() );
-#endif
+		Statistics.DrawnTransparent = TransparentNodeList.size();
 		TransparentNodeList.set_used(0);
 
 		if (LightManager)
@@ -1599,9 +1687,7 @@ void CSceneManager::drawAll()
 			for (i=0; i<TransparentEffectNodeList.size(); ++i)
 				TransparentEffectNodeList[i].Node->render();
 		}
-#ifdef _IRR_SCENEMANAGER_DEBUG
-		Parameters.setAttribute ( "drawn_transparent_effect", (s32) TransparentEffectNodeList.size() );
-#endif
+		Statistics.DrawnTransparentEffect = TransparentEffectNodeList.size();
 		TransparentEffectNodeList.set_used(0);
 	}
 
@@ -1612,8 +1698,95 @@ void CSceneManager::drawAll()
 	clearDeletionList();
 
 	CurrentRendertime = ESNRP_NONE;
+
+	Statistics.TimeRender = os::Timer::getRealTime() - time;
+
+	if (FrameLog)
+		writeFrameLog();
+}
+
+
+//! Returns the counters and timings of the last drawAll() call.
+const SSceneStatistics& CSceneManager::getFrameStatistics() const
+{
+	return Statistics;
+}
+
+
+//! Sets a file to which the statistics of each frame are appended.
+void CSceneManager::setFrameLog(io::IWriteFile* file)
+{
+	if (file)
+		file->grab();
+	if (FrameLog)
+		FrameLog->drop();
+
+	FrameLog = file;
+
+	if (FrameLog)
+	{
+		const c8 header[] = "calls;culled;solid;transparent;transparent_effect;shadows;"
+			"time_animate;time_register;time_render;draw_calls;primitives\n";
+		FrameLog->write(header, sizeof(header)-1);
+	}
 }
 
+
+//! Appends one line with the statistics of the frame to the frame log
+void CSceneManager::writeFrameLog()
+{
+	const video::SDriverStatistics& driverStats = Driver->getFrameStatistics();
+
+	core::stringc line;
+	line += Statistics.RegisterCalls;
+	line += ';';
+	line += Statistics.Culled;
+	line += ';';
+	line += Statistics.DrawnSolid;
+	line += ';';
+	line += Statistics.DrawnTransparent;
+	line += ';';
+	line += Statistics.DrawnTransparentEffect;
+	line += ';';
+	line += Statistics.DrawnShadows;
+	line += ';';
+	line += Statistics.TimeAnimate;
+	line += ';';
+	line += Statistics.TimeRegister;
+	line += ';';
+	line += Statistics.TimeRender;
+	line += ';';
+	line += driverStats.DrawCalls;
+	line += ';';
+	line += driverStats.PrimitivesDrawn;
+	line += '\n';
+
+	FrameLog->write(line.c_str(), line.size());
+}
+
+
+//! Sets length and color of the normals drawn for EDS_NORMALS.
+void CSceneManager::setDebugNormals(f32 length, video::SColor color)
+{
+	DebugNormalLength = length;
+	DebugNormalColor = color;
+}
+
+
+//! Returns the length of the normals drawn for EDS_NORMALS.
+f32 CSceneManager::getDebugNormalLength() const
+{
+	return DebugNormalLength;
+}
+
+
+//! Returns the color of the normals drawn for EDS_NORMALS.
+video::SColor CSceneManager::getDebugNormalColor() const
+{
+	return DebugNormalColor;
+}
+
+
 void CSceneManager::setLightManager(ILightManager* lightManager)
 {
 	if (lightManager)
@@ -1625,6 +1798,13 @@ void CSceneManager::setLightManager(ILightManager* lightManager)
 }
 
 
+//! Creates a light manager which switches on only the lights near each node.
+IClusteredLightManager* CSceneManager::createClusteredLightManager(f32 cellSize)
+{
+	return new CClusteredLightManager(this, cellSize);
+}
+
+
 //! Sets the color of stencil buffers shadows drawn by the scene manager.
 void CSceneManager::setShadowColor(video::SColor color)
 {
@@ -1796,12 +1976,13 @@ IMeshManipulator* CSceneManager::getMeshManipulator()
 
 
 //! Creates a simple ITriangleSelector, based on a mesh.
-ITriangleSelector* CSceneManager::createTriangleSelector(IMesh* mesh, ISceneNode* node)
+ITriangleSelector* CSceneManager::createTriangleSelector(IMesh* mesh, ISceneNode* node,
+							bool staticNode)
 {
 	if (!mesh)
 		return 0;
 
-	return new CTriangleSelector(mesh, node);
+	return new CTriangleSelector(mesh, node, staticNode);
 }
 
 
@@ -1828,12 +2009,34 @@ ITriangleSelector* CSceneManager::createTriangleSelectorFromBoundingBox(ISceneNo
 
 //! Creates a simple ITriangleSelector, based on a mesh.
 ITriangleSelector* CSceneManager::createOctreeTriangleSelector(IMesh* mesh,
-							ISceneNode* node, s32 minimalPolysPerNode)
+							ISceneNode* node, s32 minimalPolysPerNode, bool staticNode)
 {
 	if (!mesh)
 		return 0;
 
-	return new COctreeTriangleSelector(mesh, node, minimalPolysPerNode);
+	return new COctreeTriangleSelector(mesh, node, minimalPolysPerNode, staticNode, Threads);
+}
+
+
+//! Creates a triangle selector organized in a bounding volume hierarchy.
+ITriangleSelector* CSceneManager::createBVHTriangleSelector(IMesh* mesh,
+							ISceneNode* node, u32 maxTrianglesPerLeaf)
+{
+	if (!mesh)
+		return 0;
+
+	return new CBVHTriangleSelector(mesh, node, maxTrianglesPerLeaf);
+}
+
+
+//! Creates a triangle selector organized in a bounding volume hierarchy, following an animated mesh scene node.
+ITriangleSelector* CSceneManager::createBVHTriangleSelector(IAnimatedMeshSceneNode* node,
+							u32 maxTrianglesPerLeaf)
+{
+	if (!node || !node->getMesh())
+		return 0;
+
+	return new CBVHTriangleSelector(node, maxTrianglesPerLeaf);
 }
 
 
@@ -1990,6 +2193,7 @@ void CSceneManager::removeAll()
 {
 	ISceneNode::removeAll();
 	setActiveCamera(0);
+	OcclusionCuller.removeAllOccluders();
 	// Make sure the driver is reset, might need a more complex method at some point
 	if (Driver)
 		Driver->setMaterial(video::SMaterial());
@@ -13,9 +13,12 @@
 #include "IMeshLoader.h"
 #include "CAttributes.h"
 #include "ILightManager.h"
+#include "CSoftwareOcclusionCuller.h"
 
 namespace irr
 {
+class CThreadPool;
+
 namespace io
 {
 	class IXMLWriter;
@@ -26,6 +29,11 @@ namespace scene
 	class IMeshCache;
 	class IGeometryCreator;
 
+	//! Parameter of the scene manager holding the CThreadPool shared by its scene nodes
+	/** Scene nodes only know the ISceneManager interface, so they find
+	the threads through ISceneManager::getParameters(). */
+	const c8* const IRR_SCENE_MANAGER_THREAD_POOL = "IRR_ThreadPool";
+
 	/*!
 		The Scene Manager manages scene nodes, mesh recources, cameras and all the other stuff.
 	*/
@@ -125,6 +133,17 @@ namespace scene
 		virtual IMeshSceneNode* addOctreeSceneNode(IMesh* mesh, ISceneNode* parent=0,
 			s32 id=-1, s32 minimalPolysPerNode=128, bool alsoAddIfMeshPointerZero=false);
 
+		//! Adds a scene node merging the geometry of static mesh scene nodes.
+		virtual IStaticBatchSceneNode* addStaticBatchSceneNode(
+			const core::array<IMeshSceneNode*>& nodes, ISceneNode* parent=0,
+			s32 id=-1, f32 chunkSize=1000.f);
+
+		//! Adds a scene node drawing a mesh many times with different transformations.
+		virtual IInstancedMeshSceneNode* addInstancedMeshSceneNode(IMesh* mesh, ISceneNode* parent=0, s32 id=-1,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f));
+
 		//! Adds a camera scene node to the tree and sets it as active camera.
 		//! \param position: Position of the space relative to its parent where the camera will be placed.
 		//! \param lookat: Position where the camera will look at. Also known as target.
@@ -342,7 +361,8 @@ namespace scene
 
 
 		//! Creates a simple ITriangleSelector, based on a mesh.
-		virtual ITriangleSelector* createTriangleSelector(IMesh* mesh, ISceneNode* node);
+		virtual ITriangleSelector* createTriangleSelector(IMesh* mesh, ISceneNode* node,
+			bool staticNode);
 
 		//! Creates a simple ITriangleSelector, based on an animated mesh scene node.
 		//! Details of the mesh associated with the node will be extracted internally.
@@ -353,7 +373,15 @@ namespace scene
 
 		//! Creates a simple ITriangleSelector, based on a mesh.
 		virtual ITriangleSelector* createOctreeTriangleSelector(IMesh* mesh,
-			ISceneNode* node, s32 minimalPolysPerNode);
+			ISceneNode* node, s32 minimalPolysPerNode, bool staticNode);
+
+		//! Creates a triangle selector organized in a bounding volume hierarchy.
+		virtual ITriangleSelector* createBVHTriangleSelector(IMesh* mesh,
+			ISceneNode* node, u32 maxTrianglesPerLeaf);
+
+		//! Creates a triangle selector organized in a bounding volume hierarchy, following an animated mesh scene node.
+		virtual ITriangleSelector* createBVHTriangleSelector(IAnimatedMeshSceneNode* node,
+			u32 maxTrianglesPerLeaf);
 
 		//! Creates a simple dynamic ITriangleSelector, based on a axis aligned bounding box.
 		virtual ITriangleSelector* createTriangleSelectorFromBoundingBox(
@@ -509,6 +537,9 @@ namespace scene
 		//! Register a custom callbacks manager which gets callbacks during scene rendering.
 		virtual void setLightManager(ILightManager* lightManager);
 
+		//! Creates a light manager which switches on only the lights near each node.
+		virtual IClusteredLightManager* createClusteredLightManager(f32 cellSize=100.f);
+
 		//! Get current render time.
 		virtual E_SCENE_NODE_RENDER_PASS getCurrentRendertime() const { return CurrentRendertime; }
 
@@ -521,11 +552,41 @@ namespace scene
 		//! returns if node is culled
 		virtual bool isCulled(const ISceneNode* node) const;
 
+		//! Adds an occluder for software occlusion culling.
+		virtual void addOccluder(ISceneNode* node, const IMesh* mesh=0);
+
+		//! Removes an occluder added with addOccluder().
+		virtual void removeOccluder(ISceneNode* node);
+
+		//! Removes all occluders.
+		virtual void removeAllOccluders();
+
+		//! Sets the resolution of the software occlusion depth buffer.
+		virtual void setOcclusionBufferSize(const core::dimension2d<u32>& size);
+
+		//! Returns the counters and timings of the last drawAll() call.
+		virtual const SSceneStatistics& getFrameStatistics() const;
+
+		//! Sets a file to which the statistics of each frame are appended.
+		virtual void setFrameLog(io::IWriteFile* file);
+
+		//! Sets length and color of the normals drawn for EDS_NORMALS.
+		virtual void setDebugNormals(f32 length, video::SColor color);
+
+		//! Returns the length of the normals drawn for EDS_NORMALS.
+		virtual f32 getDebugNormalLength() const;
+
+		//! Returns the color of the normals drawn for EDS_NORMALS.
+		virtual video::SColor getDebugNormalColor() const;
+
 	private:
 
 		//! clears the deletion list
 		void clearDeletionList();
 
+		//! appends the statistics of the frame to the frame log
+		void writeFrameLog();
+
 		//! writes a scene node
 		void writeSceneNode(io::IXMLWriter* writer, ISceneNode* node, ISceneUserDataSerializer* userDataSerializer, const fschar_t* currentPath=0, bool init=false);
 
@@ -608,6 +669,10 @@ namespace scene
 		//! collision manager
 		ISceneCollisionManager* CollisionManager;
 
+		//! threads shared by the collision manager, the octree selectors
+		//! and the shadow volumes, started by the first job
+		CThreadPool* Threads;
+
 		//! render pass lists
 		core::array<ISceneNode*> CameraList;
 		core::array<ISceneNode*> LightList;
@@ -643,6 +708,16 @@ namespace scene
 		//! over the scene lighting and rendering.
 		ILightManager* LightManager;
 
+		//! cpu depth buffer of the occluders for EAC_OCC_SOFTWARE
+		CSoftwareOcclusionCuller OcclusionCuller;
+
+		//! counters and timings of the last drawAll
+		SSceneStatistics Statistics;
+		io::IWriteFile* FrameLog;
+
+		f32 DebugNormalLength;
+		video::SColor DebugNormalColor;
+
 		//! constants for reading and writing XML.
 		//! Not made static due to portability problems.
 		const core::stringw IRR_XML_FORMAT_SCENE;
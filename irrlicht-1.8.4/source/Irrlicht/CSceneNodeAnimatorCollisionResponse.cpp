@@ -25,7 +25,7 @@ CSceneNodeAnimatorCollisionResponse::CSceneNodeAnimatorCollisionResponse(
 	World(world), Object(object), SceneManager(scenemanager), LastTime(0),
 	SlidingSpeed(slidingSpeed), CollisionNode(0), CollisionCallback(0),
 	Falling(false), IsCamera(false), AnimateCameraTarget(true), CollisionOccurred(false),
-	FirstUpdate(true)
+	FirstUpdate(true), UseCache(false)
 {
 	#ifdef _DEBUG
 	setDebugName("CSceneNodeAnimatorCollisionResponse");
@@ -125,6 +125,7 @@ void CSceneNodeAnimatorCollisionResponse::setWorld(ITriangleSelector* newWorld)
 		World->drop();
 
 	World = newWorld;
+	Cache.clear();
 
 	FirstUpdate = true;
 }
@@ -138,6 +139,21 @@ ITriangleSelector* CSceneNodeAnimatorCollisionResponse::getWorld() const
 }
 
 
+//! Sets whether the triangles around the scene node are kept between frames.
+void CSceneNodeAnimatorCollisionResponse::setWorldCache(bool enable)
+{
+	UseCache = enable;
+	Cache.clear();
+}
+
+
+//! Returns whether the triangles around the scene node are kept between frames.
+bool CSceneNodeAnimatorCollisionResponse::getWorldCache() const
+{
+	return UseCache;
+}
+
+
 void CSceneNodeAnimatorCollisionResponse::animateNode(ISceneNode* node, u32 timeMs)
 {
 	CollisionOccurred = false;
@@ -184,12 +200,20 @@ void CSceneNodeAnimatorCollisionResponse::animateNode(ISceneNode* node, u32 time
 	{
 		// TODO: divide SlidingSpeed by frame time
 
+		// selectors without a fixed box change with each frame, their
+		// triangles can't be kept
+		core::aabbox3d<f32> worldBox;
+		const bool useCache = UseCache && World && World->getTransformedBoundingBox(worldBox);
+		if (UseCache && !useCache)
+			Cache.clear();
+
 		bool f = false;
 		CollisionResultPosition
 			= SceneManager->getSceneCollisionManager()->getCollisionResultPosition(
 				World, LastPosition-Translation,
 				Radius, vel, CollisionTriangle, CollisionPoint, f,
-				CollisionNode, SlidingSpeed, FallingVelocity);
+				CollisionNode, SlidingSpeed, FallingVelocity,
+				useCache ? &Cache : 0);
 
 		CollisionOccurred = (CollisionTriangle != RefTriangle);
 
@@ -247,6 +271,7 @@ void CSceneNodeAnimatorCollisionResponse::serializeAttributes(io::IAttributes* o
 	out->addVector3d("Gravity", Gravity);
 	out->addVector3d("Translation", Translation);
 	out->addBool("AnimateCameraTarget", AnimateCameraTarget);
+	out->addBool("WorldCache", UseCache);
 }
 
 
@@ -257,6 +282,7 @@ void CSceneNodeAnimatorCollisionResponse::deserializeAttributes(io::IAttributes*
 	Gravity = in->getAttributeAsVector3d("Gravity");
 	Translation = in->getAttributeAsVector3d("Translation");
 	AnimateCameraTarget = in->getAttributeAsBool("AnimateCameraTarget");
+	setWorldCache(in->existsAttribute("WorldCache") ? in->getAttributeAsBool("WorldCache") : false);
 }
 
 
@@ -267,6 +293,7 @@ ISceneNodeAnimator* CSceneNodeAnimatorCollisionResponse::createClone(ISceneNode*
 	CSceneNodeAnimatorCollisionResponse * newAnimator =
 		new CSceneNodeAnimatorCollisionResponse(newManager, World, Object, Radius,
 				(Gravity * 1000.0f), Translation, SlidingSpeed);
+	newAnimator->setWorldCache(UseCache);
 
 	return newAnimator;
 }
@@ -6,6 +6,7 @@
 #define __C_SCENE_NODE_ANIMATOR_COLLISION_RESPONSE_H_INCLUDED__
 
 #include "ISceneNodeAnimatorCollisionResponse.h"
+#include "ISceneCollisionManager.h"
 
 namespace irr
 {
@@ -75,6 +76,12 @@ namespace scene
 		//! collision detection.
 		virtual ITriangleSelector* getWorld() const;
 
+		//! Sets whether the triangles around the scene node are kept between frames.
+		virtual void setWorldCache(bool enable);
+
+		//! Returns whether the triangles around the scene node are kept between frames.
+		virtual bool getWorldCache() const;
+
 		//! animates a scene node
 		virtual void animateNode(ISceneNode* node, u32 timeMs);
 
@@ -143,11 +150,14 @@ namespace scene
 		ISceneNode * CollisionNode;
 		ICollisionCallback* CollisionCallback;
 
+		SCollisionCache Cache;
+
 		bool Falling;
 		bool IsCamera;
 		bool AnimateCameraTarget;
 		bool CollisionOccurred;
 		bool FirstUpdate;
+		bool UseCache;
 	};
 
 } // end namespace scene
@@ -3,12 +3,14 @@
 // For conditions of distribution and use, see copyright notice in irrlicht.h
 
 #include "CShadowVolumeSceneNode.h"
-#include "ISceneManager.h"
+#include "CSceneManager.h"
 #include "IMesh.h"
 #include "IVideoDriver.h"
 #include "ICameraSceneNode.h"
 #include "SViewFrustum.h"
 #include "SLight.h"
+#include "CThreadPool.h"
+#include "CVertexWelder.h"
 #include "os.h"
 
 namespace irr
@@ -16,13 +18,106 @@ namespace irr
 namespace scene
 {
 
+namespace
+{
+	//! meshes with less faces build their shadow volumes on the calling thread
+	const u32 SHADOW_VOLUME_MIN_THREADED_FACES = 2048;
+
+	//! Positions of the shadow mesh as seen by weldVertices()
+	struct SWeldPositions
+	{
+		SWeldPositions(const core::array<core::vector3df>& positions)
+			: Positions(positions) {}
+
+		const core::vector3df& getPosition(u32 i) const
+		{
+			return Positions[i];
+		}
+
+		bool isWeldable(u32 i, u32 j) const
+		{
+			return Positions[i].equals(Positions[j]);
+		}
+
+		const core::array<core::vector3df>& Positions;
+	};
+
+	//! Returns the index of the next vertex of the face, from index i
+	inline u32 getNextInFace(u32 i)
+	{
+		return i % 3 == 2 ? i - 2 : i + 1;
+	}
+
+	//! Returns the position ids at the ends of the edge from index i to the next one, ordered
+	inline void getEdgeIds(const core::array<u32>& indices, const core::array<u32>& ids,
+			u32 i, u32& low, u32& high)
+	{
+		const u32 a = ids[indices[i]];
+		const u32 b = ids[indices[getNextInFace(i)]];
+		low = core::min_(a, b);
+		high = core::max_(a, b);
+	}
+
+	//! Returns the first index of a face starting an edge, whose adjacent face is adjacentFace
+	u32 findEdge(const core::array<u32>& indices, const core::array<u32>& ids,
+			const core::array<u32>& adjacency, u32 face, u32 low, u32 high, u32 adjacentFace)
+	{
+		for (u32 i=face*3; i<face*3+3; ++i)
+		{
+			u32 l, h;
+			getEdgeIds(indices, ids, i, l, h);
+			if (l == low && h == high && adjacency[i] == adjacentFace)
+				return i;
+		}
+		return 0xffffffff;
+	}
+
+	//! Moves every position away from the light to where the shadow volume is closed
+	/** Same as v+(v-light).normalize()*infinity, but done once per position
+	in one tight loop instead of once per face corner and silhouette edge. */
+	void extrudePositions(const core::vector3df* positions, u32 count,
+			const core::vector3df& light, f32 infinity, core::vector3df* extruded)
+	{
+		for (u32 i=0; i<count; ++i)
+		{
+			const f32 x = positions[i].X - light.X;
+			const f32 y = positions[i].Y - light.Y;
+			const f32 z = positions[i].Z - light.Z;
+			const f64 length = x*x + y*y + z*z;
+			const f64 scale = length == 0 ? 1.0 : core::reciprocal_squareroot(length);
+			extruded[i].X = positions[i].X + (f32)(x * scale) * infinity;
+			extruded[i].Y = positions[i].Y + (f32)(y * scale) * infinity;
+			extruded[i].Z = positions[i].Z + (f32)(z * scale) * infinity;
+		}
+	}
+}
+
+
+//! Builds interleaved dirty shadow volumes on each thread of the pool
+class CShadowVolumeSceneNode::CShadowVolumeJob : public CThreadPool::IJob
+{
+public:
+	CShadowVolumeJob(CShadowVolumeSceneNode* node, u32 threadCount)
+		: Node(node), ThreadCount(threadCount) {}
+
+	virtual void run(u32 thread)
+	{
+		for (u32 i=thread; i<Node->DirtyVolumes.size(); i+=ThreadCount)
+			Node->createShadowVolume(Node->DirtyVolumes[i], Node->Scratch[thread]);
+	}
+
+private:
+	CShadowVolumeSceneNode* Node;
+	u32 ThreadCount;
+};
+
 
 //! constructor
 CShadowVolumeSceneNode::CShadowVolumeSceneNode(const IMesh* shadowMesh, ISceneNode* parent,
 		ISceneManager* mgr, s32 id, bool zfailmethod, f32 infinity)
 : IShadowVolumeSceneNode(parent, mgr, id),
 	ShadowMesh(0), IndexCount(0), VertexCount(0), ShadowVolumesUsed(0),
-	Infinity(infinity), UseZFailMethod(zfailmethod)
+	MeshFrame(1), Infinity(infinity), UseZFailMethod(zfailmethod)
 {
 	#ifdef _DEBUG
 	setDebugName("CShadowVolumeSceneNode");
@@ -40,59 +135,42 @@ CShadowVolumeSceneNode::~CShadowVolumeSceneNode()
 }
 
 
-void CShadowVolumeSceneNode::createShadowVolume(const core::vector3df& light, bool isDirectional)
+void CShadowVolumeSceneNode::createShadowVolume(u32 volume, SShadowVolumeScratch& scratch)
 {
-	SShadowVolume* svp = 0;
-	core::aabbox3d<f32>* bb = 0;
-
-	// builds the shadow volume and adds it to the shadow volume list.
-
-	if (ShadowVolumes.size() > ShadowVolumesUsed)
-	{
-		// get the next unused buffer
+	const core::vector3df& light = ShadowKeys[volume].Light;
+	SShadowVolume* svp = &ShadowVolumes[volume];
+	core::aabbox3d<f32>* bb = &ShadowBBox[volume];
 
-		svp = &ShadowVolumes[ShadowVolumesUsed];
-		svp->set_used(0);
-
-		bb = &ShadowBBox[ShadowVolumesUsed];
-	}
-	else
-	{
-		ShadowVolumes.push_back(SShadowVolume());
-		svp = &ShadowVolumes.getLast();
-
-		ShadowBBox.push_back(core::aabbox3d<f32>());
-		bb = &ShadowBBox.getLast();
-	}
-	svp->reallocate(IndexCount*5);
-	++ShadowVolumesUsed;
+	// builds the shadow volume in its slot of the shadow volume list.
+	scratch.Extruded.set_used(VertexCount);
+	extrudePositions(Vertices.const_pointer(), VertexCount, light, Infinity,
+		scratch.Extruded.pointer());
 
 	// We use triangle lists
-	Edges.set_used(IndexCount*2);
-	u32 numEdges = 0;
+	scratch.Edges.set_used(IndexCount*2);
+	scratch.FaceData.set_used(IndexCount / 3);
+	const u32 numEdges = createEdgesAndCaps(light, svp, bb, scratch);
 
-	numEdges=createEdgesAndCaps(light, svp, bb);
+	const u32* edges = scratch.Edges.const_pointer();
+	const core::vector3df* extruded = scratch.Extruded.const_pointer();
 
-	// for all edges add the near->far quads
-	for (u32 i=0; i<numEdges; ++i)
+	// for all edges add the near->far quads, behind the caps
+	core::vector3df* quad = svp->pointer() + svp->size() - numEdges*6;
+	for (u32 i=0; i<numEdges; ++i, quad+=6)
 	{
-		const core::vector3df &v1 = Vertices[Edges[2*i+0]];
-		const core::vector3df &v2 = Vertices[Edges[2*i+1]];
-		const core::vector3df v3(v1+(v1 - light).normalize()*Infinity);
-		const core::vector3df v4(v2+(v2 - light).normalize()*Infinity);
+		const core::vector3df &v1 = Vertices[edges[2*i+0]];
+		const core::vector3df &v2 = Vertices[edges[2*i+1]];
+		const core::vector3df &v3 = extruded[edges[2*i+0]];
+		const core::vector3df &v4 = extruded[edges[2*i+1]];
 
 		// Add a quad (two triangles) to the vertex list
-#ifdef _DEBUG
-		if (svp->size() >= svp->allocated_size()-5)
-			os::Printer::log("Allocation too small.", ELL_DEBUG);
-#endif
-		svp->push_back(v1);
-		svp->push_back(v2);
-		svp->push_back(v3);
+		quad[0] = v1;
+		quad[1] = v2;
+		quad[2] = v3;
 
-		svp->push_back(v2);
-		svp->push_back(v4);
-		svp->push_back(v3);
+		quad[3] = v2;
+		quad[4] = v4;
+		quad[5] = v3;
 	}
 }
 
@@ -101,10 +179,13 @@ void CShadowVolumeSceneNode::createShadowVolume(const core::vector3df& light, bo
 #define IRR_USE_REVERSE_EXTRUDED
 
 u32 CShadowVolumeSceneNode::createEdgesAndCaps(const core::vector3df& light,
-					SShadowVolume* svp, core::aabbox3d<f32>* bb)
+					SShadowVolume* svp, core::aabbox3d<f32>* bb,
+					SShadowVolumeScratch& scratch)
 {
 	u32 numEdges=0;
 	const u32 faceCount = IndexCount / 3;
+	bool* faceData = scratch.FaceData.pointer();
+	u32* edges = scratch.Edges.pointer();
 
 	if(faceCount >= 1)
 		bb->reset(Vertices[Indices[0]]);
@@ -112,6 +193,7 @@ u32 CShadowVolumeSceneNode::createEdgesAndCaps(const core::vector3df& light,
 		bb->reset(0,0,0);
 
 	// Check every face if it is front or back facing the light.
+	u32 frontFaces = 0;
 	for (u32 i=0; i<faceCount; ++i)
 	{
 		const core::vector3df v0 = Vertices[Indices[3*i+0]];
@@ -119,83 +201,70 @@ u32 CShadowVolumeSceneNode::createEdgesAndCaps(const core::vector3df& light,
 		const core::vector3df v2 = Vertices[Indices[3*i+2]];
 
 #ifdef IRR_USE_REVERSE_EXTRUDED
-		FaceData[i]=core::triangle3df(v0,v1,v2).isFrontFacing(light);
+		faceData[i]=core::triangle3df(v0,v1,v2).isFrontFacing(light);
 #else
-		FaceData[i]=core::triangle3df(v2,v1,v0).isFrontFacing(light);
-#endif
-
-		if (UseZFailMethod && FaceData[i])
-		{
-#ifdef _DEBUG
-			if (svp->size() >= svp->allocated_size()-5)
-				os::Printer::log("Allocation too small.", ELL_DEBUG);
+		faceData[i]=core::triangle3df(v2,v1,v0).isFrontFacing(light);
 #endif
-			// add front cap from light-facing faces
-			svp->push_back(v2);
-			svp->push_back(v1);
-			svp->push_back(v0);
-
-			// add back cap
-			const core::vector3df i0 = v0+(v0-light).normalize()*Infinity;
-			const core::vector3df i1 = v1+(v1-light).normalize()*Infinity;
-			const core::vector3df i2 = v2+(v2-light).normalize()*Infinity;
-
-			svp->push_back(i0);
-			svp->push_back(i1);
-			svp->push_back(i2);
-
-			bb->addInternalPoint(i0);
-			bb->addInternalPoint(i1);
-			bb->addInternalPoint(i2);
-		}
+		if (faceData[i])
+			++frontFaces;
 	}
 
-	// Create edges
-	for (u32 i=0; i<faceCount; ++i)
+	// Create edges where a front facing face meets a back facing one,
+	// or at the open borders of front facing faces
+	const u32 edgeCount = AdjacentEdges.size();
+	for (u32 i=0; i<edgeCount; ++i)
 	{
-		// check all front facing faces
-		if (FaceData[i] == true)
-		{
-			const u16 wFace0 = Indices[3*i+0];
-			const u16 wFace1 = Indices[3*i+1];
-			const u16 wFace2 = Indices[3*i+2];
-
-			const u16 adj0 = Adjacency[3*i+0];
-			const u16 adj1 = Adjacency[3*i+1];
-			const u16 adj2 = Adjacency[3*i+2];
+		const SAdjacentEdge& edge = AdjacentEdges[i];
+		const bool front0 = faceData[edge.Face[0]];
+		const bool front1 = faceData[edge.Face[1]];
+
+		u32 side;
+		if (front0 && (!front1 || edge.Face[0] == edge.Face[1]))
+			side = 0;
+		else if (edge.Shared && front1 && !front0)
+			side = 1;
+		else
+			continue;
 
-			// add edges if face is adjacent to back-facing face
-			// or if no adjacent face was found
-#ifdef IRR_USE_ADJACENCY
-			if (adj0 == i || FaceData[adj0] == false)
-#endif
-			{
-				// add edge v0-v1
-				Edges[2*numEdges+0] = wFace0;
-				Edges[2*numEdges+1] = wFace1;
-				++numEdges;
-			}
+		edges[2*numEdges+0] = edge.Vertex[side][0];
+		edges[2*numEdges+1] = edge.Vertex[side][1];
+		++numEdges;
+	}
 
-#ifdef IRR_USE_ADJACENCY
-			if (adj1 == i || FaceData[adj1] == false)
-#endif
-			{
-				// add edge v1-v2
-				Edges[2*numEdges+0] = wFace1;
-				Edges[2*numEdges+1] = wFace2;
-				++numEdges;
-			}
+	// room for the caps and the quads of all edges
+	if (!UseZFailMethod)
+		frontFaces = 0;
+	svp->set_used(frontFaces*6 + numEdges*6);
 
-#ifdef IRR_USE_ADJACENCY
-			if (adj2 == i || FaceData[adj2] == false)
-#endif
-			{
-				// add edge v2-v0
-				Edges[2*numEdges+0] = wFace2;
-				Edges[2*numEdges+1] = wFace0;
-				++numEdges;
-			}
-		}
+	const core::vector3df* extruded = scratch.Extruded.const_pointer();
+	core::vector3df* cap = svp->pointer();
+	for (u32 i=0; i<faceCount && frontFaces; ++i)
+	{
+		if (!faceData[i])
+			continue;
+
+		const core::vector3df& v0 = Vertices[Indices[3*i+0]];
+		const core::vector3df& v1 = Vertices[Indices[3*i+1]];
+		const core::vector3df& v2 = Vertices[Indices[3*i+2]];
+
+		// add front cap from light-facing faces
+		cap[0] = v2;
+		cap[1] = v1;
+		cap[2] = v0;
+
+		// add back cap
+		const core::vector3df& i0 = extruded[Indices[3*i+0]];
+		const core::vector3df& i1 = extruded[Indices[3*i+1]];
+		const core::vector3df& i2 = extruded[Indices[3*i+2]];
+
+		cap[3] = i0;
+		cap[4] = i1;
+		cap[5] = i2;
+		cap += 6;
+
+		bb->addInternalPoint(i0);
+		bb->addInternalPoint(i1);
+		bb->addInternalPoint(i2);
 	}
 	return numEdges;
 }
@@ -203,11 +272,15 @@ u32 CShadowVolumeSceneNode::createEdgesAndCaps(const core::vector3df& light,
 
 void CShadowVolumeSceneNode::setShadowMesh(const IMesh* mesh)
 {
+	// the adjacency is kept as long as the mesh stays the same
 	if (ShadowMesh == mesh)
 		return;
 	if (ShadowMesh)
 		ShadowMesh->drop();
 	ShadowMesh = mesh;
+	IndexCount = 0;
+	VertexCount = 0;
+	AdjacentEdges.clear();
 	if (ShadowMesh)
 	{
 		ShadowMesh->grab();
@@ -253,32 +326,68 @@ void CShadowVolumeSceneNode::updateShadowVolumes()
 
 	Vertices.set_used(totalVertices);
 	Indices.set_used(totalIndices);
-	FaceData.set_used(totalIndices / 3);
 
-	// copy mesh
+	// copy mesh, noting whether it changed since the last update
+	bool meshChanged = oldVertexCount != totalVertices || oldIndexCount != totalIndices;
 	for (i=0; i<bufcnt; ++i)
 	{
 		const IMeshBuffer* buf = mesh->getMeshBuffer(i);
 
-		const u16* idxp = buf->getIndices();
-		const u16* idxpend = idxp + buf->getIndexCount();
-		for (; idxp!=idxpend; ++idxp)
-			Indices[IndexCount++] = *idxp + VertexCount;
+		const u32 idxcnt = buf->getIndexCount();
+		if (buf->getIndexType() == video::EIT_32BIT)
+		{
+			const u32* idxp = (const u32*)buf->getIndices();
+			for (u32 j=0; j<idxcnt; ++j, ++IndexCount)
+			{
+				const u32 index = idxp[j] + VertexCount;
+				if (Indices[IndexCount] != index)
+				{
+					Indices[IndexCount] = index;
+					meshChanged = true;
+				}
+			}
+		}
+		else
+		{
+			const u16* idxp = buf->getIndices();
+			for (u32 j=0; j<idxcnt; ++j, ++IndexCount)
+			{
+				const u32 index = idxp[j] + VertexCount;
+				if (Indices[IndexCount] != index)
+				{
+					Indices[IndexCount] = index;
+					meshChanged = true;
+				}
+			}
+		}
 
 		const u32 vtxcnt = buf->getVertexCount();
-		for (u32 j=0; j<vtxcnt; ++j)
-			Vertices[VertexCount++] = buf->getPosition(j);
+		for (u32 j=0; j<vtxcnt; ++j, ++VertexCount)
+		{
+			const core::vector3df& pos = buf->getPosition(j);
+			core::vector3df& copy = Vertices[VertexCount];
+			if (copy.X != pos.X || copy.Y != pos.Y || copy.Z != pos.Z)
+			{
+				copy = pos;
+				meshChanged = true;
+			}
+		}
 	}
 
 	// recalculate adjacency if necessary
 	if (oldVertexCount != VertexCount || oldIndexCount != IndexCount)
 		calculateAdjacency();
 
+	// volumes built before a change of the mesh are outdated
+	if (meshChanged)
+		++MeshFrame;
+
 	core::matrix4 mat = Parent->getAbsoluteTransformation();
 	mat.makeInverse();
 	const core::vector3df parentpos = Parent->getAbsolutePosition();
 
 	// TODO: Only correct for point lights.
+	DirtyVolumes.set_used(0);
 	for (i=0; i<lightCount; ++i)
 	{
 		const video::SLight& dl = SceneManager->getVideoDriver()->getDynamicLight(i);
@@ -287,9 +396,56 @@ void CShadowVolumeSceneNode::updateShadowVolumes()
 			fabs((lpos - parentpos).getLengthSQ()) <= (dl.Radius*dl.Radius*4.0f))
 		{
 			mat.transformVect(lpos);
-			createShadowVolume(lpos);
+
+			if (ShadowVolumes.size() == ShadowVolumesUsed)
+			{
+				ShadowVolumes.push_back(SShadowVolume());
+				ShadowBBox.push_back(core::aabbox3d<f32>());
+				SShadowVolumeKey key;
+				key.MeshFrame = MeshFrame - 1;
+				ShadowKeys.push_back(key);
+			}
+
+			// the volume of the last update is kept if neither the
+			// light nor the mesh moved since
+			SShadowVolumeKey& key = ShadowKeys[ShadowVolumesUsed];
+			if (key.MeshFrame != MeshFrame || key.Light.X != lpos.X ||
+				key.Light.Y != lpos.Y || key.Light.Z != lpos.Z)
+			{
+				key.Light = lpos;
+				key.MeshFrame = MeshFrame;
+				DirtyVolumes.push_back(ShadowVolumesUsed);
+			}
+			++ShadowVolumesUsed;
 		}
 	}
+
+	const u32 dirtyCount = DirtyVolumes.size();
+	if (!dirtyCount)
+		return;
+
+	if (dirtyCount > 1 && IndexCount / 3 >= SHADOW_VOLUME_MIN_THREADED_FACES &&
+		CThreadPool::getProcessorCount() > 1)
+	{
+		// all shadows of the scene manager share its threads
+		CThreadPool* threads = (CThreadPool*) SceneManager->getParameters()->
+			getAttributeAsUserPointer(IRR_SCENE_MANAGER_THREAD_POOL);
+		if (threads)
+		{
+			const u32 threadCount = threads->getThreadCount();
+			while (Scratch.size() < threadCount)
+				Scratch.push_back(SShadowVolumeScratch());
+
+			CShadowVolumeJob job(this, threadCount);
+			threads->run(&job);
+			return;
+		}
+	}
+
+	if (Scratch.empty())
+		Scratch.push_back(SShadowVolumeScratch());
+	for (i=0; i<dirtyCount; ++i)
+		createShadowVolume(DirtyVolumes[i], Scratch[0]);
 }
 
 
@@ -369,48 +525,128 @@ const core::aabbox3d<f32>& CShadowVolumeSceneNode::getBoundingBox() const
 //! Generates adjacency information based on mesh indices.
 void CShadowVolumeSceneNode::calculateAdjacency()
 {
-	Adjacency.set_used(IndexCount);
+	AdjacentEdges.set_used(0);
+
+	const u32 edgeCount = IndexCount / 3 * 3;
+	if (!edgeCount)
+		return;
+
+	// equal positions get the same id, so faces around duplicated
+	// vertices are adjacent like faces around shared ones
+	core::array<u32> ids;
+	weldVertices(SWeldPositions(Vertices), VertexCount, core::ROUNDING_ERROR_f32, ids);
+
+	// hash of the edges, with the faces of an edge in ascending order
+	u32 tableSize = 1;
+	while (tableSize < edgeCount * 2)
+		tableSize <<= 1;
+	const u32 mask = tableSize - 1;
+
+	core::array<u32> first;
+	first.set_used(tableSize);
+	memset(first.pointer(), 0xff, tableSize * sizeof(u32));
+	core::array<u32> last;
+	last.set_used(tableSize);
+	core::array<u32> next;
+	next.set_used(edgeCount);
+
+	u32 i;
+	u32 low, high;
+	for (i=0; i<edgeCount; ++i)
+	{
+		getEdgeIds(Indices, ids, i, low, high);
+		const u32 bucket = (low * 73856093u ^ high * 19349663u) & mask;
+
+		next[i] = 0xffffffff;
+		if (first[bucket] == 0xffffffff)
+			first[bucket] = i;
+		else
+			next[last[bucket]] = i;
+		last[bucket] = i;
+	}
 
-	// go through all faces and fetch their three neighbours
-	for (u32 f=0; f<IndexCount; f+=3)
+	// the first two faces at each position, for collapsed edges
+	core::array<u32> positionFaces;
+	positionFaces.set_used(VertexCount * 2);
+	memset(positionFaces.pointer(), 0xff, VertexCount * 2 * sizeof(u32));
+	for (i=0; i<edgeCount; ++i)
 	{
-		for (u32 edge = 0; edge<3; ++edge)
-		{
-			const core::vector3df& v1 = Vertices[Indices[f+edge]];
-			const core::vector3df& v2 = Vertices[Indices[f+((edge+1)%3)]];
+		u32* const faces = &positionFaces[ids[Indices[i]] * 2];
+		if (faces[0] == 0xffffffff)
+			faces[0] = i / 3;
+		else if (faces[1] == 0xffffffff && faces[0] != i / 3)
+			faces[1] = i / 3;
+	}
+
+	// the adjacent face at each edge is the first other face with it,
+	// or the face itself if there is none
+	core::array<u32> adjacency;
+	adjacency.set_used(edgeCount);
+	for (i=0; i<edgeCount; ++i)
+	{
+		const u32 face = i / 3;
+		adjacency[i] = face;
 
-			// now we search an_O_ther _F_ace with these two
-			// vertices, which is not the current face.
-			u32 of;
+#ifdef IRR_USE_ADJACENCY
+		getEdgeIds(Indices, ids, i, low, high);
+		if (low == high)
+		{
+			// an edge collapsed to one position borders every other
+			// face at that position
+			const u32* const faces = &positionFaces[low * 2];
+			const u32 other = faces[0] != face ? faces[0] : faces[1];
+			if (other != 0xffffffff)
+				adjacency[i] = other;
+			continue;
+		}
 
-			for (of=0; of<IndexCount; of+=3)
+		const u32 bucket = (low * 73856093u ^ high * 19349663u) & mask;
+		for (u32 j=first[bucket]; j!=0xffffffff; j=next[j])
+		{
+			u32 l, h;
+			getEdgeIds(Indices, ids, j, l, h);
+			if (j / 3 != face && l == low && h == high)
 			{
-				// only other faces
-				if (of != f)
-				{
-					bool cnt1 = false;
-					bool cnt2 = false;
-
-					for (s32 e=0; e<3; ++e)
-					{
-						if (v1.equals(Vertices[Indices[of+e]]))
-							cnt1=true;
-
-						if (v2.equals(Vertices[Indices[of+e]]))
-							cnt2=true;
-					}
-					// one match for each vertex, i.e. edge is the same
-					if (cnt1 && cnt2)
-						break;
-				}
+				adjacency[i] = j / 3;
+				break;
 			}
+		}
+#endif
+	}
+
+	// one entry for each edge, faces which are adjacent to each other
+	// share the entry of their common edge
+	AdjacentEdges.reallocate(edgeCount);
+	for (i=0; i<edgeCount; ++i)
+	{
+		const u32 face = i / 3;
+		const u32 adjacentFace = adjacency[i];
+
+		SAdjacentEdge edge;
+		edge.Face[0] = face;
+		edge.Face[1] = adjacentFace;
+		edge.Vertex[0][0] = Indices[i];
+		edge.Vertex[0][1] = Indices[getNextInFace(i)];
+		edge.Vertex[1][0] = edge.Vertex[0][0];
+		edge.Vertex[1][1] = edge.Vertex[0][1];
+		edge.Shared = false;
+
+		if (adjacentFace != face)
+		{
+			getEdgeIds(Indices, ids, i, low, high);
+			const u32 j = findEdge(Indices, ids, adjacency, adjacentFace, low, high, face);
+			if (j != 0xffffffff && findEdge(Indices, ids, adjacency, face, low, high, adjacentFace) == i)
+			{
+				if (adjacentFace < face)
+					continue; // the entry of the adjacent face has this edge
 
-			// no adjacent edges -> store face number, else store adjacent face
-			if (of >= IndexCount)
-				Adjacency[f + edge] = f/3;
-			else
-				Adjacency[f + edge] = of/3;
+				edge.Vertex[1][0] = Indices[j];
+				edge.Vertex[1][1] = Indices[getNextInFace(j)];
+				edge.Shared = true;
+			}
 		}
+
+		AdjacentEdges.push_back(edge);
 	}
 }
 
@@ -49,12 +49,49 @@ namespace scene
 
 		typedef core::array<core::vector3df> SShadowVolume;
 
-		void createShadowVolume(const core::vector3df& pos, bool isDirectional=false);
-		u32 createEdgesAndCaps(const core::vector3df& light, SShadowVolume* svp, core::aabbox3d<f32>* bb);
+		//! Light position in mesh space and mesh frame a shadow volume was built for
+		struct SShadowVolumeKey
+		{
+			core::vector3df Light;
+			u32 MeshFrame;
+		};
+
+		//! Arrays used while building a shadow volume, one set for each thread
+		struct SShadowVolumeScratch
+		{
+			// positions extruded away from the light
+			core::array<core::vector3df> Extruded;
+			// silhouette edges, two vertex indices each
+			core::array<u32> Edges;
+			// tells if face is front facing
+			core::array<bool> FaceData;
+		};
+
+		//! Builds the shadow volume of a slot for the light of its key
+		void createShadowVolume(u32 volume, SShadowVolumeScratch& scratch);
+		u32 createEdgesAndCaps(const core::vector3df& light, SShadowVolume* svp,
+			core::aabbox3d<f32>* bb, SShadowVolumeScratch& scratch);
+
+		//! Builds the dirty shadow volumes on the threads of the pool
+		class CShadowVolumeJob;
+		friend class CShadowVolumeJob;
 
 		//! Generates adjacency information based on mesh indices.
 		void calculateAdjacency();
 
+		//! Edge of the mesh with the faces on both sides
+		struct SAdjacentEdge
+		{
+			//! faces on both sides, the same one twice at open borders
+			u32 Face[2];
+
+			//! the edge in the winding of each face
+			u32 Vertex[2][2];
+
+			//! false if the second face is adjacent to other faces at this edge
+			bool Shared;
+		};
+
 		core::aabbox3d<f32> Box;
 
 		// a shadow volume for every light
@@ -63,12 +100,19 @@ namespace scene
 		// a back cap bounding box for every light
 		core::array<core::aabbox3d<f32> > ShadowBBox;
 
+		// what every shadow volume was built for, unchanged volumes are kept
+		core::array<SShadowVolumeKey> ShadowKeys;
+
+		// slots of the shadow volumes to build in this update
+		core::array<u32> DirtyVolumes;
+
+		core::array<SShadowVolumeScratch> Scratch;
+
 		core::array<core::vector3df> Vertices;
-		core::array<u16> Indices;
-		core::array<u16> Adjacency;
-		core::array<u16> Edges;
-		// tells if face is front facing
-		core::array<bool> FaceData;
+		core::array<u32> Indices;
+
+		// every edge of the mesh once, for the silhouette search
+		core::array<SAdjacentEdge> AdjacentEdges;
 
 		const scene::IMesh* ShadowMesh;
 
@@ -76,6 +120,9 @@ namespace scene
 		u32 VertexCount;
 		u32 ShadowVolumesUsed;
 
+		// counts the changes of the copied mesh
+		u32 MeshFrame;
+
 		f32 Infinity;
 
 		bool UseZFailMethod;
@@ -160,8 +160,8 @@ void CSkyDomeSceneNode::render()
 		if ( DebugDataVisible & scene::EDS_NORMALS )
 		{
 			// draw normals
-			const f32 debugNormalLength = SceneManager->getParameters()->getAttributeAsFloat(DEBUG_NORMAL_LENGTH);
-			const video::SColor debugNormalColor = SceneManager->getParameters()->getAttributeAsColor(DEBUG_NORMAL_COLOR);
+			const f32 debugNormalLength = SceneManager->getDebugNormalLength();
+			const video::SColor debugNormalColor = SceneManager->getDebugNormalColor();
 			driver->drawMeshBufferNormals(Buffer, debugNormalLength, debugNormalColor);
 		}
 
@@ -177,6 +177,10 @@ bool CSoftwareDriver::queryFeature(E_VIDEO_DRIVER_FEATURE feature) const
 //! sets transformation
 void CSoftwareDriver::setTransform(E_TRANSFORMATION_STATE state, const core::matrix4& mat)
 {
+	CVideoCommandScope command(CommandRecorder);
+	if (command.isRecording())
+		command->setTransform(state, mat);
+
 	TransformationMatrix[state] = mat;
 }
 
@@ -206,6 +210,10 @@ bool CSoftwareDriver::setActiveTexture(u32 stage, video::ITexture* texture)
 //! sets a material
 void CSoftwareDriver::setMaterial(const SMaterial& material)
 {
+	CVideoCommandScope command(CommandRecorder);
+	if (command.isRecording())
+		command->setMaterial(material);
+
 	Material = material;
 	OverrideMaterial.apply(Material);
 
@@ -720,6 +728,10 @@ void CSoftwareDriver::drawClippedIndexedTriangleListT(const VERTEXTYPE* vertices
 void CSoftwareDriver::draw3DLine(const core::vector3df& start,
 				const core::vector3df& end, SColor color)
 {
+	CVideoCommandScope command(CommandRecorder);
+	if (command.isRecording())
+		command->draw3DLine(start, end, color);
+
 	core::vector3df vect = start.crossProduct(end);
 	vect.normalize();
 	vect *= Material.Thickness*0.3f;
@@ -797,6 +809,10 @@ void CSoftwareDriver::draw2DImage(const video::ITexture* texture, const core::po
 					const core::rect<s32>* clipRect, SColor color,
 					bool useAlphaChannelOfTexture)
 {
+	CVideoCommandScope command(CommandRecorder);
+	if (command.isRecording())
+		command->draw2DImage(texture, destPos, sourceRect, clipRect, color, useAlphaChannelOfTexture);
+
 	if (texture)
 	{
 		if (texture->getDriverType() != EDT_SOFTWARE)
@@ -821,6 +837,10 @@ void CSoftwareDriver::draw2DLine(const core::position2d<s32>& start,
 				const core::position2d<s32>& end,
 				SColor color)
 {
+	CVideoCommandScope command(CommandRecorder);
+	if (command.isRecording())
+		command->draw2DLine(start, end, color);
+
 	drawLine(RenderTargetSurface, start, end, color );
 }
 
@@ -828,6 +848,10 @@ void CSoftwareDriver::draw2DLine(const core::position2d<s32>& start,
 //! Draws a pixel
 void CSoftwareDriver::drawPixel(u32 x, u32 y, const SColor & color)
 {
+	CVideoCommandScope command(CommandRecorder);
+	if (command.isRecording())
+		command->drawPixel(x, y, color);
+
 	BackBuffer->setPixel(x, y, color, true);
 }
 
@@ -836,6 +860,10 @@ void CSoftwareDriver::drawPixel(u32 x, u32 y, const SColor & color)
 void CSoftwareDriver::draw2DRectangle(SColor color, const core::rect<s32>& pos,
 					const core::rect<s32>* clip)
 {
+	CVideoCommandScope command(CommandRecorder);
+	if (command.isRecording())
+		command->draw2DRectangle(color, pos, clip);
+
 	if (clip)
 	{
 		core::rect<s32> p(pos);
@@ -862,6 +890,10 @@ void CSoftwareDriver::draw2DRectangle(const core::rect<s32>& pos,
 	SColor colorLeftUp, SColor colorRightUp, SColor colorLeftDown, SColor colorRightDown,
 	const core::rect<s32>* clip)
 {
+	CVideoCommandScope command(CommandRecorder);
+	if (command.isRecording())
+		command->draw2DRectangle(pos, colorLeftUp, colorRightUp, colorLeftDown, colorRightDown, clip);
+
 	// TODO: implement
 	draw2DRectangle(colorLeftUp, pos, clip);
 }
@@ -334,8 +334,12 @@ struct program1
 //! constructor
 CBurningVideoDriver::CBurningVideoDriver(const irr::SIrrlichtCreationParameters& params, io::IFileSystem* io, video::IImagePresenter* presenter)
 : CNullDriver(io, params.WindowSize), BackBuffer(0), Presenter(presenter),
+	ExternalFrameCount(0), ExternalFrameIndex(0), ExternalFrameDone(-1),
+	ExternalDepth(0), OwnBackBuffer(0),
 	WindowId(0), SceneSourceRect(0),
 	RenderTargetTexture(0), RenderTargetSurface(0), CurrentShader(0),
+	CurrentShaderType(ETR_INVALID), ShaderStateId(0),
+	RasterizerThreads(0), Binning(false),
 	 DepthBuffer(0), StencilBuffer ( 0 ),
 	 CurrentOut ( 12 * 2, 128 ), Temp ( 12 * 2, 128 )
 {
@@ -366,39 +370,26 @@ CBurningVideoDriver::CBurningVideoDriver(const irr::SIrrlichtCreationParameters&
 	DriverAttributes->setAttribute("Version", 47);
 
 	// create triangle renderers
+	for ( u32 i = 0; i != ETR2_COUNT; ++i )
+		BurningShader[i] = createTriangleRenderer ( (EBurningFFShader) i );
 
-	irr::memset32 ( BurningShader, 0, sizeof ( BurningShader ) );
-	//BurningShader[ETR_FLAT] = createTRFlat2(DepthBuffer);
-	//BurningShader[ETR_FLAT_WIRE] = createTRFlatWire2(DepthBuffer);
-	BurningShader[ETR_GOURAUD] = createTriangleRendererGouraud2(this);
-	BurningShader[ETR_GOURAUD_ALPHA] = createTriangleRendererGouraudAlpha2(this );
-	BurningShader[ETR_GOURAUD_ALPHA_NOZ] = createTRGouraudAlphaNoZ2(this );
-	//BurningShader[ETR_GOURAUD_WIRE] = createTriangleRendererGouraudWire2(DepthBuffer);
-	//BurningShader[ETR_TEXTURE_FLAT] = createTriangleRendererTextureFlat2(DepthBuffer);
-	//BurningShader[ETR_TEXTURE_FLAT_WIRE] = createTriangleRendererTextureFlatWire2(DepthBuffer);
-	BurningShader[ETR_TEXTURE_GOURAUD] = createTriangleRendererTextureGouraud2(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_LIGHTMAP_M1] = createTriangleRendererTextureLightMap2_M1(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_LIGHTMAP_M2] = createTriangleRendererTextureLightMap2_M2(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_LIGHTMAP_M4] = createTriangleRendererGTextureLightMap2_M4(this);
-	BurningShader[ETR_TEXTURE_LIGHTMAP_M4] = createTriangleRendererTextureLightMap2_M4(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_LIGHTMAP_ADD] = createTriangleRendererTextureLightMap2_Add(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_DETAIL_MAP] = createTriangleRendererTextureDetailMap2(this);
-
-	BurningShader[ETR_TEXTURE_GOURAUD_WIRE] = createTriangleRendererTextureGouraudWire2(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_NOZ] = createTRTextureGouraudNoZ2(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_ADD] = createTRTextureGouraudAdd2(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_ADD_NO_Z] = createTRTextureGouraudAddNoZ2(this);
-	BurningShader[ETR_TEXTURE_GOURAUD_VERTEX_ALPHA] = createTriangleRendererTextureVertexAlpha2 ( this );
-
-	BurningShader[ETR_TEXTURE_GOURAUD_ALPHA] = createTRTextureGouraudAlpha(this );
-	BurningShader[ETR_TEXTURE_GOURAUD_ALPHA_NOZ] = createTRTextureGouraudAlphaNoZ( this );
-
-	BurningShader[ETR_NORMAL_MAP_SOLID] = createTRNormalMap ( this );
-	BurningShader[ETR_STENCIL_SHADOW] = createTRStencilShadow ( this );
-	BurningShader[ETR_TEXTURE_BLEND] = createTRTextureBlend( this );
-
-	BurningShader[ETR_REFERENCE] = createTriangleRendererReference ( this );
+	// post transform vertex cache
+	if ( params.VertexCacheSize )
+		VertexCache.resize ( params.VertexCacheSize );
 
+	// create rasterizer threads
+	BandJob.Driver = this;
+#ifdef _IRR_COMPILE_WITH_BURNINGSVIDEO_THREADS_
+	if ( params.RasterizerThreads != 1 )
+	{
+		RasterizerThreads = new CThreadPool ( params.RasterizerThreads );
+		if ( RasterizerThreads->getThreadCount () < 2 )
+		{
+			delete RasterizerThreads;
+			RasterizerThreads = 0;
+		}
+	}
+#endif
 
 	// add the same renderer for all solid types
 	CSoftware2MaterialRenderer_SOLID* smr = new CSoftware2MaterialRenderer_SOLID( this);
@@ -449,6 +440,9 @@ CBurningVideoDriver::CBurningVideoDriver(const irr::SIrrlichtCreationParameters&
 //! destructor
 CBurningVideoDriver::~CBurningVideoDriver()
 {
+	// release caller owned buffers
+	setExternalFrameBuffers(0, 0, 0, core::dimension2d<u32>(0,0), BURNINGSHADER_COLOR_FORMAT, 0);
+
 	// delete Backbuffer
 	if (BackBuffer)
 		BackBuffer->drop();
@@ -461,6 +455,15 @@ CBurningVideoDriver::~CBurningVideoDriver()
 			BurningShader[i]->drop();
 	}
 
+	// stop rasterizer threads
+	delete RasterizerThreads;
+
+	for (u32 i=0; i<BandShader.size(); ++i)
+	{
+		if (BandShader[i])
+			BandShader[i]->drop();
+	}
+
 	// delete Additional buffer
 	if (StencilBuffer)
 		StencilBuffer->drop();
@@ -476,6 +479,47 @@ CBurningVideoDriver::~CBurningVideoDriver()
 }
 
 
+//! creates the triangle renderer of a type, 0 if there is none
+IBurningShader* CBurningVideoDriver::createTriangleRenderer ( EBurningFFShader type )
+{
+	switch ( type )
+	{
+		//case ETR_FLAT: return createTRFlat2(DepthBuffer);
+		//case ETR_FLAT_WIRE: return createTRFlatWire2(DepthBuffer);
+		case ETR_GOURAUD: return createTriangleRendererGouraud2(this);
+		case ETR_GOURAUD_ALPHA: return createTriangleRendererGouraudAlpha2(this );
+		case ETR_GOURAUD_ALPHA_NOZ: return createTRGouraudAlphaNoZ2(this );
+		//case ETR_GOURAUD_WIRE: return createTriangleRendererGouraudWire2(DepthBuffer);
+		//case ETR_TEXTURE_FLAT: return createTriangleRendererTextureFlat2(DepthBuffer);
+		//case ETR_TEXTURE_FLAT_WIRE: return createTriangleRendererTextureFlatWire2(DepthBuffer);
+		case ETR_TEXTURE_GOURAUD: return createTriangleRendererTextureGouraud2(this);
+		case ETR_TEXTURE_GOURAUD_LIGHTMAP_M1: return createTriangleRendererTextureLightMap2_M1(this);
+		case ETR_TEXTURE_GOURAUD_LIGHTMAP_M2: return createTriangleRendererTextureLightMap2_M2(this);
+		case ETR_TEXTURE_GOURAUD_LIGHTMAP_M4: return createTriangleRendererGTextureLightMap2_M4(this);
+		case ETR_TEXTURE_LIGHTMAP_M4: return createTriangleRendererTextureLightMap2_M4(this);
+		case ETR_TEXTURE_GOURAUD_LIGHTMAP_ADD: return createTriangleRendererTextureLightMap2_Add(this);
+		case ETR_TEXTURE_GOURAUD_DETAIL_MAP: return createTriangleRendererTextureDetailMap2(this);
+
+		case ETR_TEXTURE_GOURAUD_WIRE: return createTriangleRendererTextureGouraudWire2(this);
+		case ETR_TEXTURE_GOURAUD_NOZ: return createTRTextureGouraudNoZ2(this);
+		case ETR_TEXTURE_GOURAUD_ADD: return createTRTextureGouraudAdd2(this);
+		case ETR_TEXTURE_GOURAUD_ADD_NO_Z: return createTRTextureGouraudAddNoZ2(this);
+		case ETR_TEXTURE_GOURAUD_VERTEX_ALPHA: return createTriangleRendererTextureVertexAlpha2 ( this );
+
+		case ETR_TEXTURE_GOURAUD_ALPHA: return createTRTextureGouraudAlpha(this );
+		case ETR_TEXTURE_GOURAUD_ALPHA_NOZ: return createTRTextureGouraudAlphaNoZ( this );
+
+		case ETR_NORMAL_MAP_SOLID: return createTRNormalMap ( this );
+		case ETR_STENCIL_SHADOW: return createTRStencilShadow ( this );
+		case ETR_TEXTURE_BLEND: return createTRTextureBlend( this );
+
+		case ETR_REFERENCE: return createTriangleRendererReference ( this );
+		default:
+			return 0;
+	}
+}
+
+
 /*!
 	selects the right triangle renderer based on the render states.
 */
@@ -584,24 +628,31 @@ void CBurningVideoDriver::setCurrentShader()
 
 	// switchToTriangleRenderer
 	CurrentShader = BurningShader[shader];
+	CurrentShaderType = shader;
+	++ShaderStateId;
 	if ( CurrentShader )
-	{
-		CurrentShader->setZCompareFunc ( Material.org.ZBuffer );
-		CurrentShader->setRenderTarget(RenderTargetSurface, ViewPort);
-		CurrentShader->setMaterial ( Material );
+		setShaderState ( CurrentShader, shader );
 
-		switch ( shader )
-		{
-			case ETR_TEXTURE_GOURAUD_ALPHA:
-			case ETR_TEXTURE_GOURAUD_ALPHA_NOZ:
-			case ETR_TEXTURE_BLEND:
-				CurrentShader->setParam ( 0, Material.org.MaterialTypeParam );
-				break;
-			default:
+}
+
+
+//! applies the render states of the current material to a triangle renderer
+void CBurningVideoDriver::setShaderState ( IBurningShader* shader, EBurningFFShader type )
+{
+	shader->setZCompareFunc ( Material.org.ZBuffer );
+	shader->setRenderTarget(RenderTargetSurface, ViewPort);
+	shader->setMaterial ( Material );
+
+	switch ( type )
+	{
+		case ETR_TEXTURE_GOURAUD_ALPHA:
+		case ETR_TEXTURE_GOURAUD_ALPHA_NOZ:
+		case ETR_TEXTURE_BLEND:
+			shader->setParam ( 0, Material.org.MaterialTypeParam );
 			break;
-		}
+		default:
+		break;
 	}
-
 }
 
 
@@ -639,6 +690,10 @@ bool CBurningVideoDriver::queryFeature(E_VIDEO_DRIVER_FEATURE feature) const
 //! sets transformation
 void CBurningVideoDriver::setTransform(E_TRANSFORMATION_STATE state, const core::matrix4& mat)
 {
+	CVideoCommandScope command ( CommandRecorder );
+	if ( command.isRecording () )
+		command->setTransform ( state, mat );
+
 	Transformation[state] = mat;
 	core::setbit_cond ( TransformationFlag[state], mat.isIdentity(), ETF_IDENTITY );
 
@@ -707,10 +762,128 @@ bool CBurningVideoDriver::endScene()
 {
 	CNullDriver::endScene();
 
+	// the caller reads this frame while the next one goes to the other
+	// buffer, it is not shown in the window
+	if (ExternalFrameCount)
+	{
+		ExternalFrameDone = ExternalFrameIndex;
+		setExternalBackBuffer((ExternalFrameIndex + 1) % ExternalFrameCount);
+		return true;
+	}
+
 	return Presenter->present(BackBuffer, WindowId, SceneSourceRect);
 }
 
 
+//! Renders the frame buffer into caller owned memory
+bool CBurningVideoDriver::setExternalFrameBuffers(void* const* color, u32 bufferCount,
+		void* depth, const core::dimension2d<u32>& size,
+		ECOLOR_FORMAT format, u32 pitch)
+{
+	u32 i;
+
+	if (bufferCount)
+	{
+		// the renderers address rows by the width of the target
+		if (!color || bufferCount > 2 || 0 == size.getArea() ||
+			format != BURNINGSHADER_COLOR_FORMAT ||
+			pitch != size.Width * IImage::getBitsPerPixelFromFormat(format) / 8)
+		{
+			os::Printer::log("External frame buffers need the driver color format and rows without padding.", ELL_ERROR);
+			return false;
+		}
+
+		for (i = 0; i != bufferCount; ++i)
+		{
+			if (!color[i])
+				return false;
+		}
+	}
+
+	// release the previous buffers
+	for (i = 0; i != ExternalFrameCount; ++i)
+		ExternalFrame[i]->drop();
+
+	ExternalFrameCount = 0;
+	ExternalFrameIndex = 0;
+	ExternalFrameDone = -1;
+	ExternalDepth = 0;
+
+	if (0 == bufferCount)
+	{
+		// back to the own back buffer
+		if (OwnBackBuffer)
+		{
+			const bool resetRT = (RenderTargetSurface == BackBuffer);
+
+			BackBuffer->drop();
+			BackBuffer = OwnBackBuffer;
+			OwnBackBuffer = 0;
+
+			if (resetRT)
+				setRenderTarget(BackBuffer);
+		}
+		return true;
+	}
+
+	// wrap the memory without copying it
+	for (i = 0; i != bufferCount; ++i)
+		ExternalFrame[i] = new CImage(format, size, color[i], true, false);
+
+	ExternalFrameCount = bufferCount;
+	ExternalDepth = depth;
+
+	if (!OwnBackBuffer)
+	{
+		OwnBackBuffer = BackBuffer;
+		BackBuffer = 0;
+	}
+
+	setExternalBackBuffer(0);
+	return true;
+}
+
+
+//! makes the next caller owned colour buffer the back buffer
+void CBurningVideoDriver::setExternalBackBuffer(u32 index)
+{
+	const bool resetRT = (RenderTargetSurface == BackBuffer) || (RenderTargetSurface == OwnBackBuffer);
+
+	if (BackBuffer)
+		BackBuffer->drop();
+
+	ExternalFrameIndex = index;
+	BackBuffer = ExternalFrame[index];
+	BackBuffer->grab();
+
+	if (!resetRT)
+		return;
+
+	// switching between caller owned buffers of the same size keeps the
+	// viewport, only the renderers get the new target
+	if (RenderTargetSurface && RenderTargetSurface != OwnBackBuffer &&
+		RenderTargetSize == BackBuffer->getDimension())
+	{
+		RenderTargetSurface->drop();
+		RenderTargetSurface = BackBuffer;
+		RenderTargetSurface->grab();
+
+		if (CurrentShader)
+			CurrentShader->setRenderTarget(RenderTargetSurface, ViewPort);
+		++ShaderStateId;
+	}
+	else
+		setRenderTarget(BackBuffer);
+}
+
+
+//! Returns the caller owned colour buffer holding the frame finished last
+s32 CBurningVideoDriver::getExternalFrameBufferIndex() const
+{
+	return ExternalFrameDone;
+}
+
+
 //! sets a render target
 bool CBurningVideoDriver::setRenderTarget(video::ITexture* texture, bool clearBackBuffer,
 								 bool clearZBuffer, SColor color)
@@ -768,8 +941,14 @@ void CBurningVideoDriver::setRenderTarget(video::CImage* image)
 	setViewPort(core::rect<s32>(0,0,RenderTargetSize.Width,RenderTargetSize.Height));
 
 	if (DepthBuffer)
+	{
 		DepthBuffer->setSize(RenderTargetSize);
 
+		// a caller owned depth buffer belongs to the caller owned colour buffers
+		((CDepthBuffer*) DepthBuffer)->setForeignMemory(
+			ExternalFrameCount && image == BackBuffer ? ExternalDepth : 0);
+	}
+
 	if (StencilBuffer)
 		StencilBuffer->setSize(RenderTargetSize);
 }
@@ -788,6 +967,7 @@ void CBurningVideoDriver::setViewPort(const core::rect<s32>& area)
 
 	if (CurrentShader)
 		CurrentShader->setRenderTarget(RenderTargetSurface, ViewPort);
+	++ShaderStateId;
 }
 
 /*
@@ -969,6 +1149,47 @@ u32 CBurningVideoDriver::clipToFrustum ( s4DVertex *v0, s4DVertex * v1, const u3
 	return vOut;
 }
 
+/*!
+	clips the line from v[0] to v[2] parametrically against all planes,
+	the clipped end points replace them. returns false if nothing is left.
+	clipToFrustum would treat the line as a degenerated polygon whose
+	outline covers the visible part twice.
+*/
+bool CBurningVideoDriver::clipLineToFrustum ( s4DVertex *v, s4DVertex * temp ) const
+{
+	f32 t0 = 0.f;
+	f32 t1 = 1.f;
+
+	for ( u32 g = 0; g != 6; ++g )
+	{
+		const f32 d0 = v[0].Pos.dotProduct ( NDCPlane[g] );
+		const f32 d2 = v[2].Pos.dotProduct ( NDCPlane[g] );
+
+		// inside is <= 0
+		if ( F32_GREATER_0 ( d0 ) )
+		{
+			if ( F32_GREATER_0 ( d2 ) )
+				return false;
+			t0 = core::max_ ( t0, d0 / ( d0 - d2 ) );
+		}
+		else if ( F32_GREATER_0 ( d2 ) )
+		{
+			t1 = core::min_ ( t1, d0 / ( d0 - d2 ) );
+		}
+	}
+
+	if ( t0 > t1 )
+		return false;
+
+	irr::memcpy32_small ( temp, v, SIZEOF_SVERTEX * 4 );
+	if ( t0 > 0.f )
+		v[0].interpolate ( temp[0], temp[2], t0 );
+	if ( t1 < 1.f )
+		v[2].interpolate ( temp[0], temp[2], t1 );
+
+	return true;
+}
+
 /*!
  Part I:
 	apply Clip Scale matrix
@@ -1171,29 +1392,148 @@ const SVSize CBurningVideoDriver::vSize[] =
 
 
 /*!
-	fill a cache line with transformed, light and clipp test triangles
+	transform a block of vertices to clip space and store their frustum clip flags,
+	scalar reference of the sse version
+*/
+void CBurningVideoDriver::VertexCache_transform_ref ( s4DVertex **dest, const core::vector3df **pos, u32 count ) const
+{
+	const core::matrix4 &m = Transformation [ ETS_CURRENT ];
+
+	for ( u32 i = 0; i != count; ++i )
+	{
+		m.transformVect ( &dest[i]->Pos.x, *pos[i] );
+		dest[i]->flag = clipToFrustumTest ( dest[i] );
+	}
+}
+
+
+#ifdef SOFTWARE_DRIVER_2_SSE
+
+/*!
+	transform a block of vertices to clip space and store their frustum clip flags,
+	4 vertices at once in structure of arrays layout. Same operation order as
+	matrix4::transformVect and clipToFrustumTest, so results are identical.
 */
-void CBurningVideoDriver::VertexCache_fill(const u32 sourceIndex, const u32 destIndex)
+void CBurningVideoDriver::VertexCache_transform ( s4DVertex **dest, const core::vector3df **pos, u32 count ) const
 {
-	u8 * source;
-	s4DVertex *dest;
+	const f32 *M = Transformation [ ETS_CURRENT ].pointer();
 
-	source = (u8*) VertexCache.vertices + ( sourceIndex * vSize[VertexCache.vType].Pitch );
+	__m128 m[16];
+	for ( u32 k = 0; k != 16; ++k )
+		m[k] = _mm_set1_ps ( M[k] );
 
-	// it's a look ahead so we never hit it..
-	// but give priority...
-	//VertexCache.info[ destIndex ].hit = hitCount;
+	const __m128 sign = _mm_set1_ps ( -0.f );
 
-	// store info
-	VertexCache.info[ destIndex ].index = sourceIndex;
-	VertexCache.info[ destIndex ].hit = 0;
+	u32 i = 0;
+	for ( ; i + 4 <= count; i += 4 )
+	{
+		const core::vector3df *p0 = pos[i+0];
+		const core::vector3df *p1 = pos[i+1];
+		const core::vector3df *p2 = pos[i+2];
+		const core::vector3df *p3 = pos[i+3];
 
-	// destination Vertex
-	dest = (s4DVertex *) ( (u8*) VertexCache.mem.data + ( destIndex << ( SIZEOF_SVERTEX_LOG2 + 1  ) ) );
+		const __m128 x = _mm_set_ps ( p3->X, p2->X, p1->X, p0->X );
+		const __m128 y = _mm_set_ps ( p3->Y, p2->Y, p1->Y, p0->Y );
+		const __m128 z = _mm_set_ps ( p3->Z, p2->Z, p1->Z, p0->Z );
 
-	// transform Model * World * Camera * Projection * NDCSpace matrix
+		__m128 c[4];
+		for ( u32 k = 0; k != 4; ++k )
+		{
+			c[k] = _mm_add_ps ( _mm_add_ps ( _mm_add_ps (
+					_mm_mul_ps ( x, m[k] ), _mm_mul_ps ( y, m[k+4] ) ),
+					_mm_mul_ps ( z, m[k+8] ) ), m[k+12] );
+		}
+
+		// one bit for each vertex and plane
+		s32 plane[6];
+#ifdef IRRLICHT_FAST_MATH
+		const __m128 w = _mm_xor_ps ( c[3], sign );
+		plane[0] = _mm_movemask_ps ( _mm_add_ps ( c[2], w ) );
+		plane[1] = _mm_movemask_ps ( _mm_add_ps ( _mm_xor_ps ( c[2], sign ), w ) );
+		plane[2] = _mm_movemask_ps ( _mm_add_ps ( c[0], w ) );
+		plane[3] = _mm_movemask_ps ( _mm_add_ps ( _mm_xor_ps ( c[0], sign ), w ) );
+		plane[4] = _mm_movemask_ps ( _mm_add_ps ( c[1], w ) );
+		plane[5] = _mm_movemask_ps ( _mm_add_ps ( _mm_xor_ps ( c[1], sign ), w ) );
+#else
+		plane[0] = _mm_movemask_ps ( _mm_cmple_ps ( c[2], c[3] ) );
+		plane[1] = _mm_movemask_ps ( _mm_cmple_ps ( _mm_xor_ps ( c[2], sign ), c[3] ) );
+		plane[2] = _mm_movemask_ps ( _mm_cmple_ps ( c[0], c[3] ) );
+		plane[3] = _mm_movemask_ps ( _mm_cmple_ps ( _mm_xor_ps ( c[0], sign ), c[3] ) );
+		plane[4] = _mm_movemask_ps ( _mm_cmple_ps ( c[1], c[3] ) );
+		plane[5] = _mm_movemask_ps ( _mm_cmple_ps ( _mm_xor_ps ( c[1], sign ), c[3] ) );
+#endif
+
+		// back to array of structures
+		_MM_TRANSPOSE4_PS ( c[0], c[1], c[2], c[3] );
+
+		for ( u32 k = 0; k != 4; ++k )
+		{
+			_mm_storeu_ps ( &dest[i+k]->Pos.x, c[k] );
+
+			dest[i+k]->flag =	( ( plane[0] >> k ) & 1 ) |
+								( ( ( plane[1] >> k ) & 1 ) << 1 ) |
+								( ( ( plane[2] >> k ) & 1 ) << 2 ) |
+								( ( ( plane[3] >> k ) & 1 ) << 3 ) |
+								( ( ( plane[4] >> k ) & 1 ) << 4 ) |
+								( ( ( plane[5] >> k ) & 1 ) << 5 );
+		}
+	}
+
+	// remaining vertices
+	if ( i != count )
+		VertexCache_transform_ref ( dest + i, pos + i, count - i );
+}
+
+#else
+
+void CBurningVideoDriver::VertexCache_transform ( s4DVertex **dest, const core::vector3df **pos, u32 count ) const
+{
+	VertexCache_transform_ref ( dest, pos, count );
+}
+
+#endif
+
+
+/*!
+	fill cache lines with transformed, lit and clip tested vertices
+*/
+void CBurningVideoDriver::VertexCache_fill ( const u32 *sourceIndex, const u32 *destIndex, u32 count )
+{
+	s4DVertex *dest[VERTEXCACHE_BLOCK];
+	const core::vector3df *pos[VERTEXCACHE_BLOCK];
+
+	const u32 pitch = vSize[VertexCache.vType].Pitch;
+
+	while ( count )
+	{
+		const u32 block = core::min_ ( count, (u32) VERTEXCACHE_BLOCK );
+		u32 i;
+
+		for ( i = 0; i != block; ++i )
+		{
+			dest[i] = VertexCache.getLine ( destIndex[i] );
+			pos[i] = (const core::vector3df*) ( (u8*) VertexCache.vertices + ( sourceIndex[i] * pitch ) );
+		}
+
+		// transform Model * World * Camera * Projection * NDCSpace matrix
+		VertexCache_transform ( dest, pos, block );
+
+		for ( i = 0; i != block; ++i )
+			VertexCache_shade ( (const u8*) pos[i], dest[i] );
+
+		sourceIndex += block;
+		destIndex += block;
+		count -= block;
+	}
+}
+
+
+/*!
+	light, texture transform and project a vertex after VertexCache_transform
+*/
+void CBurningVideoDriver::VertexCache_shade ( const u8 *source, s4DVertex *dest )
+{
 	const S3DVertex *base = ((S3DVertex*) source );
-	Transformation [ ETS_CURRENT].transformVect ( &dest->Pos.x, base->Pos );
 
 	//mhm ;-) maybe no goto
 	if ( VertexCache.vType == 4 ) goto clipandproject;
@@ -1398,12 +1738,9 @@ void CBurningVideoDriver::VertexCache_fill(const u32 sourceIndex, const u32 dest
 		dest->LightTangent[0].x = 0.f;
 		dest->LightTangent[0].y = 0.f;
 		dest->LightTangent[0].z = 0.f;
-		for ( u32 i = 0; i < 2 && i < LightSpace.Light.size (); ++i )
+		for ( u32 i = 0; i < 2 && i < LightSpace.Active.size (); ++i )
 		{
-			const SBurningShaderLight &light = LightSpace.Light[i];
-
-			if ( !light.LightIsOn )
-				continue;
+			const SBurningShaderLight &light = LightSpace.Light[LightSpace.Active[i]];
 
 			vp.x = light.pos.x - LightSpace.vertex.x;
 			vp.y = light.pos.y - LightSpace.vertex.y;
@@ -1457,13 +1794,20 @@ void CBurningVideoDriver::VertexCache_fill(const u32 sourceIndex, const u32 dest
 #endif
 
 clipandproject:
-	dest[0].flag = dest[1].flag = vSize[VertexCache.vType].Format;
+	// clip flags are set by VertexCache_transform
+	dest[1].flag = vSize[VertexCache.vType].Format;
+	dest[0].flag |= dest[1].flag;
 
-	// test vertex
-	dest[0].flag |= clipToFrustumTest ( dest);
+	// inside near and far, and the side planes widened by the guard band
+	if ( ( dest[0].flag & VERTEX4D_NEARFAR ) == VERTEX4D_NEARFAR && dest[0].Pos.w > 0.f )
+	{
+		const f32 guard = dest[0].Pos.w * SOFTWARE_DRIVER_2_GUARD_BAND;
+		if ( core::abs_ ( dest[0].Pos.x ) <= guard && core::abs_ ( dest[0].Pos.y ) <= guard )
+			dest[0].flag |= VERTEX4D_GUARDBAND;
+	}
 
 	// to DC Space, project homogenous vertex
-	if ( (dest[0].flag & VERTEX4D_CLIPMASK ) == VERTEX4D_INSIDE )
+	if ( dest[0].flag & VERTEX4D_GUARDBAND )
 	{
 		ndc_2_dc_and_project2 ( (const s4DVertex**) &dest, 1 );
 	}
@@ -1473,181 +1817,130 @@ clipandproject:
 
 //
 
-REALINLINE s4DVertex * CBurningVideoDriver::VertexCache_getVertex ( const u32 sourceIndex )
-{
-	for ( s32 i = 0; i < VERTEXCACHE_ELEMENT; ++i )
-	{
-		if ( VertexCache.info[ i ].index == sourceIndex )
-		{
-			return (s4DVertex *) ( (u8*) VertexCache.mem.data + ( i << ( SIZEOF_SVERTEX_LOG2 + 1  ) ) );
-		}
-	}
-	return 0;
-}
-
-
 /*
-	Cache based on linear walk indices
-	fill blockwise on the next 16(Cache_Size) unique vertices in indexlist
-	merge the next 16 vertices with the current
+	look up the vertices of the next primitives in the post transform cache
+	and transform all missing ones at once.
+	lines filled by the batch are replaced last, a batch ends before it could
+	replace a line which one of its primitives uses.
 */
-REALINLINE void CBurningVideoDriver::VertexCache_get(const s4DVertex ** face)
+void CBurningVideoDriver::VertexCache_lookup ()
 {
-	SCacheInfo info[VERTEXCACHE_ELEMENT];
+	u32 missSource[VERTEXCACHE_BATCH * 3];
+	u32 missDest[VERTEXCACHE_BATCH * 3];
+	u32 missCount = 0;
+	u32 hitCount = 0;
+
+	const u32 mask = VertexCache.size - 1;
+	const u32 firstLine = VertexCache.fifo;
+
+	// lines up to this fifo distance are used by the batch
+	u32 safe = VertexCache.size;
 
-	// next primitive must be complete in cache
-	if (	VertexCache.indicesIndex - VertexCache.indicesRun < 3 &&
-			VertexCache.indicesIndex < VertexCache.indexCount
+	u32 sourceIndex[3];
+	u32 faceCount = 0;
+
+	const u32 size = VertexCache.primitiveSize;
+
+	while ( faceCount + size <= VERTEXCACHE_BATCH * 3 &&
+			VertexCache.indicesRun + size <= VertexCache.indexCount &&
+			missCount + size <= safe
 		)
 	{
-		// rewind to start of primitive
-		VertexCache.indicesIndex = VertexCache.indicesRun;
-
-		irr::memset32 ( info, VERTEXCACHE_MISS, sizeof ( info ) );
+		u32 pos[3];
+		pos[0] = core::if_c_a_else_0 ( VertexCache.pType != scene::EPT_TRIANGLE_FAN, VertexCache.indicesRun );
+		pos[1] = VertexCache.indicesRun + 1;
+		pos[2] = VertexCache.indicesRun + 2;
 
-		// get the next unique vertices cache line
-		u32 fillIndex = 0;
-		u32 dIndex;
-		u32 i;
-		u32 sourceIndex;
+		// the last line of a loop closes it with the first vertex
+		if ( VertexCache.pType == scene::EPT_LINE_LOOP && pos[1] == VertexCache.indexCount - 1 )
+			pos[1] = 0;
 
-		while ( VertexCache.indicesIndex < VertexCache.indexCount &&
-				fillIndex < VERTEXCACHE_ELEMENT
-				)
+		u32 g;
+		switch ( VertexCache.iType )
 		{
-			switch ( VertexCache.iType )
+			case 1:
 			{
-				case 1:
-					sourceIndex =  ((u16*)VertexCache.indices) [ VertexCache.indicesIndex ];
-					break;
-				case 2:
-					sourceIndex =  ((u32*)VertexCache.indices) [ VertexCache.indicesIndex ];
-					break;
-				case 4:
-					sourceIndex = VertexCache.indicesIndex;
-					break;
+				const u16 *p = (const u16 *) VertexCache.indices;
+				for ( g = 0; g != size; ++g )
+					sourceIndex[g] = p[ pos[g] ];
 			}
+			break;
 
-			VertexCache.indicesIndex += 1;
-
-			// if not exist, push back
-			s32 exist = 0;
-			for ( dIndex = 0;  dIndex < fillIndex; ++dIndex )
+			case 2:
 			{
-				if ( info[ dIndex ].index == sourceIndex )
-				{
-					exist = 1;
-					break;
-				}
+				const u32 *p = (const u32 *) VertexCache.indices;
+				for ( g = 0; g != size; ++g )
+					sourceIndex[g] = p[ pos[g] ];
 			}
+			break;
 
-			if ( 0 == exist )
-			{
-				info[fillIndex++].index = sourceIndex;
-			}
+			default:
+				for ( g = 0; g != size; ++g )
+					sourceIndex[g] = pos[g];
+			break;
 		}
 
-		// clear marks
-		for ( i = 0; i!= VERTEXCACHE_ELEMENT; ++i )
-		{
-			VertexCache.info[i].hit = 0;
-		}
+		// misses of this primitive may replace lines up to this distance
+		const u32 replace = missCount + size;
 
-		// mark all existing
-		for ( i = 0; i!= fillIndex; ++i )
+		for ( g = 0; g != size; ++g )
 		{
-			for ( dIndex = 0;  dIndex < VERTEXCACHE_ELEMENT; ++dIndex )
+			u32 l = VertexCache.find ( sourceIndex[g] );
+			if ( l != VERTEXCACHE_MISS )
 			{
-				if ( VertexCache.info[ dIndex ].index == info[i].index )
+				const u32 distance = ( l - firstLine ) & mask;
+				if ( distance >= missCount )
 				{
-					info[i].hit = dIndex;
-					VertexCache.info[ dIndex ].hit = 1;
-					break;
+					// line filled before this batch, keep it unless it is replaced next
+					if ( distance < replace )
+						l = VERTEXCACHE_MISS;
+					else
+						safe = core::min_ ( safe, distance );
 				}
 			}
-		}
 
-		// fill new
-		for ( i = 0; i!= fillIndex; ++i )
-		{
-			if ( info[i].hit != VERTEXCACHE_MISS )
-				continue;
-
-			for ( dIndex = 0;  dIndex < VERTEXCACHE_ELEMENT; ++dIndex )
+			if ( l == VERTEXCACHE_MISS )
 			{
-				if ( 0 == VertexCache.info[dIndex].hit )
-				{
-					VertexCache_fill ( info[i].index, dIndex );
-					VertexCache.info[dIndex].hit += 1;
-					info[i].hit = dIndex;
-					break;
-				}
+				l = VertexCache.insert ( sourceIndex[g] );
+				missSource[missCount] = sourceIndex[g];
+				missDest[missCount] = l;
+				missCount += 1;
+			}
+			else
+			{
+				hitCount += 1;
 			}
-		}
-	}
-
-	const u32 i0 = core::if_c_a_else_0 ( VertexCache.pType != scene::EPT_TRIANGLE_FAN, VertexCache.indicesRun );
-
-	switch ( VertexCache.iType )
-	{
-		case 1:
-		{
-			const u16 *p = (const u16 *) VertexCache.indices;
-			face[0] = VertexCache_getVertex ( p[ i0    ] );
-			face[1] = VertexCache_getVertex ( p[ VertexCache.indicesRun + 1] );
-			face[2] = VertexCache_getVertex ( p[ VertexCache.indicesRun + 2] );
-		}
-		break;
 
-		case 2:
-		{
-			const u32 *p = (const u32 *) VertexCache.indices;
-			face[0] = VertexCache_getVertex ( p[ i0    ] );
-			face[1] = VertexCache_getVertex ( p[ VertexCache.indicesRun + 1] );
-			face[2] = VertexCache_getVertex ( p[ VertexCache.indicesRun + 2] );
+			VertexCache.face[faceCount++] = VertexCache.getLine ( l );
 		}
-		break;
 
-		case 4:
-			face[0] = VertexCache_getVertex ( VertexCache.indicesRun + 0 );
-			face[1] = VertexCache_getVertex ( VertexCache.indicesRun + 1 );
-			face[2] = VertexCache_getVertex ( VertexCache.indicesRun + 2 );
-		break;
-		default:
-			face[0] = face[1] = face[2] = VertexCache_getVertex(VertexCache.indicesRun + 0);
-		break;
+		VertexCache.indicesRun += VertexCache.primitivePitch;
 	}
 
-	VertexCache.indicesRun += VertexCache.primitivePitch;
+	VertexCache.faceRun = 0;
+	VertexCache.faceCount = faceCount;
+
+	Statistics.VertexCacheHits += hitCount;
+	Statistics.VertexCacheMisses += missCount;
+
+	VertexCache_fill ( missSource, missDest, missCount );
 }
 
+
 /*!
+	returns the transformed vertices of the next primitive
 */
-REALINLINE void CBurningVideoDriver::VertexCache_getbypass ( s4DVertex ** face )
+REALINLINE void CBurningVideoDriver::VertexCache_get ( const s4DVertex ** face )
 {
-	const u32 i0 = core::if_c_a_else_0 ( VertexCache.pType != scene::EPT_TRIANGLE_FAN, VertexCache.indicesRun );
-
-	if ( VertexCache.iType == 1 )
-	{
-		const u16 *p = (const u16 *) VertexCache.indices;
-		VertexCache_fill ( p[ i0    ], 0 );
-		VertexCache_fill ( p[ VertexCache.indicesRun + 1], 1 );
-		VertexCache_fill ( p[ VertexCache.indicesRun + 2], 2 );
-	}
-	else
-	{
-		const u32 *p = (const u32 *) VertexCache.indices;
-		VertexCache_fill ( p[ i0    ], 0 );
-		VertexCache_fill ( p[ VertexCache.indicesRun + 1], 1 );
-		VertexCache_fill ( p[ VertexCache.indicesRun + 2], 2 );
-	}
+	if ( VertexCache.faceRun == VertexCache.faceCount )
+		VertexCache_lookup ();
 
-	VertexCache.indicesRun += VertexCache.primitivePitch;
-
-	face[0] = (s4DVertex *) ( (u8*) VertexCache.mem.data + ( 0 << ( SIZEOF_SVERTEX_LOG2 + 1  ) ) );
-	face[1] = (s4DVertex *) ( (u8*) VertexCache.mem.data + ( 1 << ( SIZEOF_SVERTEX_LOG2 + 1  ) ) );
-	face[2] = (s4DVertex *) ( (u8*) VertexCache.mem.data + ( 2 << ( SIZEOF_SVERTEX_LOG2 + 1  ) ) );
+	const s4DVertex * const * f = VertexCache.face + VertexCache.faceRun;
+	face[0] = f[0];
+	face[1] = f[1];
+	face[2] = f[2];
 
+	VertexCache.faceRun += 3;
 }
 
 /*!
@@ -1662,7 +1955,6 @@ void CBurningVideoDriver::VertexCache_reset ( const void* vertices, u32 vertexCo
 	VertexCache.vertexCount = vertexCount;
 
 	VertexCache.indices = indices;
-	VertexCache.indicesIndex = 0;
 	VertexCache.indicesRun = 0;
 
 	if ( Material.org.MaterialType == video::EMT_REFLECTION_2_LAYER )
@@ -1679,25 +1971,31 @@ void CBurningVideoDriver::VertexCache_reset ( const void* vertices, u32 vertexCo
 			VertexCache.iType = iType; break;
 	}
 
+	VertexCache.primitiveSize = 3;
+
 	switch ( VertexCache.pType )
 	{
-		// most types here will not work as expected, only triangles/triangle_fan
-		// is known to work.
+		// quads and polygons are not drawn
 		case scene::EPT_POINTS:
 			VertexCache.indexCount = primitiveCount;
 			VertexCache.primitivePitch = 1;
+			VertexCache.primitiveSize = 1;
 			break;
 		case scene::EPT_LINE_STRIP:
 			VertexCache.indexCount = primitiveCount+1;
 			VertexCache.primitivePitch = 1;
+			VertexCache.primitiveSize = 2;
 			break;
 		case scene::EPT_LINE_LOOP:
+			// primitiveCount vertices, the last line ends at the first one
 			VertexCache.indexCount = primitiveCount+1;
 			VertexCache.primitivePitch = 1;
+			VertexCache.primitiveSize = 2;
 			break;
 		case scene::EPT_LINES:
 			VertexCache.indexCount = 2*primitiveCount;
 			VertexCache.primitivePitch = 2;
+			VertexCache.primitiveSize = 2;
 			break;
 		case scene::EPT_TRIANGLE_STRIP:
 			VertexCache.indexCount = primitiveCount+2;
@@ -1726,10 +2024,12 @@ void CBurningVideoDriver::VertexCache_reset ( const void* vertices, u32 vertexCo
 		case scene::EPT_POINT_SPRITES:
 			VertexCache.indexCount = primitiveCount;
 			VertexCache.primitivePitch = 1;
+			VertexCache.primitiveSize = 1;
 			break;
 	}
 
-	irr::memset32 ( VertexCache.info, VERTEXCACHE_MISS, sizeof ( VertexCache.info ) );
+	VertexCache.reserve ( vertexCount );
+	VertexCache.invalidate ();
 }
 
 
@@ -1744,17 +2044,185 @@ void CBurningVideoDriver::drawVertexPrimitiveList(const void* vertices, u32 vert
 	CNullDriver::drawVertexPrimitiveList(vertices, vertexCount, indexList, primitiveCount, vType, pType, iType);
 
 	// These calls would lead to crashes due to wrong index usage.
-	// The vertex cache needs to be rewritten for these primitives.
+	if (pType==scene::EPT_POLYGON)
+		return;
+
 	if (pType==scene::EPT_POINTS || pType==scene::EPT_LINE_STRIP ||
-		pType==scene::EPT_LINE_LOOP || pType==scene::EPT_LINES || pType==scene::EPT_POLYGON ||
+		pType==scene::EPT_LINE_LOOP || pType==scene::EPT_LINES ||
 		pType==scene::EPT_POINT_SPRITES)
+	{
+		VertexCache_reset ( vertices, vertexCount, indexList, primitiveCount, vType, pType, iType );
+		drawVertexCacheLines ( primitiveCount );
 		return;
+	}
 
 	if ( 0 == CurrentShader )
 		return;
 
 	VertexCache_reset ( vertices, vertexCount, indexList, primitiveCount, vType, pType, iType );
+	drawVertexCache ( primitiveCount );
+}
+
+
+//! Draws a mesh buffer once for each of the given world transformations
+/** The vertex cache is set up once, and only invalidated between the
+	instances. Material and shader state are left untouched. */
+void CBurningVideoDriver::drawMeshBufferInstanced(const scene::IMeshBuffer* mb,
+		const core::matrix4* transforms, u32 instanceCount)
+{
+	if ( !mb || !transforms || !instanceCount )
+		return;
+
+	const u32 primitiveCount = mb->getIndexCount() / 3;
+	if (!checkPrimitiveCount(primitiveCount))
+		return;
+
+	for ( u32 i = 0; i != instanceCount; ++i )
+		Statistics.registerDrawCall ( primitiveCount );
+
+	if ( 0 == CurrentShader )
+		return;
+
+	const core::matrix4 world = Transformation[ETS_WORLD];
+
+	VertexCache_reset ( mb->getVertices(), mb->getVertexCount(), mb->getIndices(),
+				primitiveCount, mb->getVertexType(), scene::EPT_TRIANGLES,
+				mb->getIndexType() );
+
+	for ( u32 i = 0; i != instanceCount; ++i )
+	{
+		setTransform ( ETS_WORLD, transforms[i] );
+
+		// transformed vertices of the previous instance are invalid
+		VertexCache.indicesRun = 0;
+		VertexCache.invalidate ();
+
+		drawVertexCache ( primitiveCount );
+	}
+
+	setTransform ( ETS_WORLD, world );
+}
+
+
+//! draw calls with less primitives are not worth waking the rasterizer threads
+static const u32 BINNING_MIN_PRIMITIVES = 64;
+
+//! true if the triangle renderer only draws rows it owns, so it can run on the rasterizer threads
+static inline bool isBandShader ( EBurningFFShader type )
+{
+	switch ( type )
+	{
+		case ETR_FLAT_WIRE:
+		case ETR_GOURAUD_WIRE:
+		case ETR_TEXTURE_FLAT_WIRE:
+		case ETR_TEXTURE_GOURAUD_WIRE:
+		case ETR_STENCIL_SHADOW:
+		case ETR_REFERENCE:
+		case ETR_INVALID:
+			return false;
+		default:
+			return true;
+	}
+}
+
+
+//! rasterizes a triangle now, or bins it if Binning is on
+void CBurningVideoDriver::drawTriangle ( const s4DVertex *a, const s4DVertex *b, const s4DVertex *c )
+{
+	if ( !Binning )
+	{
+		CurrentShader->drawTriangle ( a, b, c );
+		return;
+	}
+
+	// rows the triangle renderers visit, top-left fill convention
+	const s32 yStart = core::s32_max ( core::ceil32 ( core::min_ ( a->Pos.y, b->Pos.y, c->Pos.y ) ), 0 );
+	const s32 yEnd = core::ceil32 ( core::max_ ( a->Pos.y, b->Pos.y, c->Pos.y ) ) - 1;
+	if ( yEnd < yStart )
+		return;
+
+	Binned.set_used ( Binned.size () + 1 );
+	SBinnedTriangle &t = Binned.getLast ();
+
+	t.Vertex[0] = *a;
+	t.Vertex[1] = *b;
+	t.Vertex[2] = *c;
+
+	// texture stages were selected for this triangle by the calling thread
+	for ( u32 m = 0; m != BURNING_MATERIAL_MAX_TEXTURES; ++m )
+		t.IT[m] = CurrentShader->getTextureParam ( m );
+
+	t.BandStart = yStart >> SOFTWARE_DRIVER_2_BAND_HEIGHT_LOG2;
+	t.BandEnd = yEnd >> SOFTWARE_DRIVER_2_BAND_HEIGHT_LOG2;
+}
+
+
+//! rasterizes the binned triangles on all rasterizer threads
+void CBurningVideoDriver::flushBinned ()
+{
+	if ( 0 == Binned.size () )
+		return;
+
+	const u32 threads = RasterizerThreads->getThreadCount ();
+
+	if ( 0 == BandShader.size () )
+	{
+		BandShader.set_used ( threads * ETR2_COUNT );
+		BandShaderStateId.set_used ( threads * ETR2_COUNT );
+		for ( u32 i = 0; i != BandShader.size (); ++i )
+			BandShader[i] = 0;
+	}
+
+	// bring the triangle renderers of the threads to the state of CurrentShader
+	for ( u32 thread = 0; thread != threads; ++thread )
+	{
+		const u32 slot = thread * ETR2_COUNT + CurrentShaderType;
+		if ( 0 == BandShader[slot] )
+		{
+			BandShader[slot] = createTriangleRenderer ( CurrentShaderType );
+			BandShader[slot]->setRowBand ( thread, threads );
+			BandShaderStateId[slot] = ShaderStateId - 1;
+		}
 
+		if ( BandShaderStateId[slot] != ShaderStateId )
+		{
+			setShaderState ( BandShader[slot], CurrentShaderType );
+			BandShaderStateId[slot] = ShaderStateId;
+		}
+	}
+
+	RasterizerThreads->run ( &BandJob );
+
+	Binned.set_used ( 0 );
+}
+
+
+//! rasterizes the binned triangles touching the bands of a thread
+void CBurningVideoDriver::rasterizeBands ( u32 thread )
+{
+	const u32 threads = RasterizerThreads->getThreadCount ();
+	IBurningShader* shader = BandShader [ thread * ETR2_COUNT + CurrentShaderType ];
+
+	for ( u32 i = 0; i != Binned.size (); ++i )
+	{
+		const SBinnedTriangle &t = Binned[i];
+
+		// first band of this thread at or below the top of the triangle
+		const u32 skip = ( thread + threads - ( (u32) t.BandStart % threads ) ) % threads;
+		if ( skip > (u32) ( t.BandEnd - t.BandStart ) )
+			continue;
+
+		for ( u32 m = 0; m != BURNING_MATERIAL_MAX_TEXTURES; ++m )
+			shader->copyTextureParam ( m, t.IT[m] );
+
+		shader->drawTriangle ( t.Vertex + 0, t.Vertex + 1, t.Vertex + 2 );
+	}
+}
+
+
+//! rasterizes the primitives of the vertex cache
+void CBurningVideoDriver::drawVertexCache ( u32 primitiveCount )
+{
 	const s4DVertex * face[3];
 
 	f32 dc_area;
@@ -1764,6 +2232,10 @@ void CBurningVideoDriver::drawVertexPrimitiveList(const void* vertices, u32 vert
 	u32 m;
 	video::CSoftwareTexture2* tex;
 
+	// leave small draw calls to the calling thread
+	Binning = RasterizerThreads && primitiveCount >= BINNING_MIN_PRIMITIVES &&
+				isBandShader ( CurrentShaderType );
+
 	for ( i = 0; i < (u32) primitiveCount; ++i )
 	{
 		VertexCache_get(face);
@@ -1774,8 +2246,11 @@ void CBurningVideoDriver::drawVertexPrimitiveList(const void* vertices, u32 vert
 			)
 			continue;
 
-		// if fully inside
-		if ( ( face[0]->flag & face[1]->flag & face[2]->flag & VERTEX4D_CLIPMASK ) == VERTEX4D_INSIDE )
+		// if fully inside, or inside the guard band of a renderer scissoring to the viewport
+		const u32 inside = face[0]->flag & face[1]->flag & face[2]->flag;
+		if ( ( inside & VERTEX4D_CLIPMASK ) == VERTEX4D_INSIDE ||
+			( ( inside & VERTEX4D_GUARDBAND ) && CurrentShader->canScissor () )
+			)
 		{
 			dc_area = screenarea2 ( face );
 			if ( Material.org.BackfaceCulling && F32_LOWER_EQUAL_0( dc_area ) )
@@ -1800,7 +2275,7 @@ void CBurningVideoDriver::drawVertexPrimitiveList(const void* vertices, u32 vert
 			}
 
 			// rasterize
-			CurrentShader->drawTriangle ( face[0] + 1, face[1] + 1, face[2] + 1 );
+			drawTriangle ( face[0] + 1, face[1] + 1, face[2] + 1 );
 			continue;
 		}
 
@@ -1879,13 +2354,19 @@ void CBurningVideoDriver::drawVertexPrimitiveList(const void* vertices, u32 vert
 		for ( g = 0; g <= vOut - 6; g += 2 )
 		{
 			// rasterize
-			CurrentShader->drawTriangle ( CurrentOut.data + 0 + 1,
+			drawTriangle ( CurrentOut.data + 0 + 1,
 							CurrentOut.data + g + 3,
 							CurrentOut.data + g + 5);
 		}
 
 	}
 
+	if ( Binning )
+	{
+		flushBinned ();
+		Binning = false;
+	}
+
 	// dump statistics
 /*
 	char buf [64];
@@ -1899,11 +2380,94 @@ void CBurningVideoDriver::drawVertexPrimitiveList(const void* vertices, u32 vert
 }
 
 
+//! draws the points and lines of the vertex cache with the line renderer
+void CBurningVideoDriver::drawVertexCacheLines ( u32 primitiveCount )
+{
+	IBurningShader * line = BurningShader [ ETR_TEXTURE_GOURAUD_WIRE ];
+	if ( 0 == line )
+		return;
+
+	line->setRenderTarget(RenderTargetSurface, ViewPort);
+	line->setZCompareFunc ( Material.org.ZBuffer );
+	line->setMaterial ( Material );
+
+	const u32 size = VertexCache.primitiveSize;
+	const u32 format = vSize[VertexCache.vType].Format;
+
+	u32 i;
+	u32 g;
+	u32 vOut;
+
+	for ( i = 0; i < primitiveCount; ++i )
+	{
+		if ( VertexCache.faceRun == VertexCache.faceCount )
+			VertexCache_lookup ();
+
+		const s4DVertex * const * face = VertexCache.face + VertexCache.faceRun;
+		VertexCache.faceRun += size;
+
+		// points are drawn if they are inside, they have been projected then
+		if ( 1 == size )
+		{
+			if ( ( face[0]->flag & VERTEX4D_CLIPMASK ) != VERTEX4D_INSIDE )
+				continue;
+
+			irr::memcpy32_small ( CurrentOut.data, face[0], SIZEOF_SVERTEX * 2 );
+#ifdef SOFTWARE_DRIVER_2_USE_VERTEX_COLOR
+			CurrentOut.data[1].Color[0] = CurrentOut.data[0].Color[0];
+#endif
+			line->drawPoint ( CurrentOut.data + 1 );
+			continue;
+		}
+
+		// if fully outside or outside on same side
+		if ( ( (face[0]->flag | face[1]->flag) & VERTEX4D_CLIPMASK ) != VERTEX4D_INSIDE )
+			continue;
+
+		irr::memcpy32_small ( ( (u8*) CurrentOut.data + ( 0 << ( SIZEOF_SVERTEX_LOG2 + 1 ) ) ), face[0], SIZEOF_SVERTEX * 2 );
+		irr::memcpy32_small ( ( (u8*) CurrentOut.data + ( 1 << ( SIZEOF_SVERTEX_LOG2 + 1 ) ) ), face[1], SIZEOF_SVERTEX * 2 );
+
+		vOut = 4;
+
+		// the line renderer does not scissor, so lines are clipped against all planes
+		if ( ( face[0]->flag & face[1]->flag & VERTEX4D_CLIPMASK ) != VERTEX4D_INSIDE )
+		{
+			for ( g = 0; g != CurrentOut.ElementSize; ++g )
+			{
+				CurrentOut.data[g].flag = format;
+				Temp.data[g].flag = format;
+			}
+
+			if ( !clipLineToFrustum ( CurrentOut.data, Temp.data ) )
+				continue;
+
+			// to DC Space, project homogenous vertex
+			ndc_2_dc_and_project ( CurrentOut.data + 1, CurrentOut.data, vOut );
+		}
+
+		// unproject vertex color
+#ifdef SOFTWARE_DRIVER_2_USE_VERTEX_COLOR
+		for ( g = 0; g != vOut; g += 2 )
+		{
+			CurrentOut.data[ g + 1].Color[0] = CurrentOut.data[ g ].Color[0];
+		}
+#endif
+
+		// rasterize
+		line->drawLine ( CurrentOut.data + 1, CurrentOut.data + 3 );
+	}
+}
+
+
 //! Sets the dynamic ambient light color. The default color is
 //! (0,0,0,0) which means it is dark.
 //! \param color: New color of the ambient light.
 void CBurningVideoDriver::setAmbientLight(const SColorf& color)
 {
+	CVideoCommandScope command ( CommandRecorder );
+	if ( command.isRecording () )
+		command->setAmbientLight ( color );
+
 	LightSpace.Global_AmbientLight.setColorf ( color );
 }
 
@@ -1954,6 +2518,7 @@ s32 CBurningVideoDriver::addDynamicLight(const SLight& dl)
 	}
 
 	LightSpace.Light.push_back ( l );
+	LightSpace.Active.push_back ( LightSpace.Light.size() - 1 );
 	return LightSpace.Light.size() - 1;
 }
 
@@ -1962,7 +2527,24 @@ void CBurningVideoDriver::turnLightOn(s32 lightIndex, bool turnOn)
 {
 	if(lightIndex > -1 && lightIndex < (s32)LightSpace.Light.size())
 	{
+		if ( LightSpace.Light[lightIndex].LightIsOn == turnOn )
+			return;
+
 		LightSpace.Light[lightIndex].LightIsOn = turnOn;
+
+		if ( turnOn )
+		{
+			LightSpace.Active.push_back ( lightIndex );
+		}
+		else
+		{
+			const s32 i = LightSpace.Active.linear_search ( (u32) lightIndex );
+			if ( i >= 0 )
+			{
+				LightSpace.Active[i] = LightSpace.Active.getLast ();
+				LightSpace.Active.erase ( LightSpace.Active.size () - 1 );
+			}
+		}
 	}
 }
 
@@ -1984,6 +2566,10 @@ u32 CBurningVideoDriver::getMaximalDynamicLightAmount() const
 //! sets a material
 void CBurningVideoDriver::setMaterial(const SMaterial& material)
 {
+	CVideoCommandScope command ( CommandRecorder );
+	if ( command.isRecording () )
+		command->setMaterial ( material );
+
 	Material.org = material;
 
 #ifdef SOFTWARE_DRIVER_2_TEXTURE_TRANSFORM
@@ -2074,7 +2660,7 @@ void CBurningVideoDriver::lightVertex ( s4DVertex *dest, u32 vertexargb )
 	dColor = LightSpace.Global_AmbientLight;
 	dColor.add ( Material.EmissiveColor );
 
-	if ( Lights.size () == 0 )
+	if ( LightSpace.Active.size () == 0 )
 	{
 		dColor.saturate( dest->Color[0], vertexargb);
 		return;
@@ -2098,12 +2684,10 @@ void CBurningVideoDriver::lightVertex ( s4DVertex *dest, u32 vertexargb )
 	sVec4 vp;			// unit vector vertex to light
 	sVec4 lightHalf;	// blinn-phong reflection
 
-	for ( i = 0; i!= LightSpace.Light.size (); ++i )
+	// only the lights switched on, a light manager may have hundreds
+	for ( i = 0; i!= LightSpace.Active.size (); ++i )
 	{
-		const SBurningShaderLight &light = LightSpace.Light[i];
-
-		if ( !light.LightIsOn )
-			continue;
+		const SBurningShaderLight &light = LightSpace.Light[LightSpace.Active[i]];
 
 		// accumulate ambient
 		ambient.add ( light.AmbientColor );
@@ -2193,6 +2777,10 @@ void CBurningVideoDriver::draw2DImage(const video::ITexture* texture, const core
 					 const core::rect<s32>* clipRect, SColor color,
 					 bool useAlphaChannelOfTexture)
 {
+	CVideoCommandScope command ( CommandRecorder );
+	if ( command.isRecording () )
+		command->draw2DImage ( texture, destPos, sourceRect, clipRect, color, useAlphaChannelOfTexture );
+
 	if (texture)
 	{
 		if (texture->getDriverType() != EDT_BURNINGSVIDEO)
@@ -2231,6 +2819,10 @@ void CBurningVideoDriver::draw2DImage(const video::ITexture* texture, const core
 		const core::rect<s32>& sourceRect, const core::rect<s32>* clipRect,
 		const video::SColor* const colors, bool useAlphaChannelOfTexture)
 {
+	CVideoCommandScope command ( CommandRecorder );
+	if ( command.isRecording () )
+		command->draw2DImage ( texture, destRect, sourceRect, clipRect, colors, useAlphaChannelOfTexture );
+
 	if (texture)
 	{
 		if (texture->getDriverType() != EDT_BURNINGSVIDEO)
@@ -2253,6 +2845,10 @@ void CBurningVideoDriver::draw2DLine(const core::position2d<s32>& start,
 					const core::position2d<s32>& end,
 					SColor color)
 {
+	CVideoCommandScope command ( CommandRecorder );
+	if ( command.isRecording () )
+		command->draw2DLine ( start, end, color );
+
 	drawLine(BackBuffer, start, end, color );
 }
 
@@ -2260,6 +2856,10 @@ void CBurningVideoDriver::draw2DLine(const core::position2d<s32>& start,
 //! Draws a pixel
 void CBurningVideoDriver::drawPixel(u32 x, u32 y, const SColor & color)
 {
+	CVideoCommandScope command ( CommandRecorder );
+	if ( command.isRecording () )
+		command->drawPixel ( x, y, color );
+
 	BackBuffer->setPixel(x, y, color, true);
 }
 
@@ -2268,6 +2868,10 @@ void CBurningVideoDriver::drawPixel(u32 x, u32 y, const SColor & color)
 void CBurningVideoDriver::draw2DRectangle(SColor color, const core::rect<s32>& pos,
 									 const core::rect<s32>* clip)
 {
+	CVideoCommandScope command ( CommandRecorder );
+	if ( command.isRecording () )
+		command->draw2DRectangle ( color, pos, clip );
+
 	if (clip)
 	{
 		core::rect<s32> p(pos);
@@ -2315,6 +2919,14 @@ void CBurningVideoDriver::OnResize(const core::dimension2d<u32>& size)
 
 		ScreenSize = realSize;
 
+		// caller owned buffers keep their size, only the own one follows the window
+		if (OwnBackBuffer)
+		{
+			OwnBackBuffer->drop();
+			OwnBackBuffer = new CImage(BURNINGSHADER_COLOR_FORMAT, realSize);
+			return;
+		}
+
 		bool resetRT = (RenderTargetSurface == BackBuffer);
 
 		if (BackBuffer)
@@ -2339,6 +2951,10 @@ void CBurningVideoDriver::draw2DRectangle(const core::rect<s32>& position,
 	SColor colorLeftUp, SColor colorRightUp, SColor colorLeftDown, SColor colorRightDown,
 	const core::rect<s32>* clip)
 {
+	CVideoCommandScope command ( CommandRecorder );
+	if ( command.isRecording () )
+		command->draw2DRectangle ( position, colorLeftUp, colorRightUp, colorLeftDown, colorRightDown, clip );
+
 #ifdef SOFTWARE_DRIVER_2_USE_VERTEX_COLOR
 
 	core::rect<s32> pos = position;
@@ -2361,11 +2977,7 @@ void CBurningVideoDriver::draw2DRectangle(const core::rect<s32>& position,
 	s4DVertex *v;
 
 	VertexCache.vertexCount = 4;
-
-	VertexCache.info[0].index = 0;
-	VertexCache.info[1].index = 1;
-	VertexCache.info[2].index = 2;
-	VertexCache.info[3].index = 3;
+	VertexCache.invalidate ();
 
 	v = &VertexCache.mem.data [ 0 ];
 
@@ -2406,9 +3018,9 @@ void CBurningVideoDriver::draw2DRectangle(const core::rect<s32>& position,
 
 	for ( i = 0; i!= 6; i += 3 )
 	{
-		face[0] = VertexCache_getVertex ( indexList [ i + 0 ] );
-		face[1] = VertexCache_getVertex ( indexList [ i + 1 ] );
-		face[2] = VertexCache_getVertex ( indexList [ i + 2 ] );
+		face[0] = VertexCache.getLine ( indexList [ i + 0 ] );
+		face[1] = VertexCache.getLine ( indexList [ i + 1 ] );
+		face[2] = VertexCache.getLine ( indexList [ i + 2 ] );
 
 		// test clipping
 		u32 test = face[0]->flag & face[1]->flag & face[2]->flag & VERTEX4D_INSIDE;
@@ -2451,6 +3063,10 @@ void CBurningVideoDriver::draw2DRectangle(const core::rect<s32>& position,
 void CBurningVideoDriver::draw3DLine(const core::vector3df& start,
 	const core::vector3df& end, SColor color)
 {
+	CVideoCommandScope command ( CommandRecorder );
+	if ( command.isRecording () )
+		command->draw3DLine ( start, end, color );
+
 	Transformation [ ETS_CURRENT].transformVect ( &CurrentOut.data[0].Pos.x, start );
 	Transformation [ ETS_CURRENT].transformVect ( &CurrentOut.data[2].Pos.x, end );
 
@@ -2474,6 +3090,7 @@ void CBurningVideoDriver::draw3DLine(const core::vector3df& start,
 	IBurningShader * line;
 	line = BurningShader [ ETR_TEXTURE_GOURAUD_WIRE ];
 	line->setRenderTarget(RenderTargetSurface, ViewPort);
+	line->setZCompareFunc ( ECFN_LESSEQUAL );
 
 	// to DC Space, project homogenous vertex
 	ndc_2_dc_and_project ( CurrentOut.data + 1, CurrentOut.data, vOut );
@@ -2583,7 +3200,8 @@ ITexture* CBurningVideoDriver::createDeviceDependentTexture(IImage* surface, con
 	return new CSoftwareTexture2(
 		surface, name,
 		(getTextureCreationFlag(ETCF_CREATE_MIP_MAPS) ? CSoftwareTexture2::GEN_MIPMAP : 0 ) |
-		(getTextureCreationFlag(ETCF_ALLOW_NON_POWER_2) ? 0 : CSoftwareTexture2::NP2_SIZE ), mipmapData);
+		(getTextureCreationFlag(ETCF_ALLOW_NON_POWER_2) ? 0 : CSoftwareTexture2::NP2_SIZE ), mipmapData,
+		RasterizerThreads);
 
 }
 
@@ -2606,6 +3224,7 @@ void CBurningVideoDriver::drawStencilShadowVolume(const core::array<core::vector
 	IBurningShader *shader = BurningShader [ ETR_STENCIL_SHADOW ];
 
 	CurrentShader = shader;
+	CurrentShaderType = ETR_INVALID;
 	shader->setRenderTarget(RenderTargetSurface, ViewPort);
 
 	Material.org.MaterialType = video::EMT_SOLID;
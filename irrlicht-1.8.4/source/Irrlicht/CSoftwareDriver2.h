@@ -7,6 +7,7 @@
 
 #include "SoftwareDriver2_compile_config.h"
 #include "IBurningShader.h"
+#include "CThreadPool.h"
 #include "CNullDriver.h"
 #include "CImage.h"
 #include "os.h"
@@ -84,6 +85,10 @@ namespace video
 				const void* indexList, u32 primitiveCount,
 				E_VERTEX_TYPE vType, scene::E_PRIMITIVE_TYPE pType, E_INDEX_TYPE iType);
 
+		//! Draws a mesh buffer once for each of the given world transformations
+		virtual void drawMeshBufferInstanced(const scene::IMeshBuffer* mb,
+			const core::matrix4* transforms, u32 instanceCount);
+
 		//! draws an 2d image, using a color (if color is other then Color(255,255,255,255)) and the alpha channel of the texture if wanted.
 		virtual void draw2DImage(const video::ITexture* texture, const core::position2d<s32>& destPos,
 			const core::rect<s32>& sourceRect, const core::rect<s32>* clipRect = 0,
@@ -138,6 +143,14 @@ namespace video
 		//! Returns an image created from the last rendered frame.
 		virtual IImage* createScreenShot(video::ECOLOR_FORMAT format=video::ECF_UNKNOWN, video::E_RENDER_TARGET target=video::ERT_FRAME_BUFFER);
 
+		//! Renders the frame buffer into caller owned memory
+		virtual bool setExternalFrameBuffers(void* const* color, u32 bufferCount,
+			void* depth, const core::dimension2d<u32>& size,
+			ECOLOR_FORMAT format, u32 pitch);
+
+		//! Returns the caller owned colour buffer holding the frame finished last
+		virtual s32 getExternalFrameBufferIndex() const;
+
 		//! Returns the maximum amount of primitives (mostly vertices) which
 		//! the device is able to render with one drawIndexedTriangleList
 		//! call.
@@ -182,6 +195,18 @@ namespace video
 		video::CImage* BackBuffer;
 		video::IImagePresenter* Presenter;
 
+		//! makes the next caller owned colour buffer the back buffer
+		void setExternalBackBuffer(u32 index);
+
+		// caller owned colour buffers used as back buffer in turn,
+		// the own back buffer is kept meanwhile
+		video::CImage* ExternalFrame[2];
+		u32 ExternalFrameCount;
+		u32 ExternalFrameIndex;
+		s32 ExternalFrameDone;
+		void* ExternalDepth;
+		video::CImage* OwnBackBuffer;
+
 		void* WindowId;
 		core::rect<s32>* SceneSourceRect;
 
@@ -192,9 +217,63 @@ namespace video
 		//! selects the right triangle renderer based on the render states.
 		void setCurrentShader();
 
+		//! creates the triangle renderer of a type, 0 if there is none
+		IBurningShader* createTriangleRenderer ( EBurningFFShader type );
+
+		//! applies the render states of the current material to a triangle renderer
+		void setShaderState ( IBurningShader* shader, EBurningFFShader type );
+
 		IBurningShader* CurrentShader;
 		IBurningShader* BurningShader[ETR2_COUNT];
 
+		//! type of CurrentShader, ETR_INVALID if it was set up outside setCurrentShader
+		EBurningFFShader CurrentShaderType;
+
+		//! changes whenever the states of CurrentShader change
+		u32 ShaderStateId;
+
+
+		/*
+			sort-middle rasterization
+			-> triangles of a draw call are set up and binned on the calling thread
+			-> each rasterizer thread owns interleaved bands of rows of the
+				render target, depth and stencil buffer and draws the binned
+				triangles touching them in submission order
+		*/
+		struct SBinnedTriangle
+		{
+			s4DVertex Vertex[3];
+			sInternalTexture IT[BURNING_MATERIAL_MAX_TEXTURES];
+			s32 BandStart;
+			s32 BandEnd;
+		};
+
+		struct SBandJob : public CThreadPool::IJob
+		{
+			virtual void run(u32 thread) { Driver->rasterizeBands ( thread ); }
+			CBurningVideoDriver* Driver;
+		};
+
+		CThreadPool* RasterizerThreads;
+		SBandJob BandJob;
+
+		//! triangles of the current draw call, if Binning is on
+		core::array<SBinnedTriangle> Binned;
+		bool Binning;
+
+		//! triangle renderers of the rasterizer threads, [thread * ETR2_COUNT + type]
+		core::array<IBurningShader*> BandShader;
+		core::array<u32> BandShaderStateId;
+
+		//! rasterizes a triangle now, or bins it if Binning is on
+		void drawTriangle ( const s4DVertex *a, const s4DVertex *b, const s4DVertex *c );
+
+		//! rasterizes the binned triangles on all rasterizer threads
+		void flushBinned ();
+
+		//! rasterizes the binned triangles touching the bands of a thread
+		void rasterizeBands ( u32 thread );
+
 		IDepthBuffer* DepthBuffer;
 		IStencilBuffer* StencilBuffer;
 
@@ -239,16 +318,21 @@ namespace video
 					E_VERTEX_TYPE vType,scene::E_PRIMITIVE_TYPE pType,
 					E_INDEX_TYPE iType);
 		void VertexCache_get ( const s4DVertex ** face );
-		void VertexCache_getbypass ( s4DVertex ** face );
+		void VertexCache_lookup ();
 
-		void VertexCache_fill ( const u32 sourceIndex,const u32 destIndex );
-		s4DVertex * VertexCache_getVertex ( const u32 sourceIndex );
+		void VertexCache_fill ( const u32 *sourceIndex, const u32 *destIndex, u32 count );
+		void VertexCache_transform ( s4DVertex **dest, const core::vector3df **pos, u32 count ) const;
+		void VertexCache_transform_ref ( s4DVertex **dest, const core::vector3df **pos, u32 count ) const;
+		void VertexCache_shade ( const u8 *source, s4DVertex *dest );
+		void drawVertexCache ( u32 primitiveCount );
+		void drawVertexCacheLines ( u32 primitiveCount );
 
 
 		// culling & clipping
 		u32 clipToHyperPlane ( s4DVertex * dest, const s4DVertex * source, u32 inCount, const sVec4 &plane );
 		u32 clipToFrustumTest ( const s4DVertex * v  ) const;
 		u32 clipToFrustum ( s4DVertex *source, s4DVertex * temp, const u32 vIn );
+		bool clipLineToFrustum ( s4DVertex *v, s4DVertex * temp ) const;
 
 
 #ifdef SOFTWARE_DRIVER_2_LIGHTING
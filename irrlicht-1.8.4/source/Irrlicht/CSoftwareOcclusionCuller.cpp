@@ -0,0 +1,410 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CSoftwareOcclusionCuller.h"
+#include "ICameraSceneNode.h"
+#include "IMeshBuffer.h"
+
+namespace irr
+{
+namespace scene
+{
+
+//! constructor
+CSoftwareOcclusionCuller::CSoftwareOcclusionCuller()
+: Valid(false)
+{
+	setBufferSize(core::dimension2d<u32>(256, 128));
+}
+
+
+//! destructor
+CSoftwareOcclusionCuller::~CSoftwareOcclusionCuller()
+{
+	removeAllOccluders();
+}
+
+
+//! Adds or replaces an occluder, the mesh is in node space
+void CSoftwareOcclusionCuller::addOccluder(ISceneNode* node, const IMesh* mesh)
+{
+	if (!node || !mesh)
+		return;
+
+	mesh->grab();
+
+	for (u32 i=0; i<Occluders.size(); ++i)
+	{
+		if (Occluders[i].Node == node)
+		{
+			Occluders[i].Mesh->drop();
+			Occluders[i].Mesh = mesh;
+			return;
+		}
+	}
+
+	node->grab();
+
+	SOccluder occluder;
+	occluder.Node = node;
+	occluder.Mesh = mesh;
+	Occluders.push_back(occluder);
+}
+
+
+//! Removes an occluder
+void CSoftwareOcclusionCuller::removeOccluder(ISceneNode* node)
+{
+	for (u32 i=0; i<Occluders.size(); ++i)
+	{
+		if (Occluders[i].Node == node)
+		{
+			Occluders[i].Mesh->drop();
+			Occluders[i].Node->drop();
+			Occluders.erase(i);
+			break;
+		}
+	}
+
+	if (Occluders.empty())
+		Valid = false;
+}
+
+
+//! Removes all occluders
+void CSoftwareOcclusionCuller::removeAllOccluders()
+{
+	for (u32 i=0; i<Occluders.size(); ++i)
+	{
+		Occluders[i].Mesh->drop();
+		Occluders[i].Node->drop();
+	}
+
+	Occluders.clear();
+	Valid = false;
+}
+
+
+//! Sets the size of the finest depth buffer level
+void CSoftwareOcclusionCuller::setBufferSize(const core::dimension2d<u32>& size)
+{
+	Size.Width = core::max_(size.Width, 1u);
+	Size.Height = core::max_(size.Height, 1u);
+
+	LevelOffset.clear();
+	LevelSize.clear();
+
+	u32 offset = 0;
+	core::dimension2d<u32> levelSize(Size);
+	while (true)
+	{
+		LevelOffset.push_back(offset);
+		LevelSize.push_back(levelSize);
+		offset += levelSize.Width * levelSize.Height;
+
+		if (levelSize.Width == 1 && levelSize.Height == 1)
+			break;
+
+		levelSize.Width = (levelSize.Width + 1) >> 1;
+		levelSize.Height = (levelSize.Height + 1) >> 1;
+	}
+
+	Depth.set_used(offset);
+	Valid = false;
+}
+
+
+//! Rasterizes all visible occluders as seen from the camera
+void CSoftwareOcclusionCuller::update(const ICameraSceneNode* camera, const ISceneNode* root)
+{
+	Valid = false;
+
+	// release the nodes removed from the scene, they must neither
+	// occlude nor be kept alive by the occluder
+	for (u32 i=0; i<Occluders.size(); )
+	{
+		const ISceneNode* top = Occluders[i].Node;
+		while (top->getParent())
+			top = top->getParent();
+
+		if (top != root)
+		{
+			Occluders[i].Mesh->drop();
+			Occluders[i].Node->drop();
+			Occluders.erase(i);
+		}
+		else
+			++i;
+	}
+
+	if (!camera || Occluders.empty())
+		return;
+
+	ViewProjection.setbyproduct_nocheck(camera->getProjectionMatrix(), camera->getViewMatrix());
+
+	// clear the finest level to the far plane
+	const u32 count = Size.Width * Size.Height;
+	for (u32 i=0; i<count; ++i)
+		Depth[i] = 1.f;
+
+	core::matrix4 mat;
+	for (u32 i=0; i<Occluders.size(); ++i)
+	{
+		const SOccluder& occluder = Occluders[i];
+		if (!occluder.Node->isTrulyVisible())
+			continue;
+
+		mat.setbyproduct_nocheck(ViewProjection, occluder.Node->getAbsoluteTransformation());
+
+		for (u32 b=0; b<occluder.Mesh->getMeshBufferCount(); ++b)
+			drawMeshBuffer(occluder.Mesh->getMeshBuffer(b), mat);
+	}
+
+	buildHierarchy();
+	Valid = true;
+}
+
+
+void CSoftwareOcclusionCuller::drawMeshBuffer(const IMeshBuffer* mb, const core::matrix4& mat)
+{
+	if (!mb)
+		return;
+
+	const u32 vertexCount = mb->getVertexCount();
+	Transformed.set_used(vertexCount);
+	for (u32 i=0; i<vertexCount; ++i)
+		mat.transformVect(Transformed[i].Pos, mb->getPosition(i));
+
+	const u32 indexCount = mb->getIndexCount() - mb->getIndexCount() % 3;
+	if (mb->getIndexType() == video::EIT_32BIT)
+	{
+		const u32* indices = (const u32*) mb->getIndices();
+		for (u32 i=0; i<indexCount; i+=3)
+		{
+			if (indices[i] < vertexCount && indices[i+1] < vertexCount && indices[i+2] < vertexCount)
+				drawClippedTriangle(Transformed[indices[i]], Transformed[indices[i+1]], Transformed[indices[i+2]]);
+		}
+	}
+	else
+	{
+		const u16* indices = mb->getIndices();
+		for (u32 i=0; i<indexCount; i+=3)
+		{
+			if (indices[i] < vertexCount && indices[i+1] < vertexCount && indices[i+2] < vertexCount)
+				drawClippedTriangle(Transformed[indices[i]], Transformed[indices[i+1]], Transformed[indices[i+2]]);
+		}
+	}
+}
+
+
+//! clips the triangle against the near plane z=0 and draws it
+void CSoftwareOcclusionCuller::drawClippedTriangle(const SClipVertex& a, const SClipVertex& b, const SClipVertex& c)
+{
+	const SClipVertex* in[3] = { &a, &b, &c };
+
+	// trivial reject if all vertices are outside of the same frustum side
+	u32 outsideAll = 0x1f;
+	for (u32 i=0; i<3; ++i)
+	{
+		const f32* p = in[i]->Pos;
+		u32 outside = 0;
+		if (p[2] < 0.f) outside |= 1;
+		if (p[0] < -p[3]) outside |= 2;
+		if (p[0] > p[3]) outside |= 4;
+		if (p[1] < -p[3]) outside |= 8;
+		if (p[1] > p[3]) outside |= 16;
+		outsideAll &= outside;
+	}
+	if (outsideAll)
+		return;
+
+	SScreenVertex screen[4];
+	u32 n = 0;
+
+	for (u32 i=0; i<3; ++i)
+	{
+		const SClipVertex& v0 = *in[i];
+		const SClipVertex& v1 = *in[i==2 ? 0 : i+1];
+		const bool inside0 = v0.Pos[2] >= 0.f;
+		const bool inside1 = v1.Pos[2] >= 0.f;
+
+		if (inside0)
+			toScreen(screen[n++], v0);
+
+		if (inside0 != inside1)
+		{
+			const f32 t = v0.Pos[2] / (v0.Pos[2] - v1.Pos[2]);
+			SClipVertex v;
+			for (u32 k=0; k<4; ++k)
+				v.Pos[k] = v0.Pos[k] + (v1.Pos[k] - v0.Pos[k]) * t;
+			v.Pos[2] = 0.f;
+			toScreen(screen[n++], v);
+		}
+	}
+
+	for (u32 i=2; i<n; ++i)
+		drawTriangle(screen[0], screen[i-1], screen[i]);
+}
+
+
+void CSoftwareOcclusionCuller::toScreen(SScreenVertex& out, const SClipVertex& in) const
+{
+	// w can only be this small for broken projections, push the vertex far away
+	const f32 w = in.Pos[3] > 0.000001f ? in.Pos[3] : 0.000001f;
+	const f32 iw = core::reciprocal(w);
+	out.X = (in.Pos[0] * iw * 0.5f + 0.5f) * Size.Width;
+	out.Y = (0.5f - in.Pos[1] * iw * 0.5f) * Size.Height;
+	out.Z = in.Pos[2] * iw;
+}
+
+
+//! rasterizes a screen space triangle, sampling at the pixel centers
+void CSoftwareOcclusionCuller::drawTriangle(const SScreenVertex& a, const SScreenVertex& b0, const SScreenVertex& c0)
+{
+	f32 area = (b0.X - a.X) * (c0.Y - a.Y) - (b0.Y - a.Y) * (c0.X - a.X);
+	if (core::equals(area, 0.f))
+		return;
+
+	// no backface culling, occluders may be open meshes
+	const SScreenVertex& b = area > 0.f ? b0 : c0;
+	const SScreenVertex& c = area > 0.f ? c0 : b0;
+	area = core::abs_(area);
+
+	const s32 minX = core::max_(core::floor32(core::min_(a.X, b.X, c.X)), 0);
+	const s32 maxX = core::min_(core::floor32(core::max_(a.X, b.X, c.X)), (s32)Size.Width - 1);
+	const s32 minY = core::max_(core::floor32(core::min_(a.Y, b.Y, c.Y)), 0);
+	const s32 maxY = core::min_(core::floor32(core::max_(a.Y, b.Y, c.Y)), (s32)Size.Height - 1);
+
+	if (minX > maxX || minY > maxY)
+		return;
+
+	// edge functions, each is the weight of the opposite vertex
+	const f32 invArea = core::reciprocal(area);
+	const f32 dxA = b.Y - c.Y, dyA = c.X - b.X;
+	const f32 dxB = c.Y - a.Y, dyB = a.X - c.X;
+	const f32 dxC = a.Y - b.Y, dyC = b.X - a.X;
+
+	const f32 px = minX + 0.5f;
+	f32 py = minY + 0.5f;
+
+	f32* row = Depth.pointer() + minY * Size.Width;
+	for (s32 y=minY; y<=maxY; ++y, py+=1.f, row+=Size.Width)
+	{
+		f32 ea = (px - b.X) * dxA + (py - b.Y) * dyA;
+		f32 eb = (px - c.X) * dxB + (py - c.Y) * dyB;
+		f32 ec = (px - a.X) * dxC + (py - a.Y) * dyC;
+
+		for (s32 x=minX; x<=maxX; ++x, ea+=dxA, eb+=dxB, ec+=dxC)
+		{
+			if (ea < 0.f || eb < 0.f || ec < 0.f)
+				continue;
+
+			const f32 z = (ea * a.Z + eb * b.Z + ec * c.Z) * invArea;
+			if (z < row[x])
+				row[x] = z;
+		}
+	}
+}
+
+
+//! each coarser level holds the farthest depth of the texels it covers
+void CSoftwareOcclusionCuller::buildHierarchy()
+{
+	for (u32 l=1; l<LevelSize.size(); ++l)
+	{
+		const core::dimension2d<u32>& src = LevelSize[l-1];
+		const core::dimension2d<u32>& dst = LevelSize[l];
+		const f32* s = Depth.const_pointer() + LevelOffset[l-1];
+		f32* d = Depth.pointer() + LevelOffset[l];
+
+		for (u32 y=0; y<dst.Height; ++y)
+		{
+			const u32 y0 = y << 1;
+			const u32 y1 = core::min_(y0 + 1, src.Height - 1);
+
+			for (u32 x=0; x<dst.Width; ++x)
+			{
+				const u32 x0 = x << 1;
+				const u32 x1 = core::min_(x0 + 1, src.Width - 1);
+
+				d[y*dst.Width + x] = core::max_(
+					core::max_(s[y0*src.Width + x0], s[y0*src.Width + x1]),
+					core::max_(s[y1*src.Width + x0], s[y1*src.Width + x1]));
+			}
+		}
+	}
+}
+
+
+//! Returns true if the world space box is hidden behind the occluders
+bool CSoftwareOcclusionCuller::isOccluded(const core::aabbox3d<f32>& box) const
+{
+	if (!Valid)
+		return false;
+
+	core::vector3df edges[8];
+	box.getEdges(edges);
+
+	f32 minX = FLT_MAX, maxX = -FLT_MAX;
+	f32 minY = FLT_MAX, maxY = -FLT_MAX;
+	f32 minZ = FLT_MAX;
+
+	for (u32 i=0; i<8; ++i)
+	{
+		f32 p[4];
+		ViewProjection.transformVect(p, edges[i]);
+
+		// crossing the near plane, treat as visible
+		if (p[2] < 0.f || p[3] <= 0.f)
+			return false;
+
+		const f32 iw = core::reciprocal(p[3]);
+		const f32 x = (p[0] * iw * 0.5f + 0.5f) * Size.Width;
+		const f32 y = (0.5f - p[1] * iw * 0.5f) * Size.Height;
+		const f32 z = p[2] * iw;
+
+		minX = core::min_(minX, x);
+		maxX = core::max_(maxX, x);
+		minY = core::min_(minY, y);
+		maxY = core::max_(maxY, y);
+		minZ = core::min_(minZ, z);
+	}
+
+	s32 x0 = core::max_(core::floor32(minX), 0);
+	s32 x1 = core::min_(core::floor32(maxX), (s32)Size.Width - 1);
+	s32 y0 = core::max_(core::floor32(minY), 0);
+	s32 y1 = core::min_(core::floor32(maxY), (s32)Size.Height - 1);
+
+	// off screen, left to frustum culling
+	if (x0 > x1 || y0 > y1)
+		return false;
+
+	// choose the level where the box covers at most 4x4 texels
+	u32 level = 0;
+	while (level + 1 < LevelSize.size() && (x1 - x0 > 3 || y1 - y0 > 3))
+	{
+		++level;
+		x0 >>= 1; x1 >>= 1;
+		y0 >>= 1; y1 >>= 1;
+	}
+
+	const u32 width = LevelSize[level].Width;
+	const f32* d = Depth.const_pointer() + LevelOffset[level];
+
+	for (s32 y=y0; y<=y1; ++y)
+	{
+		for (s32 x=x0; x<=x1; ++x)
+		{
+			if (minZ <= d[y*width + x])
+				return false;
+		}
+	}
+
+	return true;
+}
+
+
+} // end namespace scene
+} // end namespace irr
+
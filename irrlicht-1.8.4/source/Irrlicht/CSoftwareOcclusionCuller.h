@@ -0,0 +1,105 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_SOFTWARE_OCCLUSION_CULLER_H_INCLUDED__
+#define __C_SOFTWARE_OCCLUSION_CULLER_H_INCLUDED__
+
+#include "ISceneNode.h"
+#include "IMesh.h"
+
+namespace irr
+{
+namespace scene
+{
+	class ICameraSceneNode;
+
+	//! Culls bounding boxes against a small depth buffer filled by occluder meshes on the cpu.
+	/** The occluders are rasterized once per frame into a low resolution
+	depth buffer, from which a hierarchy of farthest depth values is built.
+	A box is occluded if its nearest depth is behind the farthest occluder
+	depth of all texels it covers. Depth values are post projection z/w,
+	which is linear in screen space for perspective and orthogonal cameras.
+	Works independent of the video driver. */
+	class CSoftwareOcclusionCuller
+	{
+	public:
+
+		//! constructor
+		CSoftwareOcclusionCuller();
+
+		//! destructor
+		~CSoftwareOcclusionCuller();
+
+		//! Adds or replaces an occluder, the mesh is in node space
+		void addOccluder(ISceneNode* node, const IMesh* mesh);
+
+		//! Removes an occluder
+		void removeOccluder(ISceneNode* node);
+
+		//! Removes all occluders
+		void removeAllOccluders();
+
+		//! Returns amount of occluders
+		u32 getOccluderCount() const { return Occluders.size(); }
+
+		//! Sets the size of the finest depth buffer level
+		void setBufferSize(const core::dimension2d<u32>& size);
+
+		//! Returns the size of the finest depth buffer level
+		const core::dimension2d<u32>& getBufferSize() const { return Size; }
+
+		//! Rasterizes all visible occluders as seen from the camera
+		/** Occluders whose node is no longer below the root node are
+		removed first. */
+		void update(const ICameraSceneNode* camera, const ISceneNode* root);
+
+		//! Returns true if the world space box is hidden behind the occluders
+		bool isOccluded(const core::aabbox3d<f32>& box) const;
+
+	private:
+
+		struct SOccluder
+		{
+			ISceneNode* Node;
+			const IMesh* Mesh;
+		};
+
+		//! Clip space vertex
+		struct SClipVertex
+		{
+			f32 Pos[4];
+		};
+
+		//! Screen space vertex, depth is z/w
+		struct SScreenVertex
+		{
+			f32 X, Y, Z;
+		};
+
+		void drawMeshBuffer(const IMeshBuffer* mb, const core::matrix4& mat);
+		void drawClippedTriangle(const SClipVertex& a, const SClipVertex& b, const SClipVertex& c);
+		void drawTriangle(const SScreenVertex& a, const SScreenVertex& b, const SScreenVertex& c);
+		void toScreen(SScreenVertex& out, const SClipVertex& in) const;
+		void buildHierarchy();
+
+		core::array<SOccluder> Occluders;
+
+		//! all levels of the depth hierarchy, finest level first
+		core::array<f32> Depth;
+		core::array<u32> LevelOffset;
+		core::array<core::dimension2d<u32> > LevelSize;
+
+		//! transformed vertices of the current meshbuffer
+		core::array<SClipVertex> Transformed;
+
+		core::matrix4 ViewProjection;
+		core::dimension2d<u32> Size;
+		bool Valid;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
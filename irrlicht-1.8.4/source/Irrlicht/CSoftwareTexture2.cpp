@@ -8,6 +8,7 @@
 #include "SoftwareDriver2_compile_config.h"
 #include "SoftwareDriver2_helper.h"
 #include "CSoftwareTexture2.h"
+#include "CThreadPool.h"
 #include "os.h"
 
 namespace irr
@@ -15,9 +16,152 @@ namespace irr
 namespace video
 {
 
+#if defined ( SOFTWARE_DRIVER_2_SSE2 ) && defined ( SOFTWARE_DRIVER_2_32BIT ) && SOFTWARE_DRIVER_2_MIPMAPPING_MAX > 2
+
+namespace
+{
+
+//! textures from this size on build their first mip levels on all rasterizer threads
+const u32 MIPMAP_THREADED_MIN_AREA = 256 * 256;
+
+//! builds the first two mip levels of a power of two texture from blocks of 4x4 texels
+/** Each block gives four texels of level 1, one texel of level 2 and the channel
+sums of the block, from which the smaller levels are summed up without rounding.
+The rows of level 2 are interleaved over the threads. */
+class CMipMapJob : public CThreadPool::IJob
+{
+public:
+	CMipMapJob ( CImage* level0, CImage* level1, CImage* level2, u32* sums, u32 threadCount )
+		: Level0 ( level0 ), Level1 ( level1 ), Level2 ( level2 ), Sums ( sums ), ThreadCount ( threadCount ) {}
+
+	virtual void run ( u32 thread )
+	{
+		const u32 width = Level2->getDimension().Width;
+		const u32 height = Level2->getDimension().Height;
+		const u32 pitch0 = Level0->getPitch();
+		const u32 pitch1 = Level1->getPitch();
+
+		const __m128i zero = _mm_setzero_si128 ();
+
+		for ( u32 y = thread; y < height; y += ThreadCount )
+		{
+			const u8* s0 = (u8*) Level0->lock() + ( y << 2 ) * pitch0;
+			const u8* s1 = s0 + pitch0;
+			const u8* s2 = s1 + pitch0;
+			const u8* s3 = s2 + pitch0;
+
+			u8* d0 = (u8*) Level1->lock() + ( y << 1 ) * pitch1;
+			u8* d1 = d0 + pitch1;
+			u32* d2 = (u32*) Level2->lock() + y * width;
+			u32* sum = Sums + ( y * width << 2 );
+
+			for ( u32 x = 0; x != width; ++x )
+			{
+				const __m128i r0 = _mm_loadu_si128 ( (const __m128i*) ( s0 + ( x << 4 ) ) );
+				const __m128i r1 = _mm_loadu_si128 ( (const __m128i*) ( s1 + ( x << 4 ) ) );
+				const __m128i r2 = _mm_loadu_si128 ( (const __m128i*) ( s2 + ( x << 4 ) ) );
+				const __m128i r3 = _mm_loadu_si128 ( (const __m128i*) ( s3 + ( x << 4 ) ) );
+
+				// 2x2 sums of the left and the right half, upper and lower rows
+				__m128i a = _mm_add_epi16 ( _mm_unpacklo_epi8 ( r0, zero ), _mm_unpacklo_epi8 ( r1, zero ) );
+				__m128i b = _mm_add_epi16 ( _mm_unpackhi_epi8 ( r0, zero ), _mm_unpackhi_epi8 ( r1, zero ) );
+				const __m128i upper = _mm_add_epi16 ( _mm_unpacklo_epi64 ( a, b ), _mm_unpackhi_epi64 ( a, b ) );
+
+				a = _mm_add_epi16 ( _mm_unpacklo_epi8 ( r2, zero ), _mm_unpacklo_epi8 ( r3, zero ) );
+				b = _mm_add_epi16 ( _mm_unpackhi_epi8 ( r2, zero ), _mm_unpackhi_epi8 ( r3, zero ) );
+				const __m128i lower = _mm_add_epi16 ( _mm_unpacklo_epi64 ( a, b ), _mm_unpackhi_epi64 ( a, b ) );
+
+				const __m128i texel1 = _mm_packus_epi16 ( _mm_srli_epi16 ( upper, 2 ), _mm_srli_epi16 ( lower, 2 ) );
+				_mm_storel_epi64 ( (__m128i*) ( d0 + ( x << 3 ) ), texel1 );
+				_mm_storel_epi64 ( (__m128i*) ( d1 + ( x << 3 ) ), _mm_srli_si128 ( texel1, 8 ) );
+
+				__m128i block = _mm_add_epi16 ( upper, lower );
+				block = _mm_add_epi16 ( block, _mm_srli_si128 ( block, 8 ) );
+
+				d2[x] = _mm_cvtsi128_si32 ( _mm_packus_epi16 ( _mm_srli_epi16 ( block, 4 ), zero ) );
+				_mm_storeu_si128 ( (__m128i*) ( sum + ( x << 2 ) ), _mm_unpacklo_epi16 ( block, zero ) );
+			}
+		}
+	}
+
+private:
+	CImage* Level0;
+	CImage* Level1;
+	CImage* Level2;
+	u32* Sums;
+	u32 ThreadCount;
+};
+
+} // end anonymous namespace
+
+
+//! builds the mip levels of a power of two texture, texel exact to the box filter of level 0
+/** Level 3 and below are summed up from the channel sums of the level above,
+which are kept in place in the sums buffer. */
+static void buildMipMapLevels ( CImage** mipMap, CThreadPool* threads )
+{
+	const core::dimension2d<u32>& size0 = mipMap[0]->getDimension();
+	u32* sums = new u32 [ ( size0.Width >> 2 ) * ( size0.Height >> 2 ) * 4 ];
+
+	if ( threads && size0.getArea() >= MIPMAP_THREADED_MIN_AREA )
+	{
+		CMipMapJob job ( mipMap[0], mipMap[1], mipMap[2], sums, threads->getThreadCount() );
+		threads->run ( &job );
+	}
+	else
+	{
+		CMipMapJob job ( mipMap[0], mipMap[1], mipMap[2], sums, 1 );
+		job.run ( 0 );
+	}
+
+	for ( s32 i = 3; i < SOFTWARE_DRIVER_2_MIPMAPPING_MAX; ++i )
+	{
+		const core::dimension2d<u32>& prev = mipMap[i-1]->getDimension();
+		const core::dimension2d<u32>& size = mipMap[i]->getDimension();
+
+		const u32 stepX = prev.Width > size.Width ? 1 : 0;
+		const u32 stepY = prev.Height > size.Height ? 1 : 0;
+		const __m128i shift = _mm_cvtsi32_si128 ( s32_log2_s32 ( size0.getArea() / size.getArea() ) );
+
+		u32* dst = (u32*) mipMap[i]->lock();
+		u32* sum = sums;
+
+		for ( u32 y = 0; y != size.Height; ++y )
+		{
+			for ( u32 x = 0; x != size.Width; ++x )
+			{
+				// reads are never behind the write position, so the sums shrink in place
+				const u32* s = sums + ( ( ( y << stepY ) * prev.Width + ( x << stepX ) ) << 2 );
+				__m128i block = _mm_loadu_si128 ( (const __m128i*) s );
+				if ( stepX )
+					block = _mm_add_epi32 ( block, _mm_loadu_si128 ( (const __m128i*) ( s + 4 ) ) );
+				if ( stepY )
+				{
+					s += prev.Width << 2;
+					block = _mm_add_epi32 ( block, _mm_loadu_si128 ( (const __m128i*) s ) );
+					if ( stepX )
+						block = _mm_add_epi32 ( block, _mm_loadu_si128 ( (const __m128i*) ( s + 4 ) ) );
+				}
+
+				_mm_storeu_si128 ( (__m128i*) sum, block );
+				sum += 4;
+
+				const __m128i texel = _mm_packs_epi32 ( _mm_srl_epi32 ( block, shift ), block );
+				*dst++ = _mm_cvtsi128_si32 ( _mm_packus_epi16 ( texel, texel ) );
+			}
+		}
+		mipMap[i]->unlock();
+	}
+
+	delete [] sums;
+}
+
+#endif
+
+
 //! constructor
 CSoftwareTexture2::CSoftwareTexture2(IImage* image, const io::path& name,
-		u32 flags, void* mipmapData)
+		u32 flags, void* mipmapData, CThreadPool* threads)
 		: ITexture(name), MipMapLOD(0), Flags ( flags ), OriginalFormat(video::ECF_UNKNOWN)
 {
 	#ifdef _DEBUG
@@ -70,7 +214,7 @@ CSoftwareTexture2::CSoftwareTexture2(IImage* image, const io::path& name,
 		OrigImageDataSizeInPixels = (f32) 0.3f * MipMap[0]->getImageDataSizeInPixels();
 	}
 
-	regenerateMipMapLevels(mipmapData);
+	regenerateMipMapLevels(mipmapData, threads);
 }
 
 
@@ -88,6 +232,13 @@ CSoftwareTexture2::~CSoftwareTexture2()
 //! Regenerates the mip map levels of the texture. Useful after locking and
 //! modifying the texture
 void CSoftwareTexture2::regenerateMipMapLevels(void* mipmapData)
+{
+	regenerateMipMapLevels(mipmapData, 0);
+}
+
+
+//! Regenerates the mip map levels, large textures are filtered on the given threads
+void CSoftwareTexture2::regenerateMipMapLevels(void* mipmapData, CThreadPool* threads)
 {
 	if ( !hasMipMaps () )
 		return;
@@ -104,6 +255,14 @@ void CSoftwareTexture2::regenerateMipMapLevels(void* mipmapData)
 	core::dimension2d<u32> newSize;
 	core::dimension2d<u32> origSize=OrigSize;
 
+#if defined ( SOFTWARE_DRIVER_2_SSE2 ) && defined ( SOFTWARE_DRIVER_2_32BIT ) && SOFTWARE_DRIVER_2_MIPMAPPING_MAX > 2
+	// power of two levels of at least 4x4 texels are built in one pass over level 0
+	const core::dimension2d<u32>& size0 = MipMap[0]->getDimension();
+	const bool fastBoxFilter = 0 == mipmapData && SOFTWARE_DRIVER_2_MIPMAPPING_SCALE == 1 &&
+		size0.Width >= 4 && size0.Height >= 4 &&
+		0 == ( size0.Width & ( size0.Width - 1 ) ) && 0 == ( size0.Height & ( size0.Height - 1 ) );
+#endif
+
 	for (i=1; i < SOFTWARE_DRIVER_2_MIPMAPPING_MAX; ++i)
 	{
 		newSize = MipMap[i-1]->getDimension();
@@ -142,11 +301,20 @@ void CSoftwareTexture2::regenerateMipMapLevels(void* mipmapData)
 		{
 			MipMap[i] = new CImage(BURNINGSHADER_COLOR_FORMAT, newSize);
 
+#if defined ( SOFTWARE_DRIVER_2_SSE2 ) && defined ( SOFTWARE_DRIVER_2_32BIT ) && SOFTWARE_DRIVER_2_MIPMAPPING_MAX > 2
+			if ( fastBoxFilter )
+				continue;
+#endif
 			//static u32 color[] = { 0, 0xFFFF0000, 0xFF00FF00,0xFF0000FF,0xFFFFFF00,0xFFFF00FF,0xFF00FFFF,0xFF0F0F0F };
 			MipMap[i]->fill ( 0 );
 			MipMap[0]->copyToScalingBoxFilter( MipMap[i], 0, false );
 		}
 	}
+
+#if defined ( SOFTWARE_DRIVER_2_SSE2 ) && defined ( SOFTWARE_DRIVER_2_32BIT ) && SOFTWARE_DRIVER_2_MIPMAPPING_MAX > 2
+	if ( fastBoxFilter )
+		buildMipMapLevels ( MipMap, threads );
+#endif
 }
 
 
@@ -12,6 +12,9 @@
 
 namespace irr
 {
+
+class CThreadPool;
+
 namespace video
 {
 
@@ -30,7 +33,9 @@ public:
 		NP2_SIZE	= 4,
 		HAS_ALPHA	= 8
 	};
-	CSoftwareTexture2(IImage* surface, const io::path& name, u32 flags, void* mipmapData=0);
+	//! \param threads Optional rasterizer threads to build the mip levels of large textures
+	CSoftwareTexture2(IImage* surface, const io::path& name, u32 flags, void* mipmapData=0,
+		CThreadPool* threads=0);
 
 	//! destructor
 	virtual ~CSoftwareTexture2();
@@ -104,6 +109,9 @@ public:
 	//! modifying the texture
 	virtual void regenerateMipMapLevels(void* mipmapData=0);
 
+	//! Regenerates the mip map levels, large textures are filtered on the given threads
+	void regenerateMipMapLevels(void* mipmapData, CThreadPool* threads);
+
 	//! support mipmaps
 	virtual bool hasMipMaps() const
 	{
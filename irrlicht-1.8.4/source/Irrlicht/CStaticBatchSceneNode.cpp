@@ -0,0 +1,473 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CStaticBatchSceneNode.h"
+#include "ISceneManager.h"
+#include "IVideoDriver.h"
+#include "ICameraSceneNode.h"
+#include "SViewFrustum.h"
+#include "IMeshSceneNode.h"
+#include "IMesh.h"
+#include "IMaterialRenderer.h"
+#include "CDynamicMeshBuffer.h"
+#include "S3DVertex.h"
+
+namespace irr
+{
+namespace scene
+{
+
+static inline void transformTangents(video::S3DVertex& v, const core::matrix4& world)
+{
+}
+
+static inline void transformTangents(video::S3DVertexTangents& v, const core::matrix4& world)
+{
+	world.rotateVect(v.Tangent);
+	v.Tangent.normalize();
+	world.rotateVect(v.Binormal);
+	v.Binormal.normalize();
+}
+
+//! appends all vertices of src to dst, transformed into world space
+template <class T>
+static void appendVertices(IVertexBuffer& dst, const IMeshBuffer* src, const core::matrix4& world)
+{
+	const T* v = (const T*) src->getVertices();
+	const u32 count = src->getVertexCount();
+
+	for (u32 i=0; i<count; ++i)
+	{
+		T t(v[i]);
+		world.transformVect(t.Pos);
+		world.rotateVect(t.Normal);
+		t.Normal.normalize();
+		transformTangents(t, world);
+		dst.push_back((const video::S3DVertex&) t);
+	}
+}
+
+//! true if the box is completely on the outer side of one frustum plane
+static bool isOutsideFrustum(const SViewFrustum& frustum, const core::aabbox3d<f32>& box)
+{
+	core::vector3df edges[8];
+	box.getEdges(edges);
+
+	for (s32 i=0; i<SViewFrustum::VF_PLANE_COUNT; ++i)
+	{
+		bool boxInFrustum=false;
+		for (u32 j=0; j<8; ++j)
+		{
+			if (frustum.planes[i].classifyPointRelation(edges[j]) != core::ISREL3D_FRONT)
+			{
+				boxInFrustum=true;
+				break;
+			}
+		}
+
+		if (!boxInFrustum)
+			return true;
+	}
+	return false;
+}
+
+
+//! constructor
+CStaticBatchSceneNode::CStaticBatchSceneNode(ISceneNode* parent, ISceneManager* mgr,
+		s32 id, f32 chunkSize)
+	: IStaticBatchSceneNode(parent, mgr, id), ChunkSize(chunkSize),
+	MeshBufferCount(0), Batched(false)
+{
+	#ifdef _DEBUG
+	setDebugName("CStaticBatchSceneNode");
+	#endif
+
+	if (ChunkSize <= 0.f)
+		ChunkSize = 1000.f;
+}
+
+
+//! destructor
+CStaticBatchSceneNode::~CStaticBatchSceneNode()
+{
+	unbatch();
+
+	for (u32 i=0; i<SourceNodes.size(); ++i)
+		SourceNodes[i]->drop();
+}
+
+
+//! frame
+void CStaticBatchSceneNode::OnRegisterSceneNode()
+{
+	if (IsVisible && Batched)
+	{
+		video::IVideoDriver* driver = SceneManager->getVideoDriver();
+
+		u32 transparentCount = 0;
+		u32 solidCount = 0;
+
+		for (u32 c=0; c<Chunks.size() && !(solidCount && transparentCount); ++c)
+		{
+			const core::array<IMeshBuffer*>& buffers = Chunks[c].Buffers;
+			for (u32 i=0; i<buffers.size(); ++i)
+			{
+				const video::IMaterialRenderer* rnd =
+					driver->getMaterialRenderer(buffers[i]->getMaterial().MaterialType);
+
+				if (rnd && rnd->isTransparent())
+					++transparentCount;
+				else
+					++solidCount;
+
+				if (solidCount && transparentCount)
+					break;
+			}
+		}
+
+		if (solidCount)
+			SceneManager->registerNodeForRendering(this, scene::ESNRP_SOLID);
+
+		if (transparentCount)
+			SceneManager->registerNodeForRendering(this, scene::ESNRP_TRANSPARENT);
+	}
+
+	ISceneNode::OnRegisterSceneNode();
+}
+
+
+//! renders the node.
+void CStaticBatchSceneNode::render()
+{
+	video::IVideoDriver* driver = SceneManager->getVideoDriver();
+	const ICameraSceneNode* camera = SceneManager->getActiveCamera();
+
+	if (!Batched || !driver || !camera)
+		return;
+
+	const bool isTransparentPass =
+		SceneManager->getSceneNodeRenderPass() == scene::ESNRP_TRANSPARENT;
+
+	// merged geometry is already in world space
+	driver->setTransform(video::ETS_WORLD, core::IdentityMatrix);
+
+	const SViewFrustum* frustum = camera->getViewFrustum();
+	const core::aabbox3d<f32>& frustumBox = frustum->getBoundingBox();
+
+	for (u32 c=0; c<Chunks.size(); ++c)
+	{
+		const SChunk& chunk = Chunks[c];
+
+		if (!chunk.Box.intersectsWithBox(frustumBox) ||
+			isOutsideFrustum(*frustum, chunk.Box))
+			continue;
+
+		for (u32 i=0; i<chunk.Buffers.size(); ++i)
+		{
+			IMeshBuffer* mb = chunk.Buffers[i];
+			const video::SMaterial& material = mb->getMaterial();
+
+			const video::IMaterialRenderer* rnd = driver->getMaterialRenderer(material.MaterialType);
+			const bool transparent = (rnd && rnd->isTransparent());
+
+			// only render transparent buffer if this is the transparent render pass
+			// and solid only in solid pass
+			if (transparent == isTransparentPass)
+			{
+				driver->setMaterial(material);
+				driver->drawMeshBuffer(mb);
+			}
+		}
+	}
+
+	// for debug purposes only:
+	if (DebugDataVisible && !isTransparentPass)
+	{
+		video::SMaterial m;
+		m.Lighting = false;
+		driver->setMaterial(m);
+
+		if (DebugDataVisible & scene::EDS_BBOX)
+			driver->draw3DBox(Box, video::SColor(255,255,255,255));
+
+		if (DebugDataVisible & scene::EDS_BBOX_BUFFERS)
+		{
+			for (u32 c=0; c<Chunks.size(); ++c)
+				driver->draw3DBox(Chunks[c].Box, video::SColor(255,190,128,128));
+		}
+	}
+}
+
+
+//! returns the axis aligned bounding box of this node
+const core::aabbox3d<f32>& CStaticBatchSceneNode::getBoundingBox() const
+{
+	return Box;
+}
+
+
+//! merged geometry is in world space, so the node is never transformed
+void CStaticBatchSceneNode::updateAbsolutePosition()
+{
+	AbsoluteTransformation.makeIdentity();
+}
+
+
+void CStaticBatchSceneNode::addSourceNode(IMeshSceneNode* node)
+{
+	if (!node)
+		return;
+
+	if (SourceNodes.linear_search(node) != -1)
+		return;
+
+	node->grab();
+	SourceNodes.push_back(node);
+	SourceVisible.push_back(node->isVisible());
+}
+
+
+bool CStaticBatchSceneNode::removeSourceNode(IMeshSceneNode* node)
+{
+	const s32 index = SourceNodes.linear_search(node);
+	if (index == -1)
+		return false;
+
+	if (Batched)
+		node->setVisible(SourceVisible[index]);
+
+	node->drop();
+	SourceNodes.erase(index);
+	SourceVisible.erase(index);
+	return true;
+}
+
+
+u32 CStaticBatchSceneNode::getSourceNodeCount() const
+{
+	return SourceNodes.size();
+}
+
+
+IMeshSceneNode* CStaticBatchSceneNode::getSourceNode(u32 index) const
+{
+	if (index >= SourceNodes.size())
+		return 0;
+	return SourceNodes[index];
+}
+
+
+void CStaticBatchSceneNode::batch()
+{
+	unbatch();
+
+	for (u32 n=0; n<SourceNodes.size(); ++n)
+	{
+		IMeshSceneNode* node = SourceNodes[n];
+		IMesh* mesh = node->getMesh();
+
+		SourceVisible[n] = node->isVisible();
+
+		// nodes hidden before are not drawn by the batch either
+		if (!mesh || !SourceVisible[n])
+			continue;
+
+		// make sure the world transformation is up to date
+		node->updateAbsolutePosition();
+		const core::matrix4& world = node->getAbsoluteTransformation();
+
+		for (u32 i=0; i<mesh->getMeshBufferCount(); ++i)
+		{
+			const IMeshBuffer* mb = mesh->getMeshBuffer(i);
+			if (!mb || !mb->getIndexCount())
+				continue;
+
+			const video::SMaterial& material = node->isReadOnlyMaterials() ?
+				mb->getMaterial() : node->getMaterial(i);
+
+			appendMeshBuffer(mb, material, world);
+		}
+
+		node->setVisible(false);
+	}
+
+	Box.reset(0.f, 0.f, 0.f);
+	MeshBufferCount = 0;
+
+	for (u32 c=0; c<Chunks.size(); ++c)
+	{
+		SChunk& chunk = Chunks[c];
+		for (u32 i=0; i<chunk.Buffers.size(); ++i)
+		{
+			IMeshBuffer* mb = chunk.Buffers[i];
+			mb->recalculateBoundingBox();
+
+			if (i == 0)
+				chunk.Box = mb->getBoundingBox();
+			else
+				chunk.Box.addInternalBox(mb->getBoundingBox());
+		}
+
+		if (c == 0)
+			Box = chunk.Box;
+		else
+			Box.addInternalBox(chunk.Box);
+
+		MeshBufferCount += chunk.Buffers.size();
+	}
+
+	Batched = true;
+}
+
+
+void CStaticBatchSceneNode::unbatch()
+{
+	if (!Batched)
+		return;
+
+	for (u32 n=0; n<SourceNodes.size(); ++n)
+		SourceNodes[n]->setVisible(SourceVisible[n]);
+
+	clearChunks();
+	Batched = false;
+}
+
+
+bool CStaticBatchSceneNode::isBatched() const
+{
+	return Batched;
+}
+
+
+void CStaticBatchSceneNode::setChunkSize(f32 size)
+{
+	if (size > 0.f)
+		ChunkSize = size;
+}
+
+
+f32 CStaticBatchSceneNode::getChunkSize() const
+{
+	return ChunkSize;
+}
+
+
+u32 CStaticBatchSceneNode::getChunkCount() const
+{
+	return Chunks.size();
+}
+
+
+u32 CStaticBatchSceneNode::getMeshBufferCount() const
+{
+	return MeshBufferCount;
+}
+
+
+//! appends one source meshbuffer, transformed by world, to its chunk
+void CStaticBatchSceneNode::appendMeshBuffer(const IMeshBuffer* mb,
+		const video::SMaterial& material, const core::matrix4& world)
+{
+	core::aabbox3d<f32> worldBox = mb->getBoundingBox();
+	world.transformBoxEx(worldBox);
+	const core::vector3df center = worldBox.getCenter() / ChunkSize;
+
+	SChunkKey key;
+	key.X = core::floor32(center.X);
+	key.Y = core::floor32(center.Y);
+	key.Z = core::floor32(center.Z);
+
+	u32 chunkIndex;
+	core::map<SChunkKey, u32>::Node* node = ChunkMap.find(key);
+	if (node)
+	{
+		chunkIndex = node->getValue();
+	}
+	else
+	{
+		chunkIndex = Chunks.size();
+		Chunks.push_back(SChunk());
+		ChunkMap.insert(key, chunkIndex);
+	}
+
+	IMeshBuffer* dst = getChunkBuffer(Chunks[chunkIndex], material, mb->getVertexType());
+	IVertexBuffer& vertices = ((CDynamicMeshBuffer*) dst)->getVertexBuffer();
+	IIndexBuffer& indices = ((CDynamicMeshBuffer*) dst)->getIndexBuffer();
+
+	const u32 base = vertices.size();
+
+	switch (mb->getVertexType())
+	{
+	case video::EVT_STANDARD:
+		appendVertices<video::S3DVertex>(vertices, mb, world);
+		break;
+	case video::EVT_2TCOORDS:
+		appendVertices<video::S3DVertex2TCoords>(vertices, mb, world);
+		break;
+	case video::EVT_TANGENTS:
+		appendVertices<video::S3DVertexTangents>(vertices, mb, world);
+		break;
+	}
+
+	const u32 indexCount = mb->getIndexCount();
+	if (mb->getIndexType() == video::EIT_32BIT)
+	{
+		const u32* src = (const u32*) mb->getIndices();
+		for (u32 i=0; i<indexCount; ++i)
+			indices.push_back(base + src[i]);
+	}
+	else
+	{
+		const u16* src = mb->getIndices();
+		for (u32 i=0; i<indexCount; ++i)
+			indices.push_back(base + src[i]);
+	}
+}
+
+
+//! finds or creates the merged buffer for the material in the chunk
+IMeshBuffer* CStaticBatchSceneNode::getChunkBuffer(SChunk& chunk,
+		const video::SMaterial& material, video::E_VERTEX_TYPE vertexType)
+{
+	for (u32 i=0; i<chunk.Buffers.size(); ++i)
+	{
+		IMeshBuffer* mb = chunk.Buffers[i];
+		if (mb->getVertexType() == vertexType && mb->getMaterial() == material)
+			return mb;
+	}
+
+	CDynamicMeshBuffer* mb = new CDynamicMeshBuffer(vertexType, video::EIT_32BIT);
+	mb->getMaterial() = material;
+	mb->setHardwareMappingHint(EHM_STATIC);
+	chunk.Buffers.push_back(mb);
+	return mb;
+}
+
+
+//! drops all merged buffers
+void CStaticBatchSceneNode::clearChunks()
+{
+	video::IVideoDriver* driver = SceneManager ? SceneManager->getVideoDriver() : 0;
+
+	for (u32 c=0; c<Chunks.size(); ++c)
+	{
+		for (u32 i=0; i<Chunks[c].Buffers.size(); ++i)
+		{
+			IMeshBuffer* mb = Chunks[c].Buffers[i];
+			if (driver)
+				driver->removeHardwareBuffer(mb);
+			mb->drop();
+		}
+	}
+
+	Chunks.clear();
+	ChunkMap.clear();
+	MeshBufferCount = 0;
+	Box.reset(0.f, 0.f, 0.f);
+}
+
+
+} // end namespace scene
+} // end namespace irr
+
@@ -0,0 +1,109 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_STATIC_BATCH_SCENE_NODE_H_INCLUDED__
+#define __C_STATIC_BATCH_SCENE_NODE_H_INCLUDED__
+
+#include "IStaticBatchSceneNode.h"
+#include "IMeshBuffer.h"
+#include "irrMap.h"
+
+namespace irr
+{
+namespace scene
+{
+	//! Scene node merging static mesh scene nodes into chunked meshbuffers.
+	class CStaticBatchSceneNode : public IStaticBatchSceneNode
+	{
+	public:
+
+		//! constructor
+		CStaticBatchSceneNode(ISceneNode* parent, ISceneManager* mgr, s32 id,
+			f32 chunkSize=1000.f);
+
+		//! destructor
+		virtual ~CStaticBatchSceneNode();
+
+		//! frame
+		virtual void OnRegisterSceneNode();
+
+		//! renders the node.
+		virtual void render();
+
+		//! returns the axis aligned bounding box of this node
+		virtual const core::aabbox3d<f32>& getBoundingBox() const;
+
+		//! merged geometry is in world space, so the node is never transformed
+		virtual void updateAbsolutePosition();
+
+		virtual void addSourceNode(IMeshSceneNode* node);
+		virtual bool removeSourceNode(IMeshSceneNode* node);
+		virtual u32 getSourceNodeCount() const;
+		virtual IMeshSceneNode* getSourceNode(u32 index) const;
+
+		virtual void batch();
+		virtual void unbatch();
+		virtual bool isBatched() const;
+
+		virtual void setChunkSize(f32 size);
+		virtual f32 getChunkSize() const;
+		virtual u32 getChunkCount() const;
+		virtual u32 getMeshBufferCount() const;
+
+	private:
+
+		//! integer cell coordinates of a chunk
+		struct SChunkKey
+		{
+			s32 X, Y, Z;
+
+			bool operator<(const SChunkKey& other) const
+			{
+				if (X != other.X)
+					return X < other.X;
+				if (Y != other.Y)
+					return Y < other.Y;
+				return Z < other.Z;
+			}
+
+			bool operator==(const SChunkKey& other) const
+			{
+				return X == other.X && Y == other.Y && Z == other.Z;
+			}
+		};
+
+		struct SChunk
+		{
+			core::aabbox3d<f32> Box;
+			core::array<IMeshBuffer*> Buffers;
+		};
+
+		//! appends one source meshbuffer, transformed by world, to its chunk
+		void appendMeshBuffer(const IMeshBuffer* mb, const video::SMaterial& material,
+			const core::matrix4& world);
+
+		//! finds or creates the merged buffer for the material in the chunk
+		IMeshBuffer* getChunkBuffer(SChunk& chunk, const video::SMaterial& material,
+			video::E_VERTEX_TYPE vertexType);
+
+		//! drops all merged buffers
+		void clearChunks();
+
+		core::array<IMeshSceneNode*> SourceNodes;
+		core::array<bool> SourceVisible;
+
+		core::array<SChunk> Chunks;
+		core::map<SChunkKey, u32> ChunkMap;
+
+		core::aabbox3d<f32> Box;
+		f32 ChunkSize;
+		u32 MeshBufferCount;
+		bool Batched;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
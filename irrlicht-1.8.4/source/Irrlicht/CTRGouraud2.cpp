@@ -3,619 +3,50 @@
 // For conditions of distribution and use, see copyright notice in irrlicht.h
 
 #include "IrrCompileConfig.h"
-#include "IBurningShader.h"
+#include "CTRTemplate.h"
 
 #ifdef _IRR_COMPILE_WITH_BURNINGSVIDEO_
 
-// compile flag for this file
-#undef USE_ZBUFFER
-#undef IPOL_Z
-#undef CMP_Z
-#undef WRITE_Z
-
-#undef IPOL_W
-#undef CMP_W
-#undef WRITE_W
-
-#undef SUBTEXEL
-#undef INVERSE_W
-
-#undef IPOL_C0
-#undef IPOL_T0
-#undef IPOL_T1
-
-// define render case
-#define SUBTEXEL
-#define INVERSE_W
-
-#define USE_ZBUFFER
-#define IPOL_W
-#define CMP_W
-#define WRITE_W
-
-#define IPOL_C0
-//#define IPOL_T0
-//#define IPOL_T1
-
-// apply global override
-#ifndef SOFTWARE_DRIVER_2_PERSPECTIVE_CORRECT
-	#undef INVERSE_W
-#endif
-
-#ifndef SOFTWARE_DRIVER_2_SUBTEXEL
-	#undef SUBTEXEL
-#endif
-
-#ifndef SOFTWARE_DRIVER_2_USE_VERTEX_COLOR
-	#undef IPOL_C0
-#endif
-
-#if !defined ( SOFTWARE_DRIVER_2_USE_WBUFFER ) && defined ( USE_ZBUFFER )
-	#ifndef SOFTWARE_DRIVER_2_PERSPECTIVE_CORRECT
-		#undef IPOL_W
-	#endif
-	#define IPOL_Z
-
-	#ifdef CMP_W
-		#undef CMP_W
-		#define CMP_Z
-	#endif
-
-	#ifdef WRITE_W
-		#undef WRITE_W
-		#define WRITE_Z
-	#endif
-
-#endif
-
-
 namespace irr
 {
 
 namespace video
 {
 
-class CTRGouraud2 : public IBurningShader
-{
-public:
-
-	//! constructor
-	CTRGouraud2(CBurningVideoDriver* driver);
-
-	//! draws an indexed triangle list
-	virtual void drawTriangle ( const s4DVertex *a,const s4DVertex *b,const s4DVertex *c );
-
-
-private:
-	void scanline_bilinear ();
-	sScanConvertData scan;
-	sScanLineData line;
-
-};
-
-//! constructor
-CTRGouraud2::CTRGouraud2(CBurningVideoDriver* driver)
-: IBurningShader(driver)
+//! vertex color
+struct sPixelGouraud2
 {
-	#ifdef _DEBUG
-	setDebugName("CTRGouraud2");
-	#endif
-}
-
-
-
-/*!
-*/
-void CTRGouraud2::scanline_bilinear ()
-{
-	tVideoSample *dst;
-
-#ifdef USE_ZBUFFER
-	fp24 *z;
-#endif
-
-	s32 xStart;
-	s32 xEnd;
-	s32 dx;
-
-#ifdef SUBTEXEL
-	f32 subPixel;
-#endif
-
-#ifdef IPOL_Z
-	f32 slopeZ;
-#endif
-#ifdef IPOL_W
-	fp24 slopeW;
-#endif
-#ifdef IPOL_C0
-	sVec4 slopeC;
-#endif
-#ifdef IPOL_T0
-	sVec2 slopeT[BURNING_MATERIAL_MAX_TEXTURES];
-#endif
-
-	// apply top-left fill-convention, left
-	xStart = core::ceil32( line.x[0] );
-	xEnd = core::ceil32( line.x[1] ) - 1;
-
-	dx = xEnd - xStart;
-
-	if ( dx < 0 )
-		return;
-
-	// slopes
-	const f32 invDeltaX = core::reciprocal_approxim ( line.x[1] - line.x[0] );
-
-#ifdef IPOL_Z
-	slopeZ = (line.z[1] - line.z[0]) * invDeltaX;
-#endif
-#ifdef IPOL_W
-	slopeW = (line.w[1] - line.w[0]) * invDeltaX;
-#endif
-#ifdef IPOL_C0
-	slopeC = (line.c[0][1] - line.c[0][0]) * invDeltaX;
-#endif
-#ifdef IPOL_T0
-	slopeT[0] = (line.t[0][1] - line.t[0][0]) * invDeltaX;
-#endif
-#ifdef IPOL_T1
-	slopeT[1] = (line.t[1][1] - line.t[1][0]) * invDeltaX;
-#endif
-
-#ifdef SUBTEXEL
-	subPixel = ( (f32) xStart ) - line.x[0];
-#ifdef IPOL_Z
-	line.z[0] += slopeZ * subPixel;
-#endif
-#ifdef IPOL_W
-	line.w[0] += slopeW * subPixel;
-#endif
-#ifdef IPOL_C0
-	line.c[0][0] += slopeC * subPixel;
-#endif
-#ifdef IPOL_T0
-	line.t[0][0] += slopeT[0] * subPixel;
-#endif
-#ifdef IPOL_T1
-	line.t[1][0] += slopeT[1] * subPixel;
-#endif
-#endif
-
-	dst = (tVideoSample*)RenderTarget->lock() + ( line.y * RenderTarget->getDimension().Width ) + xStart;
-
-#ifdef USE_ZBUFFER
-	z = (fp24*) DepthBuffer->lock() + ( line.y * RenderTarget->getDimension().Width ) + xStart;
-#endif
-
-
-
-#ifdef IPOL_C0
-	tFixPoint r0, g0, b0;
-
-#ifdef INVERSE_W
-	f32 inversew;
-#endif
-
-#endif
-
-	for ( s32 i = 0; i <= dx; ++i )
+	enum
 	{
-#ifdef CMP_Z
-		if ( line.z[0] < z[i] )
-#endif
-#ifdef CMP_W
-		if ( line.w[0] >= z[i] )
-#endif
+		USE_ZBUFFER = 1,
+		CMP_W = 1,
+		WRITE_W = 1,
+		IPOL_W = 1,
+		IPOL_C0 = 1,
+		IPOL_T0 = 0,
+		IPOL_T1 = 0
+	};
+
+	static REALINLINE void shade ( tVideoSample &dst, const sScanLineData &line,
+									const sInternalTexture *IT, const tFixPointu dither )
+	{
+#ifdef SOFTWARE_DRIVER_2_USE_VERTEX_COLOR
+		tFixPoint r0, g0, b0;
 
-		{
-#ifdef IPOL_C0
-#ifdef INVERSE_W
-			inversew = core::reciprocal ( line.w[0] );
+#ifdef SOFTWARE_DRIVER_2_PERSPECTIVE_CORRECT
+		const f32 inversew = core::reciprocal ( line.w[0] );
 
-			getSample_color ( r0, g0, b0, line.c[0][0] * inversew );
+		getSample_color ( r0, g0, b0, line.c[0][0] * inversew );
 #else
-			getSample_color ( r0, g0, b0, line.c[0][0] );
+		getSample_color ( r0, g0, b0, line.c[0][0] );
 #endif
 
-			dst[i] = fix_to_color ( r0, g0, b0 );
+		dst = fix_to_color ( r0, g0, b0 );
 #else
-			dst[i] = COLOR_BRIGHT_WHITE;
-#endif
-
-#ifdef WRITE_Z
-			z[i] = line.z[0];
-#endif
-#ifdef WRITE_W
-			z[i] = line.w[0];
-#endif
-
-		}
-
-#ifdef IPOL_Z
-		line.z[0] += slopeZ;
-#endif
-#ifdef IPOL_W
-		line.w[0] += slopeW;
-#endif
-#ifdef IPOL_C0
-		line.c[0][0] += slopeC;
-#endif
-#ifdef IPOL_T0
-		line.t[0][0] += slopeT[0];
-#endif
-#ifdef IPOL_T1
-		line.t[1][0] += slopeT[1];
-#endif
-	}
-
-}
-
-void CTRGouraud2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,const s4DVertex *c )
-{
-	// sort on height, y
-	if ( a->Pos.y > b->Pos.y ) swapVertexPointer(&a, &b);
-	if ( a->Pos.y > c->Pos.y ) swapVertexPointer(&a, &c);
-	if ( b->Pos.y > c->Pos.y ) swapVertexPointer(&b, &c);
-
-	const f32 ca = c->Pos.y - a->Pos.y;
-	const f32 ba = b->Pos.y - a->Pos.y;
-	const f32 cb = c->Pos.y - b->Pos.y;
-	// calculate delta y of the edges
-	scan.invDeltaY[0] = core::reciprocal( ca );
-	scan.invDeltaY[1] = core::reciprocal( ba );
-	scan.invDeltaY[2] = core::reciprocal( cb );
-
-	if ( F32_LOWER_EQUAL_0 ( scan.invDeltaY[0] ) )
-		return;
-
-	// find if the major edge is left or right aligned
-	f32 temp[4];
-
-	temp[0] = a->Pos.x - c->Pos.x;
-	temp[1] = -ca;
-	temp[2] = b->Pos.x - a->Pos.x;
-	temp[3] = ba;
-
-	scan.left = ( temp[0] * temp[3] - temp[1] * temp[2] ) > 0.f ? 0 : 1;
-	scan.right = 1 - scan.left;
-
-	// calculate slopes for the major edge
-	scan.slopeX[0] = (c->Pos.x - a->Pos.x) * scan.invDeltaY[0];
-	scan.x[0] = a->Pos.x;
-
-#ifdef IPOL_Z
-	scan.slopeZ[0] = (c->Pos.z - a->Pos.z) * scan.invDeltaY[0];
-	scan.z[0] = a->Pos.z;
-#endif
-
-#ifdef IPOL_W
-	scan.slopeW[0] = (c->Pos.w - a->Pos.w) * scan.invDeltaY[0];
-	scan.w[0] = a->Pos.w;
-#endif
-
-#ifdef IPOL_C0
-	scan.slopeC[0][0] = (c->Color[0] - a->Color[0]) * scan.invDeltaY[0];
-	scan.c[0][0] = a->Color[0];
-#endif
-
-#ifdef IPOL_T0
-	scan.slopeT[0][0] = (c->Tex[0] - a->Tex[0]) * scan.invDeltaY[0];
-	scan.t[0][0] = a->Tex[0];
-#endif
-
-#ifdef IPOL_T1
-	scan.slopeT[1][0] = (c->Tex[1] - a->Tex[1]) * scan.invDeltaY[0];
-	scan.t[1][0] = a->Tex[1];
-#endif
-
-	// top left fill convention y run
-	s32 yStart;
-	s32 yEnd;
-
-#ifdef SUBTEXEL
-	f32 subPixel;
-#endif
-
-
-	// rasterize upper sub-triangle
-	if ( (f32) 0.0 != scan.invDeltaY[1]  )
-	{
-		// calculate slopes for top edge
-		scan.slopeX[1] = (b->Pos.x - a->Pos.x) * scan.invDeltaY[1];
-		scan.x[1] = a->Pos.x;
-
-#ifdef IPOL_Z
-		scan.slopeZ[1] = (b->Pos.z - a->Pos.z) * scan.invDeltaY[1];
-		scan.z[1] = a->Pos.z;
-#endif
-
-#ifdef IPOL_W
-		scan.slopeW[1] = (b->Pos.w - a->Pos.w) * scan.invDeltaY[1];
-		scan.w[1] = a->Pos.w;
+		dst = COLOR_BRIGHT_WHITE;
 #endif
-
-#ifdef IPOL_C0
-		scan.slopeC[0][1] = (b->Color[0] - a->Color[0]) * scan.invDeltaY[1];
-		scan.c[0][1] = a->Color[0];
-#endif
-
-#ifdef IPOL_T0
-		scan.slopeT[0][1] = (b->Tex[0] - a->Tex[0]) * scan.invDeltaY[1];
-		scan.t[0][1] = a->Tex[0];
-#endif
-
-#ifdef IPOL_T1
-		scan.slopeT[1][1] = (b->Tex[1] - a->Tex[1]) * scan.invDeltaY[1];
-		scan.t[1][1] = a->Tex[1];
-#endif
-
-		// apply top-left fill convention, top part
-		yStart = core::ceil32( a->Pos.y );
-		yEnd = core::ceil32( b->Pos.y ) - 1;
-
-#ifdef SUBTEXEL
-		subPixel = ( (f32) yStart ) - a->Pos.y;
-
-		// correct to pixel center
-		scan.x[0] += scan.slopeX[0] * subPixel;
-		scan.x[1] += scan.slopeX[1] * subPixel;		
-
-#ifdef IPOL_Z
-		scan.z[0] += scan.slopeZ[0] * subPixel;
-		scan.z[1] += scan.slopeZ[1] * subPixel;		
-#endif
-
-#ifdef IPOL_W
-		scan.w[0] += scan.slopeW[0] * subPixel;
-		scan.w[1] += scan.slopeW[1] * subPixel;		
-#endif
-
-#ifdef IPOL_C0
-		scan.c[0][0] += scan.slopeC[0][0] * subPixel;
-		scan.c[0][1] += scan.slopeC[0][1] * subPixel;		
-#endif
-
-#ifdef IPOL_T0
-		scan.t[0][0] += scan.slopeT[0][0] * subPixel;
-		scan.t[0][1] += scan.slopeT[0][1] * subPixel;		
-#endif
-
-#ifdef IPOL_T1
-		scan.t[1][0] += scan.slopeT[1][0] * subPixel;
-		scan.t[1][1] += scan.slopeT[1][1] * subPixel;		
-#endif
-
-#endif
-
-		// rasterize the edge scanlines
-		for( line.y = yStart; line.y <= yEnd; ++line.y)
-		{
-			line.x[scan.left] = scan.x[0];
-			line.x[scan.right] = scan.x[1];
-
-#ifdef IPOL_Z
-			line.z[scan.left] = scan.z[0];
-			line.z[scan.right] = scan.z[1];
-#endif
-
-#ifdef IPOL_W
-			line.w[scan.left] = scan.w[0];
-			line.w[scan.right] = scan.w[1];
-#endif
-
-#ifdef IPOL_C0
-			line.c[0][scan.left] = scan.c[0][0];
-			line.c[0][scan.right] = scan.c[0][1];
-#endif
-
-#ifdef IPOL_T0
-			line.t[0][scan.left] = scan.t[0][0];
-			line.t[0][scan.right] = scan.t[0][1];
-#endif
-
-#ifdef IPOL_T1
-			line.t[1][scan.left] = scan.t[1][0];
-			line.t[1][scan.right] = scan.t[1][1];
-#endif
-
-			// render a scanline
-			scanline_bilinear ();
-
-			scan.x[0] += scan.slopeX[0];
-			scan.x[1] += scan.slopeX[1];
-
-#ifdef IPOL_Z
-			scan.z[0] += scan.slopeZ[0];
-			scan.z[1] += scan.slopeZ[1];
-#endif
-
-#ifdef IPOL_W
-			scan.w[0] += scan.slopeW[0];
-			scan.w[1] += scan.slopeW[1];
-#endif
-
-#ifdef IPOL_C0
-			scan.c[0][0] += scan.slopeC[0][0];
-			scan.c[0][1] += scan.slopeC[0][1];
-#endif
-
-#ifdef IPOL_T0
-			scan.t[0][0] += scan.slopeT[0][0];
-			scan.t[0][1] += scan.slopeT[0][1];
-#endif
-
-#ifdef IPOL_T1
-			scan.t[1][0] += scan.slopeT[1][0];
-			scan.t[1][1] += scan.slopeT[1][1];
-#endif
-
-		}
-	}
-
-	// rasterize lower sub-triangle
-	if ( (f32) 0.0 != scan.invDeltaY[2] )
-	{
-		// advance to middle point
-		if( (f32) 0.0 != scan.invDeltaY[1] )
-		{
-			temp[0] = b->Pos.y - a->Pos.y;	// dy
-
-			scan.x[0] = a->Pos.x + scan.slopeX[0] * temp[0];
-#ifdef IPOL_Z
-			scan.z[0] = a->Pos.z + scan.slopeZ[0] * temp[0];
-#endif
-#ifdef IPOL_W
-			scan.w[0] = a->Pos.w + scan.slopeW[0] * temp[0];
-#endif
-#ifdef IPOL_C0
-			scan.c[0][0] = a->Color[0] + scan.slopeC[0][0] * temp[0];
-#endif
-#ifdef IPOL_T0
-			scan.t[0][0] = a->Tex[0] + scan.slopeT[0][0] * temp[0];
-#endif
-#ifdef IPOL_T1
-			scan.t[1][0] = a->Tex[1] + scan.slopeT[1][0] * temp[0];
-#endif
-
-		}
-
-		// calculate slopes for bottom edge
-		scan.slopeX[1] = (c->Pos.x - b->Pos.x) * scan.invDeltaY[2];
-		scan.x[1] = b->Pos.x;
-
-#ifdef IPOL_Z
-		scan.slopeZ[1] = (c->Pos.z - b->Pos.z) * scan.invDeltaY[2];
-		scan.z[1] = b->Pos.z;
-#endif
-
-#ifdef IPOL_W
-		scan.slopeW[1] = (c->Pos.w - b->Pos.w) * scan.invDeltaY[2];
-		scan.w[1] = b->Pos.w;
-#endif
-
-#ifdef IPOL_C0
-		scan.slopeC[0][1] = (c->Color[0] - b->Color[0]) * scan.invDeltaY[2];
-		scan.c[0][1] = b->Color[0];
-#endif
-
-#ifdef IPOL_T0
-		scan.slopeT[0][1] = (c->Tex[0] - b->Tex[0]) * scan.invDeltaY[2];
-		scan.t[0][1] = b->Tex[0];
-#endif
-
-#ifdef IPOL_T1
-		scan.slopeT[1][1] = (c->Tex[1] - b->Tex[1]) * scan.invDeltaY[2];
-		scan.t[1][1] = b->Tex[1];
-#endif
-
-		// apply top-left fill convention, top part
-		yStart = core::ceil32( b->Pos.y );
-		yEnd = core::ceil32( c->Pos.y ) - 1;
-
-#ifdef SUBTEXEL
-
-		subPixel = ( (f32) yStart ) - b->Pos.y;
-
-		// correct to pixel center
-		scan.x[0] += scan.slopeX[0] * subPixel;
-		scan.x[1] += scan.slopeX[1] * subPixel;		
-
-#ifdef IPOL_Z
-		scan.z[0] += scan.slopeZ[0] * subPixel;
-		scan.z[1] += scan.slopeZ[1] * subPixel;		
-#endif
-
-#ifdef IPOL_W
-		scan.w[0] += scan.slopeW[0] * subPixel;
-		scan.w[1] += scan.slopeW[1] * subPixel;		
-#endif
-
-#ifdef IPOL_C0
-		scan.c[0][0] += scan.slopeC[0][0] * subPixel;
-		scan.c[0][1] += scan.slopeC[0][1] * subPixel;		
-#endif
-
-#ifdef IPOL_T0
-		scan.t[0][0] += scan.slopeT[0][0] * subPixel;
-		scan.t[0][1] += scan.slopeT[0][1] * subPixel;		
-#endif
-
-#ifdef IPOL_T1
-		scan.t[1][0] += scan.slopeT[1][0] * subPixel;
-		scan.t[1][1] += scan.slopeT[1][1] * subPixel;		
-#endif
-
-#endif
-
-		// rasterize the edge scanlines
-		for( line.y = yStart; line.y <= yEnd; ++line.y)
-		{
-			line.x[scan.left] = scan.x[0];
-			line.x[scan.right] = scan.x[1];
-
-#ifdef IPOL_Z
-			line.z[scan.left] = scan.z[0];
-			line.z[scan.right] = scan.z[1];
-#endif
-
-#ifdef IPOL_W
-			line.w[scan.left] = scan.w[0];
-			line.w[scan.right] = scan.w[1];
-#endif
-
-#ifdef IPOL_C0
-			line.c[0][scan.left] = scan.c[0][0];
-			line.c[0][scan.right] = scan.c[0][1];
-#endif
-
-#ifdef IPOL_T0
-			line.t[0][scan.left] = scan.t[0][0];
-			line.t[0][scan.right] = scan.t[0][1];
-#endif
-
-#ifdef IPOL_T1
-			line.t[1][scan.left] = scan.t[1][0];
-			line.t[1][scan.right] = scan.t[1][1];
-#endif
-
-			// render a scanline
-			scanline_bilinear ();
-
-			scan.x[0] += scan.slopeX[0];
-			scan.x[1] += scan.slopeX[1];
-
-#ifdef IPOL_Z
-			scan.z[0] += scan.slopeZ[0];
-			scan.z[1] += scan.slopeZ[1];
-#endif
-
-#ifdef IPOL_W
-			scan.w[0] += scan.slopeW[0];
-			scan.w[1] += scan.slopeW[1];
-#endif
-
-#ifdef IPOL_C0
-			scan.c[0][0] += scan.slopeC[0][0];
-			scan.c[0][1] += scan.slopeC[0][1];
-#endif
-
-#ifdef IPOL_T0
-			scan.t[0][0] += scan.slopeT[0][0];
-			scan.t[0][1] += scan.slopeT[0][1];
-#endif
-
-#ifdef IPOL_T1
-			scan.t[1][0] += scan.slopeT[1][0];
-			scan.t[1][1] += scan.slopeT[1][1];
-#endif
-
-		}
 	}
-
-
-}
-
+};
 
 } // end namespace video
 } // end namespace irr
@@ -631,7 +62,7 @@ namespace video
 IBurningShader* createTriangleRendererGouraud2(CBurningVideoDriver* driver)
 {
 	#ifdef _IRR_COMPILE_WITH_BURNINGSVIDEO_
-	return new CTRGouraud2(driver);
+	return new CTRTemplate<sPixelGouraud2>(driver);
 	#else
 	return 0;
 	#endif // _IRR_COMPILE_WITH_BURNINGSVIDEO_
@@ -640,6 +71,3 @@ IBurningShader* createTriangleRendererGouraud2(CBurningVideoDriver* driver)
 
 } // end namespace video
 } // end namespace irr
-
-
-
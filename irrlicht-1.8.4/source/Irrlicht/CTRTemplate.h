@@ -0,0 +1,473 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt / Thomas Alten
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_TR_TEMPLATE_H_INCLUDED__
+#define __C_TR_TEMPLATE_H_INCLUDED__
+
+#include "IBurningShader.h"
+
+#ifdef _IRR_COMPILE_WITH_BURNINGSVIDEO_
+
+#ifndef SOFTWARE_DRIVER_2_USE_WBUFFER
+	#error "the burnings template rasterizer needs SOFTWARE_DRIVER_2_USE_WBUFFER"
+#endif
+
+namespace irr
+{
+
+namespace video
+{
+
+//! Triangle rasterizer generated from a pixel policy
+/** The policy replaces the render case defines of the hand written
+triangle renderers. It is a struct with the compile time flags
+
+	USE_ZBUFFER	lock the depth buffer
+	CMP_W		pass pixels with w >= z only
+	WRITE_W		write w of passed pixels
+	IPOL_W		interpolate w
+	IPOL_C0		interpolate vertex color 0, if SOFTWARE_DRIVER_2_USE_VERTEX_COLOR
+	IPOL_T0		interpolate texture coordinates 0
+	IPOL_T1		interpolate texture coordinates 1
+
+and a function writing one passed pixel
+
+	static void shade ( tVideoSample &dst, const sScanLineData &line,
+		const sInternalTexture *IT, const tFixPointu dither );
+
+dither is the ordered dither offset of the pixel with
+BURNINGVIDEO_RENDERER_FAST and 0 otherwise. Flags which are 0 remove the
+interpolation and depth code at compile time. */
+template < class TPixel >
+class CTRTemplate : public IBurningShader
+{
+public:
+
+	//! constructor
+	CTRTemplate(CBurningVideoDriver* driver)
+		: IBurningShader(driver)
+	{
+		#ifdef _DEBUG
+		setDebugName("CTRTemplate");
+		#endif
+	}
+
+	//! draws an indexed triangle list
+	virtual void drawTriangle ( const s4DVertex *a,const s4DVertex *b,const s4DVertex *c );
+
+	//! rows and spans are clamped to the viewport before the subtexel correction
+	virtual bool canScissor () const
+	{
+#ifdef SOFTWARE_DRIVER_2_SUBTEXEL
+		return true;
+#else
+		return false;
+#endif
+	}
+
+private:
+
+	enum
+	{
+#ifdef SOFTWARE_DRIVER_2_USE_VERTEX_COLOR
+		IPOL_C0 = TPixel::IPOL_C0,
+#else
+		IPOL_C0 = 0,
+#endif
+		IPOL_W = TPixel::IPOL_W || TPixel::CMP_W || TPixel::WRITE_W
+	};
+
+	//! interpolates the edges between the vertex rows of a sub triangle
+	void scanEdges ( s32 yStart, s32 yEnd );
+
+	//! rasterizes one span
+	void scanline ();
+
+	sScanConvertData scan;
+	sScanLineData line;
+};
+
+
+template < class TPixel >
+void CTRTemplate<TPixel>::scanline ()
+{
+	// apply top-left fill-convention, left
+	s32 xStart = core::ceil32( line.x[0] );
+	s32 xEnd = core::ceil32( line.x[1] ) - 1;
+
+	// guard band triangles may reach outside the viewport
+	scissorSpan ( xStart, xEnd );
+
+	s32 dx = xEnd - xStart;
+
+	if ( dx < 0 )
+		return;
+
+	if ( TPixel::CMP_W )
+	{
+		// skip the tiles at both ends in which the span is hidden
+		if ( !clipSpanDepth ( line.y, xStart, xEnd, line.x, line.w ) )
+			return;
+		dx = xEnd - xStart;
+	}
+
+	// slopes
+	const f32 invDeltaX = core::reciprocal_approxim ( line.x[1] - line.x[0] );
+
+	fp24 slopeW = 0.f;
+	sVec4 slopeC;
+	sVec2 slopeT[2];
+
+	if ( IPOL_W )
+		slopeW = (line.w[1] - line.w[0]) * invDeltaX;
+#ifdef SOFTWARE_DRIVER_2_USE_VERTEX_COLOR
+	if ( IPOL_C0 )
+		slopeC = (line.c[0][1] - line.c[0][0]) * invDeltaX;
+#endif
+	if ( TPixel::IPOL_T0 )
+		slopeT[0] = (line.t[0][1] - line.t[0][0]) * invDeltaX;
+	if ( TPixel::IPOL_T1 )
+		slopeT[1] = (line.t[1][1] - line.t[1][0]) * invDeltaX;
+
+#ifdef SOFTWARE_DRIVER_2_SUBTEXEL
+	const f32 subPixel = ( (f32) xStart ) - line.x[0];
+	if ( IPOL_W )
+		line.w[0] += slopeW * subPixel;
+#ifdef SOFTWARE_DRIVER_2_USE_VERTEX_COLOR
+	if ( IPOL_C0 )
+		line.c[0][0] += slopeC * subPixel;
+#endif
+	if ( TPixel::IPOL_T0 )
+		line.t[0][0] += slopeT[0] * subPixel;
+	if ( TPixel::IPOL_T1 )
+		line.t[1][0] += slopeT[1] * subPixel;
+#endif
+
+	tVideoSample *dst = (tVideoSample*)RenderTarget->lock() + ( line.y * RenderTarget->getDimension().Width ) + xStart;
+
+	fp24 *z = 0;
+	if ( TPixel::USE_ZBUFFER )
+		z = (fp24*) DepthBuffer->lock() + ( line.y * RenderTarget->getDimension().Width ) + xStart;
+
+#ifdef BURNINGVIDEO_RENDERER_FAST
+	const u32 dIndex = ( line.y & 3 ) << 2;
+#endif
+
+	// step a copy, stores to dst and z can not alias it
+	sScanLineData span = line;
+
+	for ( s32 i = 0; i <= dx; ++i )
+	{
+		if ( !TPixel::CMP_W || span.w[0] >= z[i] )
+		{
+			if ( TPixel::WRITE_W )
+				z[i] = span.w[0];
+
+#ifdef BURNINGVIDEO_RENDERER_FAST
+			TPixel::shade ( dst[i], span, IT, dithermask [ dIndex | ( i & 3 ) ] );
+#else
+			TPixel::shade ( dst[i], span, IT, 0 );
+#endif
+		}
+
+		if ( IPOL_W )
+			span.w[0] += slopeW;
+#ifdef SOFTWARE_DRIVER_2_USE_VERTEX_COLOR
+		if ( IPOL_C0 )
+			span.c[0][0] += slopeC;
+#endif
+		if ( TPixel::IPOL_T0 )
+			span.t[0][0] += slopeT[0];
+		if ( TPixel::IPOL_T1 )
+			span.t[1][0] += slopeT[1];
+	}
+}
+
+
+template < class TPixel >
+void CTRTemplate<TPixel>::scanEdges ( s32 yStart, s32 yEnd )
+{
+	for( line.y = yStart; line.y <= yEnd; ++line.y)
+	{
+		line.x[scan.left] = scan.x[0];
+		line.x[scan.right] = scan.x[1];
+
+		if ( IPOL_W )
+		{
+			line.w[scan.left] = scan.w[0];
+			line.w[scan.right] = scan.w[1];
+		}
+#ifdef SOFTWARE_DRIVER_2_USE_VERTEX_COLOR
+		if ( IPOL_C0 )
+		{
+			line.c[0][scan.left] = scan.c[0][0];
+			line.c[0][scan.right] = scan.c[0][1];
+		}
+#endif
+		if ( TPixel::IPOL_T0 )
+		{
+			line.t[0][scan.left] = scan.t[0][0];
+			line.t[0][scan.right] = scan.t[0][1];
+		}
+		if ( TPixel::IPOL_T1 )
+		{
+			line.t[1][scan.left] = scan.t[1][0];
+			line.t[1][scan.right] = scan.t[1][1];
+		}
+
+		// render a scanline
+		if ( isRowOwned ( line.y ) )
+			scanline ();
+
+		scan.x[0] += scan.slopeX[0];
+		scan.x[1] += scan.slopeX[1];
+
+		if ( IPOL_W )
+		{
+			scan.w[0] += scan.slopeW[0];
+			scan.w[1] += scan.slopeW[1];
+		}
+		if ( IPOL_C0 )
+		{
+			scan.c[0][0] += scan.slopeC[0][0];
+			scan.c[0][1] += scan.slopeC[0][1];
+		}
+		if ( TPixel::IPOL_T0 )
+		{
+			scan.t[0][0] += scan.slopeT[0][0];
+			scan.t[0][1] += scan.slopeT[0][1];
+		}
+		if ( TPixel::IPOL_T1 )
+		{
+			scan.t[1][0] += scan.slopeT[1][0];
+			scan.t[1][1] += scan.slopeT[1][1];
+		}
+	}
+}
+
+
+template < class TPixel >
+void CTRTemplate<TPixel>::drawTriangle ( const s4DVertex *a,const s4DVertex *b,const s4DVertex *c )
+{
+	// hidden behind the coarse depth of all tiles it touches
+	if ( TPixel::CMP_W && isOccluded ( a, b, c ) )
+		return;
+	if ( TPixel::WRITE_W )
+		markDepthTiles ( a, b, c );
+
+	// sort on height, y
+	if ( F32_A_GREATER_B ( a->Pos.y , b->Pos.y ) ) swapVertexPointer(&a, &b);
+	if ( F32_A_GREATER_B ( b->Pos.y , c->Pos.y ) ) swapVertexPointer(&b, &c);
+	if ( F32_A_GREATER_B ( a->Pos.y , b->Pos.y ) ) swapVertexPointer(&a, &b);
+
+	const f32 ca = c->Pos.y - a->Pos.y;
+	const f32 ba = b->Pos.y - a->Pos.y;
+	const f32 cb = c->Pos.y - b->Pos.y;
+	// calculate delta y of the edges
+	scan.invDeltaY[0] = core::reciprocal( ca );
+	scan.invDeltaY[1] = core::reciprocal( ba );
+	scan.invDeltaY[2] = core::reciprocal( cb );
+
+	if ( F32_LOWER_EQUAL_0 ( scan.invDeltaY[0] ) )
+		return;
+
+	// find if the major edge is left or right aligned
+	f32 temp[4];
+
+	temp[0] = a->Pos.x - c->Pos.x;
+	temp[1] = -ca;
+	temp[2] = b->Pos.x - a->Pos.x;
+	temp[3] = ba;
+
+	scan.left = ( temp[0] * temp[3] - temp[1] * temp[2] ) > 0.f ? 0 : 1;
+	scan.right = 1 - scan.left;
+
+	// calculate slopes for the major edge
+	scan.slopeX[0] = (c->Pos.x - a->Pos.x) * scan.invDeltaY[0];
+	scan.x[0] = a->Pos.x;
+
+	if ( IPOL_W )
+	{
+		scan.slopeW[0] = (c->Pos.w - a->Pos.w) * scan.invDeltaY[0];
+		scan.w[0] = a->Pos.w;
+	}
+	if ( IPOL_C0 )
+	{
+		scan.slopeC[0][0] = (c->Color[0] - a->Color[0]) * scan.invDeltaY[0];
+		scan.c[0][0] = a->Color[0];
+	}
+	if ( TPixel::IPOL_T0 )
+	{
+		scan.slopeT[0][0] = (c->Tex[0] - a->Tex[0]) * scan.invDeltaY[0];
+		scan.t[0][0] = a->Tex[0];
+	}
+	if ( TPixel::IPOL_T1 )
+	{
+		scan.slopeT[1][0] = (c->Tex[1] - a->Tex[1]) * scan.invDeltaY[0];
+		scan.t[1][0] = a->Tex[1];
+	}
+
+	// top left fill convention y run
+	s32 yStart;
+	s32 yEnd;
+
+#ifdef SOFTWARE_DRIVER_2_SUBTEXEL
+	f32 subPixel;
+#endif
+
+	// rasterize upper sub-triangle
+	if ( (f32) 0.0 != scan.invDeltaY[1]  )
+	{
+		// calculate slopes for top edge
+		scan.slopeX[1] = (b->Pos.x - a->Pos.x) * scan.invDeltaY[1];
+		scan.x[1] = a->Pos.x;
+
+		if ( IPOL_W )
+		{
+			scan.slopeW[1] = (b->Pos.w - a->Pos.w) * scan.invDeltaY[1];
+			scan.w[1] = a->Pos.w;
+		}
+		if ( IPOL_C0 )
+		{
+			scan.slopeC[0][1] = (b->Color[0] - a->Color[0]) * scan.invDeltaY[1];
+			scan.c[0][1] = a->Color[0];
+		}
+		if ( TPixel::IPOL_T0 )
+		{
+			scan.slopeT[0][1] = (b->Tex[0] - a->Tex[0]) * scan.invDeltaY[1];
+			scan.t[0][1] = a->Tex[0];
+		}
+		if ( TPixel::IPOL_T1 )
+		{
+			scan.slopeT[1][1] = (b->Tex[1] - a->Tex[1]) * scan.invDeltaY[1];
+			scan.t[1][1] = a->Tex[1];
+		}
+
+		// apply top-left fill convention, top part
+		yStart = core::ceil32( a->Pos.y );
+		yEnd = core::ceil32( b->Pos.y ) - 1;
+		scissorRows ( yStart, yEnd );
+
+#ifdef SOFTWARE_DRIVER_2_SUBTEXEL
+		subPixel = ( (f32) yStart ) - a->Pos.y;
+
+		// correct to pixel center
+		scan.x[0] += scan.slopeX[0] * subPixel;
+		scan.x[1] += scan.slopeX[1] * subPixel;
+
+		if ( IPOL_W )
+		{
+			scan.w[0] += scan.slopeW[0] * subPixel;
+			scan.w[1] += scan.slopeW[1] * subPixel;
+		}
+		if ( IPOL_C0 )
+		{
+			scan.c[0][0] += scan.slopeC[0][0] * subPixel;
+			scan.c[0][1] += scan.slopeC[0][1] * subPixel;
+		}
+		if ( TPixel::IPOL_T0 )
+		{
+			scan.t[0][0] += scan.slopeT[0][0] * subPixel;
+			scan.t[0][1] += scan.slopeT[0][1] * subPixel;
+		}
+		if ( TPixel::IPOL_T1 )
+		{
+			scan.t[1][0] += scan.slopeT[1][0] * subPixel;
+			scan.t[1][1] += scan.slopeT[1][1] * subPixel;
+		}
+#endif
+
+		// rasterize the edge scanlines
+		scanEdges ( yStart, yEnd );
+	}
+
+	// rasterize lower sub-triangle
+	if ( (f32) 0.0 != scan.invDeltaY[2] )
+	{
+		// advance to middle point
+		if( (f32) 0.0 != scan.invDeltaY[1] )
+		{
+			temp[0] = b->Pos.y - a->Pos.y;	// dy
+
+			scan.x[0] = a->Pos.x + scan.slopeX[0] * temp[0];
+			if ( IPOL_W )
+				scan.w[0] = a->Pos.w + scan.slopeW[0] * temp[0];
+			if ( IPOL_C0 )
+				scan.c[0][0] = a->Color[0] + scan.slopeC[0][0] * temp[0];
+			if ( TPixel::IPOL_T0 )
+				scan.t[0][0] = a->Tex[0] + scan.slopeT[0][0] * temp[0];
+			if ( TPixel::IPOL_T1 )
+				scan.t[1][0] = a->Tex[1] + scan.slopeT[1][0] * temp[0];
+		}
+
+		// calculate slopes for bottom edge
+		scan.slopeX[1] = (c->Pos.x - b->Pos.x) * scan.invDeltaY[2];
+		scan.x[1] = b->Pos.x;
+
+		if ( IPOL_W )
+		{
+			scan.slopeW[1] = (c->Pos.w - b->Pos.w) * scan.invDeltaY[2];
+			scan.w[1] = b->Pos.w;
+		}
+		if ( IPOL_C0 )
+		{
+			scan.slopeC[0][1] = (c->Color[0] - b->Color[0]) * scan.invDeltaY[2];
+			scan.c[0][1] = b->Color[0];
+		}
+		if ( TPixel::IPOL_T0 )
+		{
+			scan.slopeT[0][1] = (c->Tex[0] - b->Tex[0]) * scan.invDeltaY[2];
+			scan.t[0][1] = b->Tex[0];
+		}
+		if ( TPixel::IPOL_T1 )
+		{
+			scan.slopeT[1][1] = (c->Tex[1] - b->Tex[1]) * scan.invDeltaY[2];
+			scan.t[1][1] = b->Tex[1];
+		}
+
+		// apply top-left fill convention, top part
+		yStart = core::ceil32( b->Pos.y );
+		yEnd = core::ceil32( c->Pos.y ) - 1;
+		scissorRows ( yStart, yEnd );
+
+#ifdef SOFTWARE_DRIVER_2_SUBTEXEL
+		subPixel = ( (f32) yStart ) - b->Pos.y;
+
+		// correct to pixel center
+		scan.x[0] += scan.slopeX[0] * subPixel;
+		scan.x[1] += scan.slopeX[1] * subPixel;
+
+		if ( IPOL_W )
+		{
+			scan.w[0] += scan.slopeW[0] * subPixel;
+			scan.w[1] += scan.slopeW[1] * subPixel;
+		}
+		if ( IPOL_C0 )
+		{
+			scan.c[0][0] += scan.slopeC[0][0] * subPixel;
+			scan.c[0][1] += scan.slopeC[0][1] * subPixel;
+		}
+		if ( TPixel::IPOL_T0 )
+		{
+			scan.t[0][0] += scan.slopeT[0][0] * subPixel;
+			scan.t[0][1] += scan.slopeT[0][1] * subPixel;
+		}
+		if ( TPixel::IPOL_T1 )
+		{
+			scan.t[1][0] += scan.slopeT[1][0] * subPixel;
+			scan.t[1][1] += scan.slopeT[1][1] * subPixel;
+		}
+#endif
+
+		// rasterize the edge scanlines
+		scanEdges ( yStart, yEnd );
+	}
+}
+
+} // end namespace video
+} // end namespace irr
+
+#endif // _IRR_COMPILE_WITH_BURNINGSVIDEO_
+
+#endif
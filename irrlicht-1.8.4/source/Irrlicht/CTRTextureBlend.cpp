@@ -263,6 +263,13 @@ void CTRTextureBlend::fragment_dst_color_src_alpha ()
 	if ( dx < 0 )
 		return;
 
+#ifdef CMP_W
+	// skip the tiles at both ends in which the span is hidden
+	if ( !clipSpanDepth ( line.y, xStart, xEnd, line.x, line.w ) )
+		return;
+	dx = xEnd - xStart;
+#endif
+
 	// slopes
 	const f32 invDeltaX = core::reciprocal_approxim ( line.x[1] - line.x[0] );
 
@@ -447,6 +454,13 @@ void CTRTextureBlend::fragment_src_color_src_alpha ()
 	if ( dx < 0 )
 		return;
 
+#ifdef CMP_W
+	// skip the tiles at both ends in which the span is hidden
+	if ( !clipSpanDepth ( line.y, xStart, xEnd, line.x, line.w ) )
+		return;
+	dx = xEnd - xStart;
+#endif
+
 	// slopes
 	const f32 invDeltaX = core::reciprocal_approxim ( line.x[1] - line.x[0] );
 
@@ -627,6 +641,13 @@ void CTRTextureBlend::fragment_one_one_minus_src_alpha()
 	if ( dx < 0 )
 		return;
 
+#ifdef CMP_W
+	// skip the tiles at both ends in which the span is hidden
+	if ( !clipSpanDepth ( line.y, xStart, xEnd, line.x, line.w ) )
+		return;
+	dx = xEnd - xStart;
+#endif
+
 	// slopes
 	const f32 invDeltaX = core::reciprocal_approxim ( line.x[1] - line.x[0] );
 
@@ -824,6 +845,13 @@ void CTRTextureBlend::fragment_one_minus_dst_alpha_one ()
 	if ( dx < 0 )
 		return;
 
+#ifdef CMP_W
+	// skip the tiles at both ends in which the span is hidden
+	if ( !clipSpanDepth ( line.y, xStart, xEnd, line.x, line.w ) )
+		return;
+	dx = xEnd - xStart;
+#endif
+
 	// slopes
 	const f32 invDeltaX = core::reciprocal_approxim ( line.x[1] - line.x[0] );
 
@@ -1020,6 +1048,13 @@ void CTRTextureBlend::fragment_src_alpha_one ()
 	if ( dx < 0 )
 		return;
 
+#ifdef CMP_W
+	// skip the tiles at both ends in which the span is hidden
+	if ( !clipSpanDepth ( line.y, xStart, xEnd, line.x, line.w ) )
+		return;
+	dx = xEnd - xStart;
+#endif
+
 	// slopes
 	const f32 invDeltaX = core::reciprocal_approxim ( line.x[1] - line.x[0] );
 
@@ -1247,6 +1282,13 @@ void CTRTextureBlend::fragment_dst_color_one_minus_dst_alpha ()
 	if ( dx < 0 )
 		return;
 
+#ifdef CMP_W
+	// skip the tiles at both ends in which the span is hidden
+	if ( !clipSpanDepth ( line.y, xStart, xEnd, line.x, line.w ) )
+		return;
+	dx = xEnd - xStart;
+#endif
+
 	// slopes
 	const f32 invDeltaX = core::reciprocal_approxim ( line.x[1] - line.x[0] );
 
@@ -1443,6 +1485,13 @@ void CTRTextureBlend::fragment_dst_color_zero ()
 	if ( dx < 0 )
 		return;
 
+#ifdef CMP_W
+	// skip the tiles at both ends in which the span is hidden
+	if ( !clipSpanDepth ( line.y, xStart, xEnd, line.x, line.w ) )
+		return;
+	dx = xEnd - xStart;
+#endif
+
 	// slopes
 	const f32 invDeltaX = core::reciprocal_approxim ( line.x[1] - line.x[0] );
 
@@ -1637,6 +1686,13 @@ void CTRTextureBlend::fragment_dst_color_one ()
 	if ( dx < 0 )
 		return;
 
+#ifdef CMP_W
+	// skip the tiles at both ends in which the span is hidden
+	if ( !clipSpanDepth ( line.y, xStart, xEnd, line.x, line.w ) )
+		return;
+	dx = xEnd - xStart;
+#endif
+
 	// slopes
 	const f32 invDeltaX = core::reciprocal_approxim ( line.x[1] - line.x[0] );
 
@@ -1834,6 +1890,13 @@ void CTRTextureBlend::fragment_zero_one_minus_scr_color ()
 	if ( dx < 0 )
 		return;
 
+#ifdef CMP_W
+	// skip the tiles at both ends in which the span is hidden
+	if ( !clipSpanDepth ( line.y, xStart, xEnd, line.x, line.w ) )
+		return;
+	dx = xEnd - xStart;
+#endif
+
 	// slopes
 	const f32 invDeltaX = core::reciprocal_approxim ( line.x[1] - line.x[0] );
 
@@ -1992,6 +2055,15 @@ void CTRTextureBlend::fragment_zero_one_minus_scr_color ()
 
 void CTRTextureBlend::drawTriangle ( const s4DVertex *a,const s4DVertex *b,const s4DVertex *c )
 {
+#ifdef CMP_W
+	// hidden behind the coarse depth of all tiles it touches
+	if ( isOccluded ( a, b, c ) )
+		return;
+#endif
+#ifdef WRITE_W
+	markDepthTiles ( a, b, c );
+#endif
+
 	if ( 0 == fragmentShader )
 		return;
 
@@ -2161,7 +2233,8 @@ void CTRTextureBlend::drawTriangle ( const s4DVertex *a,const s4DVertex *b,const
 #endif
 
 			// render a scanline
-			(this->*fragmentShader) ();
+			if ( isRowOwned ( line.y ) )
+				(this->*fragmentShader) ();
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
@@ -2321,7 +2394,8 @@ void CTRTextureBlend::drawTriangle ( const s4DVertex *a,const s4DVertex *b,const
 #endif
 
 			// render a scanline
-			(this->*fragmentShader) ();
+			if ( isRowOwned ( line.y ) )
+				(this->*fragmentShader) ();
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
@@ -162,6 +162,13 @@ void CTRTextureGouraudAlphaNoZ::scanline_bilinear ()
 	if ( dx < 0 )
 		return;
 
+#ifdef CMP_W
+	// skip the tiles at both ends in which the span is hidden
+	if ( !clipSpanDepth ( line.y, xStart, xEnd, line.x, line.w ) )
+		return;
+	dx = xEnd - xStart;
+#endif
+
 	// slopes
 	const f32 invDeltaX = core::reciprocal_approxim ( line.x[1] - line.x[0] );
 
@@ -354,6 +361,15 @@ void CTRTextureGouraudAlphaNoZ::scanline_bilinear ()
 
 void CTRTextureGouraudAlphaNoZ::drawTriangle ( const s4DVertex *a,const s4DVertex *b,const s4DVertex *c )
 {
+#ifdef CMP_W
+	// hidden behind the coarse depth of all tiles it touches
+	if ( isOccluded ( a, b, c ) )
+		return;
+#endif
+#ifdef WRITE_W
+	markDepthTiles ( a, b, c );
+#endif
+
 	// sort on height, y
 	if ( F32_A_GREATER_B ( a->Pos.y , b->Pos.y ) ) swapVertexPointer(&a, &b);
 	if ( F32_A_GREATER_B ( b->Pos.y , c->Pos.y ) ) swapVertexPointer(&b, &c);
@@ -520,7 +536,8 @@ void CTRTextureGouraudAlphaNoZ::drawTriangle ( const s4DVertex *a,const s4DVerte
 #endif
 
 			// render a scanline
-			scanline_bilinear ( );
+			if ( isRowOwned ( line.y ) )
+				scanline_bilinear ( );
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
@@ -680,7 +697,8 @@ void CTRTextureGouraudAlphaNoZ::drawTriangle ( const s4DVertex *a,const s4DVerte
 #endif
 
 			// render a scanline
-			scanline_bilinear ( );
+			if ( isRowOwned ( line.y ) )
+				scanline_bilinear ( );
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
@@ -122,6 +122,13 @@ REALINLINE void CTRTextureLightMap2_M1::scanline_bilinear2 ()
 	if ( dx < 0 )
 		return;
 
+#ifdef CMP_W
+	// skip the tiles at both ends in which the span is hidden
+	if ( !clipSpanDepth ( line.y, xStart, xEnd, line.x, line.w ) )
+		return;
+	dx = xEnd - xStart;
+#endif
+
 	// slopes
 	const f32 invDeltaX = core::reciprocal_approxim ( line.x[1] - line.x[0] );
 
@@ -249,6 +256,15 @@ REALINLINE void CTRTextureLightMap2_M1::scanline_bilinear2 ()
 
 void CTRTextureLightMap2_M1::drawTriangle ( const s4DVertex *a,const s4DVertex *b,const s4DVertex *c )
 {
+#ifdef CMP_W
+	// hidden behind the coarse depth of all tiles it touches
+	if ( isOccluded ( a, b, c ) )
+		return;
+#endif
+#ifdef WRITE_W
+	markDepthTiles ( a, b, c );
+#endif
+
 	sScanConvertData scan;
 
 	// sort on height, y
@@ -417,7 +433,8 @@ void CTRTextureLightMap2_M1::drawTriangle ( const s4DVertex *a,const s4DVertex *
 #endif
 
 			// render a scanline
-			scanline_bilinear2 ();
+			if ( isRowOwned ( line.y ) )
+				scanline_bilinear2 ();
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
@@ -578,7 +595,8 @@ void CTRTextureLightMap2_M1::drawTriangle ( const s4DVertex *a,const s4DVertex *
 #endif
 
 			// render a scanline
-			scanline_bilinear2 ();
+			if ( isRowOwned ( line.y ) )
+				scanline_bilinear2 ();
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
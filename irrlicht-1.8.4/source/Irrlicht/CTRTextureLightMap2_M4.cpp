@@ -115,8 +115,8 @@ REALINLINE void CTRTextureLightMap2_M4::scanline_bilinear2_mag ()
 	fp24 *z;
 
 	// apply top-left fill-convention, left
-	const s32 xStart = irr::core::ceil32( line.x[0] );
-	const s32 xEnd = irr::core::ceil32( line.x[1] ) - 1;
+	s32 xStart = irr::core::ceil32( line.x[0] );
+	s32 xEnd = irr::core::ceil32( line.x[1] ) - 1;
 	s32 dx;
 	s32 i;
 
@@ -125,6 +125,13 @@ REALINLINE void CTRTextureLightMap2_M4::scanline_bilinear2_mag ()
 	if ( dx < 0 )
 		return;
 
+#ifdef CMP_W
+	// skip the tiles at both ends in which the span is hidden
+	if ( !clipSpanDepth ( line.y, xStart, xEnd, line.x, line.w ) )
+		return;
+	dx = xEnd - xStart;
+#endif
+
 	// slopes
 	const f32 invDeltaX = core::reciprocal_approxim ( line.x[1] - line.x[0] );
 
@@ -270,6 +277,13 @@ REALINLINE void CTRTextureLightMap2_M4::scanline_bilinear2_min ()
 	if ( dx < 0 )
 		return;
 
+#ifdef CMP_W
+	// skip the tiles at both ends in which the span is hidden
+	if ( !clipSpanDepth ( line.y, xStart, xEnd, line.x, line.w ) )
+		return;
+	dx = xEnd - xStart;
+#endif
+
 	// slopes
 	const f32 invDeltaX = core::reciprocal_approxim ( line.x[1] - line.x[0] );
 
@@ -379,6 +393,15 @@ REALINLINE void CTRTextureLightMap2_M4::scanline_bilinear2_min ()
 
 void CTRTextureLightMap2_M4::drawTriangle ( const s4DVertex *a,const s4DVertex *b,const s4DVertex *c )
 {
+#ifdef CMP_W
+	// hidden behind the coarse depth of all tiles it touches
+	if ( isOccluded ( a, b, c ) )
+		return;
+#endif
+#ifdef WRITE_W
+	markDepthTiles ( a, b, c );
+#endif
+
 	if ( IT[0].lodLevel <= 2 )
 		drawTriangle_Mag ( a, b, c );
 	else
@@ -555,7 +578,8 @@ void CTRTextureLightMap2_M4::drawTriangle_Min ( const s4DVertex *a,const s4DVert
 #endif
 
 			// render a scanline
-			scanline_bilinear2_min ();
+			if ( isRowOwned ( line.y ) )
+				scanline_bilinear2_min ();
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
@@ -716,7 +740,8 @@ void CTRTextureLightMap2_M4::drawTriangle_Min ( const s4DVertex *a,const s4DVert
 #endif
 
 			// render a scanline
-			scanline_bilinear2_min ();
+			if ( isRowOwned ( line.y ) )
+				scanline_bilinear2_min ();
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
@@ -929,7 +954,8 @@ void CTRTextureLightMap2_M4::drawTriangle ( const s4DVertex *a,const s4DVertex *
 #endif
 
 			// render a scanline
-			scanline_bilinear2_mag ();
+			if ( isRowOwned ( line.y ) )
+				scanline_bilinear2_mag ();
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
@@ -1090,7 +1116,8 @@ void CTRTextureLightMap2_M4::drawTriangle ( const s4DVertex *a,const s4DVertex *
 #endif
 
 			// render a scanline
-			scanline_bilinear2_mag ();
+			if ( isRowOwned ( line.y ) )
+				scanline_bilinear2_mag ();
 
 			scan.x[0] += scan.slopeX[0];
 			scan.x[1] += scan.slopeX[1];
@@ -82,13 +82,17 @@ public:
 	//! draws an indexed triangle list
 	virtual void drawTriangle ( const s4DVertex *a,const s4DVertex *b,const s4DVertex *c );
 	virtual void drawLine ( const s4DVertex *a,const s4DVertex *b);
+	virtual void drawPoint ( const s4DVertex *a );
 
-
+	virtual void setZCompareFunc ( u32 func);
+	virtual void setMaterial ( const SBurningShaderMaterial &material );
 
 private:
 	void renderAlphaLine ( const s4DVertex *a,const s4DVertex *b ) const;
 	void renderLine ( const s4DVertex *a,const s4DVertex *b ) const;
 
+	u32 ZCompare;
+	s32 PointSize;
 };
 
 //! constructor
@@ -98,6 +102,24 @@ CTRTextureWire2::CTRTextureWire2(CBurningVideoDriver* driver)
 	#ifdef _DEBUG
 	setDebugName("CTRTextureWire2");
 	#endif
+
+	ZCompare = ECFN_LESSEQUAL;
+	PointSize = 1;
+}
+
+
+/*!
+*/
+void CTRTextureWire2::setZCompareFunc ( u32 func)
+{
+	ZCompare = func;
+}
+
+/*!
+*/
+void CTRTextureWire2::setMaterial ( const SBurningShaderMaterial &material )
+{
+	PointSize = core::s32_max ( core::round32 ( material.org.Thickness ), 1 );
 }
 
 
@@ -194,6 +216,11 @@ void CTRTextureWire2::renderLine ( const s4DVertex *a,const s4DVertex *b ) const
 		if ( *z >= dataZ )
 #endif
 #ifdef CMP_W
+		if ( ECFN_NEVER == ZCompare )
+		{
+			*dst = color;
+		}
+		else
 		if ( dataW >= *z )
 #endif
 		{
@@ -250,6 +277,10 @@ void CTRTextureWire2::drawTriangle ( const s4DVertex *a,const s4DVertex *b,const
 	if ( F32_A_GREATER_B ( b->Pos.y , c->Pos.y ) ) swapVertexPointer(&b, &c);
 	if ( F32_A_GREATER_B ( a->Pos.y , b->Pos.y ) ) swapVertexPointer(&a, &b);
 
+#ifdef WRITE_W
+	markDepthTiles ( a, b, c );
+#endif
+
 	renderLine ( a, b );
 	renderLine ( b, c );
 	renderLine ( a, c );
@@ -265,11 +296,82 @@ void CTRTextureWire2::drawLine ( const s4DVertex *a,const s4DVertex *b)
 	// sort on height, y
 	if ( a->Pos.y > b->Pos.y ) swapVertexPointer(&a, &b);
 
+#ifdef WRITE_W
+	markDepthTiles ( a, b, b );
+#endif
+
 	renderLine ( a, b );
 
 }
 
 
+//! draws a square of PointSize pixels, clamped to the viewport
+void CTRTextureWire2::drawPoint ( const s4DVertex *a )
+{
+	const s32 x = (s32) a->Pos.x - ( PointSize >> 1 );
+	const s32 y = (s32) a->Pos.y - ( PointSize >> 1 );
+
+	const s32 xStart = core::s32_max ( x, Scissor.UpperLeftCorner.X );
+	const s32 yStart = core::s32_max ( y, Scissor.UpperLeftCorner.Y );
+	const s32 xEnd = core::s32_min ( x + PointSize, Scissor.LowerRightCorner.X );
+	const s32 yEnd = core::s32_min ( y + PointSize, Scissor.LowerRightCorner.Y );
+
+	if ( xEnd <= xStart || yEnd <= yStart )
+		return;
+
+#ifdef WRITE_W
+	s4DVertex corner[2];
+	corner[0].Pos.x = (f32) xStart;
+	corner[0].Pos.y = (f32) yStart;
+	corner[1].Pos.x = (f32) ( xEnd - 1 );
+	corner[1].Pos.y = (f32) ( yEnd - 1 );
+	markDepthTiles ( corner, corner + 1, corner + 1 );
+#endif
+
+	tVideoSample color;
+#ifdef SOFTWARE_DRIVER_2_USE_VERTEX_COLOR
+	tFixPoint r0, g0, b0;
+	getSample_color ( r0, g0, b0, a->Color[0] );
+	color = fix_to_color ( r0, g0, b0 );
+#else
+	color = (tVideoSample) 0xFFFFFFFF;
+#endif
+
+	const u32 pitch = RenderTarget->getDimension().Width;
+
+	for ( s32 row = yStart; row != yEnd; ++row )
+	{
+		tVideoSample *dst = (tVideoSample*)RenderTarget->lock() + ( row * pitch );
+#ifdef USE_ZBUFFER
+		fp24 *z = (fp24*) DepthBuffer->lock() + ( row * pitch );
+#endif
+
+		for ( s32 i = xStart; i != xEnd; ++i )
+		{
+			if ( ECFN_NEVER != ZCompare )
+			{
+#ifdef CMP_Z
+				if ( z[i] < a->Pos.z )
+					continue;
+#endif
+#ifdef CMP_W
+				if ( a->Pos.w < z[i] )
+					continue;
+#endif
+#ifdef WRITE_Z
+				z[i] = a->Pos.z;
+#endif
+#ifdef WRITE_W
+				z[i] = a->Pos.w;
+#endif
+			}
+
+			dst[i] = color;
+		}
+	}
+}
+
+
 } // end namespace video
 } // end namespace irr
 
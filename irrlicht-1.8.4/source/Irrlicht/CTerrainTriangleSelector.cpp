@@ -4,6 +4,7 @@
 
 #include "CTerrainTriangleSelector.h"
 #include "CTerrainSceneNode.h"
+#include "CTriangleSelector.h"
 #include "os.h"
 
 namespace irr
@@ -183,6 +184,41 @@ void CTerrainTriangleSelector::getTriangles(core::triangle3df* triangles,
 }
 
 
+//! Finds the triangle hit by a line segment
+bool CTerrainTriangleSelector::getCollisionPoint(const core::line3d<f32>& line,
+		SCollisionHit& hit, bool anyHit) const
+{
+	SCollisionLine collision(line);
+	core::vector3df intersection;
+	bool found = false;
+
+	u32 tIndex = 0;
+	for (s32 i=0; i<TrianglePatches.NumPatches; ++i)
+	{
+		const SGeoMipMapTrianglePatch& patch = TrianglePatches.TrianglePatchArray[i];
+		if (patch.Box.intersectsWithLine(line))
+		{
+			for (s32 j=0; j<patch.NumTriangles; ++j)
+			{
+				if (collision.collide(patch.Triangles[j], intersection))
+				{
+					hit.Intersection = intersection;
+					hit.Triangle = patch.Triangles[j];
+					hit.Node = SceneNode;
+					hit.TriangleIndex = tIndex + j;
+					found = true;
+					if (anyHit)
+						return true;
+				}
+			}
+		}
+		tIndex += patch.NumTriangles;
+	}
+
+	return found;
+}
+
+
 //! Returns amount of all available triangles in this selector
 s32 CTerrainTriangleSelector::getTriangleCount() const
 {
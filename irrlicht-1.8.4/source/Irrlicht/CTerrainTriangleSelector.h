@@ -66,6 +66,10 @@ public:
 	// Get the TriangleSelector based on index based on getSelectorCount
 	virtual const ITriangleSelector* getSelector(u32 index) const;
 
+	//! Finds the triangle hit by a line segment
+	virtual bool getCollisionPoint(const core::line3d<f32>& line,
+		SCollisionHit& hit, bool anyHit=false) const;
+
 private:
 
 	friend class CTerrainSceneNode;
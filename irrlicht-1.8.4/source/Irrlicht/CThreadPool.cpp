@@ -0,0 +1,421 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt / Thomas Alten
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CThreadPool.h"
+
+#ifdef _IRR_COMPILE_WITH_THREADS_
+	#if defined(_IRR_WINDOWS_API_)
+		#ifdef _IRR_XBOX_PLATFORM_
+			#include <xtl.h>
+		#else
+			#define WIN32_LEAN_AND_MEAN
+			#include <windows.h>
+		#endif
+		#define _IRR_WIN32_THREADS_
+	#elif defined(_IRR_POSIX_API_) || defined(_IRR_OSX_PLATFORM_)
+		#include <pthread.h>
+		#include <unistd.h>
+		#define _IRR_POSIX_THREADS_
+	#endif
+#endif
+
+namespace irr
+{
+
+#if defined(_IRR_WIN32_THREADS_)
+
+// ----------------------------------------------------------------
+// Windows threads, each worker waits for its own start event
+// ----------------------------------------------------------------
+
+struct CThreadPool::SPlatform
+{
+	struct SWorker
+	{
+		SPlatform* Platform;
+		u32 Index;
+		HANDLE Thread;
+		HANDLE Start;
+	};
+
+	static DWORD WINAPI threadMain(LPVOID data)
+	{
+		SWorker* worker = (SWorker*) data;
+		SPlatform* platform = worker->Platform;
+
+		for (;;)
+		{
+			WaitForSingleObject(worker->Start, INFINITE);
+			if (platform->Quit)
+				break;
+
+			platform->Job->run(worker->Index);
+
+			if (0 == InterlockedDecrement(&platform->Pending))
+				SetEvent(platform->Done);
+		}
+		return 0;
+	}
+
+	//! starts the worker threads, stops at the first one which fails
+	void start(u32 threadCount)
+	{
+		Started = true;
+		for (u32 i=1; i<threadCount; ++i)
+		{
+			SWorker& worker = Workers[WorkerCount];
+			worker.Platform = this;
+			worker.Index = i;
+			worker.Start = CreateEvent(0, FALSE, FALSE, 0);
+			worker.Thread = CreateThread(0, 0, threadMain, &worker, 0, 0);
+			if (!worker.Thread)
+			{
+				CloseHandle(worker.Start);
+				break;
+			}
+			++WorkerCount;
+		}
+	}
+
+	SWorker* Workers;
+	u32 WorkerCount;
+	HANDLE Done;
+	volatile LONG Pending;
+	volatile LONG Busy;
+	IJob* volatile Job;
+	volatile bool Quit;
+	bool Started;
+};
+
+
+//! constructor
+CThreadPool::CThreadPool(u32 threadCount)
+: Platform(0), ThreadCount(1)
+{
+	if (0 == threadCount)
+		threadCount = getProcessorCount();
+
+	if (threadCount < 2)
+		return;
+
+	Platform = new SPlatform;
+	Platform->WorkerCount = 0;
+	Platform->Workers = new SPlatform::SWorker[threadCount - 1];
+	Platform->Done = CreateEvent(0, FALSE, FALSE, 0);
+	Platform->Pending = 0;
+	Platform->Busy = 0;
+	Platform->Job = 0;
+	Platform->Quit = false;
+	Platform->Started = false;
+
+	ThreadCount = threadCount;
+}
+
+
+//! destructor, stops the worker threads
+CThreadPool::~CThreadPool()
+{
+	if (!Platform)
+		return;
+
+	Platform->Quit = true;
+
+	u32 i;
+	for (i=0; i<Platform->WorkerCount; ++i)
+		SetEvent(Platform->Workers[i].Start);
+
+	for (i=0; i<Platform->WorkerCount; ++i)
+	{
+		WaitForSingleObject(Platform->Workers[i].Thread, INFINITE);
+		CloseHandle(Platform->Workers[i].Thread);
+		CloseHandle(Platform->Workers[i].Start);
+	}
+
+	CloseHandle(Platform->Done);
+	delete [] Platform->Workers;
+	delete Platform;
+}
+
+
+//! runs the job on all threads and returns when all of them are done
+void CThreadPool::run(IJob* job)
+{
+	if (!Platform)
+	{
+		job->run(0);
+		return;
+	}
+
+	// a job of another thread or of a worker of this pool is running
+	if (InterlockedExchange(&Platform->Busy, 1))
+	{
+		runOnCaller(job);
+		return;
+	}
+
+	if (!Platform->Started)
+		Platform->start(ThreadCount);
+
+	const u32 workerCount = Platform->WorkerCount;
+	if (workerCount)
+	{
+		Platform->Job = job;
+		Platform->Pending = (LONG) workerCount;
+
+		for (u32 i=0; i<workerCount; ++i)
+			SetEvent(Platform->Workers[i].Start);
+	}
+
+	job->run(0);
+
+	// threads which could not be started
+	for (u32 i=workerCount+1; i<ThreadCount; ++i)
+		job->run(i);
+
+	if (workerCount)
+		WaitForSingleObject(Platform->Done, INFINITE);
+
+	InterlockedExchange(&Platform->Busy, 0);
+}
+
+
+//! returns the amount of processor cores, at least 1
+u32 CThreadPool::getProcessorCount()
+{
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwNumberOfProcessors ? (u32) info.dwNumberOfProcessors : 1;
+}
+
+#elif defined(_IRR_POSIX_THREADS_)
+
+// ----------------------------------------------------------------
+// pthreads, workers wait for the next job generation
+// ----------------------------------------------------------------
+
+struct CThreadPool::SPlatform
+{
+	struct SWorker
+	{
+		SPlatform* Platform;
+		u32 Index;
+		pthread_t Thread;
+	};
+
+	static void* threadMain(void* data)
+	{
+		SWorker* worker = (SWorker*) data;
+		SPlatform* platform = worker->Platform;
+		u32 generation = 0;
+
+		pthread_mutex_lock(&platform->Mutex);
+		for (;;)
+		{
+			while (platform->Generation == generation && !platform->Quit)
+				pthread_cond_wait(&platform->Start, &platform->Mutex);
+
+			if (platform->Quit)
+				break;
+
+			generation = platform->Generation;
+			IJob* job = platform->Job;
+			pthread_mutex_unlock(&platform->Mutex);
+
+			job->run(worker->Index);
+
+			pthread_mutex_lock(&platform->Mutex);
+			if (0 == --platform->Pending)
+				pthread_cond_signal(&platform->Done);
+		}
+		pthread_mutex_unlock(&platform->Mutex);
+		return 0;
+	}
+
+	//! starts the worker threads, stops at the first one which fails
+	/** Called with the mutex locked before the first job, so the workers
+	wait for the first generation. */
+	void start(u32 threadCount)
+	{
+		Started = true;
+		for (u32 i=1; i<threadCount; ++i)
+		{
+			SWorker& worker = Workers[WorkerCount];
+			worker.Platform = this;
+			worker.Index = i;
+			if (pthread_create(&worker.Thread, 0, threadMain, &worker))
+				break;
+			++WorkerCount;
+		}
+	}
+
+	SWorker* Workers;
+	u32 WorkerCount;
+	pthread_mutex_t Mutex;
+	pthread_cond_t Start;
+	pthread_cond_t Done;
+	u32 Generation;
+	u32 Pending;
+	IJob* Job;
+	bool Quit;
+	bool Busy;
+	bool Started;
+};
+
+
+//! constructor
+CThreadPool::CThreadPool(u32 threadCount)
+: Platform(0), ThreadCount(1)
+{
+	if (0 == threadCount)
+		threadCount = getProcessorCount();
+
+	if (threadCount < 2)
+		return;
+
+	Platform = new SPlatform;
+	Platform->WorkerCount = 0;
+	Platform->Workers = new SPlatform::SWorker[threadCount - 1];
+	Platform->Generation = 0;
+	Platform->Pending = 0;
+	Platform->Job = 0;
+	Platform->Quit = false;
+	Platform->Busy = false;
+	Platform->Started = false;
+	pthread_mutex_init(&Platform->Mutex, 0);
+	pthread_cond_init(&Platform->Start, 0);
+	pthread_cond_init(&Platform->Done, 0);
+
+	ThreadCount = threadCount;
+}
+
+
+//! destructor, stops the worker threads
+CThreadPool::~CThreadPool()
+{
+	if (!Platform)
+		return;
+
+	pthread_mutex_lock(&Platform->Mutex);
+	Platform->Quit = true;
+	pthread_cond_broadcast(&Platform->Start);
+	pthread_mutex_unlock(&Platform->Mutex);
+
+	for (u32 i=0; i<Platform->WorkerCount; ++i)
+		pthread_join(Platform->Workers[i].Thread, 0);
+
+	pthread_cond_destroy(&Platform->Done);
+	pthread_cond_destroy(&Platform->Start);
+	pthread_mutex_destroy(&Platform->Mutex);
+	delete [] Platform->Workers;
+	delete Platform;
+}
+
+
+//! runs the job on all threads and returns when all of them are done
+void CThreadPool::run(IJob* job)
+{
+	if (!Platform)
+	{
+		job->run(0);
+		return;
+	}
+
+	pthread_mutex_lock(&Platform->Mutex);
+
+	// a job of another thread or of a worker of this pool is running
+	if (Platform->Busy)
+	{
+		pthread_mutex_unlock(&Platform->Mutex);
+		runOnCaller(job);
+		return;
+	}
+	Platform->Busy = true;
+
+	if (!Platform->Started)
+		Platform->start(ThreadCount);
+
+	const u32 workerCount = Platform->WorkerCount;
+	Platform->Job = job;
+	Platform->Pending = workerCount;
+	++Platform->Generation;
+	pthread_cond_broadcast(&Platform->Start);
+	pthread_mutex_unlock(&Platform->Mutex);
+
+	job->run(0);
+
+	// threads which could not be started
+	for (u32 i=workerCount+1; i<ThreadCount; ++i)
+		job->run(i);
+
+	pthread_mutex_lock(&Platform->Mutex);
+	while (Platform->Pending)
+		pthread_cond_wait(&Platform->Done, &Platform->Mutex);
+	Platform->Busy = false;
+	pthread_mutex_unlock(&Platform->Mutex);
+}
+
+
+//! returns the amount of processor cores, at least 1
+u32 CThreadPool::getProcessorCount()
+{
+	const long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return count > 0 ? (u32) count : 1;
+}
+
+#else
+
+// ----------------------------------------------------------------
+// no threads, everything runs on the calling thread
+// ----------------------------------------------------------------
+
+struct CThreadPool::SPlatform
+{
+};
+
+
+//! constructor
+CThreadPool::CThreadPool(u32 threadCount)
+: Platform(0), ThreadCount(1)
+{
+}
+
+
+//! destructor
+CThreadPool::~CThreadPool()
+{
+}
+
+
+//! runs the job on the calling thread
+void CThreadPool::run(IJob* job)
+{
+	job->run(0);
+}
+
+
+//! returns the amount of processor cores, at least 1
+u32 CThreadPool::getProcessorCount()
+{
+	return 1;
+}
+
+#endif
+
+
+//! returns the amount of threads, including the calling one
+u32 CThreadPool::getThreadCount() const
+{
+	return ThreadCount;
+}
+
+
+//! runs the parts of all threads of the job one after another on the calling thread
+void CThreadPool::runOnCaller(IJob* job)
+{
+	for (u32 i=0; i<ThreadCount; ++i)
+		job->run(i);
+}
+
+
+} // end namespace irr
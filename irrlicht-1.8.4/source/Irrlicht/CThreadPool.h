@@ -0,0 +1,69 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt / Thomas Alten
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_THREAD_POOL_H_INCLUDED__
+#define __C_THREAD_POOL_H_INCLUDED__
+
+#include "IrrCompileConfig.h"
+#include "irrTypes.h"
+
+namespace irr
+{
+
+	//! Runs a job on a fixed set of threads
+	/** Used by the burnings video rasterizer and by the scene manager,
+	whose pool is shared by the batched line queries, the octree build and
+	the shadow volumes. The calling thread takes part as thread 0, so a
+	pool of one thread does not create any threads at all. The other
+	threads are started by the first job. A job started while another one
+	runs, from a second thread or from within a job, runs the parts of all
+	threads on its calling thread instead of waiting. */
+	class CThreadPool
+	{
+	public:
+
+		//! work done by every thread of the pool
+		class IJob
+		{
+		public:
+			virtual ~IJob() {}
+
+			//! called once on each thread, with thread in [0,getThreadCount())
+			virtual void run(u32 thread) = 0;
+		};
+
+		//! constructor
+		/** \param threadCount Amount of threads including the calling
+		one. 0 uses one thread for each processor core. No thread is
+		started before the first call of run(). */
+		CThreadPool(u32 threadCount);
+
+		//! destructor, stops the worker threads
+		~CThreadPool();
+
+		//! returns the amount of threads, including the calling one
+		u32 getThreadCount() const;
+
+		//! runs the job on all threads and returns when all of them are done
+		void run(IJob* job);
+
+		//! returns the amount of processor cores, at least 1
+		static u32 getProcessorCount();
+
+	private:
+
+		//! runs the parts of all threads of the job one after another on the calling thread
+		void runOnCaller(IJob* job);
+
+		//! threads and synchronization objects of the platform
+		struct SPlatform;
+
+		SPlatform* Platform;
+		u32 ThreadCount;
+	};
+
+} // end namespace irr
+
+#endif
+
@@ -18,43 +18,54 @@ CTriangleBBSelector::CTriangleBBSelector(ISceneNode* node)
 	setDebugName("CTriangleBBSelector");
 	#endif
 
-	Triangles.set_used(12); // a box has 12 triangles.
+	// a box has 12 triangles between the 8 edges
+	static const u16 indices[36] = {
+		3,0,2, 3,1,0,
+		3,2,7, 7,2,6,
+		7,6,4, 5,7,4,
+		5,4,0, 5,0,1,
+		1,3,7, 1,7,5,
+		0,6,2, 0,4,6 };
+
+	Positions.set_used(8);
+	Indices16.set_used(36);
+	for (u32 i=0; i<36; ++i)
+		Indices16[i] = indices[i];
+
+	// no node has an inverted box, so the first update builds the triangles
+	BoundingBox = core::aabbox3df(1.f, 1.f, 1.f, -1.f, -1.f, -1.f);
 }
 
 
 
-//! Gets all triangles.
-void CTriangleBBSelector::getTriangles(core::triangle3df* triangles,
-					s32 arraySize, s32& outTriangleCount,
-					const core::matrix4* transform) const
+//! Builds the triangles from the current bounding box of the node
+void CTriangleBBSelector::update(void) const
 {
 	if (!SceneNode)
 		return;
 
-	// construct triangles
+	// only written when the box changed, so queries of several threads
+	// don't write to the selector
 	const core::aabbox3d<f32>& box = SceneNode->getBoundingBox();
-	core::vector3df edges[8];
-	box.getEdges(edges);
-
-	Triangles[0].set( edges[3], edges[0], edges[2]);
-	Triangles[1].set( edges[3], edges[1], edges[0]);
-
-	Triangles[2].set( edges[3], edges[2], edges[7]);
-	Triangles[3].set( edges[7], edges[2], edges[6]);
+	if (box == BoundingBox)
+		return;
 
-	Triangles[4].set( edges[7], edges[6], edges[4]);
-	Triangles[5].set( edges[5], edges[7], edges[4]);
+	// the triangles connect the edges of the box
+	box.getEdges(Positions.pointer());
 
-	Triangles[6].set( edges[5], edges[4], edges[0]);
-	Triangles[7].set( edges[5], edges[0], edges[1]);
+	BoundingBox = box;
+}
 
-	Triangles[8].set( edges[1], edges[3], edges[7]);
-	Triangles[9].set( edges[1], edges[7], edges[5]);
 
-	Triangles[10].set(edges[0], edges[6], edges[2]);
-	Triangles[11].set(edges[0], edges[4], edges[6]);
+//! Gets all triangles.
+void CTriangleBBSelector::getTriangles(core::triangle3df* triangles,
+					s32 arraySize, s32& outTriangleCount,
+					const core::matrix4* transform) const
+{
+	if (!SceneNode)
+		return;
 
-	// call parent
+	// call parent, which updates the triangles
 	CTriangleSelector::getTriangles(triangles, arraySize, outTriangleCount,	transform);
 }
 
@@ -75,6 +86,17 @@ void CTriangleBBSelector::getTriangles(core::triangle3df* triangles,
 }
 
 
+//! Finds the triangle hit by a line segment
+bool CTriangleBBSelector::getCollisionPoint(const core::line3d<f32>& line,
+					SCollisionHit& hit, bool anyHit) const
+{
+	if (!SceneNode)
+		return false;
+
+	return CTriangleSelector::getCollisionPoint(line, hit, anyHit);
+}
+
+
 } // end namespace scene
 } // end namespace irr
 
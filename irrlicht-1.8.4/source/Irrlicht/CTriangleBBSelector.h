@@ -33,6 +33,17 @@ public:
 		s32& outTriangleCount, const core::line3d<f32>& line,
 		const core::matrix4* transform=0) const;
 
+	//! Finds the triangle hit by a line segment
+	virtual bool getCollisionPoint(const core::line3d<f32>& line,
+		SCollisionHit& hit, bool anyHit=false) const;
+
+	//! The box follows the node, so there is no fixed one
+	virtual bool getTransformedBoundingBox(core::aabbox3d<f32>& box) const { return false; }
+
+protected:
+
+	//! Builds the triangles from the current bounding box of the node
+	virtual void update(void) const;
 };
 
 } // end namespace scene
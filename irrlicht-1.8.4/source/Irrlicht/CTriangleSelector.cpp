@@ -12,9 +12,29 @@ namespace irr
 namespace scene
 {
 
+namespace
+{
+	//! Sorts the index triples of triangles, triangle i afterwards is the one at order[i] before
+	template <class T>
+	void reorderIndices(core::array<T>& indices, const core::array<u32>& order)
+	{
+		core::array<T> sorted(indices.size());
+		sorted.set_used(indices.size());
+		for (u32 i=0; i<order.size(); ++i)
+		{
+			const T* const index = indices.const_pointer() + order[i]*3;
+			sorted[i*3] = index[0];
+			sorted[i*3+1] = index[1];
+			sorted[i*3+2] = index[2];
+		}
+		indices.swap(sorted);
+	}
+}
+
+
 //! constructor
 CTriangleSelector::CTriangleSelector(ISceneNode* node)
-: SceneNode(node), AnimatedNode(0), LastMeshFrame(0)
+: SceneNode(node), TransformNode(node), AnimatedNode(0), LastMeshFrame(0)
 {
 	#ifdef _DEBUG
 	setDebugName("CTriangleSelector");
@@ -26,7 +46,7 @@ CTriangleSelector::CTriangleSelector(ISceneNode* node)
 
 //! constructor
 CTriangleSelector::CTriangleSelector(const core::aabbox3d<f32>& box, ISceneNode* node)
-: SceneNode(node), AnimatedNode(0), LastMeshFrame(0)
+: SceneNode(node), TransformNode(node), AnimatedNode(0), LastMeshFrame(0)
 {
 	#ifdef _DEBUG
 	setDebugName("CTriangleSelector");
@@ -38,8 +58,8 @@ CTriangleSelector::CTriangleSelector(const core::aabbox3d<f32>& box, ISceneNode*
 
 
 //! constructor
-CTriangleSelector::CTriangleSelector(const IMesh* mesh, ISceneNode* node)
-: SceneNode(node), AnimatedNode(0), LastMeshFrame(0)
+CTriangleSelector::CTriangleSelector(const IMesh* mesh, ISceneNode* node, bool staticNode)
+: SceneNode(node), TransformNode(staticNode ? 0 : node), AnimatedNode(0), LastMeshFrame(0)
 {
 	#ifdef _DEBUG
 	setDebugName("CTriangleSelector");
@@ -50,7 +70,7 @@ CTriangleSelector::CTriangleSelector(const IMesh* mesh, ISceneNode* node)
 
 
 CTriangleSelector::CTriangleSelector(IAnimatedMeshSceneNode* node)
-: SceneNode(node), AnimatedNode(node), LastMeshFrame(0)
+: SceneNode(node), TransformNode(node), AnimatedNode(node), LastMeshFrame(0)
 {
 	#ifdef _DEBUG
 	setDebugName("CTriangleSelector");
@@ -74,32 +94,56 @@ CTriangleSelector::CTriangleSelector(IAnimatedMeshSceneNode* node)
 void CTriangleSelector::createFromMesh(const IMesh* mesh)
 {
 	const u32 cnt = mesh->getMeshBufferCount();
-	u32 totalFaceCount = 0;
-	for (u32 j=0; j<cnt; ++j)
-		totalFaceCount += mesh->getMeshBuffer(j)->getIndexCount();
-	totalFaceCount /= 3;
-	Triangles.reallocate(totalFaceCount);
-	BoundingBox.reset(0.f, 0.f, 0.f);
+	u32 indexCount = 0;
+	u32 vertexCount = 0;
+	u32 i;
+	for (i=0; i<cnt; ++i)
+	{
+		indexCount += mesh->getMeshBuffer(i)->getIndexCount() / 3 * 3;
+		vertexCount += mesh->getMeshBuffer(i)->getVertexCount();
+	}
 
-	for (u32 i=0; i<cnt; ++i)
+	// all buffers share one pool of positions, so 16 bit indices are
+	// only enough as long as it is small
+	const bool index32 = vertexCount > 0x10000;
+	Positions.reallocate(vertexCount);
+	if (index32)
+		Indices32.reallocate(indexCount);
+	else
+		Indices16.reallocate(indexCount);
+
+	for (i=0; i<cnt; ++i)
 	{
 		const IMeshBuffer* buf = mesh->getMeshBuffer(i);
+		const u32 base = Positions.size();
+
+		for (u32 j=0; j<buf->getVertexCount(); ++j)
+			Positions.push_back(buf->getPosition(j));
 
-		const u32 idxCnt = buf->getIndexCount();
-		const u16* const indices = buf->getIndices();
+		const u32 idxCnt = buf->getIndexCount() / 3 * 3;
+		const bool bufIndex32 = buf->getIndexType() == video::EIT_32BIT;
+		const u16* const indices16 = buf->getIndices();
+		const u32* const indices32 = (const u32*) buf->getIndices();
 
-		for (u32 j=0; j<idxCnt; j+=3)
+		for (u32 j=0; j<idxCnt; ++j)
 		{
-			Triangles.push_back(core::triangle3df(
-					buf->getPosition(indices[j+0]),
-					buf->getPosition(indices[j+1]),
-					buf->getPosition(indices[j+2])));
-			const core::triangle3df& tri = Triangles.getLast();
-			BoundingBox.addInternalPoint(tri.pointA);
-			BoundingBox.addInternalPoint(tri.pointB);
-			BoundingBox.addInternalPoint(tri.pointC);
+			const u32 index = base + (bufIndex32 ? indices32[j] : indices16[j]);
+			if (index32)
+				Indices32.push_back(index);
+			else
+				Indices16.push_back((u16)index);
 		}
 	}
+
+	// static nodes keep their triangles in world space
+	if (SceneNode && !TransformNode)
+	{
+		const core::matrix4& mat = SceneNode->getAbsoluteTransformation();
+		for (i=0; i<Positions.size(); ++i)
+			mat.transformVect(Positions[i]);
+	}
+
+	updateBoundingBox();
 }
 
 
@@ -108,27 +152,57 @@ void CTriangleSelector::updateFromMesh(const IMesh* mesh) const
 	if (!mesh)
 		return;
 
-	u32 meshBuffers = mesh->getMeshBufferCount();
-	u32 triangleCount = 0;
+	// the frames share the topology, so only the positions change
+	const u32 meshBuffers = mesh->getMeshBufferCount();
+	u32 vertexCount = 0;
 
-	BoundingBox.reset(0.f, 0.f, 0.f);
 	for (u32 i = 0; i < meshBuffers; ++i)
 	{
-		IMeshBuffer* buf = mesh->getMeshBuffer(i);
-		u32 idxCnt = buf->getIndexCount();
-		const u16* indices = buf->getIndices();
+		const IMeshBuffer* buf = mesh->getMeshBuffer(i);
+		const u32 cnt = core::min_(buf->getVertexCount(), Positions.size() - vertexCount);
 
-		for (u32 index = 0; index < idxCnt; index += 3)
-		{
-			core::triangle3df& tri = Triangles[triangleCount++];
-			tri.pointA = buf->getPosition(indices[index + 0]);
-			tri.pointB = buf->getPosition(indices[index + 1]);
-			tri.pointC = buf->getPosition(indices[index + 2]);
-			BoundingBox.addInternalPoint(tri.pointA);
-			BoundingBox.addInternalPoint(tri.pointB);
-			BoundingBox.addInternalPoint(tri.pointC);
-		}
+		for (u32 j = 0; j < cnt; ++j)
+			Positions[vertexCount + j] = buf->getPosition(j);
+		vertexCount += cnt;
 	}
+
+	updateBoundingBox();
+}
+
+
+//! Fits the bounding box to the stored triangles
+void CTriangleSelector::updateBoundingBox() const
+{
+	const u32 cnt = Indices16.size() + Indices32.size();
+	if (!cnt)
+	{
+		BoundingBox.reset(0.f, 0.f, 0.f);
+		return;
+	}
+
+	// only the positions used by triangles count
+	if (Indices32.empty())
+	{
+		BoundingBox.reset(Positions[Indices16[0]]);
+		for (u32 i=1; i<cnt; ++i)
+			BoundingBox.addInternalPoint(Positions[Indices16[i]]);
+	}
+	else
+	{
+		BoundingBox.reset(Positions[Indices32[0]]);
+		for (u32 i=1; i<cnt; ++i)
+			BoundingBox.addInternalPoint(Positions[Indices32[i]]);
+	}
+}
+
+
+//! Sorts the triangles, triangle i afterwards is the one at order[i] before
+void CTriangleSelector::reorderTriangles(const core::array<u32>& order)
+{
+	if (Indices32.empty())
+		reorderIndices(Indices16, order);
+	else
+		reorderIndices(Indices32, order);
 }
 
 
@@ -162,21 +236,22 @@ void CTriangleSelector::getTriangles(core::triangle3df* triangles,
 	// Update my triangles if necessary
 	update();
 
-	u32 cnt = Triangles.size();
+	u32 cnt = getStoredTriangleCount();
 	if (cnt > (u32)arraySize)
 		cnt = (u32)arraySize;
 
 	core::matrix4 mat;
 	if (transform)
 		mat = *transform;
-	if (SceneNode)
-		mat *= SceneNode->getAbsoluteTransformation();
+	if (TransformNode)
+		mat *= TransformNode->getAbsoluteTransformation();
 
 	for (u32 i=0; i<cnt; ++i)
 	{
-		mat.transformVect( triangles[i].pointA, Triangles[i].pointA );
-		mat.transformVect( triangles[i].pointB, Triangles[i].pointB );
-		mat.transformVect( triangles[i].pointC, Triangles[i].pointC );
+		getTriangle(i, triangles[i]);
+		mat.transformVect(triangles[i].pointA);
+		mat.transformVect(triangles[i].pointB);
+		mat.transformVect(triangles[i].pointC);
 	}
 
 	outTriangleCount = cnt;
@@ -195,36 +270,43 @@ void CTriangleSelector::getTriangles(core::triangle3df* triangles,
 	core::matrix4 mat(core::matrix4::EM4CONST_NOTHING);
 	core::aabbox3df tBox(box);
 
-	if (SceneNode)
+	if (TransformNode)
 	{
-		SceneNode->getAbsoluteTransformation().getInverse(mat);
+		TransformNode->getAbsoluteTransformation().getInverse(mat);
 		mat.transformBoxEx(tBox);
 	}
 	if (transform)
 		mat = *transform;
 	else
 		mat.makeIdentity();
-	if (SceneNode)
-		mat *= SceneNode->getAbsoluteTransformation();
+	if (TransformNode)
+		mat *= TransformNode->getAbsoluteTransformation();
 
 	outTriangleCount = 0;
 
 	if (!tBox.intersectsWithBox(BoundingBox))
 		return;
 
+	const bool identity = mat.isIdentity();
+	core::triangle3df triangle;
 	s32 triangleCount = 0;
-	const u32 cnt = Triangles.size();
+	const u32 cnt = getStoredTriangleCount();
 	for (u32 i=0; i<cnt; ++i)
 	{
+		getTriangle(i, triangle);
+
 		// This isn't an accurate test, but it's fast, and the 
 		// API contract doesn't guarantee complete accuracy.
-		if (Triangles[i].isTotalOutsideBox(tBox))
+		if (triangle.isTotalOutsideBox(tBox))
 		   continue;
 
-		triangles[triangleCount] = Triangles[i];
-		mat.transformVect(triangles[triangleCount].pointA);
-		mat.transformVect(triangles[triangleCount].pointB);
-		mat.transformVect(triangles[triangleCount].pointC);
+		triangles[triangleCount] = triangle;
+		if (!identity)
+		{
+			mat.transformVect(triangles[triangleCount].pointA);
+			mat.transformVect(triangles[triangleCount].pointB);
+			mat.transformVect(triangles[triangleCount].pointC);
+		}
 
 		++triangleCount;
 
@@ -254,10 +336,80 @@ void CTriangleSelector::getTriangles(core::triangle3df* triangles,
 }
 
 
+//! Finds the triangle hit by a line segment
+bool CTriangleSelector::getCollisionPoint(const core::line3d<f32>& line,
+					SCollisionHit& hit, bool anyHit) const
+{
+	// Update my triangles if necessary
+	update();
+
+	core::aabbox3d<f32> box(line.start);
+	box.addInternalPoint(line.end);
+
+	core::matrix4 mat;
+	if (TransformNode)
+	{
+		TransformNode->getAbsoluteTransformation().getInverse(mat);
+		mat.transformBoxEx(box);
+		mat = TransformNode->getAbsoluteTransformation();
+	}
+
+	if (!box.intersectsWithBox(BoundingBox))
+		return false;
+
+	SCollisionLine collision(line);
+	core::triangle3df triangle;
+	core::vector3df intersection;
+	bool found = false;
+
+	const u32 cnt = getStoredTriangleCount();
+	for (u32 i=0; i<cnt; ++i)
+	{
+		getTriangle(i, triangle);
+		if (triangle.isTotalOutsideBox(box))
+			continue;
+
+		if (TransformNode)
+		{
+			mat.transformVect(triangle.pointA);
+			mat.transformVect(triangle.pointB);
+			mat.transformVect(triangle.pointC);
+		}
+
+		if (collision.collide(triangle, intersection))
+		{
+			hit.Intersection = intersection;
+			hit.Triangle = triangle;
+			hit.Node = SceneNode;
+			hit.TriangleIndex = i;
+			found = true;
+			if (anyHit)
+				break;
+		}
+	}
+
+	return found;
+}
+
+
+//! Get the box around all triangles in world space
+bool CTriangleSelector::getTransformedBoundingBox(core::aabbox3d<f32>& box) const
+{
+	// the triangles of animated nodes change with the frame
+	if (AnimatedNode)
+		return false;
+
+	box = BoundingBox;
+	if (TransformNode)
+		TransformNode->getAbsoluteTransformation().transformBoxEx(box);
+	return true;
+}
+
+
 //! Returns amount of all available triangles in this selector
 s32 CTriangleSelector::getTriangleCount() const
 {
-	return Triangles.size();
+	return getStoredTriangleCount();
 }
 
 
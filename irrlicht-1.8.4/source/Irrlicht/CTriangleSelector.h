@@ -18,7 +18,62 @@ namespace scene
 class ISceneNode;
 class IAnimatedMeshSceneNode;
 
+//! Line of a collision query, tests world space triangles against it
+/** The test is the one ISceneCollisionManager::getCollisionPoint() always
+did: a bounding box reject, then the intersection with the line which
+has to lie between its end points and nearer than any former hit. */
+struct SCollisionLine
+{
+	SCollisionLine(const core::line3d<f32>& line)
+		: Line(line), Direction(line.getVector()), LengthSQ(line.getLengthSQ()),
+		Nearest(FLT_MAX)
+	{
+		Direction.normalize();
+		Box.reset(line.start);
+		Box.addInternalPoint(line.end);
+	}
+
+	//! returns true if the triangle is hit nearer than any triangle before
+	bool collide(const core::triangle3df& triangle, core::vector3df& intersection)
+	{
+		if (Box.MinEdge.X > triangle.pointA.X && Box.MinEdge.X > triangle.pointB.X && Box.MinEdge.X > triangle.pointC.X)
+			return false;
+		if (Box.MaxEdge.X < triangle.pointA.X && Box.MaxEdge.X < triangle.pointB.X && Box.MaxEdge.X < triangle.pointC.X)
+			return false;
+		if (Box.MinEdge.Y > triangle.pointA.Y && Box.MinEdge.Y > triangle.pointB.Y && Box.MinEdge.Y > triangle.pointC.Y)
+			return false;
+		if (Box.MaxEdge.Y < triangle.pointA.Y && Box.MaxEdge.Y < triangle.pointB.Y && Box.MaxEdge.Y < triangle.pointC.Y)
+			return false;
+		if (Box.MinEdge.Z > triangle.pointA.Z && Box.MinEdge.Z > triangle.pointB.Z && Box.MinEdge.Z > triangle.pointC.Z)
+			return false;
+		if (Box.MaxEdge.Z < triangle.pointA.Z && Box.MaxEdge.Z < triangle.pointB.Z && Box.MaxEdge.Z < triangle.pointC.Z)
+			return false;
+
+		if (!triangle.getIntersectionWithLine(Line.start, Direction, intersection))
+			return false;
+
+		const f32 distance = intersection.getDistanceFromSQ(Line.start);
+		if (distance < LengthSQ && intersection.getDistanceFromSQ(Line.end) < LengthSQ &&
+			distance < Nearest)
+		{
+			Nearest = distance;
+			return true;
+		}
+		return false;
+	}
+
+	core::line3d<f32> Line;
+	core::vector3df Direction;
+	core::aabbox3d<f32> Box;
+	f32 LengthSQ;
+	f32 Nearest;
+};
+
 //! Stupid triangle selector without optimization
+/** The triangles are kept as indices into a pool of the mesh positions,
+with 16 bit indices as long as the pool allows it. Selectors of static
+nodes may keep the positions in world space, so queries don't need to
+transform anything. */
 class CTriangleSelector : public ITriangleSelector
 {
 public:
@@ -27,7 +82,9 @@ public:
 	CTriangleSelector(ISceneNode* node);
 
 	//! Constructs a selector based on a mesh
-	CTriangleSelector(const IMesh* mesh, ISceneNode* node);
+	//!\param staticNode True to store the triangles transformed by the
+	//! current absolute transformation of the node
+	CTriangleSelector(const IMesh* mesh, ISceneNode* node, bool staticNode=false);
 
 	//! Constructs a selector based on an animated mesh scene node
 	//!\param node An animated mesh scene node, which must have a valid mesh
@@ -64,6 +121,16 @@ public:
 	// Get the TriangleSelector based on index based on getSelectorCount
 	virtual const ITriangleSelector* getSelector(u32 index) const;
 
+	//! Takes the current frame of an animated node
+	virtual void updateForQueries() const { update(); }
+
+	//! Finds the triangle hit by a line segment
+	virtual bool getCollisionPoint(const core::line3d<f32>& line,
+		SCollisionHit& hit, bool anyHit=false) const;
+
+	//! Get the box around all triangles in world space
+	virtual bool getTransformedBoundingBox(core::aabbox3d<f32>& box) const;
+
 protected:
 	//! Create from a mesh
 	virtual void createFromMesh(const IMesh* mesh);
@@ -76,8 +143,48 @@ protected:
 	//! since the last time it was updated.
 	virtual void update(void) const;
 
+	//! Fits the bounding box to the stored triangles
+	void updateBoundingBox() const;
+
+	//! Returns a stored triangle, in world space if there is no TransformNode
+	void getTriangle(u32 i, core::triangle3df& triangle) const
+	{
+		if (Indices32.empty())
+		{
+			const u16* const index = Indices16.const_pointer() + i*3;
+			triangle.pointA = Positions[index[0]];
+			triangle.pointB = Positions[index[1]];
+			triangle.pointC = Positions[index[2]];
+		}
+		else
+		{
+			const u32* const index = Indices32.const_pointer() + i*3;
+			triangle.pointA = Positions[index[0]];
+			triangle.pointB = Positions[index[1]];
+			triangle.pointC = Positions[index[2]];
+		}
+	}
+
+	//! Returns the amount of stored triangles
+	u32 getStoredTriangleCount() const
+	{
+		return (Indices16.size() + Indices32.size()) / 3;
+	}
+
+	//! Sorts the triangles, triangle i afterwards is the one at order[i] before
+	void reorderTriangles(const core::array<u32>& order);
+
 	ISceneNode* SceneNode;
-	mutable core::array<core::triangle3df> Triangles; // (mutable for CTriangleBBSelector)
+
+	//! Node whose transformation is applied to the stored triangles, 0 when they are in world space
+	ISceneNode* TransformNode;
+
+	mutable core::array<core::vector3df> Positions; // (mutable for animated meshes and CTriangleBBSelector)
+
+	//! three positions per triangle, in Indices16 while all positions can be reached with them
+	core::array<u16> Indices16;
+	core::array<u32> Indices32;
+
 	mutable core::aabbox3df BoundingBox; // Allows for trivial rejection
 
 	IAnimatedMeshSceneNode* AnimatedNode;
@@ -0,0 +1,120 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_VERTEX_WELDER_H_INCLUDED__
+#define __C_VERTEX_WELDER_H_INCLUDED__
+
+#include "irrArray.h"
+#include "vector3d.h"
+
+namespace irr
+{
+namespace scene
+{
+
+	//! Gives every vertex the index of the first vertex before it which is weldable with it
+	/** The positions are hashed into a grid of cells twice as large as the
+	tolerance, so a vertex can only be weldable with vertices in its own
+	cell and in the neighbour cell nearer to it on each axis. Only the
+	earlier vertices of these 8 cells are compared, which gives the result
+	of comparing with all earlier vertices in expected linear time.
+	\param vertices Provides getPosition(i) and isWeldable(i, j) of the
+	vertices. Weldable vertices must have positions which are equal within
+	the tolerance.
+	\param vertexCount Amount of vertices.
+	\param tolerance Largest distance of weldable positions on each axis.
+	\param ids Receives for each vertex the index of the first vertex it
+	is welded to, which is its own index for the first one. */
+	template <class T>
+	void weldVertices(const T& vertices, u32 vertexCount, f32 tolerance, core::array<u32>& ids)
+	{
+		ids.set_used(vertexCount);
+		if (!vertexCount)
+			return;
+
+		// cells also cover the rounding of equals(), so the cell
+		// coordinates never exceed 2^21
+		f32 maxAbs = 0.f;
+		u32 i;
+		for (i=0; i<vertexCount; ++i)
+		{
+			const core::vector3df& pos = vertices.getPosition(i);
+			maxAbs = core::max_(maxAbs, core::max_(fabsf(pos.X), fabsf(pos.Y), fabsf(pos.Z)));
+		}
+		f64 cellSize = 2.0 * (core::max_(tolerance, 0.f) + maxAbs / (f64)(1 << 22));
+		if (cellSize <= 0.0)
+			cellSize = 1.0; // all positions in the origin
+		const f64 invCellSize = 1.0 / cellSize;
+
+		u32 tableSize = 1;
+		while (tableSize < vertexCount * 2)
+			tableSize <<= 1;
+		const u32 mask = tableSize - 1;
+
+		// chains of vertices per bucket, in ascending order
+		core::array<u32> first;
+		first.set_used(tableSize);
+		memset(first.pointer(), 0xff, tableSize * sizeof(u32));
+		core::array<u32> last;
+		last.set_used(tableSize);
+		core::array<u32> next;
+		next.set_used(vertexCount);
+
+		const u32 primes[3] = { 73856093u, 19349663u, 83492791u };
+
+		for (i=0; i<vertexCount; ++i)
+		{
+			const core::vector3df& pos = vertices.getPosition(i);
+
+			// the cell of the vertex and the nearer neighbour on each axis
+			u32 cellHash[3][2];
+			for (u32 axis=0; axis<3; ++axis)
+			{
+				const f64 p = (axis == 0 ? pos.X : axis == 1 ? pos.Y : pos.Z) * invCellSize;
+				const f64 cell = floor(p);
+				const s32 c = (s32)cell;
+				cellHash[axis][0] = (u32)c * primes[axis];
+				cellHash[axis][1] = (u32)(p - cell < 0.5 ? c - 1 : c + 1) * primes[axis];
+			}
+
+			u32 buckets[8];
+			u32 found = 0xffffffff;
+			for (u32 n=0; n<8; ++n)
+			{
+				const u32 bucket = (cellHash[0][n & 1] ^ cellHash[1][(n >> 1) & 1] ^ cellHash[2][n >> 2]) & mask;
+				buckets[n] = bucket;
+
+				u32 k = 0;
+				while (k < n && buckets[k] != bucket)
+					++k;
+				if (k < n)
+					continue; // bucket already searched
+
+				for (u32 j=first[bucket]; j<found; j=next[j])
+				{
+					if (vertices.isWeldable(i, j))
+					{
+						found = j;
+						break;
+					}
+				}
+			}
+
+			ids[i] = found != 0xffffffff ? ids[found] : i;
+
+			// append the vertex to the chain of its own cell
+			next[i] = 0xffffffff;
+			if (first[buckets[0]] == 0xffffffff)
+				first[buckets[0]] = i;
+			else
+				next[last[buckets[0]]] = i;
+			last[buckets[0]] = i;
+		}
+	}
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
@@ -0,0 +1,778 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CVideoCommandStream.h"
+#include "IReadFile.h"
+#include "IWriteFile.h"
+#include "SLight.h"
+#include "os.h"
+
+namespace irr
+{
+namespace video
+{
+
+namespace
+{
+	//! "IRCS" in the first word of a stream
+	const u32 VIDEO_COMMAND_MAGIC = 0x53435249;
+	const u32 VIDEO_COMMAND_VERSION = 1;
+
+	//! buffered words written to the file at once
+	const u32 VIDEO_COMMAND_FLUSH_SIZE = 1 << 16;
+
+	//! words of a material without its texture matrices
+	const u32 VIDEO_COMMAND_MATERIAL_SIZE = 12 + MATERIAL_MAX_TEXTURES * 3;
+
+	//! returns the amount of indices used by a primitive list
+	u32 getIndexCount(scene::E_PRIMITIVE_TYPE pType, u32 primitiveCount)
+	{
+		switch (pType)
+		{
+		case scene::EPT_LINE_STRIP:
+			return primitiveCount + 1;
+		case scene::EPT_LINES:
+			return primitiveCount * 2;
+		case scene::EPT_TRIANGLE_STRIP:
+		case scene::EPT_TRIANGLE_FAN:
+			return primitiveCount + 2;
+		case scene::EPT_TRIANGLES:
+			return primitiveCount * 3;
+		case scene::EPT_QUAD_STRIP:
+			return primitiveCount * 2 + 2;
+		case scene::EPT_QUADS:
+			return primitiveCount * 4;
+		default:
+			// points, point sprites, line loop and polygon
+			return primitiveCount;
+		}
+	}
+
+	//! least amount of words after the header of each command
+	const u32 VIDEO_COMMAND_MIN_SIZE[EVC_COUNT] =
+	{
+		2, 0, 17, 12, 7, 7, 7, 14, 20, 9, 10, 13, 5, 3, 4, 27, 0, 2, 2
+	};
+
+	core::rect<s32> readRect(const u32* src)
+	{
+		return core::rect<s32>((s32)src[0], (s32)src[1], (s32)src[2], (s32)src[3]);
+	}
+
+	SColorf readColorf(const u32* src)
+	{
+		return SColorf(FR(src[0]), FR(src[1]), FR(src[2]), FR(src[3]));
+	}
+
+	void writeColorf(u32* dst, const SColorf& color)
+	{
+		dst[0] = IR(color.r);
+		dst[1] = IR(color.g);
+		dst[2] = IR(color.b);
+		dst[3] = IR(color.a);
+	}
+}
+
+
+//! constructor, writes the stream header
+CVideoCommandRecorder::CVideoCommandRecorder(io::IWriteFile* file)
+	: File(file), Depth(0)
+{
+	File->grab();
+
+	Words.push_back(VIDEO_COMMAND_MAGIC);
+	Words.push_back(VIDEO_COMMAND_VERSION);
+}
+
+
+//! destructor, flushes the stream and releases the file
+CVideoCommandRecorder::~CVideoCommandRecorder()
+{
+	flush();
+	File->drop();
+}
+
+
+//! writes the buffered words to the file
+void CVideoCommandRecorder::flush()
+{
+	if (Words.size())
+		File->write(Words.const_pointer(), Words.size() * sizeof(u32));
+	Words.set_used(0);
+}
+
+
+//! starts a command of the given amount of words after the header
+u32* CVideoCommandRecorder::command(E_VIDEO_COMMAND type, u32 words)
+{
+	if (Words.size() >= VIDEO_COMMAND_FLUSH_SIZE)
+		flush();
+
+	const u32 start = Words.size();
+	Words.set_used(start + 1 + words);
+	Words[start] = type | (words << 8);
+	return Words.pointer() + start + 1;
+}
+
+
+//! returns the id of the texture, writes its name on first use
+u32 CVideoCommandRecorder::textureId(const ITexture* texture)
+{
+	if (!texture)
+		return 0;
+
+	const io::path& name = texture->getName().getPath();
+
+	// a texture may have been deleted and another one created at its address
+	core::map<const ITexture*, u32>::Node* node = Textures.find(texture);
+	if (node && TextureNames[node->getValue() - 1] == name)
+		return node->getValue();
+
+	TextureNames.push_back(name);
+	const u32 id = TextureNames.size();
+	Textures.set(texture, id);
+
+	const core::stringc chars(name);
+	const u32 size = chars.size();
+	u32* dst = command(EVC_TEXTURE, 2 + ((size + 3) >> 2));
+	dst[0] = id;
+	dst[1] = size;
+	dst[1 + ((size + 3) >> 2)] = 0;
+	memcpy(dst + 2, chars.c_str(), size);
+	return id;
+}
+
+
+//! returns the id of the data, writes it on first use
+u32 CVideoCommandRecorder::dataId(const void* data, u32 size)
+{
+	if (!data)
+		return 0;
+
+	// fnv-1a of the bytes, mixed with the size
+	u64 hash = 14695981039346656037ULL;
+	const u8* bytes = (const u8*) data;
+	for (u32 i = 0; i != size; ++i)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+	hash ^= (u64) size << 40;
+
+	// blocks with the same hash are only the same when their bytes are
+	core::map<u64, u32>::Node* node = Data.find(hash);
+	u32 last = 0;
+	for (u32 i = node ? node->getValue() : 0; i; i = DataBlocks[i - 1].Next)
+	{
+		const SData& block = DataBlocks[i - 1];
+		if (block.Size == size && 0 == memcmp(DataBytes.const_pointer() + block.Start, data, size))
+			return i;
+		last = i;
+	}
+
+	SData block;
+	block.Start = DataBytes.size();
+	block.Size = size;
+	block.Next = 0;
+	DataBlocks.push_back(block);
+	const u32 id = DataBlocks.size();
+	if (last)
+		DataBlocks[last - 1].Next = id;
+	else
+		Data.insert(hash, id);
+
+	if (DataBytes.allocated_size() < block.Start + size)
+		DataBytes.reallocate(core::max_(block.Start + size, DataBytes.allocated_size() * 2));
+	DataBytes.set_used(block.Start + size);
+	memcpy(DataBytes.pointer() + block.Start, data, size);
+
+	u32* dst = command(EVC_DATA, 2 + ((size + 3) >> 2));
+	dst[0] = id;
+	dst[1] = size;
+	dst[1 + ((size + 3) >> 2)] = 0;
+	memcpy(dst + 2, data, size);
+	return id;
+}
+
+
+void CVideoCommandRecorder::writeRect(u32* dst, const core::rect<s32>& rect) const
+{
+	dst[0] = rect.UpperLeftCorner.X;
+	dst[1] = rect.UpperLeftCorner.Y;
+	dst[2] = rect.LowerRightCorner.X;
+	dst[3] = rect.LowerRightCorner.Y;
+}
+
+
+u32* CVideoCommandRecorder::writeClip(u32* dst, const core::rect<s32>* clip) const
+{
+	dst[0] = clip ? 1 : 0;
+	writeRect(dst + 1, clip ? *clip : core::rect<s32>(0, 0, 0, 0));
+	return dst + 5;
+}
+
+
+void CVideoCommandRecorder::beginScene(bool backBuffer, bool zBuffer, SColor color)
+{
+	u32* dst = command(EVC_BEGIN_SCENE, 2);
+	dst[0] = (backBuffer ? 1 : 0) | (zBuffer ? 2 : 0);
+	dst[1] = color.color;
+}
+
+
+void CVideoCommandRecorder::endScene()
+{
+	command(EVC_END_SCENE, 0);
+	flush();
+}
+
+
+void CVideoCommandRecorder::setTransform(E_TRANSFORMATION_STATE state, const core::matrix4& mat)
+{
+	u32* dst = command(EVC_SET_TRANSFORM, 17);
+	dst[0] = state;
+	memcpy(dst + 1, mat.pointer(), 16 * sizeof(f32));
+}
+
+
+void CVideoCommandRecorder::setMaterial(const SMaterial& material)
+{
+	u32 i;
+	u32 texture[MATERIAL_MAX_TEXTURES];
+	u32 words = VIDEO_COMMAND_MATERIAL_SIZE;
+	for (i = 0; i != MATERIAL_MAX_TEXTURES; ++i)
+	{
+		texture[i] = textureId(material.TextureLayer[i].Texture);
+		if (!material.TextureLayer[i].getTextureMatrix().isIdentity())
+			words += 16;
+	}
+
+	u32* dst = command(EVC_SET_MATERIAL, words);
+	dst[0] = material.MaterialType;
+	dst[1] = material.AmbientColor.color;
+	dst[2] = material.DiffuseColor.color;
+	dst[3] = material.EmissiveColor.color;
+	dst[4] = material.SpecularColor.color;
+	dst[5] = IR(material.Shininess);
+	dst[6] = IR(material.MaterialTypeParam);
+	dst[7] = IR(material.MaterialTypeParam2);
+	dst[8] = IR(material.Thickness);
+	dst[9] = material.ZBuffer | (material.AntiAliasing << 8) |
+		(material.ColorMask << 16) | (material.ColorMaterial << 20) |
+		(material.BlendOperation << 24) | (material.PolygonOffsetFactor << 28) |
+		((u32) material.PolygonOffsetDirection << 31);
+	dst[10] = (material.Wireframe ? 1 : 0) | (material.PointCloud ? 2 : 0) |
+		(material.GouraudShading ? 4 : 0) | (material.Lighting ? 8 : 0) |
+		(material.ZWriteEnable ? 16 : 0) | (material.BackfaceCulling ? 32 : 0) |
+		(material.FrontfaceCulling ? 64 : 0) | (material.FogEnable ? 128 : 0) |
+		(material.NormalizeNormals ? 256 : 0) | (material.UseMipMaps ? 512 : 0);
+	dst[11] = MATERIAL_MAX_TEXTURES;
+	dst += 12;
+
+	for (i = 0; i != MATERIAL_MAX_TEXTURES; ++i)
+	{
+		const SMaterialLayer& layer = material.TextureLayer[i];
+		const core::matrix4& mat = layer.getTextureMatrix();
+
+		dst[0] = texture[i];
+		dst[1] = layer.TextureWrapU | (layer.TextureWrapV << 4) |
+			(layer.BilinearFilter ? 0x100 : 0) | (layer.TrilinearFilter ? 0x200 : 0) |
+			(layer.AnisotropicFilter << 16) | ((u8) layer.LODBias << 24);
+		dst[2] = mat.isIdentity() ? 0 : 1;
+		dst += 3;
+		if (dst[-1])
+		{
+			memcpy(dst, mat.pointer(), 16 * sizeof(f32));
+			dst += 16;
+		}
+	}
+}
+
+
+void CVideoCommandRecorder::drawVertexPrimitiveList(bool twoD, const void* vertices, u32 vertexCount,
+		const void* indexList, u32 primitiveCount,
+		E_VERTEX_TYPE vType, scene::E_PRIMITIVE_TYPE pType, E_INDEX_TYPE iType)
+{
+	// hardware buffers draw without vertex data
+	if (!vertices && vertexCount)
+		return;
+
+	const u32 vertexId = dataId(vertices, vertexCount * getVertexPitchFromType(vType));
+	const u32 indexId = dataId(indexList,
+			getIndexCount(pType, primitiveCount) * (iType == EIT_16BIT ? sizeof(u16) : sizeof(u32)));
+
+	u32* dst = command(twoD ? EVC_DRAW_2D_PRIMITIVES : EVC_DRAW_PRIMITIVES, 7);
+	dst[0] = vertexId;
+	dst[1] = vertexCount;
+	dst[2] = indexId;
+	dst[3] = primitiveCount;
+	dst[4] = vType;
+	dst[5] = pType;
+	dst[6] = iType;
+}
+
+
+void CVideoCommandRecorder::draw3DLine(const core::vector3df& start, const core::vector3df& end, SColor color)
+{
+	u32* dst = command(EVC_DRAW_3D_LINE, 7);
+	memcpy(dst, &start.X, 3 * sizeof(f32));
+	memcpy(dst + 3, &end.X, 3 * sizeof(f32));
+	dst[6] = color.color;
+}
+
+
+void CVideoCommandRecorder::draw2DImage(const ITexture* texture, const core::position2d<s32>& destPos,
+		const core::rect<s32>& sourceRect, const core::rect<s32>* clipRect,
+		SColor color, bool useAlphaChannelOfTexture)
+{
+	const u32 id = textureId(texture);
+	u32* dst = command(EVC_DRAW_2D_IMAGE, 14);
+	dst[0] = id;
+	dst[1] = destPos.X;
+	dst[2] = destPos.Y;
+	writeRect(dst + 3, sourceRect);
+	dst = writeClip(dst + 7, clipRect);
+	dst[0] = color.color;
+	dst[1] = useAlphaChannelOfTexture ? 1 : 0;
+}
+
+
+void CVideoCommandRecorder::draw2DImage(const ITexture* texture, const core::rect<s32>& destRect,
+		const core::rect<s32>& sourceRect, const core::rect<s32>* clipRect,
+		const SColor* const colors, bool useAlphaChannelOfTexture)
+{
+	const u32 id = textureId(texture);
+	u32* dst = command(EVC_DRAW_2D_IMAGE_RECT, 20);
+	dst[0] = id;
+	writeRect(dst + 1, destRect);
+	writeRect(dst + 5, sourceRect);
+	dst = writeClip(dst + 9, clipRect);
+	dst[0] = colors ? 1 : 0;
+	for (u32 i = 0; i != 4; ++i)
+		dst[1 + i] = colors ? colors[i].color : 0;
+	dst[5] = useAlphaChannelOfTexture ? 1 : 0;
+}
+
+
+void CVideoCommandRecorder::draw2DImageBatch(const ITexture* texture,
+		const core::array<core::position2d<s32> >& positions,
+		const core::array<core::rect<s32> >& sourceRects,
+		const core::rect<s32>* clipRect, SColor color,
+		bool useAlphaChannelOfTexture)
+{
+	const u32 id = textureId(texture);
+	const u32 count = core::min_(positions.size(), sourceRects.size());
+	u32* dst = command(EVC_DRAW_2D_IMAGE_BATCH, 9 + count * 6);
+	dst[0] = id;
+	dst[1] = count;
+	dst = writeClip(dst + 2, clipRect);
+	dst[0] = color.color;
+	dst[1] = useAlphaChannelOfTexture ? 1 : 0;
+	dst += 2;
+
+	for (u32 i = 0; i != count; ++i)
+	{
+		dst[0] = positions[i].X;
+		dst[1] = positions[i].Y;
+		writeRect(dst + 2, sourceRects[i]);
+		dst += 6;
+	}
+}
+
+
+//! written as a batch with positions, placed like CNullDriver does
+void CVideoCommandRecorder::draw2DImageBatch(const ITexture* texture,
+		const core::position2d<s32>& pos,
+		const core::array<core::rect<s32> >& sourceRects,
+		const core::array<s32>& indices, s32 kerningWidth,
+		const core::rect<s32>* clipRect, SColor color,
+		bool useAlphaChannelOfTexture)
+{
+	core::array<core::position2d<s32> > positions(indices.size());
+	core::array<core::rect<s32> > rects(indices.size());
+	core::position2d<s32> target(pos);
+
+	for (u32 i = 0; i != indices.size(); ++i)
+	{
+		const core::rect<s32>& source = sourceRects[indices[i]];
+		positions.push_back(target);
+		rects.push_back(source);
+		target.X += source.getWidth() + kerningWidth;
+	}
+
+	draw2DImageBatch(texture, positions, rects, clipRect, color, useAlphaChannelOfTexture);
+}
+
+
+void CVideoCommandRecorder::draw2DRectangle(SColor color, const core::rect<s32>& pos, const core::rect<s32>* clip)
+{
+	u32* dst = command(EVC_DRAW_2D_RECTANGLE, 10);
+	dst[0] = color.color;
+	writeRect(dst + 1, pos);
+	writeClip(dst + 5, clip);
+}
+
+
+void CVideoCommandRecorder::draw2DRectangle(const core::rect<s32>& pos,
+		SColor colorLeftUp, SColor colorRightUp,
+		SColor colorLeftDown, SColor colorRightDown,
+		const core::rect<s32>* clip)
+{
+	u32* dst = command(EVC_DRAW_2D_RECTANGLE_GRADIENT, 13);
+	writeRect(dst, pos);
+	dst[4] = colorLeftUp.color;
+	dst[5] = colorRightUp.color;
+	dst[6] = colorLeftDown.color;
+	dst[7] = colorRightDown.color;
+	writeClip(dst + 8, clip);
+}
+
+
+void CVideoCommandRecorder::draw2DLine(const core::position2d<s32>& start, const core::position2d<s32>& end, SColor color)
+{
+	u32* dst = command(EVC_DRAW_2D_LINE, 5);
+	dst[0] = start.X;
+	dst[1] = start.Y;
+	dst[2] = end.X;
+	dst[3] = end.Y;
+	dst[4] = color.color;
+}
+
+
+void CVideoCommandRecorder::drawPixel(u32 x, u32 y, SColor color)
+{
+	u32* dst = command(EVC_DRAW_PIXEL, 3);
+	dst[0] = x;
+	dst[1] = y;
+	dst[2] = color.color;
+}
+
+
+void CVideoCommandRecorder::setAmbientLight(const SColorf& color)
+{
+	writeColorf(command(EVC_SET_AMBIENT_LIGHT, 4), color);
+}
+
+
+void CVideoCommandRecorder::addDynamicLight(const SLight& light)
+{
+	u32* dst = command(EVC_ADD_DYNAMIC_LIGHT, 27);
+	writeColorf(dst, light.AmbientColor);
+	writeColorf(dst + 4, light.DiffuseColor);
+	writeColorf(dst + 8, light.SpecularColor);
+	memcpy(dst + 12, &light.Attenuation.X, 3 * sizeof(f32));
+	dst[15] = IR(light.OuterCone);
+	dst[16] = IR(light.InnerCone);
+	dst[17] = IR(light.Falloff);
+	memcpy(dst + 18, &light.Position.X, 3 * sizeof(f32));
+	memcpy(dst + 21, &light.Direction.X, 3 * sizeof(f32));
+	dst[24] = IR(light.Radius);
+	dst[25] = light.Type;
+	dst[26] = light.CastShadows ? 1 : 0;
+}
+
+
+void CVideoCommandRecorder::deleteAllDynamicLights()
+{
+	command(EVC_DELETE_ALL_DYNAMIC_LIGHTS, 0);
+}
+
+
+//! Replays a command stream on a driver
+s32 replayVideoCommands(IVideoDriver* driver, io::IReadFile* file,
+		core::array<SVideoCommandTiming>* timings)
+{
+	if (!file)
+		return -1;
+
+	core::array<u32> words;
+	words.set_used(file->getSize() / sizeof(u32));
+	if (words.size() < 2 ||
+		file->read(words.pointer(), words.size() * sizeof(u32)) != (s32) (words.size() * sizeof(u32)) ||
+		words[0] != VIDEO_COMMAND_MAGIC || words[1] != VIDEO_COMMAND_VERSION)
+	{
+		os::Printer::log("Not a video command stream", file->getFileName(), ELL_ERROR);
+		return -1;
+	}
+
+	// data with its size in bytes and textures by id, 0 is none
+	core::array<const u32*> data;
+	core::array<u32> dataSizes;
+	core::array<ITexture*> textures;
+	data.push_back(0);
+	dataSizes.push_back(0);
+	textures.push_back(0);
+
+	SMaterial material;
+	s32 calls = 0;
+
+	u32 pos = 2;
+	while (pos < words.size())
+	{
+		const E_VIDEO_COMMAND type = (E_VIDEO_COMMAND) (words[pos] & 0xFF);
+		const u32 size = words[pos] >> 8;
+		const u32* src = words.const_pointer() + pos + 1;
+
+		if (pos + 1 + size > words.size())
+		{
+			os::Printer::log("Truncated video command stream", file->getFileName(), ELL_ERROR);
+			return -1;
+		}
+		pos += 1 + size;
+
+		// commands of later versions are skipped
+		if (type >= EVC_COUNT || size < VIDEO_COMMAND_MIN_SIZE[type])
+			continue;
+
+		// definitions
+		if (type == EVC_DATA || type == EVC_TEXTURE)
+		{
+			if (src[1] > (size - 2) * sizeof(u32))
+				continue;
+		}
+		if (type == EVC_DATA)
+		{
+			while (data.size() <= src[0])
+			{
+				data.push_back(0);
+				dataSizes.push_back(0);
+			}
+			data[src[0]] = src + 2;
+			dataSizes[src[0]] = src[1];
+			continue;
+		}
+		if (type == EVC_TEXTURE)
+		{
+			const io::path name(core::stringc((const c8*) (src + 2), src[1]));
+			ITexture* texture = driver->findTexture(name);
+			if (!texture)
+				texture = driver->getTexture(name);
+			while (textures.size() <= src[0])
+				textures.push_back(0);
+			textures[src[0]] = texture;
+			continue;
+		}
+
+		// resolve references before timing the call
+		ITexture* texture = 0;
+		const void* vertices = 0;
+		const void* indices = 0;
+		core::array<core::position2d<s32> > positions;
+		core::array<core::rect<s32> > sourceRects;
+		switch (type)
+		{
+		case EVC_SET_MATERIAL:
+			{
+				material.MaterialType = (E_MATERIAL_TYPE) src[0];
+				material.AmbientColor.color = src[1];
+				material.DiffuseColor.color = src[2];
+				material.EmissiveColor.color = src[3];
+				material.SpecularColor.color = src[4];
+				material.Shininess = FR(src[5]);
+				material.MaterialTypeParam = FR(src[6]);
+				material.MaterialTypeParam2 = FR(src[7]);
+				material.Thickness = FR(src[8]);
+				material.ZBuffer = src[9] & 0xFF;
+				material.AntiAliasing = (src[9] >> 8) & 0xFF;
+				material.ColorMask = (src[9] >> 16) & 0xF;
+				material.ColorMaterial = (src[9] >> 20) & 0x7;
+				material.BlendOperation = (E_BLEND_OPERATION) ((src[9] >> 24) & 0xF);
+				material.PolygonOffsetFactor = (src[9] >> 28) & 0x7;
+				material.PolygonOffsetDirection = (E_POLYGON_OFFSET) (src[9] >> 31);
+				material.Wireframe = (src[10] & 1) != 0;
+				material.PointCloud = (src[10] & 2) != 0;
+				material.GouraudShading = (src[10] & 4) != 0;
+				material.Lighting = (src[10] & 8) != 0;
+				material.ZWriteEnable = (src[10] & 16) != 0;
+				material.BackfaceCulling = (src[10] & 32) != 0;
+				material.FrontfaceCulling = (src[10] & 64) != 0;
+				material.FogEnable = (src[10] & 128) != 0;
+				material.NormalizeNormals = (src[10] & 256) != 0;
+				material.UseMipMaps = (src[10] & 512) != 0;
+
+				const u32* layerSrc = src + 12;
+				for (u32 i = 0; i != src[11] && layerSrc + 3 <= src + size; ++i)
+				{
+					if (layerSrc[2] && layerSrc + 19 > src + size)
+						break;
+					if (i < MATERIAL_MAX_TEXTURES)
+					{
+						SMaterialLayer& layer = material.TextureLayer[i];
+						layer.Texture = layerSrc[0] < textures.size() ? textures[layerSrc[0]] : 0;
+						layer.TextureWrapU = layerSrc[1] & 0xF;
+						layer.TextureWrapV = (layerSrc[1] >> 4) & 0xF;
+						layer.BilinearFilter = (layerSrc[1] & 0x100) != 0;
+						layer.TrilinearFilter = (layerSrc[1] & 0x200) != 0;
+						layer.AnisotropicFilter = (layerSrc[1] >> 16) & 0xFF;
+						layer.LODBias = (s8) (layerSrc[1] >> 24);
+						if (layerSrc[2])
+							layer.getTextureMatrix().setM((const f32*) (layerSrc + 3));
+						else if (!((const SMaterialLayer&) layer).getTextureMatrix().isIdentity())
+							layer.setTextureMatrix(core::IdentityMatrix);
+					}
+					layerSrc += layerSrc[2] ? 19 : 3;
+				}
+			}
+			break;
+		case EVC_DRAW_PRIMITIVES:
+		case EVC_DRAW_2D_PRIMITIVES:
+			{
+				if (src[0] >= data.size() || src[2] >= data.size() ||
+					src[4] > EVT_TANGENTS || src[5] > scene::EPT_POINT_SPRITES ||
+					(src[6] != EIT_16BIT && src[6] != EIT_32BIT))
+					continue;
+
+				// the data has to cover all vertices and indices drawn, each
+				// primitive uses at least one index
+				const u32 vertexPitch = getVertexPitchFromType((E_VERTEX_TYPE) src[4]);
+				const u32 indexSize = src[6] == EIT_16BIT ? sizeof(u16) : sizeof(u32);
+				if ((u64) src[1] * vertexPitch > dataSizes[src[0]] || src[3] > dataSizes[src[2]] ||
+					(u64) getIndexCount((scene::E_PRIMITIVE_TYPE) src[5], src[3]) * indexSize > dataSizes[src[2]])
+					continue;
+			}
+			vertices = data[src[0]];
+			indices = data[src[2]];
+			break;
+		case EVC_DRAW_2D_IMAGE:
+		case EVC_DRAW_2D_IMAGE_RECT:
+			texture = src[0] < textures.size() ? textures[src[0]] : 0;
+			break;
+		case EVC_DRAW_2D_IMAGE_BATCH:
+			{
+				if (src[1] > (size - 9) / 6)
+					continue;
+				texture = src[0] < textures.size() ? textures[src[0]] : 0;
+				positions.reallocate(src[1]);
+				sourceRects.reallocate(src[1]);
+				const u32* element = src + 9;
+				for (u32 i = 0; i != src[1]; ++i)
+				{
+					positions.push_back(core::position2d<s32>((s32) element[0], (s32) element[1]));
+					sourceRects.push_back(readRect(element + 2));
+					element += 6;
+				}
+			}
+			break;
+		default:
+			break;
+		}
+
+		const u32 start = os::Timer::getRealTimeMicroseconds();
+
+		switch (type)
+		{
+		case EVC_BEGIN_SCENE:
+			driver->beginScene((src[0] & 1) != 0, (src[0] & 2) != 0, SColor(src[1]));
+			break;
+		case EVC_END_SCENE:
+			driver->endScene();
+			break;
+		case EVC_SET_TRANSFORM:
+			{
+				core::matrix4 mat(core::matrix4::EM4CONST_NOTHING);
+				mat.setM((const f32*) (src + 1));
+				driver->setTransform((E_TRANSFORMATION_STATE) src[0], mat);
+			}
+			break;
+		case EVC_SET_MATERIAL:
+			driver->setMaterial(material);
+			break;
+		case EVC_DRAW_PRIMITIVES:
+			driver->drawVertexPrimitiveList(vertices, src[1], indices, src[3],
+				(E_VERTEX_TYPE) src[4], (scene::E_PRIMITIVE_TYPE) src[5], (E_INDEX_TYPE) src[6]);
+			break;
+		case EVC_DRAW_2D_PRIMITIVES:
+			driver->draw2DVertexPrimitiveList(vertices, src[1], indices, src[3],
+				(E_VERTEX_TYPE) src[4], (scene::E_PRIMITIVE_TYPE) src[5], (E_INDEX_TYPE) src[6]);
+			break;
+		case EVC_DRAW_3D_LINE:
+			driver->draw3DLine(core::vector3df(FR(src[0]), FR(src[1]), FR(src[2])),
+				core::vector3df(FR(src[3]), FR(src[4]), FR(src[5])), SColor(src[6]));
+			break;
+		case EVC_DRAW_2D_IMAGE:
+			{
+				const core::rect<s32> clip(readRect(src + 8));
+				driver->draw2DImage(texture, core::position2d<s32>((s32) src[1], (s32) src[2]),
+					readRect(src + 3), src[7] ? &clip : 0, SColor(src[12]), src[13] != 0);
+			}
+			break;
+		case EVC_DRAW_2D_IMAGE_RECT:
+			{
+				const core::rect<s32> clip(readRect(src + 10));
+				const SColor colors[4] = { SColor(src[15]), SColor(src[16]), SColor(src[17]), SColor(src[18]) };
+				driver->draw2DImage(texture, readRect(src + 1), readRect(src + 5),
+					src[9] ? &clip : 0, src[14] ? colors : 0, src[19] != 0);
+			}
+			break;
+		case EVC_DRAW_2D_IMAGE_BATCH:
+			{
+				const core::rect<s32> clip(readRect(src + 3));
+				driver->draw2DImageBatch(texture, positions, sourceRects,
+					src[2] ? &clip : 0, SColor(src[7]), src[8] != 0);
+			}
+			break;
+		case EVC_DRAW_2D_RECTANGLE:
+			{
+				const core::rect<s32> clip(readRect(src + 6));
+				driver->draw2DRectangle(SColor(src[0]), readRect(src + 1), src[5] ? &clip : 0);
+			}
+			break;
+		case EVC_DRAW_2D_RECTANGLE_GRADIENT:
+			{
+				const core::rect<s32> clip(readRect(src + 9));
+				driver->draw2DRectangle(readRect(src), SColor(src[4]), SColor(src[5]),
+					SColor(src[6]), SColor(src[7]), src[8] ? &clip : 0);
+			}
+			break;
+		case EVC_DRAW_2D_LINE:
+			driver->draw2DLine(core::position2d<s32>((s32) src[0], (s32) src[1]),
+				core::position2d<s32>((s32) src[2], (s32) src[3]), SColor(src[4]));
+			break;
+		case EVC_DRAW_PIXEL:
+			driver->drawPixel(src[0], src[1], SColor(src[2]));
+			break;
+		case EVC_SET_AMBIENT_LIGHT:
+			driver->setAmbientLight(readColorf(src));
+			break;
+		case EVC_ADD_DYNAMIC_LIGHT:
+			{
+				SLight light;
+				light.AmbientColor = readColorf(src);
+				light.DiffuseColor = readColorf(src + 4);
+				light.SpecularColor = readColorf(src + 8);
+				light.Attenuation.set(FR(src[12]), FR(src[13]), FR(src[14]));
+				light.OuterCone = FR(src[15]);
+				light.InnerCone = FR(src[16]);
+				light.Falloff = FR(src[17]);
+				light.Position.set(FR(src[18]), FR(src[19]), FR(src[20]));
+				light.Direction.set(FR(src[21]), FR(src[22]), FR(src[23]));
+				light.Radius = FR(src[24]);
+				light.Type = (E_LIGHT_TYPE) src[25];
+				light.CastShadows = src[26] != 0;
+				driver->addDynamicLight(light);
+			}
+			break;
+		case EVC_DELETE_ALL_DYNAMIC_LIGHTS:
+			driver->deleteAllDynamicLights();
+			break;
+		default:
+			continue;
+		}
+
+		if (timings)
+		{
+			SVideoCommandTiming timing;
+			timing.Command = type;
+			timing.Time = os::Timer::getRealTimeMicroseconds() - start;
+			timings->push_back(timing);
+		}
+		++calls;
+	}
+
+	return calls;
+}
+
+} // end namespace video
+} // end namespace irr
+
@@ -0,0 +1,156 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_VIDEO_COMMAND_STREAM_H_INCLUDED__
+#define __C_VIDEO_COMMAND_STREAM_H_INCLUDED__
+
+#include "IVideoDriver.h"
+#include "irrMap.h"
+
+namespace irr
+{
+namespace io
+{
+	class IReadFile;
+	class IWriteFile;
+} // end namespace io
+
+namespace video
+{
+
+	//! Writes the draw calls of a driver into a command stream
+	/** The stream is a sequence of 32 bit words. Each command starts with
+	a word holding its E_VIDEO_COMMAND in the low byte and the amount of
+	following words above. Vertex and index data and texture names are
+	written once as EVC_DATA and EVC_TEXTURE commands, and referenced by id
+	afterwards. */
+	class CVideoCommandRecorder
+	{
+	public:
+
+		//! constructor, writes the stream header
+		CVideoCommandRecorder(io::IWriteFile* file);
+
+		//! destructor, flushes the stream and releases the file
+		~CVideoCommandRecorder();
+
+		//! enters a driver call, returns true if it is not called by another recorded one
+		bool enter() { return 0 == Depth++; }
+
+		//! leaves a driver call
+		void leave() { --Depth; }
+
+		void beginScene(bool backBuffer, bool zBuffer, SColor color);
+		void endScene();
+		void setTransform(E_TRANSFORMATION_STATE state, const core::matrix4& mat);
+		void setMaterial(const SMaterial& material);
+		void drawVertexPrimitiveList(bool twoD, const void* vertices, u32 vertexCount,
+				const void* indexList, u32 primitiveCount,
+				E_VERTEX_TYPE vType, scene::E_PRIMITIVE_TYPE pType, E_INDEX_TYPE iType);
+		void draw3DLine(const core::vector3df& start, const core::vector3df& end, SColor color);
+		void draw2DImage(const ITexture* texture, const core::position2d<s32>& destPos,
+				const core::rect<s32>& sourceRect, const core::rect<s32>* clipRect,
+				SColor color, bool useAlphaChannelOfTexture);
+		void draw2DImage(const ITexture* texture, const core::rect<s32>& destRect,
+				const core::rect<s32>& sourceRect, const core::rect<s32>* clipRect,
+				const SColor* const colors, bool useAlphaChannelOfTexture);
+		void draw2DImageBatch(const ITexture* texture,
+				const core::array<core::position2d<s32> >& positions,
+				const core::array<core::rect<s32> >& sourceRects,
+				const core::rect<s32>* clipRect, SColor color,
+				bool useAlphaChannelOfTexture);
+		void draw2DImageBatch(const ITexture* texture,
+				const core::position2d<s32>& pos,
+				const core::array<core::rect<s32> >& sourceRects,
+				const core::array<s32>& indices, s32 kerningWidth,
+				const core::rect<s32>* clipRect, SColor color,
+				bool useAlphaChannelOfTexture);
+		void draw2DRectangle(SColor color, const core::rect<s32>& pos, const core::rect<s32>* clip);
+		void draw2DRectangle(const core::rect<s32>& pos,
+				SColor colorLeftUp, SColor colorRightUp,
+				SColor colorLeftDown, SColor colorRightDown,
+				const core::rect<s32>* clip);
+		void draw2DLine(const core::position2d<s32>& start, const core::position2d<s32>& end, SColor color);
+		void drawPixel(u32 x, u32 y, SColor color);
+		void setAmbientLight(const SColorf& color);
+		void addDynamicLight(const SLight& light);
+		void deleteAllDynamicLights();
+
+	private:
+
+		//! starts a command of the given amount of words after the header
+		u32* command(E_VIDEO_COMMAND type, u32 words);
+
+		//! returns the id of the texture, writes its name on first use
+		u32 textureId(const ITexture* texture);
+
+		//! returns the id of the data, writes it on first use
+		u32 dataId(const void* data, u32 size);
+
+		void writeRect(u32* dst, const core::rect<s32>& rect) const;
+		u32* writeClip(u32* dst, const core::rect<s32>* clip) const;
+
+		//! writes the buffered words to the file
+		void flush();
+
+		io::IWriteFile* File;
+		core::array<u32> Words;
+
+		core::map<const ITexture*, u32> Textures;
+		core::array<io::path> TextureNames;
+		//! a written data block, its bytes are kept to compare blocks with the same hash
+		struct SData
+		{
+			u32 Start;
+			u32 Size;
+			//! next id with the same hash, 0 for none
+			u32 Next;
+		};
+
+		//! first id of each hash
+		core::map<u64, u32> Data;
+		//! blocks by id - 1
+		core::array<SData> DataBlocks;
+		core::array<u8> DataBytes;
+
+		u32 Depth;
+	};
+
+
+	//! Lets the outermost recorded call of a driver write its command
+	/** Driver calls made by another recorded call, like draw2DRectangle()
+	calling its gradient version, are not written. */
+	class CVideoCommandScope
+	{
+	public:
+		CVideoCommandScope(CVideoCommandRecorder* recorder)
+			: Recorder(recorder), Outermost(recorder && recorder->enter()) {}
+
+		~CVideoCommandScope()
+		{
+			if (Recorder)
+				Recorder->leave();
+		}
+
+		//! returns true if the call has to be written
+		bool isRecording() const { return Outermost; }
+
+		CVideoCommandRecorder* operator->() const { return Recorder; }
+
+	private:
+		CVideoCommandRecorder* Recorder;
+		bool Outermost;
+	};
+
+
+	//! Replays a command stream on a driver
+	/** \return Amount of replayed calls, -1 for an invalid stream. */
+	s32 replayVideoCommands(IVideoDriver* driver, io::IReadFile* file,
+			core::array<SVideoCommandTiming>* timings);
+
+} // end namespace video
+} // end namespace irr
+
+#endif
+
@@ -35,6 +35,8 @@ namespace video
 
 		Driver = driver;
 		RenderTarget = 0;
+		BandIndex = 0;
+		BandCount = 1;
 		ColorMask = COLOR_BRIGHT_WHITE;
 		DepthBuffer = (CDepthBuffer*) driver->getDepthBuffer ();
 		if ( DepthBuffer )
@@ -73,6 +75,7 @@ namespace video
 			RenderTarget->drop();
 
 		RenderTarget = (video::CImage* ) surface;
+		Scissor = viewPort;
 
 		if (RenderTarget)
 		{
@@ -114,6 +117,129 @@ namespace video
 	}
 
 
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+
+	// relative amount a triangle is moved to the front before it is compared
+	// to the coarse depth, covers the rounding of the span interpolation
+	static const f32 DEPTH_TILE_BIAS = 1.f / 256.f;
+
+	//! tile range [x0,x1] [y0,y1] of the pixels a triangle covers, false if none
+	bool IBurningShader::getTileRect ( const s4DVertex *a, const s4DVertex *b, const s4DVertex *c, u32 *tile ) const
+	{
+		const core::dimension2d<u32>& size = DepthBuffer->getSize ();
+
+		// pixels any renderer may visit, lines round to the nearest pixel
+		const s32 x0 = core::s32_max ( core::floor32 ( core::min_ ( a->Pos.x, b->Pos.x, c->Pos.x ) ), 0 );
+		const s32 x1 = core::s32_min ( core::ceil32 ( core::max_ ( a->Pos.x, b->Pos.x, c->Pos.x ) ), (s32) size.Width - 1 );
+		const s32 y0 = core::s32_max ( core::floor32 ( core::min_ ( a->Pos.y, b->Pos.y, c->Pos.y ) ), 0 );
+		const s32 y1 = core::s32_min ( core::ceil32 ( core::max_ ( a->Pos.y, b->Pos.y, c->Pos.y ) ), (s32) size.Height - 1 );
+
+		if ( x1 < x0 || y1 < y0 )
+			return false;
+
+		tile[0] = x0 >> SOFTWARE_DRIVER_2_TILE_SIZE_LOG2;
+		tile[1] = x1 >> SOFTWARE_DRIVER_2_TILE_SIZE_LOG2;
+		tile[2] = y0 >> SOFTWARE_DRIVER_2_TILE_SIZE_LOG2;
+		tile[3] = y1 >> SOFTWARE_DRIVER_2_TILE_SIZE_LOG2;
+		return true;
+	}
+
+
+	//! true if the triangle is behind the coarse depth of all tiles it touches
+	bool IBurningShader::isOccluded ( const s4DVertex *a, const s4DVertex *b, const s4DVertex *c )
+	{
+		u32 tile[4];
+		if ( 0 == DepthBuffer || !getTileRect ( a, b, c, tile ) )
+			return false;
+
+		// small triangles are cheaper to test per pixel than to update their tiles
+		if ( ( tile[1] - tile[0] + 1 ) * ( tile[3] - tile[2] + 1 ) < 4 )
+			return false;
+
+		// w buffer, the nearest value of the triangle is its largest 1/w
+		f32 zNear = core::max_ ( a->Pos.w, b->Pos.w, c->Pos.w );
+		zNear += zNear * DEPTH_TILE_BIAS;
+
+		for ( u32 y = tile[2]; y <= tile[3]; ++y )
+		{
+			if ( !isRowOwned ( y << SOFTWARE_DRIVER_2_TILE_SIZE_LOG2 ) )
+				continue;
+
+			for ( u32 x = tile[0]; x <= tile[1]; ++x )
+			{
+				if ( zNear >= DepthBuffer->getTileFar ( x, y ) )
+					return false;
+			}
+		}
+
+		return true;
+	}
+
+
+	//! marks the coarse depth of all tiles the triangle touches as written
+	void IBurningShader::markDepthTiles ( const s4DVertex *a, const s4DVertex *b, const s4DVertex *c )
+	{
+		u32 tile[4];
+		if ( 0 == DepthBuffer || !getTileRect ( a, b, c, tile ) )
+			return;
+
+		for ( u32 y = tile[2]; y <= tile[3]; ++y )
+		{
+			if ( isRowOwned ( y << SOFTWARE_DRIVER_2_TILE_SIZE_LOG2 ) )
+				DepthBuffer->markTiles ( tile[0], tile[1], y );
+		}
+	}
+
+
+	//! moves both ends of a span past the tiles in which it is behind the coarse depth
+	bool IBurningShader::clipSpanDepthTiles ( s32 y, s32 &xStart, s32 &xEnd, const f32 *x, const fp24 *w )
+	{
+		const u32 tileY = (u32) y >> SOFTWARE_DRIVER_2_TILE_SIZE_LOG2;
+
+		// w at the span ends of a tile, clamped to the span
+		const f32 wMin = core::min_ ( w[0], w[1] );
+		const f32 wMax = core::max_ ( w[0], w[1] );
+		const f32 dx = x[1] - x[0];
+		const f32 slope = dx > 0.0001f ? ( w[1] - w[0] ) / dx : 0.f;
+
+		// leading tiles
+		while ( xStart <= xEnd )
+		{
+			const s32 tileX = xStart >> SOFTWARE_DRIVER_2_TILE_SIZE_LOG2;
+			const s32 end = core::s32_min ( ( ( tileX + 1 ) << SOFTWARE_DRIVER_2_TILE_SIZE_LOG2 ) - 1, xEnd );
+
+			f32 zNear = core::max_ ( w[0] + slope * ( (f32) xStart - x[0] ), w[0] + slope * ( (f32) end - x[0] ) );
+			zNear = core::clamp ( zNear, wMin, wMax );
+			zNear += zNear * DEPTH_TILE_BIAS;
+
+			if ( zNear >= DepthBuffer->getTileFar ( tileX, tileY ) )
+				break;
+
+			xStart = end + 1;
+		}
+
+		// trailing tiles
+		while ( xStart <= xEnd )
+		{
+			const s32 tileX = xEnd >> SOFTWARE_DRIVER_2_TILE_SIZE_LOG2;
+			const s32 start = core::s32_max ( tileX << SOFTWARE_DRIVER_2_TILE_SIZE_LOG2, xStart );
+
+			f32 zNear = core::max_ ( w[0] + slope * ( (f32) start - x[0] ), w[0] + slope * ( (f32) xEnd - x[0] ) );
+			zNear = core::clamp ( zNear, wMin, wMax );
+			zNear += zNear * DEPTH_TILE_BIAS;
+
+			if ( zNear >= DepthBuffer->getTileFar ( tileX, tileY ) )
+				break;
+
+			xEnd = start - 1;
+		}
+
+		return xStart <= xEnd;
+	}
+
+#endif // SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+
+
 } // end namespace video
 } // end namespace irr
 
@@ -58,10 +58,13 @@ namespace video
 		void reset ()
 		{
 			Light.set_used ( 0 );
+			Active.set_used ( 0 );
 			Global_AmbientLight.set ( 0.f, 0.f, 0.f );
 			Flags = 0;
 		}
 		core::array<SBurningShaderLight> Light;
+		// indices of the lights which are on, so lighting skips all others
+		core::array<u32> Active;
 		sVec3 Global_AmbientLight;
 		sVec4 FogColor;
 		sVec4 campos;
@@ -138,24 +141,109 @@ namespace video
 		virtual void setTextureParam( u32 stage, video::CSoftwareTexture2* texture, s32 lodLevel);
 		virtual void drawTriangle ( const s4DVertex *a,const s4DVertex *b,const s4DVertex *c ) = 0;
 		virtual void drawLine ( const s4DVertex *a,const s4DVertex *b) {};
+		virtual void drawPoint ( const s4DVertex *a ) {};
 
 		virtual void setParam ( u32 index, f32 value) {};
 		virtual void setZCompareFunc ( u32 func) {};
 
 		virtual void setMaterial ( const SBurningShaderMaterial &material ) {};
 
+		//! true if the renderer clamps rows and spans to the viewport
+		/** Such renderers accept projected triangles reaching into the
+		guard band, without clipping them against the side planes. */
+		virtual bool canScissor () const { return false; }
+
+		//! restricts rasterization to the rows of every count'th band, starting with band index
+		void setRowBand ( u32 index, u32 count )
+		{
+			BandIndex = index;
+			BandCount = count;
+		}
+
+		//! returns the texture stage prepared by setTextureParam
+		const sInternalTexture& getTextureParam ( u32 stage ) const
+		{
+			return IT[stage];
+		}
+
+		//! copies a texture stage prepared by another renderer, without grabbing or locking the texture
+		void copyTextureParam ( u32 stage, const sInternalTexture& source )
+		{
+			sInternalTexture *it = &IT[stage];
+			it->textureXMask = source.textureXMask;
+			it->textureYMask = source.textureYMask;
+			it->pitchlog2 = source.pitchlog2;
+			it->data = source.data;
+			it->lodLevel = source.lodLevel;
+		}
+
 	protected:
 
+		//! clamps the rows [yStart,yEnd] of a triangle to the viewport
+		inline void scissorRows ( s32 &yStart, s32 &yEnd ) const
+		{
+			yStart = core::s32_max ( yStart, Scissor.UpperLeftCorner.Y );
+			yEnd = core::s32_min ( yEnd, Scissor.LowerRightCorner.Y - 1 );
+		}
+
+		//! clamps the pixels [xStart,xEnd] of a span to the viewport
+		inline void scissorSpan ( s32 &xStart, s32 &xEnd ) const
+		{
+			xStart = core::s32_max ( xStart, Scissor.UpperLeftCorner.X );
+			xEnd = core::s32_min ( xEnd, Scissor.LowerRightCorner.X - 1 );
+		}
+
+		//! true if the row belongs to the band set of this renderer
+		inline bool isRowOwned ( s32 y ) const
+		{
+			return BandCount < 2 ||
+				( (u32) y >> SOFTWARE_DRIVER_2_BAND_HEIGHT_LOG2 ) % BandCount == BandIndex;
+		}
+
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+		//! true if the triangle is behind the coarse depth of all tiles it touches
+		/** Only valid for renderers passing pixels with w >= z or w == z. */
+		bool isOccluded ( const s4DVertex *a, const s4DVertex *b, const s4DVertex *c );
+
+		//! marks the coarse depth of all tiles the triangle touches as written
+		void markDepthTiles ( const s4DVertex *a, const s4DVertex *b, const s4DVertex *c );
+
+		//! moves both ends of a span past the tiles in which it is behind the coarse depth
+		/** Returns false if the whole span is hidden. x and w are the
+		span start and end as in sScanLineData. */
+		inline bool clipSpanDepth ( s32 y, s32 &xStart, s32 &xEnd, const f32 *x, const fp24 *w )
+		{
+			if ( xEnd - xStart < ( 2 << SOFTWARE_DRIVER_2_TILE_SIZE_LOG2 ) || 0 == DepthBuffer )
+				return true;
+			return clipSpanDepthTiles ( y, xStart, xEnd, x, w );
+		}
+#else
+		bool isOccluded ( const s4DVertex *a, const s4DVertex *b, const s4DVertex *c ) { return false; }
+		void markDepthTiles ( const s4DVertex *a, const s4DVertex *b, const s4DVertex *c ) {}
+		bool clipSpanDepth ( s32 y, s32 &xStart, s32 &xEnd, const f32 *x, const fp24 *w ) { return true; }
+#endif
+
 		CBurningVideoDriver *Driver;
 
 		video::CImage* RenderTarget;
+		core::rect<s32> Scissor;
 		CDepthBuffer* DepthBuffer;
 		CStencilBuffer * Stencil;
 		tVideoSample ColorMask;
 
 		sInternalTexture IT[ BURNING_MATERIAL_MAX_TEXTURES ];
 
+		u32 BandIndex;
+		u32 BandCount;
+
 		static const tFixPointu dithermask[ 4 * 4];
+
+	private:
+
+#ifdef SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+		bool getTileRect ( const s4DVertex *a, const s4DVertex *b, const s4DVertex *c, u32 *tile ) const;
+		bool clipSpanDepthTiles ( s32 y, s32 &xStart, s32 &xEnd, const f32 *x, const fp24 *w );
+#endif
 	};
 
 
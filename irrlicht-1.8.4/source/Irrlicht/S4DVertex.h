@@ -9,6 +9,7 @@
 #include "SoftwareDriver2_compile_config.h"
 #include "SoftwareDriver2_helper.h"
 #include "irrAllocator.h"
+#include "irrArray.h"
 
 namespace irr
 {
@@ -401,7 +402,9 @@ enum e4DVertexFlag
 {
 	VERTEX4D_INSIDE		= 0x0000003F,
 	VERTEX4D_CLIPMASK	= 0x0000003F,
+	VERTEX4D_NEARFAR	= 0x00000003,
 	VERTEX4D_PROJECTED	= 0x00000100,
+	VERTEX4D_GUARDBAND	= 0x00000200,
 
 	VERTEX4D_FORMAT_MASK			= 0xFFFF0000,
 
@@ -496,7 +499,7 @@ struct s4DVertex
 struct SAlignedVertex
 {
 	SAlignedVertex ( u32 element, u32 aligned )
-		: ElementSize ( element )
+		: ElementSize ( element ), Aligned ( aligned )
 	{
 		u32 byteSize = (ElementSize << SIZEOF_SVERTEX_LOG2 ) + aligned;
 		mem = new u8 [ byteSize ];
@@ -508,9 +511,19 @@ struct SAlignedVertex
 		delete [] mem;
 	}
 
+	//! reallocates for element vertices, the content is lost
+	void resize ( u32 element )
+	{
+		delete [] mem;
+		ElementSize = element;
+		mem = new u8 [ (ElementSize << SIZEOF_SVERTEX_LOG2 ) + Aligned ];
+		data = (s4DVertex*) mem;
+	}
+
 	s4DVertex *data;
 	u8 *mem;
 	u32 ElementSize;
+	u32 Aligned;
 };
 
 
@@ -523,39 +536,139 @@ struct SVSize
 };
 
 
-// a cache info
-struct SCacheInfo
-{
-	u32 index;
-	u32 hit;
-};
+// default and smallest amount of cache lines
+#define VERTEXCACHE_ELEMENT	1024
+#define VERTEXCACHE_ELEMENT_MIN	16
+
+// vertices transformed at once
+#define VERTEXCACHE_BLOCK	16
+
+// primitives looked up at once
+#define VERTEXCACHE_BATCH	32
 
-#define VERTEXCACHE_ELEMENT	16
 #define VERTEXCACHE_MISS 0xFFFFFFFF
+
+/*
+	post transform cache, keyed by source index.
+	cache lines are replaced in fifo order, a table over the source vertices
+	finds them. a table entry is valid while its cache line was filled since
+	the last invalidate and still holds the source index, so the table itself
+	is never cleared.
+*/
 struct SVertexCache
 {
-	SVertexCache (): mem ( VERTEXCACHE_ELEMENT * 2, 128 ) {}
+	SVertexCache (): mem ( VERTEXCACHE_ELEMENT * 2, 128 )
+	{
+		resize ( VERTEXCACHE_ELEMENT );
+	}
+
+	//! sets the amount of cache lines, rounded up to a power of two
+	void resize ( u32 element )
+	{
+		element = core::max_ ( element, (u32) VERTEXCACHE_ELEMENT_MIN );
+
+		size = 1;
+		while ( size < element )
+			size <<= 1;
 
-	SCacheInfo info[VERTEXCACHE_ELEMENT];
+		if ( mem.ElementSize != size * 2 )
+			mem.resize ( size * 2 );
 
+		line.set_used ( size );
+		invalidate ();
+	}
+
+	//! makes room in the table for source indices up to count-1
+	void reserve ( u32 count )
+	{
+		const u32 old = info.size ();
+		if ( count <= old )
+			return;
+
+		info.set_used ( count );
+		irr::memset32 ( info.pointer () + old, VERTEXCACHE_MISS, ( count - old ) * sizeof ( u32 ) );
+	}
+
+	//! forgets all transformed vertices
+	void invalidate ()
+	{
+		fifo = 0;
+		used = 0;
+		faceRun = 0;
+		faceCount = 0;
+	}
+
+	//! returns the cache line holding sourceIndex, or VERTEXCACHE_MISS
+	inline u32 find ( u32 sourceIndex ) const
+	{
+		if ( sourceIndex >= info.size () )
+			return VERTEXCACHE_MISS;
+
+		const u32 l = info [ sourceIndex ];
+		if ( l < used && line [ l ] == sourceIndex )
+			return l;
+		return VERTEXCACHE_MISS;
+	}
+
+	//! assigns the next cache line in fifo order to sourceIndex
+	inline u32 insert ( u32 sourceIndex )
+	{
+		const u32 l = fifo;
+		fifo = ( fifo + 1 ) & ( size - 1 );
+		if ( used < size )
+			used += 1;
+
+		line [ l ] = sourceIndex;
+		if ( sourceIndex < info.size () )
+			info [ sourceIndex ] = l;
+		return l;
+	}
+
+	//! transformed vertex pair of a cache line
+	inline s4DVertex * getLine ( u32 l ) const
+	{
+		return (s4DVertex *) ( (u8*) mem.data + ( l << ( SIZEOF_SVERTEX_LOG2 + 1 ) ) );
+	}
+
+	// cache line of each source vertex
+	core::array<u32> info;
+
+	// source index held by each cache line
+	core::array<u32> line;
 
 	// Transformed and lite, clipping state
 	// + Clipped, Projected
 	SAlignedVertex mem;
 
+	// cache lines, power of two
+	u32 size;
+
+	// next cache line to replace
+	u32 fifo;
+
+	// cache lines filled since the last invalidate
+	u32 used;
+
+	// vertices of the primitives looked up at once
+	const s4DVertex *face[VERTEXCACHE_BATCH * 3];
+	u32 faceRun;
+	u32 faceCount;
+
 	// source
 	const void* vertices;
 	u32 vertexCount;
 
 	const void* indices;
 	u32 indexCount;
-	u32 indicesIndex;
 
 	u32 indicesRun;
 
 	// primitives consist of x vertices
 	u32 primitivePitch;
 
+	// vertices looked up per primitive, 1 for points, 2 for lines, 3 for triangles
+	u32 primitiveSize;
+
 	u32 vType;		//E_VERTEX_TYPE
 	u32 pType;		//scene::E_PRIMITIVE_TYPE
 	u32 iType;		//E_INDEX_TYPE iType
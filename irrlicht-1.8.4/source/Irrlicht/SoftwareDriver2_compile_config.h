@@ -93,6 +93,32 @@
 
 #define SOFTWARE_DRIVER_2_MIPMAPPING_SCALE (8/SOFTWARE_DRIVER_2_MIPMAPPING_MAX)
 
+// batched vertex transform with sse, the scalar reference is used otherwise
+#if !defined(NO_SOFTWARE_DRIVER_2_SSE) && ( defined(__SSE__) || defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 1 ) )
+	#define SOFTWARE_DRIVER_2_SSE
+	#include <xmmintrin.h>
+#endif
+
+// packed integer mip map generation and bilinear sampling
+#if defined ( SOFTWARE_DRIVER_2_SSE ) && ( defined(__SSE2__) || defined(_M_X64) || ( defined(_M_IX86_FP) && _M_IX86_FP >= 2 ) )
+	#define SOFTWARE_DRIVER_2_SSE2
+	#include <emmintrin.h>
+#endif
+
+// rasterizer threads own interleaved bands of 1 << SOFTWARE_DRIVER_2_BAND_HEIGHT_LOG2 rows
+#define SOFTWARE_DRIVER_2_BAND_HEIGHT_LOG2	4
+
+// farthest depth of square tiles, to reject hidden triangles and span ends early.
+// tiles must not be higher than bands, so each tile is written by one thread only
+#if defined ( SOFTWARE_DRIVER_2_USE_WBUFFER ) && !defined ( NO_SOFTWARE_DRIVER_2_HIERARCHICAL_Z )
+	#define SOFTWARE_DRIVER_2_HIERARCHICAL_Z
+#endif
+#define SOFTWARE_DRIVER_2_TILE_SIZE_LOG2	3
+
+// triangles inside this multiple of the viewport in ndc are scissored by the renderers
+// instead of clipped against the side planes
+#define SOFTWARE_DRIVER_2_GUARD_BAND	8.f
+
 #ifndef REALINLINE
 	#ifdef _MSC_VER
 		#define REALINLINE __forceinline
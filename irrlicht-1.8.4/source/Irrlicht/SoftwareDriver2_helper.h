@@ -863,6 +863,71 @@ REALINLINE void getSample_linear ( tFixPointu &r, tFixPointu &g, tFixPointu &b,
 	b	 =	(t00 & MASK_B);
 }
 
+#if defined ( SOFTWARE_DRIVER_2_SSE2 ) && defined ( SOFTWARE_DRIVER_2_32BIT )
+
+// get Sample bilinear, the four texels are weighted with packed 16 bit multiply adds.
+// returns the weighted sums of b,g,r,a, equal to the scalar sampler
+REALINLINE __m128i getSample_bilinear ( const sInternalTexture * t, const tFixPointu tx, const tFixPointu ty )
+{
+	u32 o0, o1,o2,o3;
+
+	o0 = ( ( (ty) & t->textureYMask ) >> FIX_POINT_PRE ) << t->pitchlog2;
+	o1 = ( ( (ty+FIX_POINT_ONE) & t->textureYMask ) >> FIX_POINT_PRE ) << t->pitchlog2;
+	o2 =   ( (tx) & t->textureXMask ) >> ( FIX_POINT_PRE - VIDEO_SAMPLE_GRANULARITY );
+	o3 =   ( (tx+FIX_POINT_ONE) & t->textureXMask ) >> ( FIX_POINT_PRE - VIDEO_SAMPLE_GRANULARITY );
+
+	const __m128i zero = _mm_setzero_si128 ();
+
+	// b00 b10 g00 g10 r00 r10 a00 a10 as 16 bit, same for the lower row
+	const __m128i t0 = _mm_unpacklo_epi8 ( _mm_unpacklo_epi8 (
+					_mm_cvtsi32_si128 ( *((tVideoSample*)( (u8*) t->data + (o0 | o2 ) )) ),
+					_mm_cvtsi32_si128 ( *((tVideoSample*)( (u8*) t->data + (o0 | o3 ) )) ) ), zero );
+	const __m128i t1 = _mm_unpacklo_epi8 ( _mm_unpacklo_epi8 (
+					_mm_cvtsi32_si128 ( *((tVideoSample*)( (u8*) t->data + (o1 | o2 ) )) ),
+					_mm_cvtsi32_si128 ( *((tVideoSample*)( (u8*) t->data + (o1 | o3 ) )) ) ), zero );
+
+	const tFixPointu txFract = tx & FIX_POINT_FRACT_MASK;
+	const tFixPointu txFractInv = FIX_POINT_ONE - txFract;
+
+	const tFixPointu tyFract = ty & FIX_POINT_FRACT_MASK;
+	const tFixPointu tyFractInv = FIX_POINT_ONE - tyFract;
+
+	const tFixPointu w00 = imulFixu ( txFractInv, tyFractInv );
+	const tFixPointu w10 = imulFixu ( txFract	, tyFractInv );
+	const tFixPointu w01 = imulFixu ( txFractInv, tyFract );
+	const tFixPointu w11 = imulFixu ( txFract	, tyFract );
+
+	return _mm_add_epi32 (	_mm_madd_epi16 ( t0, _mm_set1_epi32 ( w00 | ( w10 << 16 ) ) ),
+							_mm_madd_epi16 ( t1, _mm_set1_epi32 ( w01 | ( w11 << 16 ) ) ) );
+}
+
+// get Sample bilinear
+REALINLINE void getSample_texture ( tFixPoint &r, tFixPoint &g, tFixPoint &b,
+								const sInternalTexture * t, const tFixPointu tx, const tFixPointu ty
+								)
+{
+	const __m128i s = getSample_bilinear ( t, tx, ty );
+
+	b = _mm_cvtsi128_si32 ( s );
+	g = _mm_cvtsi128_si32 ( _mm_srli_si128 ( s, 4 ) );
+	r = _mm_cvtsi128_si32 ( _mm_srli_si128 ( s, 8 ) );
+}
+
+// get Sample bilinear
+REALINLINE void getSample_texture ( tFixPoint &a, tFixPoint &r, tFixPoint &g, tFixPoint &b,
+								const sInternalTexture * t, const tFixPointu tx, const tFixPointu ty
+								)
+{
+	const __m128i s = getSample_bilinear ( t, tx, ty );
+
+	b = _mm_cvtsi128_si32 ( s );
+	g = _mm_cvtsi128_si32 ( _mm_srli_si128 ( s, 4 ) );
+	r = _mm_cvtsi128_si32 ( _mm_srli_si128 ( s, 8 ) );
+	a = _mm_cvtsi128_si32 ( _mm_srli_si128 ( s, 12 ) );
+}
+
+#else
+
 // get Sample bilinear
 REALINLINE void getSample_texture ( tFixPoint &r, tFixPoint &g, tFixPoint &b,
 								const sInternalTexture * t, const tFixPointu tx, const tFixPointu ty
@@ -1000,6 +1065,8 @@ REALINLINE void getSample_texture ( tFixPoint &a, tFixPoint &r, tFixPoint &g, tF
 
 }
 
+#endif // SOFTWARE_DRIVER_2_SSE2
+
 
 #endif
 
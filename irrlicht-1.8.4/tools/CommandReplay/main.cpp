@@ -0,0 +1,133 @@
+#include <irrlicht.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace irr;
+
+using namespace core;
+using namespace video;
+using namespace io;
+
+#ifdef _IRR_WINDOWS_
+#pragma comment(lib, "Irrlicht.lib")
+#endif
+
+void usage(const char* name)
+{
+	fprintf(stderr, "Usage: %s [options] <commandFile>\n", name);
+	fprintf(stderr, "  replays a command stream written by IVideoDriver::startCommandRecording\n");
+	fprintf(stderr, "  where options are\n");
+	fprintf(stderr, " --driver=[burnings|software|opengl|d3d9|null]: Driver to replay on, default burnings\n");
+	fprintf(stderr, " --size=<width>x<height>: Window size, default 640x480\n");
+	fprintf(stderr, " --repeat=<n>: Replay the stream n times, default 1\n");
+}
+
+int main(int argc, char* argv[])
+{
+	E_DRIVER_TYPE driverType = EDT_BURNINGSVIDEO;
+	dimension2d<u32> size(640, 480);
+	u32 repeat = 1;
+
+	int i = 1;
+	for (; i < argc && argv[i][0] == '-'; ++i)
+	{
+		stringc option = argv[i];
+		if (option.equalsn("--driver=", 9))
+		{
+			option = option.subString(9, option.size());
+			if (option == "software")
+				driverType = EDT_SOFTWARE;
+			else if (option == "opengl")
+				driverType = EDT_OPENGL;
+			else if (option == "d3d9")
+				driverType = EDT_DIRECT3D9;
+			else if (option == "null")
+				driverType = EDT_NULL;
+			else
+				driverType = EDT_BURNINGSVIDEO;
+		}
+		else if (option.equalsn("--size=", 7))
+		{
+			u32 width, height;
+			if (sscanf(argv[i] + 7, "%ux%u", &width, &height) == 2)
+				size.set(width, height);
+		}
+		else if (option.equalsn("--repeat=", 9))
+			repeat = (u32)core::max_(1, atoi(argv[i] + 9));
+		else
+		{
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (i != argc - 1)
+	{
+		usage(argv[0]);
+		return 1;
+	}
+
+	IrrlichtDevice* device = createDevice(driverType, size, 32, false, false, false, 0);
+	if (!device)
+	{
+		fprintf(stderr, "Could not create the driver\n");
+		return 1;
+	}
+	device->setWindowCaption(L"Command Replay");
+	IVideoDriver* driver = device->getVideoDriver();
+
+	IReadFile* file = device->getFileSystem()->createAndOpenFile(argv[i]);
+	if (!file)
+	{
+		fprintf(stderr, "Could not open %s\n", argv[i]);
+		device->drop();
+		return 1;
+	}
+
+	// sums of all runs, by command
+	u32 count[EVC_COUNT] = { 0 };
+	u32 maximum[EVC_COUNT] = { 0 };
+	f64 total[EVC_COUNT] = { 0 };
+
+	array<SVideoCommandTiming> timings;
+	for (u32 run = 0; run != repeat && device->run(); ++run)
+	{
+		timings.set_used(0);
+		file->seek(0);
+		if (driver->replayCommands(file, &timings) < 0)
+		{
+			fprintf(stderr, "%s is not a command stream\n", argv[i]);
+			file->drop();
+			device->drop();
+			return 1;
+		}
+
+		for (u32 j = 0; j != timings.size(); ++j)
+		{
+			const SVideoCommandTiming& timing = timings[j];
+			++count[timing.Command];
+			total[timing.Command] += timing.Time;
+			maximum[timing.Command] = core::max_(maximum[timing.Command], timing.Time);
+		}
+	}
+
+	const u32 frames = count[EVC_END_SCENE];
+	f64 sum = 0;
+	printf("%-28s %10s %12s %10s %10s\n", "command", "calls", "total ms", "avg us", "max us");
+	for (u32 c = 0; c != EVC_COUNT; ++c)
+	{
+		if (!count[c])
+			continue;
+		sum += total[c];
+		printf("%-28s %10u %12.3f %10.2f %10u\n", VideoCommandNames[c], count[c],
+			total[c] / 1000.0, total[c] / count[c], maximum[c]);
+	}
+	printf("%u frames, %.3f ms, %.3f ms per frame\n", frames, sum / 1000.0,
+		frames ? sum / 1000.0 / frames : 0.0);
+
+	file->drop();
+	device->drop();
+
+	return 0;
+}
+